@@ -0,0 +1,179 @@
+//==============================================================================
+// AxisFilter.h - Estimation de la vitesse et de l'accélération d'un axe
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Les conditions amortisseur, inertie et frottement ont besoin de la vitesse
+// et de l'accélération du volant, que evdev ne fournit pas. Dériver deux fois
+// une position quantifiée sur 10 bits et horodatée irrégulièrement amplifie
+// le bruit de quantification : l'estimation passe par un filtre de Kalman à
+// accélération constante (état position/vitesse/accélération, jerk blanc).
+//  - Le pas de temps de chaque mise à jour est l'écart réel entre deux
+//    horodatages de trame (SYN_REPORT).
+//  - Le bruit de mesure est celui de la quantification (pas²/12).
+//  - Un volant immobile n'émet rien : Hold() confirme la dernière position à
+//    l'instant de lecture, ce qui ramène vitesse et accélération vers 0.
+// Une mise à jour coûte quelques dizaines d'opérations flottantes.
+//
+// Échelles (Q15, comme AxisState) :
+//  - vitesse : ±32767 = AXIS_VELOCITY_FULL_SCALE demi-courses par seconde ;
+//  - accélération : ±32767 = AXIS_ACCELERATION_FULL_SCALE demi-courses/s².
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+//==============================================================================
+// PARAMÈTRES
+//==============================================================================
+
+const float AXIS_VELOCITY_FULL_SCALE = 8.0f;           // 4 allers de butée à butée par s
+const float AXIS_ACCELERATION_FULL_SCALE = 256.0f;
+
+struct AxisFilterParams
+{
+    float jerkDensity;           // Densité spectrale du jerk (Q15²/s⁵)
+    float measurementNoise;      // Variance de la mesure (Q15²)
+    int64_t minStepNs;           // Pas minimal (horodatages égaux)
+    int64_t maxStepNs;           // Pas maximal (reprise après une longue pause)
+
+    AxisFilterParams()
+        : jerkDensity(5.0e12f)
+        , measurementNoise(64.0f * 64.0f / 12.0f)        // Pas de 10 bits ramené en Q15
+        , minStepNs(100000), maxStepNs(100000000)
+    {
+    }
+};
+
+//==============================================================================
+// FILTRE
+//==============================================================================
+
+class AxisFilter
+{
+private:
+    AxisFilterParams m_Params;
+    bool m_bHaveSample;
+    int64_t m_LastNs;
+    float m_State[3];            // Position (Q15), vitesse (Q15/s), accélération (Q15/s²)
+    float m_Cov[3][3];
+
+    static int32_t ToQ15(float value, float fullScale)
+    {
+        const float scaled = value / fullScale;
+        return static_cast<int32_t>(std::max(-32767.0f, std::min(32767.0f, scaled)));
+    }
+
+public:
+    AxisFilter()
+    {
+        Reset();
+    }
+
+    void SetParams(const AxisFilterParams& params) { m_Params = params; }
+
+    void Reset()
+    {
+        m_bHaveSample = false;
+        m_LastNs = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            m_State[i] = 0.0f;
+            for (int j = 0; j < 3; j++)
+                m_Cov[i][j] = 0.0f;
+        }
+    }
+
+    /**
+     * Mesure de position (Q15) horodatée en ns. Les mesures antérieures à
+     * la précédente sont ignorées.
+     */
+    void Update(int64_t timeNs, int32_t position)
+    {
+        const float z = static_cast<float>(position);
+        if (!m_bHaveSample)
+        {
+            Reset();
+            m_bHaveSample = true;
+            m_LastNs = timeNs;
+            m_State[0] = z;
+            m_Cov[0][0] = m_Params.measurementNoise;
+            m_Cov[1][1] = 32767.0f * 32767.0f;
+            m_Cov[2][2] = 32767.0f * 32767.0f * 64.0f;
+            return;
+        }
+        if (timeNs < m_LastNs)
+            return;
+
+        const int64_t stepNs = std::min(std::max(timeNs - m_LastNs, m_Params.minStepNs), m_Params.maxStepNs);
+        const float dt = static_cast<float>(stepNs) * 1e-9f;
+        const float dt2 = dt * dt;
+        const float dt3 = dt2 * dt;
+
+        // Prédiction : x = F x, P = F P F' + Q
+        m_State[0] += m_State[1] * dt + 0.5f * m_State[2] * dt2;
+        m_State[1] += m_State[2] * dt;
+
+        float fp[3][3];
+        for (int j = 0; j < 3; j++)
+        {
+            fp[0][j] = m_Cov[0][j] + dt * m_Cov[1][j] + 0.5f * dt2 * m_Cov[2][j];
+            fp[1][j] = m_Cov[1][j] + dt * m_Cov[2][j];
+            fp[2][j] = m_Cov[2][j];
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            m_Cov[i][0] = fp[i][0] + dt * fp[i][1] + 0.5f * dt2 * fp[i][2];
+            m_Cov[i][1] = fp[i][1] + dt * fp[i][2];
+            m_Cov[i][2] = fp[i][2];
+        }
+
+        const float q = m_Params.jerkDensity;
+        m_Cov[0][0] += q * dt3 * dt2 / 20.0f;
+        m_Cov[0][1] += q * dt2 * dt2 / 8.0f;
+        m_Cov[0][2] += q * dt3 / 6.0f;
+        m_Cov[1][0] += q * dt2 * dt2 / 8.0f;
+        m_Cov[1][1] += q * dt3 / 3.0f;
+        m_Cov[1][2] += q * dt2 / 2.0f;
+        m_Cov[2][0] += q * dt3 / 6.0f;
+        m_Cov[2][1] += q * dt2 / 2.0f;
+        m_Cov[2][2] += q * dt;
+
+        // Correction (mesure scalaire de la position)
+        const float innovation = z - m_State[0];
+        const float s = m_Cov[0][0] + m_Params.measurementNoise;
+        float gain[3];
+        for (int i = 0; i < 3; i++)
+            gain[i] = m_Cov[i][0] / s;
+
+        for (int i = 0; i < 3; i++)
+            m_State[i] += gain[i] * innovation;
+
+        const float row[3] = { m_Cov[0][0], m_Cov[0][1], m_Cov[0][2] };
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+                m_Cov[i][j] -= gain[i] * row[j];
+        }
+
+        m_LastNs = timeNs;
+    }
+
+    /**
+     * Aucun événement depuis la dernière mesure : la position n'a pas changé
+     * jusqu'à timeNs (evdev ne signale que les changements).
+     */
+    void Hold(int64_t timeNs, int32_t position)
+    {
+        if (m_bHaveSample && timeNs > m_LastNs)
+            Update(timeNs, position);
+    }
+
+    bool HasSample() const { return m_bHaveSample; }
+    int32_t GetPosition() const { return static_cast<int32_t>(std::max(-32767.0f, std::min(32767.0f, m_State[0]))); }
+    int32_t GetVelocity() const { return ToQ15(m_State[1], AXIS_VELOCITY_FULL_SCALE); }
+    int32_t GetAcceleration() const { return ToQ15(m_State[2], AXIS_ACCELERATION_FULL_SCALE); }
+};
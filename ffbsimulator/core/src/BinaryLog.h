@@ -0,0 +1,510 @@
+//==============================================================================
+// BinaryLog.h - Format de log binaire et décodeur
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// En mode binaire, le logger n'écrit pas de texte. Chaque appel de log
+// (niveau, littéraux du code, types des autres arguments) est décrit une
+// seule fois par segment dans un enregistrement Format ; chaque ligne ne
+// contient ensuite que l'écart de temps monotone brut depuis la ligne
+// précédente, l'ID du format et les valeurs dynamiques. Le formatage
+// (texte, heure murale) est fait hors ligne par BinaryLogReader (ffblog).
+//
+// Fichier : suite d'enregistrements [varint taille][u8 type][contenu]
+//  - Header : BinaryLogHeader (début de chaque segment, d'où des segments
+//    concaténables : zcat log.*.gz | ffblog -) ;
+//  - Format : varint ID (attribués dans l'ordre), niveau (chaîne), u8
+//    nombre d'arguments, puis par argument u8 BinaryLogTag et, pour un
+//    littéral, son texte (chaîne) ;
+//  - Line : varint écart en ns, varint ID du format, puis les valeurs des
+//    arguments non littéraux dans l'ordre. Une ligne tronquée s'arrête
+//    au premier argument qui ne tenait pas ;
+//  - End : varint écart en ns (fin de session).
+// Chaîne = varint longueur + octets. Entiers en varint (zigzag si signés),
+// flottants bruts dans l'ordre des octets de la machine (vérifié par
+// l'en-tête).
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <istream>
+#include <sstream>
+
+//==============================================================================
+// FORMAT
+//==============================================================================
+
+const char BINARY_LOG_MAGIC[8] = { 'F', 'F', 'B', 'B', 'L', 'O', 'G', '\0' };
+const uint16_t BINARY_LOG_VERSION = 1;
+const uint32_t BINARY_LOG_BYTE_ORDER = 0x01020304;
+const size_t BINARY_LOG_RECORD_CAPACITY = 1024;         // Taille max d'un enregistrement
+
+#pragma pack(push, 1)
+struct BinaryLogHeader
+{
+    char magic[8];
+    uint16_t version;
+    uint32_t byteOrder;
+    int64_t realtimeNs;          // Heure murale au même instant que monotonicNs
+    int64_t monotonicNs;         // Origine des écarts de la première ligne
+};
+#pragma pack(pop)
+
+enum class BinaryLogRecord : uint8_t
+{
+    Header = 0,
+    Format = 1,
+    Line = 2,
+    End = 3
+};
+
+enum class BinaryLogTag : uint8_t
+{
+    Literal = 1,                 // Texte dans le format, rien dans la ligne
+    String = 2,                  // Chaîne
+    Int = 3,                     // varint zigzag
+    UInt = 4,                    // varint
+    Float = 5,                   // f32
+    Double = 6,                  // f64
+    Hex = 7,                     // varint (32 bits), affiché 0x...
+    Char = 8,                    // 1 octet
+    Bool = 9                     // 1 octet, affiché 0/1 comme ostream
+};
+
+//==============================================================================
+// ÉCRITURE
+//==============================================================================
+
+/**
+ * Enregistrement en cours de construction (tampon fixe, sans allocation).
+ * Ce qui dépasse la capacité est abandonné : la valeur en cours est
+ * retirée et Full() devient vrai.
+ */
+class BinaryLogRecordBuffer
+{
+private:
+    static const size_t SIZE_PREFIX = 2;    // varint de la taille (< 16384)
+
+    uint8_t m_Data[SIZE_PREFIX + BINARY_LOG_RECORD_CAPACITY];
+    size_t m_Size;
+    bool m_bFull;
+
+public:
+    BinaryLogRecordBuffer() : m_Size(0), m_bFull(false) {}
+
+    void Begin(BinaryLogRecord type)
+    {
+        m_Size = SIZE_PREFIX;
+        m_bFull = false;
+        m_Data[m_Size++] = static_cast<uint8_t>(type);
+    }
+
+    bool Put(const void* data, size_t size)
+    {
+        if (m_bFull || m_Size + size > sizeof(m_Data))
+        {
+            m_bFull = true;
+            return false;
+        }
+        memcpy(m_Data + m_Size, data, size);
+        m_Size += size;
+        return true;
+    }
+
+    template<typename T>
+    bool PutValue(T value) { return Put(&value, sizeof(value)); }
+
+    bool PutVarint(uint64_t value)
+    {
+        uint8_t bytes[10];
+        size_t count = 0;
+        while (value >= 0x80)
+        {
+            bytes[count++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        bytes[count++] = static_cast<uint8_t>(value);
+        return Put(bytes, count);
+    }
+
+    bool PutZigzag(int64_t value)
+    {
+        return PutVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    /**
+     * Chaîne tronquée à la place restante, comme une ligne texte.
+     */
+    bool PutString(const char* text, size_t length)
+    {
+        const size_t room = sizeof(m_Data) - m_Size;
+        if (m_bFull || room < SIZE_PREFIX)
+        {
+            m_bFull = true;
+            return false;
+        }
+        length = std::min(length, room - SIZE_PREFIX);
+        return PutVarint(length) && Put(text, length);
+    }
+
+    /**
+     * Écrit la taille en tête et renvoie l'enregistrement complet.
+     */
+    const uint8_t* Finish(size_t& size)
+    {
+        const size_t payload = m_Size - SIZE_PREFIX;
+        if (payload < 0x80)
+        {
+            m_Data[1] = static_cast<uint8_t>(payload);
+            size = payload + 1;
+            return m_Data + 1;
+        }
+        m_Data[0] = static_cast<uint8_t>(payload | 0x80);
+        m_Data[1] = static_cast<uint8_t>(payload >> 7);
+        size = m_Size;
+        return m_Data;
+    }
+
+    bool Full() const { return m_bFull; }
+};
+
+inline BinaryLogHeader MakeBinaryLogHeader(int64_t realtimeNs, int64_t monotonicNs)
+{
+    BinaryLogHeader header;
+    memcpy(header.magic, BINARY_LOG_MAGIC, sizeof(header.magic));
+    header.version = BINARY_LOG_VERSION;
+    header.byteOrder = BINARY_LOG_BYTE_ORDER;
+    header.realtimeNs = realtimeNs;
+    header.monotonicNs = monotonicNs;
+    return header;
+}
+
+//==============================================================================
+// DÉCODAGE
+//==============================================================================
+
+/**
+ * Relit un log binaire et restitue les lignes au format du log texte.
+ * Un fichier peut contenir plusieurs segments concaténés (en-tête répété).
+ */
+class BinaryLogReader
+{
+private:
+    struct FormatArg
+    {
+        BinaryLogTag tag;
+        std::string text;        // Littéral
+    };
+
+    struct Format
+    {
+        std::string level;
+        std::vector<FormatArg> args;
+    };
+
+    std::istream& m_In;
+    BinaryLogHeader m_Header;
+    bool m_bHaveHeader;
+    int64_t m_LastNs;                    // Horodatage de la ligne précédente
+    std::vector<Format> m_Formats;       // Index = ID
+    std::string m_Error;
+    uint64_t m_Lines;
+
+    template<typename T>
+    static bool Take(const uint8_t*& p, const uint8_t* end, T& value)
+    {
+        if (static_cast<size_t>(end - p) < sizeof(T))
+            return false;
+        memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    static bool TakeVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7)
+        {
+            const uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    static bool TakeString(const uint8_t*& p, const uint8_t* end, std::string& text)
+    {
+        uint64_t length;
+        if (!TakeVarint(p, end, length) || static_cast<uint64_t>(end - p) < length)
+            return false;
+        text.assign(reinterpret_cast<const char*>(p), static_cast<size_t>(length));
+        p += length;
+        return true;
+    }
+
+    bool ReadHeader(const uint8_t* p, const uint8_t* end)
+    {
+        BinaryLogHeader header;
+        if (!Take(p, end, header) || memcmp(header.magic, BINARY_LOG_MAGIC, sizeof(header.magic)) != 0)
+        {
+            m_Error = "en-tête de log binaire invalide";
+            return false;
+        }
+        if (header.byteOrder != BINARY_LOG_BYTE_ORDER || header.version != BINARY_LOG_VERSION)
+        {
+            m_Error = "version ou ordre des octets non supporté";
+            return false;
+        }
+        m_Header = header;
+        m_bHaveHeader = true;
+        m_LastNs = header.monotonicNs;
+        m_Formats.clear();
+        return true;
+    }
+
+    bool ReadFormat(const uint8_t* p, const uint8_t* end)
+    {
+        // IDs attribués dans l'ordre : un saut signale un fichier corrompu
+        uint64_t id;
+        Format format;
+        uint8_t count;
+        if (!TakeVarint(p, end, id) || id != m_Formats.size() ||
+            !TakeString(p, end, format.level) || !Take(p, end, count))
+            return false;
+
+        // Définition tronquée à l'écriture : arguments restants ignorés
+        for (uint8_t i = 0; i < count; i++)
+        {
+            FormatArg arg;
+            uint8_t tag;
+            if (!Take(p, end, tag))
+                break;
+            arg.tag = static_cast<BinaryLogTag>(tag);
+            if (arg.tag == BinaryLogTag::Literal && !TakeString(p, end, arg.text))
+                break;
+            format.args.push_back(arg);
+        }
+
+        m_Formats.push_back(format);
+        return true;
+    }
+
+    void FormatTime(std::ostream& out, int64_t monotonicNs) const
+    {
+        const int64_t wallNs = m_Header.realtimeNs + (monotonicNs - m_Header.monotonicNs);
+        const time_t seconds = static_cast<time_t>(wallNs / 1000000000LL);
+        struct tm timeinfo;
+#if defined(_WIN32)
+        localtime_s(&timeinfo, &seconds);
+#else
+        localtime_r(&seconds, &timeinfo);
+#endif
+        char buffer[48];
+        const size_t length = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
+        snprintf(buffer + length, sizeof(buffer) - length, ".%03d",
+                 static_cast<int>((wallNs / 1000000) % 1000));
+        out << buffer;
+    }
+
+    /**
+     * Valeur d'un argument non littéral.
+     * @return false si la ligne s'arrête avant (troncature).
+     */
+    static bool FormatValue(BinaryLogTag tag, const uint8_t*& p, const uint8_t* end, std::ostream& out)
+    {
+        uint64_t value;
+        switch (tag)
+        {
+        case BinaryLogTag::String:
+        {
+            std::string text;
+            if (!TakeString(p, end, text))
+                return false;
+            out << text;
+            return true;
+        }
+        case BinaryLogTag::Int:
+            if (!TakeVarint(p, end, value))
+                return false;
+            out << static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+            return true;
+        case BinaryLogTag::UInt:
+            if (!TakeVarint(p, end, value))
+                return false;
+            out << value;
+            return true;
+        case BinaryLogTag::Float:
+        {
+            float number;
+            if (!Take(p, end, number))
+                return false;
+            out << number;
+            return true;
+        }
+        case BinaryLogTag::Double:
+        {
+            double number;
+            if (!Take(p, end, number))
+                return false;
+            out << number;
+            return true;
+        }
+        case BinaryLogTag::Hex:
+            if (!TakeVarint(p, end, value))
+                return false;
+            out << "0x" << std::hex << std::uppercase << static_cast<uint32_t>(value) << std::dec << std::nouppercase;
+            return true;
+        case BinaryLogTag::Char:
+        case BinaryLogTag::Bool:
+        {
+            uint8_t byte;
+            if (!Take(p, end, byte))
+                return false;
+            if (tag == BinaryLogTag::Char)
+                out << static_cast<char>(byte);
+            else
+                out << static_cast<int>(byte);
+            return true;
+        }
+        case BinaryLogTag::Literal:
+            break;
+        }
+        return false;
+    }
+
+    bool FormatLine(const uint8_t* p, const uint8_t* end, std::string& line)
+    {
+        uint64_t delta;
+        uint64_t id;
+        if (!TakeVarint(p, end, delta) || !TakeVarint(p, end, id) || id >= m_Formats.size())
+            return false;
+        m_LastNs += static_cast<int64_t>(delta);
+
+        const Format& format = m_Formats[id];
+        std::ostringstream out;
+        out << '[';
+        FormatTime(out, m_LastNs);
+        out << "] [" << format.level << "] ";
+
+        for (const FormatArg& arg : format.args)
+        {
+            if (arg.tag == BinaryLogTag::Literal)
+                out << arg.text;
+            else if (!FormatValue(arg.tag, p, end, out))
+                break;
+        }
+
+        line = out.str();
+        m_Lines++;
+        return true;
+    }
+
+public:
+    explicit BinaryLogReader(std::istream& in) : m_In(in), m_bHaveHeader(false), m_LastNs(0), m_Lines(0)
+    {
+        memset(&m_Header, 0, sizeof(m_Header));
+    }
+
+    /**
+     * Ligne suivante, au format du log texte. Le début de chaque segment
+     * et la fin de session sont restitués par une ligne "=== ... ===".
+     * @return false en fin de fichier ou sur erreur (GetError() non vide).
+     */
+    bool Next(std::string& line)
+    {
+        for (;;)
+        {
+            // Taille : varint sur un ou deux octets
+            uint8_t first;
+            if (!m_In.read(reinterpret_cast<char*>(&first), 1))
+                return false;
+            size_t payload = first & 0x7F;
+            if (first & 0x80)
+            {
+                uint8_t second;
+                if (!m_In.read(reinterpret_cast<char*>(&second), 1) || (second & 0x80))
+                {
+                    m_Error = "enregistrement tronqué";
+                    return false;
+                }
+                payload |= static_cast<size_t>(second) << 7;
+            }
+
+            uint8_t record[BINARY_LOG_RECORD_CAPACITY];
+            if (payload == 0 || payload > sizeof(record) ||
+                !m_In.read(reinterpret_cast<char*>(record), static_cast<std::streamsize>(payload)))
+            {
+                m_Error = "enregistrement tronqué";
+                return false;
+            }
+
+            const uint8_t* p = record + 1;
+            const uint8_t* end = record + payload;
+            const BinaryLogRecord type = static_cast<BinaryLogRecord>(record[0]);
+            if (type == BinaryLogRecord::Header)
+            {
+                if (!ReadHeader(p, end))
+                    return false;
+                line = "=== Segment démarré: " + GetStartTime() + " ===";
+                return true;
+            }
+            if (!m_bHaveHeader)
+            {
+                m_Error = "en-tête de log binaire absent";
+                return false;
+            }
+
+            switch (type)
+            {
+            case BinaryLogRecord::Header:
+                break;
+            case BinaryLogRecord::Format:
+                if (ReadFormat(p, end))
+                    continue;
+                break;
+            case BinaryLogRecord::Line:
+                if (FormatLine(p, end, line))
+                    return true;
+                break;
+            case BinaryLogRecord::End:
+            {
+                uint64_t delta;
+                if (!TakeVarint(p, end, delta))
+                    break;
+                m_LastNs += static_cast<int64_t>(delta);
+                std::ostringstream out;
+                out << "=== Session terminée: ";
+                FormatTime(out, m_LastNs);
+                out << " ===";
+                line = out.str();
+                return true;
+            }
+            }
+
+            m_Error = "enregistrement invalide";
+            return false;
+        }
+    }
+
+    /**
+     * Début de session du segment courant (heure murale).
+     */
+    std::string GetStartTime() const
+    {
+        std::ostringstream out;
+        FormatTime(out, m_Header.monotonicNs);
+        return out.str();
+    }
+
+    const std::string& GetError() const { return m_Error; }
+    uint64_t GetLineCount() const { return m_Lines; }
+};
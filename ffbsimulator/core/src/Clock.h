@@ -0,0 +1,82 @@
+//==============================================================================
+// Clock.h - Horloge monotone et attente jusqu'à une échéance
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Toutes les échéances du cœur (séquenceur, rendu, scripts) sont des
+// instants absolus en ns de cette horloge : CLOCK_MONOTONIC sous Linux
+// (même base que les horodatages evdev et la mémoire partagée),
+// steady_clock (QueryPerformanceCounter) ailleurs.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cerrno>
+#include <ctime>
+
+#if defined(__linux__)
+#include <time.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+//==============================================================================
+// HORLOGE MONOTONE
+//==============================================================================
+
+inline int64_t MonotonicNowNs()
+{
+#if defined(__linux__)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Heure murale en ns (base des horodatages evdev par défaut).
+ */
+inline int64_t RealtimeNowNs()
+{
+#if defined(__linux__)
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Attend jusqu'à l'échéance absolue (MonotonicNowNs). Le sommeil s'arrête
+ * spinNs avant l'échéance puis l'attente se termine en boucle active, pour
+ * borner l'erreur à quelques microsecondes malgré la latence du réveil.
+ */
+inline void SleepUntilNs(int64_t deadlineNs, int64_t spinNs = 200000)
+{
+    const int64_t wakeNs = deadlineNs - spinNs;
+    if (MonotonicNowNs() < wakeNs)
+    {
+#if defined(__linux__)
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(wakeNs / 1000000000LL);
+        ts.tv_nsec = static_cast<long>(wakeNs % 1000000000LL);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+        {
+        }
+#else
+        std::this_thread::sleep_for(std::chrono::nanoseconds(wakeNs - MonotonicNowNs()));
+#endif
+    }
+
+    while (MonotonicNowNs() < deadlineNs)
+    {
+    }
+}
@@ -0,0 +1,210 @@
+//==============================================================================
+// EffectPresets.h - Bibliothèque d'effets intégrés générée à la compilation
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Chaque préréglage est un ff_effect complet construit par une fonction
+// constexpr : les tables sont matérialisées statiquement, et un paramètre
+// hors plage (force > 32767, période nulle, forme d'onde inconnue...)
+// provoque une erreur de compilation au lieu d'un échec EVIOCSFF.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "FFEffect.h"
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const uint16_t PRESET_INFINITE = 0;          // 0 = infini sous Linux
+const uint16_t PRESET_DIRECTION_RIGHT = 0x4000;
+const uint16_t PRESET_DEFAULT_DEADBAND = 500;
+
+//==============================================================================
+// VALIDATION
+//==============================================================================
+
+namespace preset_detail
+{
+
+/**
+ * Vérifie une plage. Dans une évaluation constexpr, le throw n'est pas une
+ * expression constante : la compilation échoue avec le message.
+ */
+constexpr int32_t Checked(int32_t value, int32_t lo, int32_t hi, const char* what)
+{
+    return (value < lo || value > hi) ? throw std::out_of_range(what) : value;
+}
+
+constexpr int16_t Level(int32_t value)
+{
+    return static_cast<int16_t>(Checked(value, -32767, 32767, "niveau hors de [-32767, 32767]"));
+}
+
+constexpr uint16_t Magnitude(int32_t value)
+{
+    return static_cast<uint16_t>(Checked(value, 0, 32767, "magnitude hors de [0, 32767]"));
+}
+
+constexpr uint16_t Unsigned16(int32_t value, const char* what)
+{
+    return static_cast<uint16_t>(Checked(value, 0, 0xFFFF, what));
+}
+
+constexpr uint16_t Waveform(uint16_t waveform)
+{
+    return (waveform == FF_SQUARE || waveform == FF_TRIANGLE || waveform == FF_SINE ||
+            waveform == FF_SAW_UP || waveform == FF_SAW_DOWN)
+        ? waveform
+        : throw std::invalid_argument("forme d'onde périodique inconnue");
+}
+
+constexpr uint16_t ConditionType(uint16_t type)
+{
+    return (type == FF_SPRING || type == FF_DAMPER || type == FF_INERTIA || type == FF_FRICTION)
+        ? type
+        : throw std::invalid_argument("type de condition inconnu");
+}
+
+constexpr ff_effect BaseEffect(uint16_t type, uint16_t direction, uint16_t length)
+{
+    ff_effect effect{};
+    effect.type = type;
+    effect.id = -1; // Le kernel assignera un ID
+    effect.direction = direction;
+    effect.replay.length = length;
+    return effect;
+}
+
+} // namespace preset_detail
+
+//==============================================================================
+// CONSTRUCTEURS CONSTEXPR
+//==============================================================================
+
+/**
+ * Effet constant (force directionnelle).
+ */
+constexpr ff_effect ConstantEffect(int32_t force, int32_t length = PRESET_INFINITE)
+{
+    ff_effect effect = preset_detail::BaseEffect(
+        FF_CONSTANT, PRESET_DIRECTION_RIGHT, preset_detail::Unsigned16(length, "durée hors plage"));
+    effect.u.constant.level = preset_detail::Level(force);
+    return effect;
+}
+
+/**
+ * Effet périodique (vibrations), période en ms.
+ */
+constexpr ff_effect PeriodicEffect(uint16_t waveform, int32_t magnitude, int32_t period,
+                                   int32_t length = PRESET_INFINITE)
+{
+    ff_effect effect = preset_detail::BaseEffect(
+        FF_PERIODIC, PRESET_DIRECTION_RIGHT, preset_detail::Unsigned16(length, "durée hors plage"));
+    effect.u.periodic.waveform = preset_detail::Waveform(waveform);
+    effect.u.periodic.magnitude = static_cast<int16_t>(preset_detail::Magnitude(magnitude));
+    effect.u.periodic.period = static_cast<uint16_t>(
+        preset_detail::Checked(period, 1, 0xFFFF, "période hors de [1, 65535] ms"));
+    return effect;
+}
+
+/**
+ * Effet rampe (force progressive) ; la durée doit être finie.
+ */
+constexpr ff_effect RampEffect(int32_t startForce, int32_t endForce, int32_t length)
+{
+    ff_effect effect = preset_detail::BaseEffect(
+        FF_RAMP, PRESET_DIRECTION_RIGHT,
+        static_cast<uint16_t>(preset_detail::Checked(length, 1, 0xFFFF, "une rampe doit avoir une durée finie")));
+    effect.u.ramp.start_level = preset_detail::Level(startForce);
+    effect.u.ramp.end_level = preset_detail::Level(endForce);
+    return effect;
+}
+
+/**
+ * Effet de condition sur l'axe volant (ressort, amortissement, etc.).
+ */
+constexpr ff_effect ConditionEffect(uint16_t type, int32_t coefficient, int32_t saturation,
+                                    int32_t deadband = PRESET_DEFAULT_DEADBAND)
+{
+    ff_effect effect = preset_detail::BaseEffect(
+        preset_detail::ConditionType(type), PRESET_DIRECTION_RIGHT, PRESET_INFINITE);
+    effect.u.condition[0].right_saturation = preset_detail::Unsigned16(saturation, "saturation hors de [0, 65535]");
+    effect.u.condition[0].left_saturation = effect.u.condition[0].right_saturation;
+    effect.u.condition[0].right_coeff = preset_detail::Level(coefficient);
+    effect.u.condition[0].left_coeff = effect.u.condition[0].right_coeff;
+    effect.u.condition[0].deadband = preset_detail::Unsigned16(deadband, "zone morte hors de [0, 65535]");
+    effect.u.condition[0].center = 0;
+    return effect;
+}
+
+/**
+ * Ajoute une enveloppe d'attaque/fondu à un effet constant, périodique ou
+ * rampe (durées en ms, niveaux absolus 0..32767).
+ */
+constexpr ff_effect WithEnvelope(ff_effect effect, int32_t attackLength, int32_t attackLevel,
+                                 int32_t fadeLength, int32_t fadeLevel)
+{
+    ff_envelope envelope{};
+    envelope.attack_length = preset_detail::Unsigned16(attackLength, "durée d'attaque hors plage");
+    envelope.attack_level = preset_detail::Magnitude(attackLevel);
+    envelope.fade_length = preset_detail::Unsigned16(fadeLength, "durée de fondu hors plage");
+    envelope.fade_level = preset_detail::Magnitude(fadeLevel);
+
+    if (effect.type == FF_CONSTANT)
+        effect.u.constant.envelope = envelope;
+    else if (effect.type == FF_PERIODIC)
+        effect.u.periodic.envelope = envelope;
+    else if (effect.type == FF_RAMP)
+        effect.u.ramp.envelope = envelope;
+    else
+        throw std::invalid_argument("enveloppe impossible sur une condition");
+    return effect;
+}
+
+//==============================================================================
+// BIBLIOTHÈQUE INTÉGRÉE
+//==============================================================================
+
+struct EffectPreset
+{
+    const char* name;
+    ff_effect effect;
+};
+
+constexpr EffectPreset BUILTIN_EFFECTS[] =
+{
+    // Effets constants
+    { "Constant_Droite",   ConstantEffect(24000) },
+    { "Constant_Gauche",   ConstantEffect(-24000) },
+    { "Constant_Fort",     ConstantEffect(32000) },
+    { "Constant_Faible",   ConstantEffect(12000) },
+
+    // Effets périodiques
+    { "Sinus",             PeriodicEffect(FF_SINE, 20000, 200) },
+    { "Carre",             PeriodicEffect(FF_SQUARE, 22000, 150) },
+    { "Triangle",          PeriodicEffect(FF_TRIANGLE, 18000, 300) },
+    { "Dent_Scie",         PeriodicEffect(FF_SAW_UP, 20000, 180) },
+
+    // Effets rampe (3 secondes)
+    { "Rampe_Montante",    RampEffect(5000, 30000, 3000) },
+    { "Rampe_Descendante", RampEffect(30000, 5000, 3000) },
+
+    // Effets de condition
+    { "Ressort",           ConditionEffect(FF_SPRING, 24000, 32767) },
+    { "Amortissement",     ConditionEffect(FF_DAMPER, 20000, 32767) },
+    { "Inertie",           ConditionEffect(FF_INERTIA, 18000, 32767) },
+    { "Friction",          ConditionEffect(FF_FRICTION, 15000, 32767) },
+};
+
+const size_t BUILTIN_EFFECT_COUNT = sizeof(BUILTIN_EFFECTS) / sizeof(BUILTIN_EFFECTS[0]);
+
+static_assert(BUILTIN_EFFECT_COUNT == 14, "La bibliothèque intégrée compte 14 effets");
+static_assert(BUILTIN_EFFECTS[0].effect.u.constant.level == 24000, "Préréglage constant mal construit");
+static_assert(BUILTIN_EFFECTS[8].effect.replay.length == 3000, "Les rampes durent 3 secondes");
@@ -0,0 +1,210 @@
+//==============================================================================
+// EffectRender.h - Évaluation logicielle des effets ff_effect en virgule fixe
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Reproduit la sémantique du kernel (ff-memless) : enveloppe, formes d'onde
+// périodiques, rampe, projection selon la direction, et conditions
+// (ressort, amortissement, inertie, friction) à partir de l'état de l'axe.
+// Toutes les valeurs sont en unités kernel (int16_t, Q15).
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+
+#include "FFEffect.h"
+
+#include "FixedPoint.h"
+
+//==============================================================================
+// ÉTAT DE L'AXE
+//==============================================================================
+
+/**
+ * État normalisé de l'axe volant, en Q15 (-32768 = butée gauche,
+ * 32767 = butée droite). Vitesse et accélération en Q15, pleine échelle
+ * AXIS_VELOCITY_FULL_SCALE demi-courses/s et AXIS_ACCELERATION_FULL_SCALE
+ * demi-courses/s² (AxisFilter.h).
+ */
+struct AxisState
+{
+    int32_t position;
+    int32_t velocity;
+    int32_t acceleration;
+
+    AxisState() : position(0), velocity(0), acceleration(0) {}
+};
+
+/**
+ * Normalise une valeur brute d'axe dans [minimum, maximum] vers Q15.
+ */
+inline int32_t NormalizeAxis(int32_t raw, int32_t minimum, int32_t maximum)
+{
+    if (maximum <= minimum)
+        return fixp::SaturateQ15(raw);
+
+    const int64_t span = static_cast<int64_t>(maximum) - minimum;
+    const int64_t centered = 2 * (static_cast<int64_t>(raw) - minimum) - span;
+    return fixp::SaturateQ15((centered * fixp::Q15_ONE) / span);
+}
+
+//==============================================================================
+// ÉVALUATION
+//==============================================================================
+
+/**
+ * Applique l'enveloppe à un niveau, à l'instant t (ms) depuis le début
+ * de l'effet.
+ */
+inline int32_t ApplyEnvelope(const ff_envelope& envelope, const ff_replay& replay,
+                             int32_t level, uint32_t t)
+{
+    const int32_t magnitude = fixp::Abs(level);
+    int32_t result = magnitude;
+
+    if (envelope.attack_length && t < envelope.attack_length)
+    {
+        result = fixp::Lerp(envelope.attack_level, magnitude,
+                            fixp::Ratio(t, envelope.attack_length));
+    }
+    else if (envelope.fade_length && replay.length &&
+             t + envelope.fade_length > replay.length)
+    {
+        const uint32_t fadeStart = replay.length - envelope.fade_length;
+        const uint32_t elapsed = t > fadeStart ? t - fadeStart : 0;
+        result = fixp::Lerp(magnitude, envelope.fade_level,
+                            fixp::Ratio(elapsed, envelope.fade_length));
+    }
+
+    return level < 0 ? -result : result;
+}
+
+/**
+ * Forme d'onde périodique, phase en fraction de tour (0x10000 = 1 tour).
+ */
+inline int32_t EvaluateWaveform(uint16_t waveform, uint16_t phase)
+{
+    switch (waveform)
+    {
+    case FF_SQUARE:
+        return phase < 0x8000 ? fixp::Q15_MAX : -fixp::Q15_MAX;
+
+    case FF_TRIANGLE:
+        // 0 -> +1 -> 0 -> -1 -> 0
+        if (phase < 0x4000)
+            return fixp::SaturateQ15(static_cast<int32_t>(phase) * 2);
+        if (phase < 0xC000)
+            return fixp::SaturateQ15(0x10000 - static_cast<int32_t>(phase) * 2);
+        return static_cast<int32_t>(phase) * 2 - 0x20000;
+
+    case FF_SAW_UP:
+        return static_cast<int32_t>(phase) - 0x8000;
+
+    case FF_SAW_DOWN:
+        return 0x7FFF - static_cast<int32_t>(phase);
+
+    case FF_SINE:
+    default:
+        return fixp::Sin(phase);
+    }
+}
+
+/**
+ * Force d'une condition sur un axe, à partir de l'état de l'axe.
+ */
+inline int32_t EvaluateCondition(uint16_t type, const ff_condition_effect& condition,
+                                 const AxisState& axis)
+{
+    int32_t input = 0;
+
+    switch (type)
+    {
+    case FF_SPRING:
+        input = axis.position - condition.center;
+        break;
+    case FF_DAMPER:
+        input = axis.velocity;
+        break;
+    case FF_INERTIA:
+        input = axis.acceleration;
+        break;
+    case FF_FRICTION:
+        // Force constante opposée au mouvement
+        input = fixp::Sign(axis.velocity) * fixp::Q15_MAX;
+        break;
+    default:
+        return 0;
+    }
+
+    // Zone morte autour du centre
+    const int32_t deadband = condition.deadband;
+    if (fixp::Abs(input) <= deadband)
+        return 0;
+    input -= fixp::Sign(input) * deadband;
+
+    const bool positive = input > 0;
+    const int32_t coeff = positive ? condition.right_coeff : condition.left_coeff;
+    const int32_t saturation = positive ? condition.right_saturation : condition.left_saturation;
+
+    // La force s'oppose au déplacement
+    const int32_t force = -fixp::MulSat(input, coeff);
+    const int32_t limit = saturation ? fixp::Clamp(saturation, 0, fixp::Q15_MAX) : fixp::Q15_MAX;
+    return fixp::Clamp(force, -limit, limit);
+}
+
+/**
+ * Force produite par un effet t millisecondes après son démarrage,
+ * projetée sur l'axe du volant. 0 si l'effet est terminé.
+ */
+inline int32_t EvaluateEffect(const ff_effect& effect, uint32_t t, const AxisState& axis)
+{
+    if (effect.replay.length && t >= effect.replay.length)
+        return 0;
+
+    int32_t level = 0;
+
+    switch (effect.type)
+    {
+    case FF_CONSTANT:
+        level = ApplyEnvelope(effect.u.constant.envelope, effect.replay,
+                              effect.u.constant.level, t);
+        break;
+
+    case FF_RAMP:
+    {
+        const int32_t progress = effect.replay.length
+            ? fixp::Ratio(t, effect.replay.length) : 0;
+        level = fixp::Lerp(effect.u.ramp.start_level, effect.u.ramp.end_level, progress);
+        level = ApplyEnvelope(effect.u.ramp.envelope, effect.replay, level, t);
+        break;
+    }
+
+    case FF_PERIODIC:
+    {
+        const ff_periodic_effect& periodic = effect.u.periodic;
+        const uint32_t period = periodic.period ? periodic.period : 1;
+        const uint16_t phase = static_cast<uint16_t>(
+            ((t % period) << 16) / period + periodic.phase);
+        const int32_t magnitude = ApplyEnvelope(periodic.envelope, effect.replay,
+                                                periodic.magnitude, t);
+        level = fixp::SaturateQ15(fixp::Mul(EvaluateWaveform(periodic.waveform, phase), magnitude)
+                                  + periodic.offset);
+        break;
+    }
+
+    case FF_SPRING:
+    case FF_DAMPER:
+    case FF_INERTIA:
+    case FF_FRICTION:
+        // Les conditions agissent directement sur l'axe, sans direction
+        return EvaluateCondition(effect.type, effect.u.condition[0], axis);
+
+    default:
+        return 0;
+    }
+
+    // Projection sur l'axe X : direction 0x4000 = vers la droite
+    return fixp::MulSat(level, fixp::Sin(effect.direction));
+}
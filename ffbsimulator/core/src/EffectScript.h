@@ -0,0 +1,218 @@
+//==============================================================================
+// EffectScript.h - Scripts d'effets pour le mode batch (sans interface)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Format : une commande par ligne, '#' pour les commentaires, durées en ms.
+//
+//   play   <effet> <durée>                 joue l'effet puis l'arrête
+//   start  <effet>                         démarre l'effet
+//   stop   <effet>                         arrête l'effet
+//   stopall                                arrête tous les effets
+//   wait   <durée>                         attend
+//   level  <effet> <niveau>                modifie le niveau/magnitude/coeff.
+//   sweep  <effet> <de> <à> <durée> <pas>  balaye le niveau en <pas> étapes
+//
+// Le script est compilé en une liste d'étapes horodatées (décalage depuis
+// le début de l'exécution), exécutées ensuite par un ordonnanceur basé sur
+// l'horloge monotone (Clock.h).
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cerrno>
+#include <ctime>
+
+#include "Clock.h"
+
+//==============================================================================
+// ÉTAPES
+//==============================================================================
+
+enum class ScriptAction
+{
+    Start,
+    Stop,
+    StopAll,
+    SetLevel,
+};
+
+struct ScriptStep
+{
+    int64_t plannedNs;           // Décalage prévu depuis le début du script
+    ScriptAction action;
+    std::string effectName;
+    int32_t value;               // Niveau pour SetLevel
+    int lineNumber;              // Ligne source (diagnostic)
+};
+
+inline const char* ScriptActionName(ScriptAction action)
+{
+    switch (action)
+    {
+    case ScriptAction::Start:    return "start";
+    case ScriptAction::Stop:     return "stop";
+    case ScriptAction::StopAll:  return "stopall";
+    case ScriptAction::SetLevel: return "level";
+    }
+    return "?";
+}
+
+//==============================================================================
+// SCRIPT
+//==============================================================================
+
+class EffectScript
+{
+private:
+    std::vector<ScriptStep> m_Steps;
+    int64_t m_DurationNs;
+    std::string m_Error;
+
+    static int64_t MsToNs(int64_t ms) { return ms * 1000000LL; }
+
+    void AddStep(int64_t atNs, ScriptAction action, const std::string& effect,
+                 int32_t value, int line)
+    {
+        ScriptStep step;
+        step.plannedNs = atNs;
+        step.action = action;
+        step.effectName = effect;
+        step.value = value;
+        step.lineNumber = line;
+        m_Steps.push_back(step);
+    }
+
+    bool Fail(int line, const std::string& message)
+    {
+        std::ostringstream oss;
+        oss << "ligne " << line << ": " << message;
+        m_Error = oss.str();
+        return false;
+    }
+
+public:
+    EffectScript() : m_DurationNs(0) {}
+
+    const std::vector<ScriptStep>& GetSteps() const { return m_Steps; }
+    int64_t GetDurationNs() const { return m_DurationNs; }
+    const std::string& GetError() const { return m_Error; }
+
+    bool LoadFile(const std::string& filename)
+    {
+        std::ifstream file(filename);
+        if (!file.is_open())
+        {
+            m_Error = "impossible d'ouvrir " + filename;
+            return false;
+        }
+
+        std::ostringstream content;
+        content << file.rdbuf();
+        return Parse(content.str());
+    }
+
+    /**
+     * Compile le texte du script en étapes horodatées.
+     */
+    bool Parse(const std::string& text)
+    {
+        m_Steps.clear();
+        m_Error.clear();
+
+        std::istringstream input(text);
+        std::string line;
+        int lineNumber = 0;
+        int64_t cursorNs = 0;
+
+        while (std::getline(input, line))
+        {
+            lineNumber++;
+
+            size_t comment = line.find('#');
+            if (comment != std::string::npos)
+                line.erase(comment);
+
+            std::istringstream tokens(line);
+            std::string command;
+            if (!(tokens >> command))
+                continue;
+
+            std::string effect;
+            int64_t duration = 0;
+
+            if (command == "play")
+            {
+                if (!(tokens >> effect >> duration) || duration <= 0)
+                    return Fail(lineNumber, "usage: play <effet> <durée_ms>");
+                AddStep(cursorNs, ScriptAction::Start, effect, 0, lineNumber);
+                cursorNs += MsToNs(duration);
+                AddStep(cursorNs, ScriptAction::Stop, effect, 0, lineNumber);
+            }
+            else if (command == "start" || command == "stop")
+            {
+                if (!(tokens >> effect))
+                    return Fail(lineNumber, "usage: " + command + " <effet>");
+                AddStep(cursorNs, command == "start" ? ScriptAction::Start : ScriptAction::Stop,
+                        effect, 0, lineNumber);
+            }
+            else if (command == "stopall")
+            {
+                AddStep(cursorNs, ScriptAction::StopAll, std::string(), 0, lineNumber);
+            }
+            else if (command == "wait")
+            {
+                if (!(tokens >> duration) || duration < 0)
+                    return Fail(lineNumber, "usage: wait <durée_ms>");
+                cursorNs += MsToNs(duration);
+            }
+            else if (command == "level")
+            {
+                int32_t level = 0;
+                if (!(tokens >> effect >> level) || level < -32767 || level > 32767)
+                    return Fail(lineNumber, "usage: level <effet> <niveau -32767..32767>");
+                AddStep(cursorNs, ScriptAction::SetLevel, effect, level, lineNumber);
+            }
+            else if (command == "sweep")
+            {
+                int32_t from = 0, to = 0, steps = 0;
+                if (!(tokens >> effect >> from >> to >> duration >> steps) ||
+                    duration <= 0 || steps <= 0 ||
+                    from < -32767 || from > 32767 || to < -32767 || to > 32767)
+                {
+                    return Fail(lineNumber, "usage: sweep <effet> <de> <à> <durée_ms> <pas>");
+                }
+
+                for (int32_t i = 0; i <= steps; i++)
+                {
+                    int32_t level = from + static_cast<int32_t>(
+                        (static_cast<int64_t>(to - from) * i) / steps);
+                    AddStep(cursorNs + (MsToNs(duration) * i) / steps,
+                            ScriptAction::SetLevel, effect, level, lineNumber);
+                }
+                cursorNs += MsToNs(duration);
+            }
+            else
+            {
+                return Fail(lineNumber, "commande inconnue '" + command + "'");
+            }
+
+            std::string extra;
+            if (tokens >> extra)
+                return Fail(lineNumber, "argument inattendu '" + extra + "'");
+        }
+
+        std::stable_sort(m_Steps.begin(), m_Steps.end(),
+            [](const ScriptStep& a, const ScriptStep& b) { return a.plannedNs < b.plannedNs; });
+
+        m_DurationNs = cursorNs;
+        return true;
+    }
+};
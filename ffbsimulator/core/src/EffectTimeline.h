@@ -0,0 +1,203 @@
+//==============================================================================
+// EffectTimeline.h - Séquenceur d'événements d'effets (tas de minuteries)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Les événements (démarrage, arrêt, mise à jour d'un effet) sont rangés dans
+// un tas binaire trié par échéance absolue CLOCK_MONOTONIC. Le thread de
+// force attend la prochaine échéance, puis retire d'un coup tous les
+// événements échus pour les envoyer au device en un seul lot.
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "Clock.h"
+#include "FFEffect.h"
+
+//==============================================================================
+// ÉVÉNEMENTS
+//==============================================================================
+
+enum class TimelineAction : uint8_t
+{
+    Start,
+    Stop,
+    StopAll,
+    Update,                      // EVIOCSFF avec le contenu de 'effect'
+};
+
+/**
+ * Résultat d'un événement, renseigné par le thread de force si l'appelant
+ * fournit un emplacement (rapport du mode batch, par exemple).
+ */
+struct TimelineResult
+{
+    int64_t dispatchNs;          // Instant réel d'envoi (CLOCK_MONOTONIC)
+    bool success;
+};
+
+struct TimelineEvent
+{
+    int64_t dueNs;               // Échéance absolue (CLOCK_MONOTONIC)
+    uint64_t sequence;           // Ordre d'insertion, départage les ex aequo
+    TimelineAction action;
+    int16_t effectId;
+    struct ff_effect effect;     // Pour Update uniquement
+    TimelineResult* result;      // Optionnel
+};
+
+//==============================================================================
+// SÉQUENCEUR
+//==============================================================================
+
+class EffectTimeline
+{
+private:
+    std::vector<TimelineEvent> m_Heap;
+    uint64_t m_NextSequence;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Cond;
+
+    // Ordre du tas : la plus petite échéance au sommet
+    static bool Later(const TimelineEvent& a, const TimelineEvent& b)
+    {
+        return a.dueNs != b.dueNs ? a.dueNs > b.dueNs : a.sequence > b.sequence;
+    }
+
+public:
+    explicit EffectTimeline(size_t capacity = 1024)
+        : m_NextSequence(0)
+    {
+        m_Heap.reserve(capacity);
+    }
+
+    /**
+     * Ajoute un événement (thread-safe). Réveille le thread de force si
+     * l'événement devient la prochaine échéance.
+     */
+    void Schedule(const TimelineEvent& event)
+    {
+        bool bNewHead;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            const uint64_t sequence = m_NextSequence++;
+            m_Heap.push_back(event);
+            m_Heap.back().sequence = sequence;
+            std::push_heap(m_Heap.begin(), m_Heap.end(), Later);
+            bNewHead = m_Heap.front().sequence == sequence;
+        }
+        if (bNewHead)
+            m_Cond.notify_one();
+    }
+
+    /**
+     * Ajoute un lot d'événements sous un seul verrou.
+     */
+    void ScheduleBatch(const std::vector<TimelineEvent>& events)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (const TimelineEvent& event : events)
+            {
+                m_Heap.push_back(event);
+                m_Heap.back().sequence = m_NextSequence++;
+                std::push_heap(m_Heap.begin(), m_Heap.end(), Later);
+            }
+        }
+        m_Cond.notify_one();
+    }
+
+    /**
+     * Retire tous les événements échus à nowNs, dans l'ordre des échéances.
+     * @return Nombre d'événements ajoutés à batch.
+     */
+    size_t PopDue(int64_t nowNs, std::vector<TimelineEvent>& batch)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        size_t count = 0;
+        while (!m_Heap.empty() && m_Heap.front().dueNs <= nowNs)
+        {
+            std::pop_heap(m_Heap.begin(), m_Heap.end(), Later);
+            batch.push_back(m_Heap.back());
+            m_Heap.pop_back();
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * Bloque jusqu'à ce que le prochain événement soit échu (sommeil sur
+     * la variable de condition, puis attente active sur les spinNs
+     * dernières nanosecondes). Retourne false si aucun événement n'est
+     * échu à l'issue de maxWaitNs ou si bRunning passe à false.
+     */
+    bool WaitForDue(const std::atomic<bool>& bRunning, int64_t maxWaitNs, int64_t spinNs = 200000)
+    {
+        const int64_t limitNs = MonotonicNowNs() + maxWaitNs;
+        int64_t headNs = 0;
+
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            while (bRunning)
+            {
+                const int64_t nowNs = MonotonicNowNs();
+                if (nowNs >= limitNs)
+                    return false;
+
+                if (m_Heap.empty())
+                {
+                    m_Cond.wait_for(lock, std::chrono::nanoseconds(limitNs - nowNs));
+                    continue;
+                }
+
+                headNs = m_Heap.front().dueNs;
+                if (nowNs >= headNs - spinNs)
+                    break;
+
+                const int64_t wakeNs = std::min(headNs - spinNs, limitNs);
+                m_Cond.wait_for(lock, std::chrono::nanoseconds(wakeNs - nowNs));
+            }
+        }
+
+        if (!bRunning)
+            return false;
+
+        // Fin d'attente hors verrou : un Schedule() plus précoce reste possible
+        while (MonotonicNowNs() < headNs)
+        {
+        }
+        return true;
+    }
+
+    /**
+     * Réveille le thread en attente (arrêt).
+     */
+    void Wake()
+    {
+        m_Cond.notify_all();
+    }
+
+    /**
+     * Supprime tous les événements en attente.
+     */
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Heap.clear();
+    }
+
+    size_t GetPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Heap.size();
+    }
+};
@@ -0,0 +1,442 @@
+//==============================================================================
+// EnvelopeEngine.h - Enveloppes logicielles (ADSR à courbes) en virgule fixe
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Chaque couche active du rendu logiciel possède une enveloppe attaque /
+// déclin / maintien / relâche. Les segments suivent une courbe tabulée
+// (linéaire, quadratique, en S, exponentielle ou table fournie par
+// l'appelant). Les paramètres sont rangés par colonnes (une valeur par
+// couche) pour que l'évaluation de toutes les couches à chaque tick soit
+// une boucle sans branchement, vectorisable par le compilateur.
+// Gains en Q15 : Q15_ONE = gain unitaire.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <climits>
+#include <algorithm>
+
+#include "FFEffect.h"
+
+#include "FixedPoint.h"
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const size_t ENVELOPE_MAX_LAYERS = 16;
+const int ENVELOPE_CURVE_SEGMENTS = 32;
+
+// Les conditions n'ont pas d'enveloppe kernel : attaque/relâche par défaut
+const uint16_t ENVELOPE_CONDITION_ATTACK_MS = 100;
+const uint16_t ENVELOPE_CONDITION_RELEASE_MS = 100;
+
+//==============================================================================
+// COURBES
+//==============================================================================
+
+/**
+ * Courbe de segment : points[i] = forme(i / ENVELOPE_CURVE_SEGMENTS) en Q15,
+ * de 0 à Q15_ONE, interpolée linéairement entre deux points.
+ */
+struct EnvelopeCurveTable
+{
+    int32_t points[ENVELOPE_CURVE_SEGMENTS + 1];
+};
+
+enum class EnvelopeCurve : uint8_t
+{
+    Linear,
+    EaseIn,                      // p²
+    EaseOut,                     // 1 - (1 - p)²
+    SCurve,                      // 3p² - 2p³
+    Exponential,                 // (1 - e^-4p) / (1 - e^-4)
+};
+
+namespace envelope_detail
+{
+
+constexpr int32_t ShapePoint(EnvelopeCurve curve, int32_t p)
+{
+    const int32_t q = fixp::Q15_ONE - p;
+    switch (curve)
+    {
+    case EnvelopeCurve::EaseIn:
+        return fixp::Mul(p, p);
+    case EnvelopeCurve::EaseOut:
+        return fixp::Q15_ONE - fixp::Mul(q, q);
+    case EnvelopeCurve::SCurve:
+        return fixp::Mul(fixp::Mul(p, p), 3 * fixp::Q15_ONE - 2 * p);
+    case EnvelopeCurve::Exponential:
+    {
+        const int32_t norm = fixp::Q15_ONE - fixp::ExpNeg(4 * fixp::Q15_ONE);
+        return static_cast<int32_t>(
+            (static_cast<int64_t>(fixp::Q15_ONE - fixp::ExpNeg(4 * p)) * fixp::Q15_ONE) / norm);
+    }
+    case EnvelopeCurve::Linear:
+    default:
+        return p;
+    }
+}
+
+constexpr EnvelopeCurveTable MakeCurve(EnvelopeCurve curve)
+{
+    EnvelopeCurveTable table{};
+    for (int i = 0; i <= ENVELOPE_CURVE_SEGMENTS; i++)
+    {
+        const int32_t p = (i * fixp::Q15_ONE) / ENVELOPE_CURVE_SEGMENTS;
+        table.points[i] = fixp::Clamp(ShapePoint(curve, p), 0, fixp::Q15_ONE);
+    }
+    // Extrémités exactes : le segment part de sa valeur et atteint sa cible
+    table.points[0] = 0;
+    table.points[ENVELOPE_CURVE_SEGMENTS] = fixp::Q15_ONE;
+    return table;
+}
+
+} // namespace envelope_detail
+
+constexpr EnvelopeCurveTable ENVELOPE_CURVES[] =
+{
+    envelope_detail::MakeCurve(EnvelopeCurve::Linear),
+    envelope_detail::MakeCurve(EnvelopeCurve::EaseIn),
+    envelope_detail::MakeCurve(EnvelopeCurve::EaseOut),
+    envelope_detail::MakeCurve(EnvelopeCurve::SCurve),
+    envelope_detail::MakeCurve(EnvelopeCurve::Exponential),
+};
+
+static_assert(ENVELOPE_CURVES[0].points[16] == 16384, "Courbe linéaire mal construite");
+static_assert(ENVELOPE_CURVES[3].points[16] == 16384, "La courbe en S passe par le milieu");
+
+inline const EnvelopeCurveTable* BuiltinCurve(EnvelopeCurve curve)
+{
+    return &ENVELOPE_CURVES[static_cast<size_t>(curve)];
+}
+
+/**
+ * Forme d'un segment à la progression p (Q15, 0..Q15_ONE).
+ */
+inline int32_t ShapeCurve(const EnvelopeCurveTable& curve, int32_t p)
+{
+    const int shift = 15 - 5;    // 32 segments
+    const int32_t index = p >> shift;
+    if (index >= ENVELOPE_CURVE_SEGMENTS)
+        return curve.points[ENVELOPE_CURVE_SEGMENTS];
+    const int32_t frac = (p & ((1 << shift) - 1)) << (15 - shift);
+    return fixp::Lerp(curve.points[index], curve.points[index + 1], frac);
+}
+
+//==============================================================================
+// ENVELOPPE ADSR
+//==============================================================================
+
+/**
+ * Enveloppe d'une couche. Les niveaux sont des gains Q15 appliqués à la
+ * force de l'effet. autoReleaseMs > 0 déclenche la relâche à cet instant
+ * (fondu de fin d'un effet à durée finie) ; sinon elle démarre à l'arrêt.
+ */
+struct EnvelopeADSR
+{
+    uint16_t attackMs;
+    uint16_t decayMs;
+    uint16_t releaseMs;
+    int32_t attackLevel;         // Gain au démarrage
+    int32_t sustainLevel;        // Gain après le déclin
+    int32_t releaseLevel;        // Gain en fin de relâche
+    uint32_t autoReleaseMs;
+    const EnvelopeCurveTable* attackCurve;
+    const EnvelopeCurveTable* decayCurve;
+    const EnvelopeCurveTable* releaseCurve;
+
+    EnvelopeADSR()
+        : attackMs(0), decayMs(0), releaseMs(0)
+        , attackLevel(fixp::Q15_ONE), sustainLevel(fixp::Q15_ONE), releaseLevel(0)
+        , autoReleaseMs(0)
+        , attackCurve(BuiltinCurve(EnvelopeCurve::Linear))
+        , decayCurve(BuiltinCurve(EnvelopeCurve::Linear))
+        , releaseCurve(BuiltinCurve(EnvelopeCurve::Linear))
+    {
+    }
+};
+
+/**
+ * Magnitude de référence d'un effet (celle que l'enveloppe kernel module).
+ */
+inline int32_t EffectMagnitude(const ff_effect& effect)
+{
+    switch (effect.type)
+    {
+    case FF_CONSTANT:
+        return fixp::Abs(effect.u.constant.level);
+    case FF_PERIODIC:
+        return fixp::Abs(effect.u.periodic.magnitude);
+    case FF_RAMP:
+        return std::max(fixp::Abs(effect.u.ramp.start_level), fixp::Abs(effect.u.ramp.end_level));
+    default:
+        return fixp::Q15_MAX;
+    }
+}
+
+/**
+ * Traduit l'enveloppe kernel d'un effet en ADSR logiciel (niveaux absolus
+ * ramenés en gains relatifs à la magnitude). Les conditions, sans
+ * enveloppe kernel, reçoivent une attaque et une relâche en S.
+ */
+inline EnvelopeADSR EnvelopeFromEffect(const ff_effect& effect)
+{
+    EnvelopeADSR adsr;
+
+    const ff_envelope* envelope = nullptr;
+    switch (effect.type)
+    {
+    case FF_CONSTANT: envelope = &effect.u.constant.envelope; break;
+    case FF_PERIODIC: envelope = &effect.u.periodic.envelope; break;
+    case FF_RAMP:     envelope = &effect.u.ramp.envelope; break;
+    default: break;
+    }
+
+    if (!envelope)
+    {
+        adsr.attackMs = ENVELOPE_CONDITION_ATTACK_MS;
+        adsr.attackLevel = 0;
+        adsr.releaseMs = ENVELOPE_CONDITION_RELEASE_MS;
+        adsr.attackCurve = BuiltinCurve(EnvelopeCurve::SCurve);
+        adsr.releaseCurve = BuiltinCurve(EnvelopeCurve::SCurve);
+        return adsr;
+    }
+
+    const uint32_t magnitude = static_cast<uint32_t>(EffectMagnitude(effect));
+    if (envelope->attack_length)
+    {
+        adsr.attackMs = envelope->attack_length;
+        adsr.attackLevel = fixp::Ratio(envelope->attack_level, magnitude);
+    }
+    if (envelope->fade_length)
+    {
+        adsr.releaseMs = envelope->fade_length;
+        adsr.releaseLevel = fixp::Ratio(envelope->fade_level, magnitude);
+        if (effect.replay.length > envelope->fade_length)
+            adsr.autoReleaseMs = effect.replay.length - envelope->fade_length;
+    }
+    return adsr;
+}
+
+/**
+ * Copie d'un effet sans son enveloppe kernel (appliquée en logiciel).
+ */
+inline ff_effect StripEnvelope(const ff_effect& effect)
+{
+    ff_effect stripped = effect;
+    switch (stripped.type)
+    {
+    case FF_CONSTANT: stripped.u.constant.envelope = ff_envelope(); break;
+    case FF_PERIODIC: stripped.u.periodic.envelope = ff_envelope(); break;
+    case FF_RAMP:     stripped.u.ramp.envelope = ff_envelope(); break;
+    default: break;
+    }
+    return stripped;
+}
+
+//==============================================================================
+// BANQUE D'ENVELOPPES (une colonne par paramètre)
+//==============================================================================
+
+class EnvelopeBank
+{
+private:
+    static const int32_t NEVER = INT32_MAX;
+
+    // Paramètres, en ms depuis le démarrage de la couche
+    int32_t m_AttackEnd[ENVELOPE_MAX_LAYERS];
+    int32_t m_DecayEnd[ENVELOPE_MAX_LAYERS];
+    int32_t m_ReleaseStart[ENVELOPE_MAX_LAYERS];
+    int32_t m_ReleaseEnd[ENVELOPE_MAX_LAYERS];
+    // Durées de segment (au moins 1 ms) et leurs inverses (Q30), pour
+    // calculer la progression sans division ni produit 64 bits
+    int32_t m_AttackLength[ENVELOPE_MAX_LAYERS];
+    int32_t m_DecayLength[ENVELOPE_MAX_LAYERS];
+    int32_t m_ReleaseLength[ENVELOPE_MAX_LAYERS];
+    int32_t m_AttackInv[ENVELOPE_MAX_LAYERS];
+    int32_t m_DecayInv[ENVELOPE_MAX_LAYERS];
+    int32_t m_ReleaseInv[ENVELOPE_MAX_LAYERS];
+    int32_t m_AttackLevel[ENVELOPE_MAX_LAYERS];
+    int32_t m_SustainLevel[ENVELOPE_MAX_LAYERS];
+    int32_t m_ReleaseFrom[ENVELOPE_MAX_LAYERS];
+    int32_t m_ReleaseLevel[ENVELOPE_MAX_LAYERS];
+    const EnvelopeCurveTable* m_Curves[3][ENVELOPE_MAX_LAYERS];
+
+    // Résultats intermédiaires du tick
+    int32_t m_Progress[ENVELOPE_MAX_LAYERS];
+    int32_t m_From[ENVELOPE_MAX_LAYERS];
+    int32_t m_To[ENVELOPE_MAX_LAYERS];
+    int32_t m_Segment[ENVELOPE_MAX_LAYERS];
+
+    size_t m_Count;
+
+    static int32_t Length(uint16_t lengthMs)
+    {
+        return lengthMs ? lengthMs : 1;
+    }
+
+    static int32_t Inverse(uint16_t lengthMs)
+    {
+        return (1 << 30) / Length(lengthMs);
+    }
+
+    void Copy(size_t to, size_t from)
+    {
+        m_AttackEnd[to] = m_AttackEnd[from];
+        m_DecayEnd[to] = m_DecayEnd[from];
+        m_ReleaseStart[to] = m_ReleaseStart[from];
+        m_ReleaseEnd[to] = m_ReleaseEnd[from];
+        m_AttackLength[to] = m_AttackLength[from];
+        m_DecayLength[to] = m_DecayLength[from];
+        m_AttackInv[to] = m_AttackInv[from];
+        m_DecayInv[to] = m_DecayInv[from];
+        m_ReleaseInv[to] = m_ReleaseInv[from];
+        m_AttackLevel[to] = m_AttackLevel[from];
+        m_SustainLevel[to] = m_SustainLevel[from];
+        m_ReleaseFrom[to] = m_ReleaseFrom[from];
+        m_ReleaseLevel[to] = m_ReleaseLevel[from];
+        m_ReleaseLength[to] = m_ReleaseLength[from];
+        for (int segment = 0; segment < 3; segment++)
+            m_Curves[segment][to] = m_Curves[segment][from];
+    }
+
+public:
+    EnvelopeBank() : m_Count(0) {}
+
+    size_t GetCount() const { return m_Count; }
+    bool IsFull() const { return m_Count >= ENVELOPE_MAX_LAYERS; }
+
+    /**
+     * Ajoute une enveloppe en dernière position.
+     * @return Index de la couche, ou ENVELOPE_MAX_LAYERS si la banque est pleine.
+     */
+    size_t Add(const EnvelopeADSR& adsr)
+    {
+        if (IsFull())
+            return ENVELOPE_MAX_LAYERS;
+
+        const size_t i = m_Count++;
+        m_AttackEnd[i] = adsr.attackMs;
+        m_DecayEnd[i] = adsr.attackMs + adsr.decayMs;
+        m_AttackLength[i] = Length(adsr.attackMs);
+        m_DecayLength[i] = Length(adsr.decayMs);
+        m_ReleaseLength[i] = Length(adsr.releaseMs);
+        m_AttackInv[i] = Inverse(adsr.attackMs);
+        m_DecayInv[i] = Inverse(adsr.decayMs);
+        m_ReleaseInv[i] = Inverse(adsr.releaseMs);
+        m_AttackLevel[i] = adsr.attackLevel;
+        m_SustainLevel[i] = adsr.sustainLevel;
+        m_ReleaseLevel[i] = adsr.releaseLevel;
+        m_Curves[0][i] = adsr.attackCurve;
+        m_Curves[1][i] = adsr.decayCurve;
+        m_Curves[2][i] = adsr.releaseCurve;
+
+        m_ReleaseStart[i] = NEVER;
+        m_ReleaseEnd[i] = NEVER;
+        m_ReleaseFrom[i] = adsr.sustainLevel;
+        if (adsr.autoReleaseMs)
+        {
+            m_ReleaseStart[i] = static_cast<int32_t>(adsr.autoReleaseMs);
+            m_ReleaseEnd[i] = m_ReleaseStart[i] + m_ReleaseLength[i];
+        }
+        return i;
+    }
+
+    /**
+     * Retire une couche (la dernière prend sa place, comme pour les couches
+     * du rendu).
+     */
+    void Remove(size_t i)
+    {
+        if (i >= m_Count)
+            return;
+        m_Count--;
+        if (i != m_Count)
+            Copy(i, m_Count);
+    }
+
+    void Clear() { m_Count = 0; }
+
+    /**
+     * Démarre la relâche à elapsedMs, depuis le gain courant (aucun saut
+     * même en pleine attaque). Sans effet si la relâche a déjà commencé.
+     */
+    void Release(size_t i, int32_t elapsedMs)
+    {
+        if (i >= m_Count || elapsedMs >= m_ReleaseStart[i])
+            return;
+        m_ReleaseFrom[i] = GainAt(i, elapsedMs);
+        m_ReleaseStart[i] = elapsedMs;
+        m_ReleaseEnd[i] = elapsedMs + m_ReleaseLength[i];
+    }
+
+    /**
+     * Vrai quand la relâche est terminée : la couche peut être retirée.
+     */
+    bool IsFinished(size_t i, int32_t elapsedMs) const
+    {
+        return i < m_Count && elapsedMs >= m_ReleaseEnd[i];
+    }
+
+    int32_t GainAt(size_t i, int32_t elapsedMs)
+    {
+        int32_t gain = 0;
+        Evaluate(&elapsedMs, &gain, i, 1);
+        return gain;
+    }
+
+    /**
+     * Gains de toutes les couches : gains[i] pour la durée elapsedMs[i]
+     * écoulée depuis le démarrage de la couche i.
+     */
+    void EvaluateAll(const int32_t* elapsedMs, int32_t* gains)
+    {
+        Evaluate(elapsedMs, gains, 0, m_Count);
+    }
+
+private:
+    void Evaluate(const int32_t* elapsedMs, int32_t* gains, size_t first, size_t count)
+    {
+        using fixp::Select;
+        const size_t end = first + count;
+
+        // Passe 1 sans branchement : segment, progression et bornes
+        for (size_t i = first; i < end; i++)
+        {
+            const int32_t t = elapsedMs[i - first];
+            const int32_t inRelease = t >= m_ReleaseStart[i];
+            const int32_t inAttack = (t < m_AttackEnd[i]) & !inRelease;
+            const int32_t inDecay = (t >= m_AttackEnd[i]) & (t < m_DecayEnd[i]) & !inRelease;
+
+            const int32_t origin = Select(inRelease, Select(inDecay, 0, m_AttackEnd[i]), m_ReleaseStart[i]);
+            const int32_t length = Select(inRelease, Select(inDecay, m_AttackLength[i], m_DecayLength[i]), m_ReleaseLength[i]);
+            const int32_t inverse = Select(inRelease, Select(inDecay, m_AttackInv[i], m_DecayInv[i]), m_ReleaseInv[i]);
+
+            // dt <= longueur : dt * inverse <= 2^30, le produit tient sur 32 bits
+            const int32_t dt = t - origin;
+            m_Progress[i] = (Select(dt > length, dt, length) * inverse) >> 15;
+
+            const int32_t sustain = m_SustainLevel[i];
+            m_From[i] = Select(inRelease,
+                               Select(inAttack, Select(inDecay, sustain, fixp::Q15_ONE), m_AttackLevel[i]),
+                               m_ReleaseFrom[i]);
+            m_To[i] = Select(inRelease,
+                             Select(inAttack, sustain, fixp::Q15_ONE),
+                             m_ReleaseLevel[i]);
+            m_Segment[i] = Select(inRelease, Select(inDecay, 0, 1), 2);
+        }
+
+        // Passe 2 : mise en forme (lecture de table) et interpolation
+        for (size_t i = first; i < end; i++)
+        {
+            const EnvelopeCurveTable& curve = *m_Curves[m_Segment[i]][i];
+            gains[i - first] = fixp::Lerp(m_From[i], m_To[i], ShapeCurve(curve, m_Progress[i]));
+        }
+    }
+};
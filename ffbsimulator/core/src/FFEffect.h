@@ -0,0 +1,127 @@
+//==============================================================================
+// FFEffect.h - Modèle d'effet force feedback commun (structures ff_effect)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Le cœur (préréglages, rendu, enveloppes, mixeur, séquenceur) décrit les
+// effets avec les structures evdev ff_effect. Sous Linux, ce sont celles du
+// kernel ; ailleurs, ce fichier en reprend la définition à l'identique
+// (linux/input.h, ABI stable) pour que le backend DirectInput convertisse
+// les mêmes préréglages.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__linux__)
+
+#include <linux/input.h>
+
+#else
+
+//==============================================================================
+// TYPES ET CONSTANTES (miroir de linux/input.h)
+//==============================================================================
+
+#define FF_RUMBLE       0x50
+#define FF_PERIODIC     0x51
+#define FF_CONSTANT     0x52
+#define FF_SPRING       0x53
+#define FF_FRICTION     0x54
+#define FF_DAMPER       0x55
+#define FF_INERTIA      0x56
+#define FF_RAMP         0x57
+
+#define FF_SQUARE       0x58
+#define FF_TRIANGLE     0x59
+#define FF_SINE         0x5a
+#define FF_SAW_UP       0x5b
+#define FF_SAW_DOWN     0x5c
+#define FF_CUSTOM       0x5d
+
+#define FF_GAIN         0x60
+#define FF_AUTOCENTER   0x61
+#define FF_MAX          0x7f
+
+struct ff_replay
+{
+    uint16_t length;             // ms, 0 = infini
+    uint16_t delay;
+};
+
+struct ff_trigger
+{
+    uint16_t button;
+    uint16_t interval;
+};
+
+struct ff_envelope
+{
+    uint16_t attack_length;
+    uint16_t attack_level;
+    uint16_t fade_length;
+    uint16_t fade_level;
+};
+
+struct ff_constant_effect
+{
+    int16_t level;
+    struct ff_envelope envelope;
+};
+
+struct ff_ramp_effect
+{
+    int16_t start_level;
+    int16_t end_level;
+    struct ff_envelope envelope;
+};
+
+struct ff_condition_effect
+{
+    uint16_t right_saturation;
+    uint16_t left_saturation;
+    int16_t right_coeff;
+    int16_t left_coeff;
+    uint16_t deadband;
+    int16_t center;
+};
+
+struct ff_periodic_effect
+{
+    uint16_t waveform;
+    uint16_t period;             // ms
+    int16_t magnitude;
+    int16_t offset;
+    uint16_t phase;
+    struct ff_envelope envelope;
+    uint32_t custom_len;
+    int16_t* custom_data;
+};
+
+struct ff_rumble_effect
+{
+    uint16_t strong_magnitude;
+    uint16_t weak_magnitude;
+};
+
+struct ff_effect
+{
+    uint16_t type;
+    int16_t id;
+    uint16_t direction;          // 0x4000 = droite, 0xC000 = gauche
+    struct ff_trigger trigger;
+    struct ff_replay replay;
+
+    union
+    {
+        struct ff_constant_effect constant;
+        struct ff_ramp_effect ramp;
+        struct ff_periodic_effect periodic;
+        struct ff_condition_effect condition[2];     // Un par axe
+        struct ff_rumble_effect rumble;
+    } u;
+};
+
+#endif
@@ -0,0 +1,263 @@
+//==============================================================================
+// FixedPoint.h - Arithmétique virgule fixe Q15 pour le rendu des forces
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Toutes les tables sont générées à la compilation avec des entiers 64 bits
+// uniquement : le résultat est identique bit à bit quel que soit le
+// compilateur ou le FPU, et aucune fonction trigonométrique flottante
+// n'est appelée pendant le rendu.
+//
+// Conventions :
+//  - Q15 : int32_t dont 1.0 vaut 32768 (valeurs utiles dans [-32768, 32767])
+//  - Angle : uint16_t, 0x10000 correspond à un tour complet (comme
+//    ff_effect.direction)
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fixp
+{
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const int32_t Q15_ONE = 32768;
+const int32_t Q15_MAX = 32767;
+const int32_t Q15_MIN = -32768;
+
+// Table de sinus : une période complète + une entrée de garde pour l'interpolation
+const size_t SINE_TABLE_BITS = 8;
+const size_t SINE_TABLE_SIZE = size_t(1) << SINE_TABLE_BITS;
+
+// Table exp(-x) pour x dans [0, EXP_TABLE_RANGE]
+const size_t EXP_TABLE_SIZE = 256;
+const int32_t EXP_TABLE_RANGE = 8;
+
+//==============================================================================
+// SATURATION SANS BRANCHEMENT
+//==============================================================================
+
+/**
+ * Sélectionne b si cond vaut 1, a si cond vaut 0, par masque.
+ */
+constexpr int32_t Select(int32_t cond, int32_t a, int32_t b)
+{
+    return (a & ~(-cond)) | (b & -cond);
+}
+
+constexpr int32_t Clamp(int32_t x, int32_t lo, int32_t hi)
+{
+    return Select(x < lo, Select(x > hi, x, hi), lo);
+}
+
+/**
+ * Ramène un entier 32 bits dans la plage int16_t.
+ */
+constexpr int32_t SaturateQ15(int32_t x)
+{
+    return Clamp(x, Q15_MIN, Q15_MAX);
+}
+
+/**
+ * Ramène un entier 64 bits dans la plage int16_t.
+ */
+constexpr int32_t SaturateQ15(int64_t x)
+{
+    return static_cast<int32_t>(x < Q15_MIN ? Q15_MIN : (x > Q15_MAX ? Q15_MAX : x));
+}
+
+constexpr int32_t Abs(int32_t x)
+{
+    return (x ^ (x >> 31)) - (x >> 31);
+}
+
+/**
+ * Signe de x : -1, 0 ou 1.
+ */
+constexpr int32_t Sign(int32_t x)
+{
+    return (x > 0) - (x < 0);
+}
+
+//==============================================================================
+// OPÉRATIONS Q15
+//==============================================================================
+
+/**
+ * Produit Q15 x Q15 avec arrondi au plus proche.
+ */
+constexpr int32_t Mul(int32_t a, int32_t b)
+{
+    return static_cast<int32_t>((static_cast<int64_t>(a) * b + (1 << 14)) >> 15);
+}
+
+/**
+ * Produit Q15 saturé (résultat dans la plage int16_t).
+ */
+constexpr int32_t MulSat(int32_t a, int32_t b)
+{
+    return SaturateQ15((static_cast<int64_t>(a) * b + (1 << 14)) >> 15);
+}
+
+/**
+ * Interpolation linéaire a + (b - a) * t, t en Q15 dans [0, Q15_ONE].
+ */
+constexpr int32_t Lerp(int32_t a, int32_t b, int32_t t)
+{
+    return a + static_cast<int32_t>((static_cast<int64_t>(b - a) * t) >> 15);
+}
+
+/**
+ * Rapport num / den en Q15, borné à [0, Q15_ONE] (progression temporelle).
+ */
+constexpr int32_t Ratio(uint32_t num, uint32_t den)
+{
+    return den == 0 || num >= den
+        ? Q15_ONE
+        : static_cast<int32_t>((static_cast<uint64_t>(num) << 15) / den);
+}
+
+//==============================================================================
+// GÉNÉRATION DES TABLES (entiers uniquement)
+//==============================================================================
+
+namespace detail
+{
+
+// Q30 : 1.0 = 2^30
+const int64_t Q30_ONE = int64_t(1) << 30;
+// pi en Q30 (3.14159265358979 * 2^30)
+const int64_t Q30_PI = 3373259426LL;
+
+/**
+ * sin(x) en Q30 pour x en Q30 radians dans [-pi/2, pi/2] (série de Taylor).
+ */
+constexpr int64_t SinQ30(int64_t x)
+{
+    int64_t x2 = (x * x) >> 30;
+    int64_t term = x;
+    int64_t sum = x;
+    for (int k = 1; k <= 8; k++)
+    {
+        term = -((term * x2) >> 30) / ((2 * k) * (2 * k + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * exp(-x) en Q30 pour x en Q30 dans [0, 1] (série de Taylor).
+ */
+constexpr int64_t ExpNegQ30(int64_t x)
+{
+    int64_t term = Q30_ONE;
+    int64_t sum = Q30_ONE;
+    for (int k = 1; k <= 14; k++)
+    {
+        term = -((term * x) >> 30) / k;
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr int32_t RoundQ30ToQ15(int64_t v)
+{
+    return static_cast<int32_t>((v + (int64_t(1) << 14)) >> 15);
+}
+
+struct SineTable
+{
+    int16_t values[SINE_TABLE_SIZE + 1];
+
+    constexpr SineTable() : values()
+    {
+        for (size_t i = 0; i <= SINE_TABLE_SIZE; i++)
+        {
+            // Réduction dans [-pi/2, pi/2] par symétrie : sin(pi - x) = sin(x)
+            int64_t angle = static_cast<int64_t>((2 * Q30_PI * static_cast<int64_t>(i % SINE_TABLE_SIZE))
+                                                 / static_cast<int64_t>(SINE_TABLE_SIZE));
+            if (angle > Q30_PI / 2 && angle <= 3 * Q30_PI / 2)
+                angle = Q30_PI - angle;
+            else if (angle > 3 * Q30_PI / 2)
+                angle = angle - 2 * Q30_PI;
+
+            int32_t v = RoundQ30ToQ15(SinQ30(angle));
+            values[i] = static_cast<int16_t>(v > Q15_MAX ? Q15_MAX : v);
+        }
+    }
+};
+
+struct ExpTable
+{
+    int16_t values[EXP_TABLE_SIZE + 1];
+
+    constexpr ExpTable() : values()
+    {
+        // exp(-k * step) par multiplications successives de exp(-step)
+        const int64_t step = (int64_t(EXP_TABLE_RANGE) * Q30_ONE) / int64_t(EXP_TABLE_SIZE);
+        const int64_t factor = ExpNegQ30(step);
+        int64_t current = Q30_ONE;
+        for (size_t i = 0; i <= EXP_TABLE_SIZE; i++)
+        {
+            int32_t v = RoundQ30ToQ15(current);
+            values[i] = static_cast<int16_t>(v > Q15_MAX ? Q15_MAX : v);
+            current = (current * factor + (Q30_ONE >> 1)) >> 30;
+        }
+    }
+};
+
+} // namespace detail
+
+constexpr detail::SineTable SINE_TABLE{};
+constexpr detail::ExpTable EXP_TABLE{};
+
+static_assert(SINE_TABLE.values[0] == 0, "sin(0) doit valoir 0");
+static_assert(SINE_TABLE.values[SINE_TABLE_SIZE / 4] == Q15_MAX, "sin(pi/2) doit valoir 1");
+static_assert(SINE_TABLE.values[SINE_TABLE_SIZE / 2] == 0, "sin(pi) doit valoir 0");
+static_assert(SINE_TABLE.values[3 * SINE_TABLE_SIZE / 4] == -Q15_ONE, "sin(3pi/2) doit valoir -1");
+static_assert(EXP_TABLE.values[0] == Q15_MAX, "exp(0) doit valoir 1");
+
+//==============================================================================
+// FONCTIONS
+//==============================================================================
+
+/**
+ * sin(angle) en Q15, interpolé linéairement entre deux entrées de table.
+ */
+constexpr int32_t Sin(uint16_t angle)
+{
+    const unsigned shift = 16 - SINE_TABLE_BITS;
+    const uint32_t index = angle >> shift;
+    const int32_t frac = static_cast<int32_t>(angle & ((1u << shift) - 1)) << (15 - shift);
+    return Lerp(SINE_TABLE.values[index], SINE_TABLE.values[index + 1], frac);
+}
+
+constexpr int32_t Cos(uint16_t angle)
+{
+    return Sin(static_cast<uint16_t>(angle + 0x4000));
+}
+
+/**
+ * exp(-x) en Q15, x en Q15 (x >= EXP_TABLE_RANGE donne 0).
+ */
+constexpr int32_t ExpNeg(int32_t x)
+{
+    if (x <= 0)
+        return Q15_MAX;
+    if (x >= EXP_TABLE_RANGE * Q15_ONE)
+        return 0;
+
+    // Position dans la table en Q15 d'entrées
+    const int64_t pos = (static_cast<int64_t>(x) * EXP_TABLE_SIZE) / EXP_TABLE_RANGE;
+    const uint32_t index = static_cast<uint32_t>(pos >> 15);
+    const int32_t frac = static_cast<int32_t>(pos & (Q15_ONE - 1));
+    return Lerp(EXP_TABLE.values[index], EXP_TABLE.values[index + 1], frac);
+}
+
+} // namespace fixp
@@ -0,0 +1,38 @@
+//==============================================================================
+// InputSnapshot.h - État courant des axes et boutons du volant
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Rempli par le backend de la plateforme (événements evdev sous Linux,
+// DIJOYSTATE2 sous Windows), lu par l'écran d'état et le rendu.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+
+//==============================================================================
+// INSTANTANÉ DES ENTRÉES
+//==============================================================================
+
+struct InputSnapshot
+{
+    int16_t steering;            // Volant brut (ABS_X)
+    int16_t pedal1;              // Accélérateur (ABS_Y)
+    int16_t pedal2;              // Frein (ABS_Z)
+    uint32_t buttons;            // Bit i = bouton i
+    int64_t timestampNs;         // Dernière trame, horloge MonotonicNowNs (0 = aucune)
+
+    // Volant filtré (AxisFilter.h), Q15 : position normalisée, vitesse et
+    // accélération aux échelles AXIS_VELOCITY/ACCELERATION_FULL_SCALE
+    int32_t steeringPosition;
+    int32_t steeringVelocity;
+    int32_t steeringAcceleration;
+
+    InputSnapshot()
+        : steering(0), pedal1(0), pedal2(0), buttons(0), timestampNs(0)
+        , steeringPosition(0), steeringVelocity(0), steeringAcceleration(0)
+    {
+    }
+};
@@ -0,0 +1,152 @@
+//==============================================================================
+// LogCompressor.h - Compression des segments de log fermés
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Les segments de log fermés par la rotation sont compressés en gzip
+// (<segment>.gz, original supprimé) par un thread dédié : le thread qui
+// journalise ne fait que mettre le chemin en file. Le thread démarre au
+// premier segment et, à l'arrêt, termine la file avant de rendre la main.
+// La compression demande zlib (FFB_HAVE_ZLIB, détecté par CMake) ; sans
+// zlib, les segments restent en clair.
+//==============================================================================
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#if defined(FFB_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+const size_t LOG_COMPRESS_CHUNK = 64 * 1024;
+
+class LogCompressor
+{
+private:
+    std::thread m_Thread;
+    std::mutex m_Mutex;
+    std::condition_variable m_Cond;
+    std::deque<std::string> m_Queue;
+    bool m_bStopping;
+    std::atomic<uint64_t> m_Compressed;
+    std::atomic<uint64_t> m_Failed;
+
+    /**
+     * Compresse path en path.gz puis supprime path. En cas d'échec, le
+     * segment en clair est conservé.
+     */
+    static bool CompressFile(const std::string& path)
+    {
+#if defined(FFB_HAVE_ZLIB)
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in)
+            return false;
+
+        const std::string target = path + ".gz";
+        gzFile out = gzopen(target.c_str(), "wb6");
+        if (!out)
+        {
+            fclose(in);
+            return false;
+        }
+
+        char buffer[LOG_COMPRESS_CHUNK];
+        bool bOk = true;
+        size_t n;
+        while (bOk && (n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+            bOk = gzwrite(out, buffer, static_cast<unsigned>(n)) == static_cast<int>(n);
+        bOk = bOk && !ferror(in);
+
+        fclose(in);
+        bOk = gzclose(out) == Z_OK && bOk;
+        if (!bOk)
+        {
+            remove(target.c_str());
+            return false;
+        }
+        return remove(path.c_str()) == 0;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    void Worker()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        for (;;)
+        {
+            m_Cond.wait(lock, [this]() { return m_bStopping || !m_Queue.empty(); });
+            if (m_Queue.empty())
+                return;
+
+            const std::string path = m_Queue.front();
+            m_Queue.pop_front();
+
+            lock.unlock();
+            if (CompressFile(path))
+                m_Compressed++;
+            else
+                m_Failed++;
+            lock.lock();
+        }
+    }
+
+public:
+    LogCompressor() : m_bStopping(false), m_Compressed(0), m_Failed(0) {}
+
+    ~LogCompressor()
+    {
+        Stop();
+    }
+
+    static bool IsAvailable()
+    {
+#if defined(FFB_HAVE_ZLIB)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Met un segment fermé en file (démarre le thread au premier appel).
+     */
+    void Enqueue(const std::string& path)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Queue.push_back(path);
+            m_bStopping = false;
+            if (!m_Thread.joinable())
+                m_Thread = std::thread(&LogCompressor::Worker, this);
+        }
+        m_Cond.notify_one();
+    }
+
+    /**
+     * Termine les segments en file puis arrête le thread.
+     */
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bStopping = true;
+        }
+        m_Cond.notify_one();
+        if (m_Thread.joinable())
+            m_Thread.join();
+    }
+
+    uint64_t GetCompressedCount() const { return m_Compressed; }
+    uint64_t GetFailedCount() const { return m_Failed; }
+};
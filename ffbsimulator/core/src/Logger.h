@@ -0,0 +1,625 @@
+//==============================================================================
+// Logger.h - Journalisation console et fichier
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Une ligne est formatée dans un tampon de taille fixe sur la pile
+// (LogLineBuffer) : journaliser depuis le chemin de lecture d'un effet ne
+// fait aucune allocation. Une ligne plus longue que LOG_LINE_CAPACITY est
+// tronquée.
+//
+// Le fichier est écrit à travers un grand tampon (LogRotationParams::
+// bufferBytes) : il n'est vidé qu'après un avertissement ou une erreur, ou
+// à la première ligne qui suit flushIntervalMs. Pour les sessions longues,
+// le segment actif est fermé au-delà de maxBytes ou de maxAgeSeconds,
+// renommé <nom>.<n>.log et compressé en arrière-plan (LogCompressor.h) ;
+// la session continue dans un segment neuf sous le nom d'origine.
+//
+// En mode binaire (LogFormat::Binary, BinaryLog.h), chaque appel de log
+// est décrit une fois par segment (niveau, littéraux, types), puis chaque
+// ligne n'écrit que l'écart de temps monotone, l'ID de cet appel et les
+// valeurs brutes des autres arguments. Aucun formatage n'est fait à
+// l'écriture ; ffblog restitue le texte. La console, si elle est active,
+// reste en texte.
+//==============================================================================
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <type_traits>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include "Clock.h"
+#include "BinaryLog.h"
+#include "LogCompressor.h"
+
+const size_t LOG_LINE_CAPACITY = 1024;
+
+enum class LogFormat
+{
+    Text,                        // Lignes horodatées lisibles
+    Binary                       // Enregistrements bruts (BinaryLog.h)
+};
+
+/**
+ * Littéral du code (tableau de const char) : écrit une fois dans la
+ * description de l'appel, identifié par son adresse. Le type ne distingue
+ * pas un tampon const rempli à l'exécution (membre char[N] d'une structure
+ * const) : voir IsLogLiteralText().
+ */
+template<typename T>
+constexpr bool IS_LOG_LITERAL = std::is_array_v<std::remove_reference_t<T>> &&
+    std::is_same_v<std::remove_extent_t<std::remove_reference_t<T>>, const char>;
+
+/**
+ * Un littéral remplit exactement son tableau (terminateur en N - 1). Un
+ * tampon qui ne le remplit pas n'est pas mis en cache : son texte change
+ * d'une ligne à l'autre à la même adresse. Reste la contrainte : un tampon
+ * const plein à l'exécution serait pris pour un littéral, à journaliser
+ * par .data() ou en const char*.
+ */
+template<size_t N>
+inline bool IsLogLiteralText(const char (&text)[N])
+{
+    return strnlen(text, N) + 1 == N;
+}
+
+/**
+ * Écriture et rotation du fichier de log.
+ */
+struct LogRotationParams
+{
+    uint64_t maxBytes;           // Taille max d'un segment (0 = illimitée)
+    int64_t maxAgeSeconds;       // Âge max d'un segment (0 = illimité)
+    bool bCompress;              // Segments fermés compressés en gzip (zlib requis)
+    size_t bufferBytes;          // Tampon d'écriture du segment actif
+    int64_t flushIntervalMs;     // Délai max avant vidage, vérifié à chaque ligne
+    
+    LogRotationParams()
+        : maxBytes(64ull * 1024 * 1024), maxAgeSeconds(0), bCompress(true)
+        , bufferBytes(256 * 1024), flushIntervalMs(1000)
+    {
+    }
+};
+
+//==============================================================================
+// TAMPON DE LIGNE
+//==============================================================================
+
+/**
+ * streambuf sur un tableau fixe : les caractères au-delà de la capacité
+ * sont perdus (overflow par défaut), sans allocation.
+ */
+class LogLineBuffer : public std::streambuf
+{
+private:
+    char m_Data[LOG_LINE_CAPACITY];
+    
+public:
+    LogLineBuffer()
+    {
+        setp(m_Data, m_Data + sizeof(m_Data));
+    }
+    
+    const char* Data() const { return m_Data; }
+    std::streamsize Size() const { return pptr() - pbase(); }
+};
+
+//==============================================================================
+// CLASSE DE LOGGING
+//==============================================================================
+
+class Logger
+{
+private:
+    std::ofstream m_LogFile;
+    std::string m_LogFilename;
+    bool m_IsOpen;
+    bool m_bConsole;
+    
+    // Segment actif et rotation
+    std::mutex m_Mutex;
+    LogRotationParams m_Rotation;
+    std::vector<char> m_FileBuffer;
+    uint64_t m_SegmentBytes;
+    int m_Segment;               // Segments déjà fermés
+    std::chrono::steady_clock::time_point m_SegmentStart;
+    std::chrono::steady_clock::time_point m_LastFlush;
+    LogCompressor m_Compressor;
+    
+    // Mode binaire : appels déjà décrits dans le segment, par empreinte
+    struct BinaryFormat
+    {
+        uint32_t id;
+        std::vector<const void*> key;    // Signature, niveau, littéraux
+    };
+    LogFormat m_Format;
+    std::unordered_map<uint64_t, BinaryFormat> m_Formats;
+    uint32_t m_NextFormat;
+    int64_t m_LastNs;                    // Horodatage de la ligne précédente
+    
+    /**
+     * Horodatage "AAAA-MM-JJ HH:MM:SS.mmm" (buffer d'au moins 32 octets).
+     */
+    static void FormatTimestamp(char* buffer, size_t size)
+    {
+        auto now = std::chrono::system_clock::now();
+        auto time_t_now = std::chrono::system_clock::to_time_t(now);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()) % 1000;
+        
+        struct tm timeinfo;
+#if defined(_WIN32)
+        localtime_s(&timeinfo, &time_t_now);
+#else
+        localtime_r(&time_t_now, &timeinfo);
+#endif
+        
+        const size_t length = strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &timeinfo);
+        snprintf(buffer + length, size - length, ".%03d", static_cast<int>(ms.count()));
+    }
+    
+    std::string GetTimestamp()
+    {
+        char buffer[32];
+        FormatTimestamp(buffer, sizeof(buffer));
+        return buffer;
+    }
+    
+    /**
+     * Ouvre le segment actif sous m_LogFilename, derrière le tampon
+     * d'écriture (à installer avant l'ouverture).
+     */
+    bool OpenSegment()
+    {
+        m_FileBuffer.resize(std::max(m_Rotation.bufferBytes, LOG_LINE_CAPACITY));
+        m_LogFile.rdbuf()->pubsetbuf(m_FileBuffer.data(), static_cast<std::streamsize>(m_FileBuffer.size()));
+        m_LogFile.open(m_LogFilename, std::ios::out | std::ios::app | std::ios::binary);
+        m_IsOpen = m_LogFile.is_open();
+        
+        m_SegmentBytes = 0;
+        m_SegmentStart = std::chrono::steady_clock::now();
+        m_LastFlush = m_SegmentStart;
+        
+        // Chaque segment binaire se décode seul : en-tête, dictionnaire vide
+        m_Formats.clear();
+        m_NextFormat = 0;
+        m_LastNs = MonotonicNowNs();
+        if (m_IsOpen && m_Format == LogFormat::Binary)
+        {
+            const BinaryLogHeader header = MakeBinaryLogHeader(RealtimeNowNs(), m_LastNs);
+            BinaryLogRecordBuffer record;
+            record.Begin(BinaryLogRecord::Header);
+            record.Put(&header, sizeof(header));
+            WriteRecord(record);
+        }
+        return m_IsOpen;
+    }
+    
+    /**
+     * <nom>.<n>.log pour le n-ième segment fermé.
+     */
+    std::string SegmentName(int segment) const
+    {
+        std::string stem = m_LogFilename;
+        std::string extension;
+        const size_t dot = stem.rfind('.');
+        if (dot != std::string::npos && stem.find('/', dot) == std::string::npos)
+        {
+            extension = stem.substr(dot);
+            stem.resize(dot);
+        }
+        return stem + "." + std::to_string(segment) + extension;
+    }
+    
+    /**
+     * Ferme le segment actif, le confie au thread de compression et
+     * continue dans un segment neuf. m_Mutex verrouillé.
+     */
+    void Rotate()
+    {
+        m_Segment++;
+        const std::string closed = SegmentName(m_Segment);
+        const bool bText = m_Format == LogFormat::Text;
+        if (bText)
+        {
+            m_LogFile << "Suite: segment " << (m_Segment + 1) << "\n";
+        }
+        m_LogFile.close();
+        
+        const bool bRenamed = std::rename(m_LogFilename.c_str(), closed.c_str()) == 0;
+        if (bRenamed && m_Rotation.bCompress && LogCompressor::IsAvailable())
+        {
+            m_Compressor.Enqueue(closed);
+        }
+        
+        if (OpenSegment() && bText)
+        {
+            m_LogFile << "Segment " << (m_Segment + 1) << ", précédent: "
+                      << (bRenamed ? closed : std::string("non renommé")) << "\n";
+        }
+    }
+    
+    /**
+     * Écrit un enregistrement binaire dans le segment. m_Mutex verrouillé.
+     */
+    void WriteRecord(BinaryLogRecordBuffer& record)
+    {
+        size_t size;
+        const uint8_t* data = record.Finish(size);
+        m_LogFile.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        m_SegmentBytes += size;
+    }
+    
+    /**
+     * Écart depuis la ligne précédente, pour un enregistrement Line ou End.
+     * m_Mutex verrouillé.
+     */
+    uint64_t TakeDeltaNs()
+    {
+        const int64_t delta = std::max<int64_t>(0, MonotonicNowNs() - m_LastNs);
+        m_LastNs += delta;
+        return static_cast<uint64_t>(delta);
+    }
+    
+    /**
+     * Type d'un argument dans la description de l'appel. Les types sans
+     * représentation brute sont formatés en texte (chaîne).
+     */
+    template<typename T>
+    static constexpr BinaryLogTag TagOf()
+    {
+        using Value = std::decay_t<T>;
+        if constexpr (IS_LOG_LITERAL<T>)
+            return BinaryLogTag::Literal;
+        else if constexpr (std::is_same_v<Value, bool>)
+            return BinaryLogTag::Bool;
+        else if constexpr (std::is_same_v<Value, char> || std::is_same_v<Value, signed char> ||
+                           std::is_same_v<Value, unsigned char>)
+            return BinaryLogTag::Char;       // Affichés comme caractères par ostream
+        else if constexpr (std::is_integral_v<Value> && std::is_signed_v<Value>)
+            return BinaryLogTag::Int;
+        else if constexpr (std::is_integral_v<Value>)
+            return BinaryLogTag::UInt;
+        else if constexpr (std::is_same_v<Value, float>)
+            return BinaryLogTag::Float;
+        else if constexpr (std::is_floating_point_v<Value>)
+            return BinaryLogTag::Double;
+        else if constexpr (std::is_same_v<Value, Hex>)
+            return BinaryLogTag::Hex;
+        else
+            return BinaryLogTag::String;
+    }
+    
+    template<typename T>
+    static void CollectLiteral(const void** key, size_t& count, bool& bCacheable, const T& arg)
+    {
+        if constexpr (IS_LOG_LITERAL<T>)
+        {
+            key[count++] = arg;
+            bCacheable &= IsLogLiteralText(arg);
+        }
+    }
+    
+    template<typename T>
+    static void DefineArg(BinaryLogRecordBuffer& record, const T& arg)
+    {
+        record.PutValue(static_cast<uint8_t>(TagOf<T>()));
+        if constexpr (IS_LOG_LITERAL<T>)
+        {
+            record.PutString(arg, strnlen(arg, std::extent_v<std::remove_reference_t<T>>));
+        }
+    }
+    
+    /**
+     * ID de la description de cet appel ; elle est écrite à la première
+     * utilisation dans le segment. L'appel est identifié par la liste des
+     * types (une signature par instanciation), le niveau et les adresses
+     * des littéraux ; un tampon pris pour un littéral (IsLogLiteralText)
+     * fait redécrire l'appel. m_Mutex verrouillé.
+     */
+    template<typename... Args>
+    uint32_t FormatId(const char* level, const Args&... args)
+    {
+        static const char s_Signature = 0;
+        const void* key[2 + (static_cast<size_t>(IS_LOG_LITERAL<Args>) + ... + 0)];
+        size_t count = 0;
+        bool bCacheable = true;
+        key[count++] = &s_Signature;
+        key[count++] = level;
+        (CollectLiteral<Args>(key, count, bCacheable, args), ...);
+        
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < count; i++)
+        {
+            hash = (hash ^ reinterpret_cast<uintptr_t>(key[i])) * 1099511628211ull;
+        }
+        
+        const auto found = bCacheable ? m_Formats.find(hash) : m_Formats.end();
+        if (found != m_Formats.end() && std::equal(key, key + count, found->second.key.begin(), found->second.key.end()))
+            return found->second.id;
+        
+        // Collision d'empreinte ou tampon : appel redécrit à chaque ligne, sans cache
+        const uint32_t id = m_NextFormat++;
+        if (bCacheable && found == m_Formats.end())
+        {
+            m_Formats.emplace(hash, BinaryFormat{ id, std::vector<const void*>(key, key + count) });
+        }
+        
+        BinaryLogRecordBuffer record;
+        record.Begin(BinaryLogRecord::Format);
+        record.PutVarint(id);
+        record.PutString(level, strlen(level));
+        record.PutValue(static_cast<uint8_t>(sizeof...(Args)));
+        (DefineArg<Args>(record, args), ...);
+        WriteRecord(record);
+        return id;
+    }
+    
+    /**
+     * Valeur brute d'un argument non littéral.
+     */
+    template<typename T>
+    static void EncodeValue(BinaryLogRecordBuffer& record, const T& arg)
+    {
+        using Value = std::decay_t<T>;
+        constexpr BinaryLogTag tag = TagOf<T>();
+        
+        if constexpr (tag == BinaryLogTag::Literal)
+            return;
+        else if constexpr (tag == BinaryLogTag::Bool)
+            record.PutValue(static_cast<uint8_t>(arg));
+        else if constexpr (tag == BinaryLogTag::Char)
+            record.PutValue(static_cast<char>(arg));
+        else if constexpr (tag == BinaryLogTag::Int)
+            record.PutZigzag(static_cast<int64_t>(arg));
+        else if constexpr (tag == BinaryLogTag::UInt)
+            record.PutVarint(static_cast<uint64_t>(arg));
+        else if constexpr (tag == BinaryLogTag::Float)
+            record.PutValue(arg);
+        else if constexpr (tag == BinaryLogTag::Double)
+            record.PutValue(static_cast<double>(arg));
+        else if constexpr (tag == BinaryLogTag::Hex)
+            record.PutVarint(static_cast<uint32_t>(arg.value));
+        else if constexpr (std::is_same_v<Value, std::string>)
+            record.PutString(arg.data(), arg.size());
+        else if constexpr (std::is_same_v<Value, const char*> || std::is_same_v<Value, char*>)
+            record.PutString(arg, strlen(arg));
+        else
+        {
+            LogLineBuffer text;
+            std::ostream oss(&text);
+            oss << arg;
+            record.PutString(text.Data(), static_cast<size_t>(text.Size()));
+        }
+    }
+    
+    // Helper pour construire le message à partir des arguments
+    template<typename T>
+    void BuildMessage(std::ostream& oss, T&& arg)
+    {
+        oss << std::forward<T>(arg);
+    }
+    
+    template<typename T, typename... Args>
+    void BuildMessage(std::ostream& oss, T&& first, Args&&... args)
+    {
+        oss << std::forward<T>(first);
+        BuildMessage(oss, std::forward<Args>(args)...);
+    }
+    
+public:
+    Logger()
+        : m_IsOpen(false), m_bConsole(true), m_SegmentBytes(0), m_Segment(0)
+        , m_Format(LogFormat::Text), m_NextFormat(0), m_LastNs(0)
+    {
+    }
+    
+    ~Logger()
+    {
+        Close();
+    }
+    
+    /**
+     * Paramètres d'écriture et de rotation, à fixer avant Open().
+     */
+    void SetRotation(const LogRotationParams& params)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Rotation = params;
+    }
+    
+    /**
+     * Format du fichier (texte ou binaire), à fixer avant Open().
+     */
+    void SetFormat(LogFormat format)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Format = format;
+    }
+    
+    bool Open(const std::string& filename)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_LogFilename = filename;
+        m_Segment = 0;
+        
+        // En binaire, l'en-tête du segment tient lieu de bannière
+        if (OpenSegment() && m_Format == LogFormat::Text)
+        {
+            m_LogFile << "\n========================================\n";
+            m_LogFile << "Session démarrée: " << GetTimestamp() << "\n";
+            m_LogFile << "========================================\n";
+            m_LogFile.flush();
+        }
+        
+        return m_IsOpen;
+    }
+    
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_IsOpen && m_Format == LogFormat::Binary)
+            {
+                BinaryLogRecordBuffer record;
+                record.Begin(BinaryLogRecord::End);
+                record.PutVarint(TakeDeltaNs());
+                WriteRecord(record);
+                m_LogFile.close();
+                m_IsOpen = false;
+            }
+            else if (m_IsOpen)
+            {
+                m_LogFile << "========================================\n";
+                m_LogFile << "Session terminée: " << GetTimestamp() << "\n";
+                m_LogFile << "========================================\n\n";
+                m_LogFile.close();
+                m_IsOpen = false;
+            }
+        }
+        
+        // Segments encore en file compressés avant de rendre la main
+        m_Compressor.Stop();
+    }
+    
+    /**
+     * Méthode template principale pour logger avec paramètres variadiques.
+     */
+    template<typename... Args>
+    void Log(const char* level, Args&&... args)
+    {
+        Write(level, false, std::forward<Args>(args)...);
+    }
+    
+    /**
+     * Comme Log ; bFlush vide en plus le tampon du fichier immédiatement.
+     */
+    template<typename... Args>
+    void Write(const char* level, bool bFlush, Args&&... args)
+    {
+        // Texte formaté seulement si la console ou le fichier le demandent
+        const bool bBinary = m_Format == LogFormat::Binary;
+        LogLineBuffer line;
+        if (m_bConsole || !bBinary)
+        {
+            char timestamp[32];
+            FormatTimestamp(timestamp, sizeof(timestamp));
+            
+            std::ostream oss(&line);
+            oss << '[' << timestamp << "] [" << level << "] ";
+            BuildMessage(oss, args...);
+        }
+        
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        
+        // Affichage console
+        if (m_bConsole)
+        {
+            std::cout.write(line.Data(), line.Size()) << std::endl;
+        }
+        
+        // Écriture fichier (tamponnée)
+        if (m_IsOpen)
+        {
+            if (bBinary)
+            {
+                const uint32_t format = FormatId<Args...>(level, args...);
+                
+                BinaryLogRecordBuffer record;
+                record.Begin(BinaryLogRecord::Line);
+                record.PutVarint(TakeDeltaNs());
+                record.PutVarint(format);
+                (EncodeValue<Args>(record, args), ...);
+                WriteRecord(record);
+            }
+            else
+            {
+                m_LogFile.write(line.Data(), line.Size()).put('\n');
+                m_SegmentBytes += static_cast<uint64_t>(line.Size()) + 1;
+            }
+            
+            const auto now = std::chrono::steady_clock::now();
+            if (bFlush || now - m_LastFlush >= std::chrono::milliseconds(m_Rotation.flushIntervalMs))
+            {
+                m_LogFile.flush();
+                m_LastFlush = now;
+            }
+            
+            const bool bFull = m_Rotation.maxBytes > 0 && m_SegmentBytes >= m_Rotation.maxBytes;
+            const bool bOld = m_Rotation.maxAgeSeconds > 0 &&
+                              now - m_SegmentStart >= std::chrono::seconds(m_Rotation.maxAgeSeconds);
+            if (bFull || bOld)
+            {
+                Rotate();
+            }
+        }
+    }
+    
+    // Méthodes pratiques avec templates variadiques
+    template<typename... Args>
+    void Info(Args&&... args)
+    {
+        Log("INFO", std::forward<Args>(args)...);
+    }
+    
+    template<typename... Args>
+    void Warning(Args&&... args)
+    {
+        Write("WARN", true, std::forward<Args>(args)...);
+    }
+    
+    template<typename... Args>
+    void Error(Args&&... args)
+    {
+        Write("ERROR", true, std::forward<Args>(args)...);
+    }
+    
+    template<typename... Args>
+    void Debug(Args&&... args)
+    {
+        Log("DEBUG", std::forward<Args>(args)...);
+    }
+    
+    template<typename... Args>
+    void Success(Args&&... args)
+    {
+        Log("OK", std::forward<Args>(args)...);
+    }
+    
+    /**
+     * Helper pour formater en hexadécimal.
+     */
+    struct Hex
+    {
+        int value;
+        explicit Hex(int v) : value(v) {}
+    };
+    
+    std::string GetFilename() const { return m_LogFilename; }
+    int GetClosedSegmentCount() const { return m_Segment; }
+    
+    /**
+     * Active ou coupe la recopie des messages sur la console.
+     */
+    void SetConsoleOutput(bool bEnabled) { m_bConsole = bEnabled; }
+};
+
+// Surcharge de l'opérateur << pour Logger::Hex
+inline std::ostream& operator<<(std::ostream& os, const Logger::Hex& hex)
+{
+    os << "0x" << std::hex << std::uppercase << hex.value << std::dec;
+    return os;
+}
@@ -0,0 +1,263 @@
+//==============================================================================
+// Metrics.h - Registre de métriques (compteurs, jauges, histogrammes)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Les métriques sont enregistrées une fois à l'initialisation (allocation,
+// nom, libellés) ; sur le chemin chaud, une mise à jour n'est qu'un ou
+// quelques incréments atomiques relâchés, sans verrou ni allocation.
+// Export au format texte Prometheus (exposition 0.0.4) : les durées sont
+// mesurées en ns et exportées en secondes, selon la convention Prometheus.
+//==============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+// Bornes des histogrammes de durée (ns) : de 10 µs à 1 s
+const int64_t METRIC_DURATION_BOUNDS_NS[] = {
+    10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000, 25000000, 50000000,
+    100000000, 250000000, 1000000000,
+};
+const size_t METRIC_DURATION_BUCKETS = sizeof(METRIC_DURATION_BOUNDS_NS) / sizeof(METRIC_DURATION_BOUNDS_NS[0]);
+
+//==============================================================================
+// MÉTRIQUES
+//==============================================================================
+
+class MetricCounter
+{
+private:
+    std::atomic<uint64_t> m_Value;
+
+public:
+    MetricCounter() : m_Value(0) {}
+
+    void Add(uint64_t delta = 1) { m_Value.fetch_add(delta, std::memory_order_relaxed); }
+    uint64_t Get() const { return m_Value.load(std::memory_order_relaxed); }
+};
+
+class MetricGauge
+{
+private:
+    std::atomic<int64_t> m_Value;
+
+public:
+    MetricGauge() : m_Value(0) {}
+
+    void Set(int64_t value) { m_Value.store(value, std::memory_order_relaxed); }
+    void Add(int64_t delta) { m_Value.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t Get() const { return m_Value.load(std::memory_order_relaxed); }
+};
+
+/**
+ * Histogramme de durées à bornes fixes (METRIC_DURATION_BOUNDS_NS).
+ * Les classes ne sont pas cumulatives en mémoire ; l'export les cumule.
+ */
+class MetricHistogram
+{
+private:
+    std::atomic<uint64_t> m_Buckets[METRIC_DURATION_BUCKETS + 1];   // + dépassement
+    std::atomic<uint64_t> m_Count;
+    std::atomic<int64_t> m_SumNs;
+
+public:
+    MetricHistogram() : m_Count(0), m_SumNs(0)
+    {
+        for (std::atomic<uint64_t>& bucket : m_Buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+    void Observe(int64_t valueNs)
+    {
+        size_t i = 0;
+        while (i < METRIC_DURATION_BUCKETS && valueNs > METRIC_DURATION_BOUNDS_NS[i])
+            i++;
+        m_Buckets[i].fetch_add(1, std::memory_order_relaxed);
+        m_Count.fetch_add(1, std::memory_order_relaxed);
+        m_SumNs.fetch_add(valueNs, std::memory_order_relaxed);
+    }
+
+    uint64_t GetBucket(size_t i) const { return m_Buckets[i].load(std::memory_order_relaxed); }
+    uint64_t GetCount() const { return m_Count.load(std::memory_order_relaxed); }
+    int64_t GetSumNs() const { return m_SumNs.load(std::memory_order_relaxed); }
+};
+
+//==============================================================================
+// REGISTRE
+//==============================================================================
+
+enum class MetricType
+{
+    Counter,
+    Gauge,
+    Histogram,
+};
+
+class MetricsRegistry
+{
+private:
+    struct Entry
+    {
+        std::string name;
+        std::string labels;      // 'effect="Sinus"', vide si aucun
+        std::string help;
+        MetricType type;
+        double scale;            // Facteur appliqué à l'export (ns -> s)
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+
+    mutable std::mutex m_Mutex;          // Enregistrement et export uniquement
+    std::vector<std::unique_ptr<Entry>> m_Entries;
+
+    Entry& AddEntry(const std::string& name, const std::string& labels, const std::string& help,
+                    MetricType type, double scale)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Entries.emplace_back(new Entry());
+        Entry& entry = *m_Entries.back();
+        entry.name = name;
+        entry.labels = labels;
+        entry.help = help;
+        entry.type = type;
+        entry.scale = scale;
+        return entry;
+    }
+
+    static const char* TypeName(MetricType type)
+    {
+        switch (type)
+        {
+        case MetricType::Counter:   return "counter";
+        case MetricType::Gauge:     return "gauge";
+        case MetricType::Histogram: return "histogram";
+        }
+        return "untyped";
+    }
+
+    static std::string Series(const std::string& name, const std::string& labels, const std::string& extra = "")
+    {
+        std::string series = name;
+        if (!labels.empty() || !extra.empty())
+        {
+            series += "{" + labels;
+            if (!labels.empty() && !extra.empty())
+                series += ",";
+            series += extra + "}";
+        }
+        return series;
+    }
+
+public:
+    /**
+     * Compteur (monotone). scale s'applique à l'export, par exemple 1e-9
+     * pour un compteur de nanosecondes exporté en secondes.
+     */
+    MetricCounter& Counter(const std::string& name, const std::string& help,
+                           const std::string& labels = "", double scale = 1.0)
+    {
+        Entry& entry = AddEntry(name, labels, help, MetricType::Counter, scale);
+        entry.counter.reset(new MetricCounter());
+        return *entry.counter;
+    }
+
+    MetricGauge& Gauge(const std::string& name, const std::string& help, const std::string& labels = "")
+    {
+        Entry& entry = AddEntry(name, labels, help, MetricType::Gauge, 1.0);
+        entry.gauge.reset(new MetricGauge());
+        return *entry.gauge;
+    }
+
+    /**
+     * Histogramme de durées en ns, exporté en secondes.
+     */
+    MetricHistogram& Histogram(const std::string& name, const std::string& help, const std::string& labels = "")
+    {
+        Entry& entry = AddEntry(name, labels, help, MetricType::Histogram, 1e-9);
+        entry.histogram.reset(new MetricHistogram());
+        return *entry.histogram;
+    }
+
+    /**
+     * Écrit toutes les métriques au format texte Prometheus. Les séries
+     * d'un même nom (libellés différents) partagent HELP et TYPE.
+     */
+    void Export(std::ostream& out) const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        out << std::setprecision(9);
+
+        for (size_t i = 0; i < m_Entries.size(); i++)
+        {
+            const Entry& entry = *m_Entries[i];
+
+            bool bFirst = true;
+            for (size_t j = 0; j < i && bFirst; j++)
+                bFirst = m_Entries[j]->name != entry.name;
+            if (bFirst)
+            {
+                out << "# HELP " << entry.name << " " << entry.help << "\n";
+                out << "# TYPE " << entry.name << " " << TypeName(entry.type) << "\n";
+            }
+
+            switch (entry.type)
+            {
+            case MetricType::Counter:
+                if (entry.scale == 1.0)
+                    out << Series(entry.name, entry.labels) << " " << entry.counter->Get() << "\n";
+                else
+                    out << Series(entry.name, entry.labels) << " "
+                        << static_cast<double>(entry.counter->Get()) * entry.scale << "\n";
+                break;
+
+            case MetricType::Gauge:
+                out << Series(entry.name, entry.labels) << " " << entry.gauge->Get() << "\n";
+                break;
+
+            case MetricType::Histogram:
+            {
+                const MetricHistogram& h = *entry.histogram;
+                uint64_t cumulative = 0;
+                for (size_t b = 0; b < METRIC_DURATION_BUCKETS; b++)
+                {
+                    cumulative += h.GetBucket(b);
+                    std::ostringstream le;
+                    le << std::setprecision(9) << static_cast<double>(METRIC_DURATION_BOUNDS_NS[b]) * entry.scale;
+                    out << Series(entry.name + "_bucket", entry.labels, "le=\"" + le.str() + "\"")
+                        << " " << cumulative << "\n";
+                }
+                cumulative += h.GetBucket(METRIC_DURATION_BUCKETS);
+                out << Series(entry.name + "_bucket", entry.labels, "le=\"+Inf\"") << " " << cumulative << "\n";
+                out << Series(entry.name + "_sum", entry.labels) << " "
+                    << static_cast<double>(h.GetSumNs()) * entry.scale << "\n";
+                out << Series(entry.name + "_count", entry.labels) << " " << h.GetCount() << "\n";
+                break;
+            }
+            }
+        }
+    }
+
+    std::string ExportText() const
+    {
+        std::ostringstream out;
+        Export(out);
+        return out.str();
+    }
+};
@@ -0,0 +1,155 @@
+//==============================================================================
+// OutputStage.h - Étage de sortie de la force (seuil, cadence, pente)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Le rendu logiciel produit une force à 1 kHz, mais chaque changement coûte
+// une mise à jour EVIOCSFF, donc un transfert sur l'endpoint USB basse
+// vitesse du Sidewinder. Cet étage décide, tick par tick, si la force doit
+// partir :
+//  - écart au dernier niveau envoyé inférieur au seuil : supprimé ;
+//  - mise à jour trop proche de la précédente (cadence max) : supprimée ;
+//  - pente max : le niveau envoyé rejoint la cible par paliers bornés ;
+//  - une cible stable depuis flushNs est toujours envoyée telle quelle,
+//    même sous le seuil, pour que le volant finisse sur la valeur exacte.
+// L'étage ne fait aucun appel système : l'appelant envoie la valeur
+// proposée puis confirme avec Commit() si l'envoi a réussi.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+#include "FixedPoint.h"
+
+//==============================================================================
+// PARAMÈTRES
+//==============================================================================
+
+struct OutputStageParams
+{
+    int32_t threshold;           // Écart minimal à envoyer (Q15, 0 = tout changement)
+    int64_t minIntervalNs;       // Intervalle minimal entre deux envois (0 = illimité)
+    int32_t maxSlewPerMs;        // Variation max par ms (Q15, 0 = illimitée)
+    int64_t flushNs;             // Stabilité de la cible avant envoi forcé
+
+    OutputStageParams()
+        : threshold(128), minIntervalNs(2000000), maxSlewPerMs(0), flushNs(10000000)
+    {
+    }
+};
+
+/**
+ * Décision de l'étage pour un tick.
+ */
+enum class OutputDecision
+{
+    Idle,                        // Cible déjà envoyée
+    Send,                        // Envoyer la valeur proposée
+    Flush,                       // Envoyer la cible finale (sous le seuil)
+    SuppressedThreshold,         // Écart sous le seuil
+    SuppressedRate               // Cadence max atteinte
+};
+
+//==============================================================================
+// ÉTAGE DE SORTIE
+//==============================================================================
+
+class OutputStage
+{
+private:
+    OutputStageParams m_Params;
+    int16_t m_Sent;              // Dernier niveau confirmé
+    int64_t m_LastSendNs;
+    int32_t m_Target;
+    int64_t m_TargetSinceNs;     // Instant du dernier changement de cible
+    bool m_bSlewLimited;         // La dernière proposition a été bornée en pente
+
+public:
+    OutputStage()
+        : m_Sent(0), m_LastSendNs(0), m_Target(0), m_TargetSinceNs(0), m_bSlewLimited(false)
+    {
+    }
+
+    void SetParams(const OutputStageParams& params) { m_Params = params; }
+    const OutputStageParams& GetParams() const { return m_Params; }
+
+    /**
+     * Repart d'un niveau connu (effet de sortie recréé, par exemple).
+     */
+    void Reset(int16_t level, int64_t nowNs)
+    {
+        m_Sent = level;
+        m_LastSendNs = nowNs;
+        m_Target = level;
+        m_TargetSinceNs = nowNs;
+        m_bSlewLimited = false;
+    }
+
+    /**
+     * Présente la force du tick. Si la décision est Send ou Flush, value
+     * reçoit le niveau à envoyer ; sinon value est inchangée.
+     */
+    OutputDecision Step(int32_t target, int64_t nowNs, int16_t& value)
+    {
+        target = fixp::SaturateQ15(target);
+        if (target != m_Target)
+        {
+            m_Target = target;
+            m_TargetSinceNs = nowNs;
+        }
+        m_bSlewLimited = false;
+
+        if (target == m_Sent)
+        {
+            return OutputDecision::Idle;
+        }
+
+        const int64_t elapsedNs = nowNs - m_LastSendNs;
+        if (elapsedNs < m_Params.minIntervalNs)
+        {
+            return OutputDecision::SuppressedRate;
+        }
+
+        const int32_t delta = target - m_Sent;
+        const bool bStable = nowNs - m_TargetSinceNs >= m_Params.flushNs;
+        if (std::abs(delta) < m_Params.threshold && !bStable)
+        {
+            return OutputDecision::SuppressedThreshold;
+        }
+
+        int32_t step = delta;
+        if (m_Params.maxSlewPerMs > 0)
+        {
+            // Écart borné à 1 s : évite le débordement après une longue pause
+            const int64_t maxStep = static_cast<int64_t>(m_Params.maxSlewPerMs)
+                * std::min<int64_t>(elapsedNs, 1000000000LL) / 1000000;
+            const int32_t limit = static_cast<int32_t>(std::max<int64_t>(maxStep, 1));
+            if (std::abs(step) > limit)
+            {
+                step = step > 0 ? limit : -limit;
+                m_bSlewLimited = true;
+            }
+        }
+
+        value = static_cast<int16_t>(m_Sent + step);
+        return std::abs(delta) < m_Params.threshold ? OutputDecision::Flush : OutputDecision::Send;
+    }
+
+    /**
+     * Confirme l'envoi de value (à ne pas appeler si l'envoi a échoué :
+     * la proposition sera refaite au tick suivant).
+     */
+    void Commit(int16_t value, int64_t nowNs)
+    {
+        m_Sent = value;
+        m_LastSendNs = nowNs;
+    }
+
+    int16_t GetSent() const { return m_Sent; }
+    int32_t GetTarget() const { return m_Target; }
+    bool IsSlewLimited() const { return m_bSlewLimited; }
+};
@@ -0,0 +1,149 @@
+//==============================================================================
+// PhaseProfiler.h - Chronométrage des phases de démarrage
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Chaque phase mesurée (Measure) devient une plage [début, fin] sur
+// l'horloge monotone, imbriquée dans la phase en cours : Initialize() ->
+// CreateAllEffects -> un EVIOCSFF par effet, par exemple. Après coup, les
+// plages donnent une répartition du temps de démarrage et peuvent être
+// écrites au format Chrome trace (chrome://tracing, Perfetto) : un
+// événement complet ("ph":"X") par plage, horodatages en µs.
+// Hors de Start()/Stop(), Measure() exécute simplement la phase.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "Clock.h"
+
+//==============================================================================
+// PLAGES
+//==============================================================================
+
+struct ProfileSpan
+{
+    std::string name;
+    const char* category;        // "phase", "ioctl"...
+    int depth;                   // 0 = phase de premier niveau
+    int64_t startNs;             // MonotonicNowNs()
+    int64_t endNs;
+};
+
+//==============================================================================
+// PROFILEUR
+//==============================================================================
+
+class PhaseProfiler
+{
+private:
+    std::vector<ProfileSpan> m_Spans;
+    bool m_bActive;
+    int m_Depth;
+    int64_t m_StartNs;
+    int64_t m_EndNs;
+
+    static void WriteJsonString(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                out << ' ';
+            else
+                out << c;
+        }
+        out << '"';
+    }
+
+public:
+    PhaseProfiler() : m_bActive(false), m_Depth(0), m_StartNs(0), m_EndNs(0) {}
+
+    /**
+     * Début de l'enregistrement (les plages précédentes sont effacées).
+     */
+    void Start()
+    {
+        m_Spans.clear();
+        m_Depth = 0;
+        m_StartNs = MonotonicNowNs();
+        m_EndNs = m_StartNs;
+        m_bActive = true;
+    }
+
+    void Stop()
+    {
+        m_EndNs = MonotonicNowNs();
+        m_bActive = false;
+    }
+
+    /**
+     * Exécute body() comme une phase nommée et renvoie son résultat.
+     */
+    template<typename Body>
+    auto Measure(const std::string& name, Body&& body, const char* category = "phase") -> decltype(body())
+    {
+        if (!m_bActive)
+            return body();
+
+        const size_t index = m_Spans.size();
+        m_Spans.push_back(ProfileSpan{ name, category, m_Depth, MonotonicNowNs(), 0 });
+        m_Depth++;
+
+        // Plage refermée même si body() lève une exception
+        struct Closer
+        {
+            PhaseProfiler& profiler;
+            size_t index;
+            ~Closer()
+            {
+                profiler.m_Depth--;
+                profiler.m_Spans[index].endNs = MonotonicNowNs();
+            }
+        } closer{ *this, index };
+
+        return body();
+    }
+
+    const std::vector<ProfileSpan>& GetSpans() const { return m_Spans; }
+    int64_t GetTotalNs() const { return m_EndNs - m_StartNs; }
+
+    /**
+     * Écrit les plages au format Chrome trace (JSON, tableau traceEvents).
+     * @return false si le fichier n'a pas pu être écrit.
+     */
+    bool WriteChromeTrace(const std::string& path, const char* processName) const
+    {
+        std::ofstream file(path);
+        if (!file)
+            return false;
+
+        char number[32];
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":";
+        WriteJsonString(file, processName);
+        file << "}}";
+
+        for (const ProfileSpan& span : m_Spans)
+        {
+            file << ",\n{\"name\":";
+            WriteJsonString(file, span.name);
+            file << ",\"cat\":\"" << span.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1";
+            snprintf(number, sizeof(number), "%.3f", static_cast<double>(span.startNs - m_StartNs) / 1000.0);
+            file << ",\"ts\":" << number;
+            snprintf(number, sizeof(number), "%.3f", static_cast<double>(span.endNs - span.startNs) / 1000.0);
+            file << ",\"dur\":" << number << "}";
+        }
+
+        file << "\n]}\n";
+        return static_cast<bool>(file);
+    }
+};
@@ -0,0 +1,170 @@
+//==============================================================================
+// SoftwareRenderer.h - Rendu logiciel des effets (mixage des couches actives)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// En mode rendu logiciel, les effets ne sont pas envoyés au device : chaque
+// effet joué devient une couche (ff_effect sans enveloppe kernel + enveloppe
+// ADSR logicielle). À chaque tick du thread de force, les couches sont
+// évaluées, pondérées par leur enveloppe puis sommées ; le résultat alimente
+// un unique effet constant sur le device. Les enveloppes fonctionnent ainsi
+// sur tous les types d'effets, que le pilote les gère ou non.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "FFEffect.h"
+
+#include "FixedPoint.h"
+#include "EffectRender.h"
+#include "EnvelopeEngine.h"
+
+//==============================================================================
+// RENDU
+//==============================================================================
+
+class SoftwareRenderer
+{
+private:
+    struct Layer
+    {
+        int16_t sourceId;        // ID de l'effet d'origine
+        ff_effect effect;        // Sans enveloppe kernel
+        int64_t startNs;
+    };
+
+    // Couches et enveloppes partagent les mêmes index
+    Layer m_Layers[ENVELOPE_MAX_LAYERS];
+    EnvelopeBank m_Envelopes;
+    int32_t m_Elapsed[ENVELOPE_MAX_LAYERS];
+    int32_t m_Gains[ENVELOPE_MAX_LAYERS];
+
+    size_t Find(int16_t sourceId) const
+    {
+        for (size_t i = 0; i < m_Envelopes.GetCount(); i++)
+        {
+            if (m_Layers[i].sourceId == sourceId)
+                return i;
+        }
+        return ENVELOPE_MAX_LAYERS;
+    }
+
+    static int32_t ElapsedMs(int64_t nowNs, int64_t startNs)
+    {
+        const int64_t ms = (nowNs - startNs) / 1000000;
+        return static_cast<int32_t>(ms < 0 ? 0 : (ms > INT32_MAX ? INT32_MAX : ms));
+    }
+
+    void RemoveAt(size_t i)
+    {
+        const size_t last = m_Envelopes.GetCount() - 1;
+        m_Envelopes.Remove(i);
+        if (i != last)
+            m_Layers[i] = m_Layers[last];
+    }
+
+public:
+    SoftwareRenderer() {}
+
+    size_t GetActiveCount() const { return m_Envelopes.GetCount(); }
+
+    /**
+     * Effets actifs (bit i = ID source i, IDs 0 à 31).
+     */
+    uint32_t GetActiveMask() const
+    {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < m_Envelopes.GetCount(); i++)
+        {
+            if (m_Layers[i].sourceId >= 0 && m_Layers[i].sourceId < 32)
+                mask |= 1u << m_Layers[i].sourceId;
+        }
+        return mask;
+    }
+
+    /**
+     * Démarre (ou redémarre) une couche pour l'effet donné.
+     * @return false si toutes les couches sont occupées.
+     */
+    bool Start(const ff_effect& effect, const EnvelopeADSR& envelope, int64_t nowNs)
+    {
+        const size_t existing = Find(effect.id);
+        if (existing < ENVELOPE_MAX_LAYERS)
+            RemoveAt(existing);
+
+        const size_t i = m_Envelopes.Add(envelope);
+        if (i >= ENVELOPE_MAX_LAYERS)
+            return false;
+
+        m_Layers[i].sourceId = effect.id;
+        m_Layers[i].effect = StripEnvelope(effect);
+        m_Layers[i].startNs = nowNs;
+        return true;
+    }
+
+    /**
+     * Met à jour les paramètres d'une couche active (niveau, magnitude...)
+     * sans relancer son enveloppe.
+     */
+    void Update(const ff_effect& effect)
+    {
+        const size_t i = Find(effect.id);
+        if (i < ENVELOPE_MAX_LAYERS)
+            m_Layers[i].effect = StripEnvelope(effect);
+    }
+
+    /**
+     * Passe la couche en relâche ; elle disparaît à la fin de celle-ci.
+     */
+    void Release(int16_t sourceId, int64_t nowNs)
+    {
+        const size_t i = Find(sourceId);
+        if (i < ENVELOPE_MAX_LAYERS)
+            m_Envelopes.Release(i, ElapsedMs(nowNs, m_Layers[i].startNs));
+    }
+
+    void ReleaseAll(int64_t nowNs)
+    {
+        for (size_t i = 0; i < m_Envelopes.GetCount(); i++)
+            m_Envelopes.Release(i, ElapsedMs(nowNs, m_Layers[i].startNs));
+    }
+
+    void Clear()
+    {
+        m_Envelopes.Clear();
+    }
+
+    /**
+     * Force totale à nowNs (Q15 saturé). Les couches terminées (relâche
+     * achevée ou durée écoulée) sont retirées.
+     */
+    int32_t Render(int64_t nowNs, const AxisState& axis)
+    {
+        // Retrait des couches terminées avant l'évaluation
+        for (size_t i = m_Envelopes.GetCount(); i-- > 0;)
+        {
+            const int32_t elapsed = ElapsedMs(nowNs, m_Layers[i].startNs);
+            const uint16_t length = m_Layers[i].effect.replay.length;
+            if (m_Envelopes.IsFinished(i, elapsed) || (length && elapsed >= length))
+                RemoveAt(i);
+        }
+
+        const size_t count = m_Envelopes.GetCount();
+        for (size_t i = 0; i < count; i++)
+            m_Elapsed[i] = ElapsedMs(nowNs, m_Layers[i].startNs);
+
+        m_Envelopes.EvaluateAll(m_Elapsed, m_Gains);
+
+        int32_t total = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const int32_t force = EvaluateEffect(m_Layers[i].effect, static_cast<uint32_t>(m_Elapsed[i]), axis);
+            total += fixp::Mul(force, m_Gains[i]);
+        }
+        return fixp::SaturateQ15(total);
+    }
+};
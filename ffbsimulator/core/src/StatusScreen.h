@@ -0,0 +1,216 @@
+//==============================================================================
+// StatusScreen.h - Rendu texte de l'écran d'état du simulateur
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// L'écran est construit à partir d'un instantané (StatusScreen) et écrit sur
+// n'importe quel flux : la console en fonctionnement normal, un tampon pour
+// les benchmarks. Les valeurs sont formatées directement dans le flux, sans
+// chaîne intermédiaire : rafraîchir l'écran ne fait aucune allocation.
+// Commun aux deux frontends (evdev, DirectInput) : chacun remplit
+// l'instantané dans ses unités, l'écran d'aide suit le même principe.
+//==============================================================================
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+#include "InputSnapshot.h"
+
+//==============================================================================
+// FORMATAGE
+//==============================================================================
+
+inline void WriteForce(std::ostream& out, int16_t force)
+{
+    double percentage = (force * 100.0) / 32767;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%d (%.1f%%)", (int)force, percentage);
+    out << buffer;
+}
+
+inline void WriteDirection(std::ostream& out, int16_t direction)
+{
+    if (direction == 0) out << "Centre";
+    else if (direction > 0) out << "Droite (" << direction << ")";
+    else out << "Gauche (" << direction << ")";
+}
+
+inline void WriteDuration(std::ostream& out, uint32_t duration)
+{
+    if (duration == 0) out << "Infinie";    // 0 = infinie (INFINITE ramené à 0 sous Windows)
+    else out << duration << "ms";
+}
+
+//==============================================================================
+// ÉCRAN D'ÉTAT
+//==============================================================================
+
+struct StatusScreen
+{
+    const char* platform;        // "Linux", "Windows"
+    bool bDeviceOpen;
+    const char* devicePath;
+    InputSnapshot input;
+    const std::vector<std::string>* effectNames;
+    size_t currentEffect;
+    bool bEffectPlaying;
+    bool bShowForce;
+    int16_t force;
+    int16_t intensity;
+    int16_t direction;
+    uint32_t duration;
+    bool bSteeringPhysics;
+    int speedKmh;
+};
+
+inline void RenderStatusScreen(std::ostream& out, const StatusScreen& screen)
+{
+    out << "\033[2J\033[1;1H"; // Clear screen ANSI
+
+    out << "=== SIMULATEUR FORCE FEEDBACK SIDEWINDER (" << screen.platform << ") ===" << std::endl;
+    out << "=====================================================" << std::endl;
+
+    // État du périphérique
+    out << "Device: " << (screen.bDeviceOpen ? "CONNECTÉ" : "DÉCONNECTÉ") << std::endl;
+    out << "Path: " << screen.devicePath << std::endl;
+
+    if (screen.bDeviceOpen)
+    {
+        out << "Position volant: " << screen.input.steering << std::endl;
+        out << "Pédales: Acc=" << screen.input.pedal1 << " Frein=" << screen.input.pedal2 << std::endl;
+
+        // Affichage des boutons pressés
+        out << "Boutons: ";
+        bool hasButtons = false;
+        for (int i = 0; i < 32; i++)
+        {
+            if (screen.input.buttons & (1u << i))
+            {
+                out << i << " ";
+                hasButtons = true;
+            }
+        }
+        if (!hasButtons) out << "Aucun";
+        out << std::endl;
+    }
+
+    out << "=====================================================" << std::endl;
+
+    // Effet courant
+    const std::vector<std::string>& names = *screen.effectNames;
+    if (!names.empty())
+    {
+        out << "Effet courant: [" << (screen.currentEffect + 1) << "/" << names.size() << "] ";
+        out << names[screen.currentEffect];
+        out << " " << (screen.bEffectPlaying ? "[EN COURS]" : "[ARRÊTÉ]") << std::endl;
+    }
+
+    if (screen.bShowForce)
+    {
+        out << "Force estimée: ";
+        WriteForce(out, screen.force);
+        out << std::endl;
+    }
+
+    if (screen.bSteeringPhysics)
+    {
+        out << "Physique direction: " << screen.speedKmh << " km/h" << std::endl;
+    }
+
+    // Paramètres
+    out << "Intensité: ";
+    WriteForce(out, screen.intensity);
+    out << std::endl << "Direction: ";
+    WriteDirection(out, screen.direction);
+    out << std::endl << "Durée: ";
+    WriteDuration(out, screen.duration);
+    out << std::endl;
+
+    out << "=====================================================" << std::endl;
+
+    // Liste des effets disponibles
+    out << "Effets disponibles:" << std::endl;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        out << "  " << (i == screen.currentEffect ? "►" : " ") << " " << names[i] << std::endl;
+    }
+
+    out << "=====================================================" << std::endl;
+}
+
+//==============================================================================
+// ÉCRAN D'AIDE
+//==============================================================================
+
+struct HelpScreen
+{
+    const char* platform;
+    int intensityStep;           // Pas des touches + et -
+    bool bArrowKeys;             // Direction (← →) et durée (↑ ↓) réglables
+    const char* devicePath;      // Section permissions (Linux), nullptr sinon
+};
+
+inline void RenderHelpScreen(std::ostream& out, const HelpScreen& help)
+{
+    out << "\033[2J\033[1;1H"; // Clear screen ANSI
+
+    out << "===================================================" << std::endl;
+    out << "         AIDE - SIMULATEUR FFB (" << help.platform << ")" << std::endl;
+    out << "===================================================" << std::endl;
+    out << std::endl;
+
+    out << "CONTRÔLES PRINCIPAUX:" << std::endl;
+    out << "  ESPACE      Jouer/Arrêter l'effet courant" << std::endl;
+    out << "  N           Effet suivant" << std::endl;
+    out << "  P           Effet précédent" << std::endl;
+    out << "  S           Arrêter tous les effets" << std::endl;
+    out << std::endl;
+
+    out << "AJUSTEMENTS:" << std::endl;
+    out << "  +  =        Augmenter l'intensité (+" << help.intensityStep << ")" << std::endl;
+    out << "  -  _        Diminuer l'intensité (-" << help.intensityStep << ")" << std::endl;
+    if (help.bArrowKeys)
+    {
+        out << "  ← →         Ajuster la direction (±1000)" << std::endl;
+        out << "  ↑ ↓         Ajuster la durée (±500ms)" << std::endl;
+    }
+    out << std::endl;
+
+    out << "NAVIGATION:" << std::endl;
+    out << "  H           Basculer aide ON/OFF" << std::endl;
+    out << "  ESC         Quitter l'aide ou le programme" << std::endl;
+    out << std::endl;
+
+    out << "EFFETS DISPONIBLES:" << std::endl;
+    out << "  • Effets constants (résistance directionnelle)" << std::endl;
+    out << "  • Effets périodiques (vibrations rythmées)" << std::endl;
+    out << "  • Effets rampe (force progressive)" << std::endl;
+    out << "  • Effets condition (ressort, amortissement)" << std::endl;
+    out << std::endl;
+
+    out << "CONSEILS D'UTILISATION:" << std::endl;
+    out << "  1. Commencez par 'Constant_Droite' ou 'Sinus'" << std::endl;
+    out << "  2. Ajustez l'intensité selon votre confort" << std::endl;
+    out << "  3. Les effets 'Condition' simulent des résistances" << std::endl;
+    out << "  4. Utilisez 'S' pour arrêter rapidement si nécessaire" << std::endl;
+    out << std::endl;
+
+    if (help.devicePath)
+    {
+        out << "PERMISSIONS:" << std::endl;
+        out << "  Si erreur d'accès, exécutez:" << std::endl;
+        out << "    sudo chmod 666 " << help.devicePath << std::endl;
+        out << "  Ou ajoutez votre utilisateur au groupe 'input'" << std::endl;
+        out << std::endl;
+    }
+
+    out << "===================================================" << std::endl;
+    out << "   Appuyez sur H ou ESC pour revenir au menu      " << std::endl;
+    out << "===================================================" << std::endl;
+}
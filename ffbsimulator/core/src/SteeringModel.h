@@ -0,0 +1,253 @@
+//==============================================================================
+// SteeringModel.h - Modèle physique de direction (couple d'autoalignement)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Modèle temps réel cadencé à 1 kHz par le thread de force :
+//  - véhicule en modèle bicyclette (vitesse latérale, vitesse de lacet) ;
+//  - pneus à saturation progressive, couple d'autoalignement via la chasse
+//    pneumatique (qui s'effondre quand le pneu glisse) et la chasse
+//    mécanique ;
+//  - crémaillère avec inertie et amortissement, reliée au volant mesuré
+//    (ABS_X) par une barre de torsion ;
+//  - butées de fin de course.
+// Le couple ressenti est la réaction de la barre de torsion plus les butées.
+// Intégration d'Euler semi-implicite à pas fixe, subdivisé pour que le
+// terme le plus raide reste dans la zone de stabilité.
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+#include "FixedPoint.h"
+
+//==============================================================================
+// PARAMÈTRES
+//==============================================================================
+
+const float STEERING_TICK_SECONDS = 0.001f;       // 1 kHz
+const float STEERING_MIN_SPEED = 0.5f;            // m/s, évite la singularité à l'arrêt
+const float STEERING_GRAVITY = 9.81f;
+
+struct SteeringParams
+{
+    // Véhicule (modèle bicyclette)
+    float mass;                  // kg
+    float yawInertia;            // kg·m²
+    float frontAxle;             // Distance CG - essieu avant (m)
+    float rearAxle;              // Distance CG - essieu arrière (m)
+    float frontCornering;        // Rigidité de dérive avant (N/rad)
+    float rearCornering;         // Rigidité de dérive arrière (N/rad)
+    float friction;              // Coefficient d'adhérence
+
+    // Pneu avant : chasse pneumatique et mécanique (m)
+    float pneumaticTrail;
+    float mechanicalTrail;
+    float slideSlip;             // Dérive où la chasse pneumatique s'annule (rad)
+
+    // Direction (grandeurs ramenées au volant)
+    float steeringRatio;
+    float wheelRange;            // Débattement total du volant (rad)
+    float rackInertia;           // kg·m²
+    float rackDamping;           // N·m·s/rad
+    float torsionStiffness;      // N·m/rad
+    float torsionDamping;        // N·m·s/rad
+    float alignGain;             // Part du couple d'autoalignement transmise
+    float endStopFraction;       // Début de butée (fraction du demi-débattement)
+    float endStopStiffness;      // N·m/rad
+    float endStopDamping;        // N·m·s/rad
+    float maxTorque;             // Couple correspondant à la force maximale (N·m)
+    float velocityFilterHz;      // Coupure du filtre de vitesse du volant
+
+    SteeringParams()
+        : mass(1200.0f), yawInertia(1800.0f), frontAxle(1.2f), rearAxle(1.4f)
+        , frontCornering(80000.0f), rearCornering(90000.0f), friction(1.0f)
+        , pneumaticTrail(0.04f), mechanicalTrail(0.02f), slideSlip(0.12f)
+        , steeringRatio(15.0f), wheelRange(4.19f)       // 240°
+        , rackInertia(0.04f), rackDamping(0.15f)
+        , torsionStiffness(60.0f), torsionDamping(0.6f)
+        , alignGain(0.25f)
+        , endStopFraction(0.95f), endStopStiffness(200.0f), endStopDamping(2.0f)
+        , maxTorque(4.0f), velocityFilterHz(20.0f)
+    {
+    }
+};
+
+//==============================================================================
+// MODÈLE
+//==============================================================================
+
+class SteeringModel
+{
+private:
+    SteeringParams m_Params;
+    int m_Substeps;
+    float m_FrontLoad;           // Force latérale max avant (µ·Fz, N)
+    float m_RearLoad;
+    float m_VelocityAlpha;       // Coefficient du filtre passe-bas
+
+    // Entrées
+    float m_Speed;               // Vitesse longitudinale (m/s)
+    float m_WheelAngle;          // Angle volant mesuré (rad)
+    float m_WheelVelocity;       // Filtrée (rad/s)
+    bool m_bHaveWheel;
+
+    // État
+    float m_LateralVelocity;     // m/s
+    float m_YawRate;             // rad/s
+    float m_RackAngle;           // rad, au volant
+    float m_RackVelocity;        // rad/s
+    float m_FrontSlip;           // rad (diagnostic)
+    float m_Torque;              // Couple ressenti (N·m)
+
+    /**
+     * Force latérale d'un pneu, linéaire à faible dérive puis saturée.
+     */
+    static float TyreForce(float cornering, float slip, float limit)
+    {
+        return limit * std::tanh(cornering * slip / limit);
+    }
+
+    void Substep(float h)
+    {
+        const SteeringParams& p = m_Params;
+        const float vx = std::max(m_Speed, STEERING_MIN_SPEED);
+        const float delta = m_RackAngle / p.steeringRatio;
+
+        // Dérives et efforts des pneus
+        m_FrontSlip = delta - (m_LateralVelocity + p.frontAxle * m_YawRate) / vx;
+        const float rearSlip = -(m_LateralVelocity - p.rearAxle * m_YawRate) / vx;
+        const float frontForce = TyreForce(p.frontCornering, m_FrontSlip, m_FrontLoad);
+        const float rearForce = TyreForce(p.rearCornering, rearSlip, m_RearLoad);
+
+        // Couple d'autoalignement, atténué à très basse vitesse
+        const float trail = p.pneumaticTrail * std::max(0.0f, 1.0f - std::fabs(m_FrontSlip) / p.slideSlip)
+                          + p.mechanicalTrail;
+        const float speedFactor = std::min(1.0f, m_Speed / 2.0f);
+        const float alignTorque = -p.alignGain * speedFactor * trail * frontForce / p.steeringRatio;
+
+        // Barre de torsion entre le volant et la crémaillère
+        const float barTorque = p.torsionStiffness * (m_WheelAngle - m_RackAngle)
+                              + p.torsionDamping * (m_WheelVelocity - m_RackVelocity);
+
+        // Vitesses d'abord, puis positions (Euler semi-implicite)
+        if (m_Speed > 0.0f)
+        {
+            m_LateralVelocity += h * ((frontForce + rearForce) / p.mass - vx * m_YawRate);
+            m_YawRate += h * (p.frontAxle * frontForce - p.rearAxle * rearForce) / p.yawInertia;
+        }
+        else
+        {
+            m_LateralVelocity = 0.0f;
+            m_YawRate = 0.0f;
+        }
+
+        m_RackVelocity += h * (barTorque + alignTorque - p.rackDamping * m_RackVelocity) / p.rackInertia;
+        m_RackAngle += h * m_RackVelocity;
+
+        // Réaction ressentie par le conducteur
+        m_Torque = -barTorque;
+    }
+
+public:
+    explicit SteeringModel(const SteeringParams& params = SteeringParams())
+        : m_Params(params)
+        , m_Substeps(1)
+        , m_Speed(0.0f)
+    {
+        m_FrontLoad = params.friction * params.mass * STEERING_GRAVITY * params.rearAxle
+                    / (params.frontAxle + params.rearAxle);
+        m_RearLoad = params.friction * params.mass * STEERING_GRAVITY * params.frontAxle
+                   / (params.frontAxle + params.rearAxle);
+
+        const float rc = 1.0f / (2.0f * 3.14159265f * params.velocityFilterHz);
+        m_VelocityAlpha = STEERING_TICK_SECONDS / (rc + STEERING_TICK_SECONDS);
+
+        // Taux caractéristique le plus raide : oscillation de la barre de
+        // torsion, amortissement de la crémaillère, dérive à vitesse minimale
+        const float rates[] = {
+            std::sqrt(params.torsionStiffness / params.rackInertia),
+            (params.torsionDamping + params.rackDamping) / params.rackInertia,
+            (params.frontCornering + params.rearCornering) / (params.mass * STEERING_MIN_SPEED),
+            params.frontCornering * params.frontAxle * params.frontAxle / (params.yawInertia * STEERING_MIN_SPEED),
+        };
+        const float stiffest = *std::max_element(std::begin(rates), std::end(rates));
+
+        // h · taux <= 0.25 : large marge sous la limite de stabilité (2)
+        m_Substeps = std::max(1, static_cast<int>(std::ceil(stiffest * STEERING_TICK_SECONDS / 0.25f)));
+
+        Reset();
+    }
+
+    void Reset()
+    {
+        m_WheelAngle = 0.0f;
+        m_WheelVelocity = 0.0f;
+        m_bHaveWheel = false;
+        m_LateralVelocity = 0.0f;
+        m_YawRate = 0.0f;
+        m_RackAngle = 0.0f;
+        m_RackVelocity = 0.0f;
+        m_FrontSlip = 0.0f;
+        m_Torque = 0.0f;
+    }
+
+    /**
+     * Vitesse du véhicule (m/s).
+     */
+    void SetSpeed(float speed) { m_Speed = std::max(0.0f, speed); }
+
+    /**
+     * Avance le modèle d'un tick (STEERING_TICK_SECONDS).
+     * @param position Position normalisée du volant en Q15.
+     * @return Force à appliquer en Q15 (positive = vers la droite).
+     */
+    int32_t Step(int32_t position)
+    {
+        const SteeringParams& p = m_Params;
+        const float halfRange = 0.5f * p.wheelRange;
+        const float angle = static_cast<float>(position) * (halfRange / fixp::Q15_ONE);
+
+        // Vitesse du volant : différence finie filtrée (l'ABS_X est quantifié)
+        if (m_bHaveWheel)
+        {
+            const float raw = (angle - m_WheelAngle) / STEERING_TICK_SECONDS;
+            m_WheelVelocity += m_VelocityAlpha * (raw - m_WheelVelocity);
+        }
+        else
+        {
+            m_RackAngle = angle;
+            m_bHaveWheel = true;
+        }
+        m_WheelAngle = angle;
+
+        const float h = STEERING_TICK_SECONDS / static_cast<float>(m_Substeps);
+        for (int i = 0; i < m_Substeps; i++)
+            Substep(h);
+
+        // Butées de fin de course
+        float torque = m_Torque;
+        const float limit = p.endStopFraction * halfRange;
+        const float excess = std::fabs(angle) - limit;
+        if (excess > 0.0f)
+        {
+            const float sign = angle > 0.0f ? 1.0f : -1.0f;
+            torque -= sign * p.endStopStiffness * excess + p.endStopDamping * m_WheelVelocity;
+        }
+
+        const float scaled = torque * (fixp::Q15_MAX / p.maxTorque);
+        return fixp::SaturateQ15(static_cast<int32_t>(std::max(-65536.0f, std::min(65536.0f, scaled))));
+    }
+
+    int GetSubsteps() const { return m_Substeps; }
+    float GetTorque() const { return m_Torque; }
+    float GetFrontSlip() const { return m_FrontSlip; }
+    float GetYawRate() const { return m_YawRate; }
+    float GetRackAngle() const { return m_RackAngle; }
+    float GetSpeed() const { return m_Speed; }
+};
@@ -0,0 +1,128 @@
+//==============================================================================
+// SteeringPredictor.h - Prédiction de la position du volant (filtre alpha-bêta)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// La force calculée à partir de la dernière position lue arrive au moteur
+// avec la latence d'entrée (horodatage de l'événement -> lecture) plus la
+// latence de sortie (tick -> EVIOCSFF -> moteur). Avec un ressort ou un
+// amortisseur de gain élevé, ce retard se comporte comme un amortissement
+// négatif et fait osciller le volant.
+//
+// Le prédicteur suit position et vitesse par un filtre alpha-bêta alimenté
+// avec l'horodatage de chaque événement ABS_X (pas irrégulier), puis
+// extrapole la position à l'instant d'actionnement prévu. L'horizon est
+// borné, et la vitesse est ignorée quand le volant n'a plus émis
+// d'événement depuis staleNs (evdev ne signale que les changements : un
+// volant immobile ne produit plus rien).
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+//==============================================================================
+// PARAMÈTRES
+//==============================================================================
+
+struct PredictorParams
+{
+    float alpha;                 // Gain de correction de la position
+    float beta;                  // Gain de correction de la vitesse
+    int64_t minStepNs;           // Pas minimal entre deux mesures (horodatages égaux)
+    int64_t maxHorizonNs;        // Extrapolation max au-delà de la dernière mesure
+    int64_t staleNs;             // Au-delà, volant considéré immobile
+
+    PredictorParams()
+        : alpha(0.5f), beta(0.1f), minStepNs(500000), maxHorizonNs(25000000), staleNs(50000000)
+    {
+    }
+};
+
+//==============================================================================
+// PRÉDICTEUR
+//==============================================================================
+
+class SteeringPredictor
+{
+private:
+    PredictorParams m_Params;
+    bool m_bHaveSample;
+    int64_t m_LastNs;            // Horodatage de la dernière mesure
+    float m_Position;            // Estimation à m_LastNs (Q15)
+    float m_Velocity;            // Q15 par seconde
+    int32_t m_Measured;          // Dernière mesure brute
+
+public:
+    SteeringPredictor()
+    {
+        Reset();
+    }
+
+    void SetParams(const PredictorParams& params) { m_Params = params; }
+    const PredictorParams& GetParams() const { return m_Params; }
+
+    void Reset()
+    {
+        m_bHaveSample = false;
+        m_LastNs = 0;
+        m_Position = 0.0f;
+        m_Velocity = 0.0f;
+        m_Measured = 0;
+    }
+
+    /**
+     * Nouvelle mesure de position (Q15) horodatée en ns. Les mesures plus
+     * anciennes que la précédente sont ignorées.
+     */
+    void Update(int64_t timeNs, int32_t position)
+    {
+        m_Measured = position;
+        if (!m_bHaveSample)
+        {
+            m_bHaveSample = true;
+            m_LastNs = timeNs;
+            m_Position = static_cast<float>(position);
+            m_Velocity = 0.0f;
+            return;
+        }
+        if (timeNs < m_LastNs)
+            return;
+
+        // Après une longue immobilité, la vitesse suivie n'a plus de sens
+        const int64_t gapNs = timeNs - m_LastNs;
+        if (gapNs > m_Params.staleNs)
+            m_Velocity = 0.0f;
+
+        const float dt = static_cast<float>(std::max(gapNs, m_Params.minStepNs)) * 1e-9f;
+        const float predicted = m_Position + m_Velocity * dt;
+        const float residual = static_cast<float>(position) - predicted;
+
+        m_Position = predicted + m_Params.alpha * residual;
+        m_Velocity += m_Params.beta * residual / dt;
+        m_LastNs = timeNs;
+    }
+
+    /**
+     * Position extrapolée à l'instant timeNs (Q15).
+     */
+    int32_t Predict(int64_t timeNs) const
+    {
+        if (!m_bHaveSample)
+            return m_Measured;
+
+        const int64_t ageNs = timeNs - m_LastNs;
+        if (ageNs > m_Params.staleNs)
+            return m_Measured;
+
+        const int64_t horizonNs = std::min(std::max<int64_t>(ageNs, 0), m_Params.maxHorizonNs);
+        const float position = m_Position + m_Velocity * static_cast<float>(horizonNs) * 1e-9f;
+        return static_cast<int32_t>(std::max(-32767.0f, std::min(32767.0f, position)));
+    }
+
+    bool HasSample() const { return m_bHaveSample; }
+    int32_t GetMeasured() const { return m_Measured; }
+    float GetVelocity() const { return m_Velocity; }
+};
@@ -0,0 +1,446 @@
+//==============================================================================
+// AllocationCheck.cpp - Absence d'allocation sur les chemins chauds
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Remplace operator new/delete pour compter les allocations, puis pilote un
+// vrai ForceEffectSimulator (bibliothèque ffbsim, celle du simulateur) une
+// fois l'initialisation terminée, en rendu logiciel puis en rendu matériel.
+// Son API de pilotage pas à pas est appelée à la cadence du rendu (1 kHz),
+// sur le thread de la session :
+//  - entrée : UpdateDeviceState (trames ABS_X + SYN_REPORT à chaque tick) ;
+//  - force : ScheduleEvent, DispatchDueEvents et RenderTick, comme un tour
+//    de ForceLoop ;
+//  - lecture : NextEffect, PlayCurrentEffect (StopAllEffectsLocked,
+//    SetEffectPlaying, log ">>> EFFET JOUÉ"), puis StopAllEffects ;
+//  - écran : DisplayStatus (tous les 50 ticks, std::cout absorbé).
+// Le périphérique est un volant virtuel uinput quand /dev/uinput est
+// accessible (initialisation normale) ; sinon un substitut : /dev/null pour
+// les écritures EV_FF (EVIOCSFF y est refusé : chemin d'erreur de l'étage
+// de sortie) et un tube pour les trames d'entrée, passés à
+// AttachDescriptors. Seul le thread de la
+// session est compté. Un premier passage (non compté) amorce les caches
+// paresseux des flux. Le programme échoue si une allocation a lieu en
+// régime établi et indique le mode et le chemin fautifs.
+//
+// Usage : ffb_alloc_check [--seconds S]
+//==============================================================================
+
+#include <iostream>
+#include <string>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <atomic>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ForceEffectSimulator.h"
+#include "VirtualWheel.h"
+
+//==============================================================================
+// COMPTAGE DES ALLOCATIONS
+//==============================================================================
+
+namespace
+{
+
+enum HotPath
+{
+    PATH_INPUT,
+    PATH_FORCE,
+    PATH_PLAY,
+    PATH_SCREEN,
+    PATH_COUNT
+};
+
+const char* const PATH_NAMES[PATH_COUNT] = { "entrée", "force", "lecture", "écran" };
+
+// Par thread : ceux du logger et du volant virtuel ne sont pas comptés
+thread_local bool g_bCounting = false;
+std::atomic<int> g_Path(PATH_INPUT);
+std::atomic<uint64_t> g_Allocations[PATH_COUNT];
+
+void* CountedAlloc(std::size_t size)
+{
+    if (g_bCounting)
+        g_Allocations[g_Path.load(std::memory_order_relaxed)].fetch_add(1, std::memory_order_relaxed);
+
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* CountedAlignedAlloc(std::size_t size, std::align_val_t alignment)
+{
+    if (g_bCounting)
+        g_Allocations[g_Path.load(std::memory_order_relaxed)].fetch_add(1, std::memory_order_relaxed);
+
+    void* p = nullptr;
+    if (posix_memalign(&p, static_cast<std::size_t>(alignment), size ? size : 1) != 0)
+        throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return CountedAlignedAlloc(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return CountedAlignedAlloc(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return CountedAlloc(size); } catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return CountedAlloc(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+//==============================================================================
+// SESSION
+//==============================================================================
+
+namespace
+{
+
+const int PLAY_PERIOD_TICKS = 250;               // Touches N + Espace, puis S à mi-période
+const int SCREEN_PERIOD_TICKS = 50;              // UPDATE_INTERVAL de l'interface
+const int UPDATE_PERIOD_TICKS = 20;              // Événements programmés dans le séquenceur
+const int BURST_PERIOD_TICKS = 100;              // Démarrage, puis arrêt différé
+const int64_t BURST_LENGTH_NS = 50000000;
+const int32_t STANDIN_AXIS_MAX = 1023;           // ABS_X du substitut (10 bits)
+
+/**
+ * streambuf qui absorbe tout : l'écran d'état est rendu sans terminal.
+ */
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c == traits_type::eof() ? 0 : c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+} // namespace
+
+/**
+ * Branche un ForceEffectSimulator sur un périphérique et appelle ses
+ * chemins chauds tick par tick, à la place des threads de Run().
+ */
+class AllocationProbe
+{
+private:
+    ForceEffectSimulator& m_Sim;
+    VirtualWheel* m_Wheel;       // nullptr : substitut
+    int m_InputFd;               // Écriture du tube lu comme m_JoystickFd (substitut)
+    int m_Preset;                // Préréglage des événements programmés
+    int m_Tick;
+
+    /**
+     * Une trame ABS_X + SYN_REPORT, horodatée CLOCK_REALTIME comme par un
+     * nœud sans EVIOCSCLOCKID.
+     */
+    bool EmitSteering(int32_t value)
+    {
+        if (m_Wheel)
+            return m_Wheel->EmitSteering(value);
+
+        const int64_t nowNs = RealtimeNowNs();
+        struct input_event events[2];
+        memset(events, 0, sizeof(events));
+        for (struct input_event& ev : events)
+        {
+            ev.input_event_sec = nowNs / 1000000000LL;
+            ev.input_event_usec = (nowNs % 1000000000LL) / 1000;
+        }
+        events[0].type = EV_ABS;
+        events[0].code = ABS_X;
+        events[0].value = value;
+        events[1].type = EV_SYN;
+        events[1].code = SYN_REPORT;
+        return write(m_InputFd, events, sizeof(events)) == sizeof(events);
+    }
+
+    /**
+     * Programme une mise à jour de niveau, ou un démarrage suivi d'un arrêt
+     * différé, comme le protocole de contrôle ou un script.
+     */
+    void ScheduleEvents(int64_t nowNs)
+    {
+        const struct ff_effect* effect = m_Sim.FindPresetEffect(static_cast<int16_t>(m_Preset));
+        if (!effect)
+            return;
+
+        TimelineEvent event;
+        memset(&event, 0, sizeof(event));
+        event.dueNs = nowNs;
+        event.effectId = effect->id;
+
+        if (m_Tick % BURST_PERIOD_TICKS == 0)
+        {
+            event.action = TimelineAction::Start;
+            m_Sim.ScheduleEvent(event);
+            event.action = TimelineAction::Stop;
+            event.dueNs = nowNs + BURST_LENGTH_NS;
+            m_Sim.ScheduleEvent(event);
+            m_Preset = (m_Preset + 1) % static_cast<int>(BUILTIN_EFFECT_COUNT);
+            return;
+        }
+
+        event.action = TimelineAction::Update;
+        event.effect = *effect;
+        ForceEffectSimulator::ApplyEffectLevel(event.effect, m_Tick % 2000 * 16 - 16000);
+        m_Sim.ScheduleEvent(event);
+    }
+
+    void Tick()
+    {
+        // Entrée : slalom lent sur la demi-course centrale
+        g_Path = PATH_INPUT;
+        const int32_t minimum = m_Sim.GetCapabilities().axes[0].minimum;
+        const int32_t maximum = m_Sim.GetCapabilities().axes[0].maximum;
+        const int32_t ramp = m_Tick % 400 < 200 ? m_Tick % 200 : 200 - m_Tick % 200;
+        EmitSteering(minimum + (maximum - minimum) / 4 + (maximum - minimum) / 2 * ramp / 200);
+        m_Sim.UpdateDeviceState();
+
+        // Lecture : touches de l'interface
+        if (m_Tick % PLAY_PERIOD_TICKS == 0)
+        {
+            g_Path = PATH_PLAY;
+            m_Sim.NextEffect();
+            m_Sim.PlayCurrentEffect();
+        }
+        else if (m_Tick % PLAY_PERIOD_TICKS == PLAY_PERIOD_TICKS / 2)
+        {
+            g_Path = PATH_PLAY;
+            m_Sim.StopAllEffects();
+        }
+
+        // Force : un tour de ForceLoop (lot échu, puis tick du rendu logiciel)
+        g_Path = PATH_FORCE;
+        const int64_t nowNs = MonotonicNowNs();
+        if (m_Tick % UPDATE_PERIOD_TICKS == 0)
+            ScheduleEvents(nowNs);
+        m_Sim.DispatchDueEvents(nowNs);
+        if (m_Sim.IsSoftwareRender())
+            m_Sim.RenderTick(MonotonicNowNs());
+
+        // Écran d'état
+        if (m_Tick % SCREEN_PERIOD_TICKS == 0)
+        {
+            g_Path = PATH_SCREEN;
+            m_Sim.DisplayStatus();
+        }
+
+        m_Tick++;
+    }
+
+public:
+    explicit AllocationProbe(ForceEffectSimulator& simulator)
+        : m_Sim(simulator)
+        , m_Wheel(nullptr)
+        , m_InputFd(-1)
+        , m_Preset(0)
+        , m_Tick(0)
+    {
+    }
+
+    ~AllocationProbe()
+    {
+        if (m_InputFd >= 0)
+            close(m_InputFd);
+    }
+
+    AllocationProbe(const AllocationProbe&) = delete;
+    AllocationProbe& operator=(const AllocationProbe&) = delete;
+
+    /**
+     * Initialisation normale du simulateur sur le nœud du volant virtuel.
+     */
+    bool AttachVirtual(VirtualWheel& wheel, const std::string& node, bool bSoftware)
+    {
+        m_Wheel = &wheel;
+        m_Sim.SetDevicePath(node);
+        m_Sim.SetSoftwareRender(bSoftware);
+        return m_Sim.Initialize();
+    }
+
+    /**
+     * Substitut sans uinput : le simulateur reprend la lecture du tube et
+     * /dev/null (EVIOCSFF y échoue, d'où les ID locaux d'AttachDescriptors).
+     */
+    bool AttachStandIn(bool bSoftware)
+    {
+        int fds[2];
+        if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0)
+            return false;
+        m_InputFd = fds[1];
+
+        const int deviceFd = open("/dev/null", O_RDWR | O_CLOEXEC);
+        if (deviceFd < 0)
+        {
+            close(fds[0]);
+            return false;
+        }
+
+        AxisRange steering;
+        memset(&steering, 0, sizeof(steering));
+        steering.maximum = STANDIN_AXIS_MAX;
+        m_Sim.SetSoftwareRender(bSoftware);
+        return m_Sim.AttachDescriptors(deviceFd, fds[0], "/dev/null (substitut)", steering);
+    }
+
+    /**
+     * ticks tours de 1 ms, à l'échéance de chacun (RENDER_PERIOD_NS).
+     */
+    void Run(int ticks)
+    {
+        int64_t nextNs = MonotonicNowNs();
+        for (int i = 0; i < ticks; i++)
+        {
+            Tick();
+            nextNs += RENDER_PERIOD_NS;
+            SleepUntilNs(nextNs, 0);
+        }
+    }
+};
+
+namespace
+{
+
+/**
+ * Une session complète dans un mode de rendu : initialisation et amorçage
+ * (allocations permises), puis ticks comptés.
+ * @return false si le simulateur n'a pas pu être initialisé.
+ */
+bool RunSession(bool bSoftware, VirtualWheel* wheel, const std::string& node, int ticks)
+{
+    ForceEffectSimulator simulator;
+    AllocationProbe probe(simulator);
+    const bool bAttached = wheel ? probe.AttachVirtual(*wheel, node, bSoftware) : probe.AttachStandIn(bSoftware);
+    if (!bAttached)
+        return false;
+
+    probe.Run(PLAY_PERIOD_TICKS * 2);
+
+    for (int i = 0; i < PATH_COUNT; i++)
+        g_Allocations[i] = 0;
+    g_bCounting = true;
+    probe.Run(ticks);
+    g_bCounting = false;
+
+    simulator.Shutdown();
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int seconds = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc)
+            seconds = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--seconds S]" << std::endl;
+            return 2;
+        }
+    }
+
+    char path[] = "/tmp/ffb_alloc_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        std::cerr << "Impossible de créer le journal temporaire" << std::endl;
+        return 3;
+    }
+    close(fd);
+
+    g_Logger.SetConsoleOutput(false);
+    if (!g_Logger.Open(path))
+    {
+        std::cerr << "Impossible d'ouvrir " << path << std::endl;
+        unlink(path);
+        return 3;
+    }
+
+    // Volant virtuel si possible, substitut sinon
+    VirtualWheel wheel;
+    std::string node;
+    if (wheel.Create())
+        node = wheel.GetEventNode();
+    VirtualWheel* device = node.empty() ? nullptr : &wheel;
+    std::cout << "Périphérique: " << (device ? node : std::string("substitut (/dev/uinput inaccessible)")) << std::endl;
+
+    const int ticks = seconds * 1000;
+    const struct
+    {
+        const char* name;
+        bool bSoftware;
+    } modes[] = {
+        { "rendu logiciel", true },
+        { "rendu matériel", false },
+    };
+
+    // L'écran d'état écrit sur std::cout
+    NullBuffer nullBuffer;
+    std::streambuf* const console = std::cout.rdbuf();
+
+    uint64_t total = 0;
+    int exitCode = 0;
+    for (const auto& mode : modes)
+    {
+        std::cout.rdbuf(&nullBuffer);
+        const bool bRan = RunSession(mode.bSoftware, device, node, ticks);
+        std::cout.rdbuf(console);
+        if (!bRan)
+        {
+            std::cerr << "Initialisation du simulateur impossible (" << mode.name << "), voir " << path << std::endl;
+            exitCode = 3;
+            break;
+        }
+
+        std::cout << "Session " << mode.name << ": " << ticks << " ticks, " << ticks / PLAY_PERIOD_TICKS
+                  << " lectures, " << ticks / SCREEN_PERIOD_TICKS << " écrans" << std::endl;
+        for (int i = 0; i < PATH_COUNT; i++)
+        {
+            const uint64_t count = g_Allocations[i];
+            total += count;
+            std::cout << "  " << PATH_NAMES[i] << ": " << count << " allocations" << std::endl;
+        }
+    }
+
+    wheel.Destroy();
+    g_Logger.Close();
+    if (exitCode != 0)
+        return exitCode;
+    unlink(path);
+
+    if (total > 0)
+    {
+        std::cerr << "ÉCHEC: " << total << " allocations en régime établi" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+//==============================================================================
+// BenchHarness.h - Chronométrage et rapport des micro-benchmarks
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Chaque mesure exécute le corps du benchmark par lots de N opérations ; un
+// échantillon est la durée d'un lot (CLOCK_MONOTONIC) divisée par N, ce qui
+// rend le coût de l'horloge négligeable. Le rapport donne la médiane et le
+// p99 des échantillons, plus stables que la moyenne sur une machine chargée.
+//==============================================================================
+
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "Clock.h"
+
+namespace bench
+{
+
+/**
+ * Empêche le compilateur d'éliminer un calcul dont le résultat n'est pas
+ * utilisé.
+ */
+template<typename T>
+inline void KeepValue(const T& value)
+{
+    __asm__ __volatile__("" : : "r"(&value) : "memory");
+}
+
+struct Result
+{
+    std::string name;
+    size_t opsPerSample;
+    size_t samples;
+    double medianNs;             // Par opération
+    double p99Ns;                // Par opération
+    double minNs;                // Par opération
+};
+
+class Runner
+{
+private:
+    std::string m_Filter;
+    size_t m_Samples;
+    size_t m_Warmup;
+    std::vector<Result> m_Results;
+    std::vector<int64_t> m_Timings;
+
+public:
+    Runner() : m_Samples(200), m_Warmup(20) {}
+
+    void SetFilter(const std::string& filter) { m_Filter = filter; }
+
+    /**
+     * Mode rapide (test de fumée) : peu d'échantillons.
+     */
+    void SetQuick(bool bQuick)
+    {
+        m_Samples = bQuick ? 15 : 200;
+        m_Warmup = bQuick ? 2 : 20;
+    }
+
+    const std::vector<Result>& GetResults() const { return m_Results; }
+
+    /**
+     * Mesure body(), qui doit effectuer opsPerSample opérations par appel.
+     */
+    template<typename Body>
+    void Run(const std::string& name, size_t opsPerSample, Body&& body)
+    {
+        if (!m_Filter.empty() && name.find(m_Filter) == std::string::npos)
+            return;
+
+        for (size_t i = 0; i < m_Warmup; i++)
+            body();
+
+        m_Timings.clear();
+        m_Timings.reserve(m_Samples);
+        for (size_t i = 0; i < m_Samples; i++)
+        {
+            const int64_t start = MonotonicNowNs();
+            body();
+            m_Timings.push_back(MonotonicNowNs() - start);
+        }
+
+        std::sort(m_Timings.begin(), m_Timings.end());
+        const auto percentile = [&](double p) {
+            return static_cast<double>(m_Timings[static_cast<size_t>(p * static_cast<double>(m_Timings.size() - 1))])
+                 / static_cast<double>(opsPerSample);
+        };
+
+        Result result;
+        result.name = name;
+        result.opsPerSample = opsPerSample;
+        result.samples = m_Timings.size();
+        result.medianNs = percentile(0.5);
+        result.p99Ns = percentile(0.99);
+        result.minNs = percentile(0.0);
+        m_Results.push_back(result);
+    }
+
+    void PrintText(std::ostream& out) const
+    {
+        out << std::left << std::setw(28) << "benchmark"
+            << std::right << std::setw(12) << "médiane ns" << std::setw(12) << "p99 ns"
+            << std::setw(12) << "min ns" << std::setw(14) << "ops/s" << std::endl;
+        out << std::string(78, '-') << std::endl;
+
+        out << std::fixed << std::setprecision(1);
+        for (const Result& r : m_Results)
+        {
+            const double opsPerSec = r.medianNs > 0.0 ? 1e9 / r.medianNs : 0.0;
+            out << std::left << std::setw(28) << r.name
+                << std::right << std::setw(12) << r.medianNs << std::setw(12) << r.p99Ns
+                << std::setw(12) << r.minNs << std::setw(14) << std::setprecision(0) << opsPerSec
+                << std::setprecision(1) << std::endl;
+        }
+        out.unsetf(std::ios::fixed);
+    }
+
+    /**
+     * Rapport JSON (une entrée par benchmark), pour le suivi des régressions.
+     */
+    void PrintJson(std::ostream& out, const std::string& version) const
+    {
+        out << "{\n  \"version\": \"" << version << "\",\n  \"unit\": \"ns/op\",\n  \"benchmarks\": [";
+        out << std::fixed << std::setprecision(2);
+        for (size_t i = 0; i < m_Results.size(); i++)
+        {
+            const Result& r = m_Results[i];
+            out << (i ? ",\n" : "\n")
+                << "    {\"name\": \"" << r.name << "\""
+                << ", \"ops_per_sample\": " << r.opsPerSample
+                << ", \"samples\": " << r.samples
+                << ", \"median_ns\": " << r.medianNs
+                << ", \"p99_ns\": " << r.p99Ns
+                << ", \"min_ns\": " << r.minNs << "}";
+        }
+        out << "\n  ]\n}" << std::endl;
+        out.unsetf(std::ios::fixed);
+    }
+};
+
+} // namespace bench
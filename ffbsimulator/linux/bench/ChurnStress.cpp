@@ -0,0 +1,282 @@
+//==============================================================================
+// ChurnStress.cpp - Stress du chemin upload/mise à jour/lecture/effacement
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Plusieurs threads, chacun avec son propre descripteur sur le device,
+// enchaînent en boucle le cycle de vie complet d'un effet :
+//   EVIOCSFF (création) → N × EVIOCSFF (mise à jour) → write EV_FF (lecture)
+//   → write EV_FF (arrêt) → EVIOCRMFF
+// Chaque opération est chronométrée ; le rapport donne le débit, les
+// centiles de latence et les erreurs par type d'opération, pour dimensionner
+// la cadence de mise à jour du moteur de force.
+//
+// Par défaut, la cible est un volant virtuel uinput : ses uploads et
+// effacements passent par le thread de service de VirtualWheel, dont la
+// latence fait partie de la mesure. --device vise un nœud existant (le vrai
+// volant, par exemple).
+//
+// Usage : ffb_churn [--threads N] [--seconds S] [--updates N] [--device <chemin>]
+//==============================================================================
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+
+#include <linux/input.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "Clock.h"
+#include "LatencyHistogram.h"
+#include "EffectPresets.h"
+#include "VirtualWheel.h"
+
+namespace
+{
+
+enum ChurnOp
+{
+    OP_UPLOAD,
+    OP_UPDATE,
+    OP_PLAY,
+    OP_STOP,
+    OP_ERASE,
+    OP_COUNT
+};
+
+const char* const OP_NAMES[OP_COUNT] = { "upload", "update", "play", "stop", "erase" };
+
+const int EXIT_CHURN_OK = 0;
+const int EXIT_CHURN_ERRORS = 1;         // Au moins une opération refusée
+const int EXIT_CHURN_SETUP = 3;          // Device introuvable ou inaccessible
+
+struct WorkerStats
+{
+    LatencyHistogram latency[OP_COUNT];
+    uint64_t errors[OP_COUNT];
+    int lastErrno[OP_COUNT];
+    uint64_t cycles;
+
+    WorkerStats() : cycles(0)
+    {
+        memset(errors, 0, sizeof(errors));
+        memset(lastErrno, 0, sizeof(lastErrno));
+    }
+};
+
+/**
+ * Exécute une opération chronométrée et comptabilise son résultat.
+ */
+template<typename Op>
+bool Timed(WorkerStats& stats, ChurnOp op, Op&& body)
+{
+    const int64_t start = MonotonicNowNs();
+    const bool ok = body();
+    stats.latency[op].Record(MonotonicNowNs() - start);
+    if (!ok)
+    {
+        stats.errors[op]++;
+        stats.lastErrno[op] = errno;
+    }
+    return ok;
+}
+
+bool WritePlay(int fd, int16_t id, int value)
+{
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = EV_FF;
+    ev.code = static_cast<uint16_t>(id);
+    ev.value = value;
+    return write(fd, &ev, sizeof(ev)) == sizeof(ev);
+}
+
+void ChurnWorker(const std::string& devicePath, int updates, int index,
+                 const std::atomic<bool>& bRunning, WorkerStats& stats, std::atomic<int>& openFailures)
+{
+    const int fd = open(devicePath.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        openFailures++;
+        return;
+    }
+
+    // Chaque thread fait varier sa propre forme d'effet
+    ff_effect effect = PeriodicEffect(FF_SINE, 12000, 100 + 10 * index);
+
+    while (bRunning)
+    {
+        effect.id = -1;
+        if (!Timed(stats, OP_UPLOAD, [&]() { return ioctl(fd, EVIOCSFF, &effect) >= 0; }))
+            continue;
+
+        for (int i = 0; i < updates; i++)
+        {
+            effect.u.periodic.magnitude = static_cast<int16_t>(4000 + (i * 2000) % 24000);
+            Timed(stats, OP_UPDATE, [&]() { return ioctl(fd, EVIOCSFF, &effect) >= 0; });
+        }
+
+        Timed(stats, OP_PLAY, [&]() { return WritePlay(fd, effect.id, 1); });
+        Timed(stats, OP_STOP, [&]() { return WritePlay(fd, effect.id, 0); });
+        Timed(stats, OP_ERASE, [&]() { return ioctl(fd, EVIOCRMFF, effect.id) >= 0; });
+        stats.cycles++;
+    }
+
+    close(fd);
+}
+
+void PrintUsage(const char* program)
+{
+    std::cerr << "Usage: " << program
+              << " [--threads N] [--seconds S] [--updates N] [--device <chemin>]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int threads = 4;
+    int seconds = 5;
+    int updates = 4;
+    std::string devicePath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seconds" && i + 1 < argc)
+            seconds = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--updates" && i + 1 < argc)
+            updates = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--device" && i + 1 < argc)
+            devicePath = argv[++i];
+        else
+        {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    VirtualWheel wheel;
+    if (devicePath.empty())
+    {
+        if (!wheel.Create())
+        {
+            std::cerr << "Impossible de créer le volant virtuel (/dev/uinput): " << strerror(errno) << std::endl;
+            return EXIT_CHURN_SETUP;
+        }
+        devicePath = wheel.GetEventNode();
+        if (devicePath.empty())
+        {
+            std::cerr << "Nœud du volant virtuel introuvable" << std::endl;
+            return EXIT_CHURN_SETUP;
+        }
+    }
+
+    std::cout << "Cible: " << devicePath << (wheel.IsCreated() ? " (volant virtuel)" : "") << std::endl;
+    std::cout << "Threads: " << threads << ", durée: " << seconds << " s, mises à jour par cycle: "
+              << updates << std::endl;
+
+    // Histogrammes volumineux : alloués une fois, hors de la mesure
+    std::vector<std::unique_ptr<WorkerStats>> stats;
+    for (int i = 0; i < threads; i++)
+        stats.emplace_back(new WorkerStats());
+
+    std::atomic<bool> bRunning(true);
+    std::atomic<int> openFailures(0);
+    std::vector<std::thread> workers;
+
+    const int64_t start = MonotonicNowNs();
+    for (int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(ChurnWorker, devicePath, updates, i,
+                             std::cref(bRunning), std::ref(*stats[i]), std::ref(openFailures));
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    bRunning = false;
+    for (std::thread& worker : workers)
+        worker.join();
+    const double elapsed = static_cast<double>(MonotonicNowNs() - start) / 1e9;
+
+    if (openFailures == threads)
+    {
+        std::cerr << "Impossible d'ouvrir " << devicePath << " (permissions ?)" << std::endl;
+        return EXIT_CHURN_SETUP;
+    }
+
+    // Fusion des mesures par opération
+    std::unique_ptr<WorkerStats> total(new WorkerStats());
+    for (const auto& worker : stats)
+    {
+        for (int op = 0; op < OP_COUNT; op++)
+        {
+            total->latency[op].Merge(worker->latency[op]);
+            total->errors[op] += worker->errors[op];
+            if (worker->lastErrno[op])
+                total->lastErrno[op] = worker->lastErrno[op];
+        }
+        total->cycles += worker->cycles;
+    }
+
+    uint64_t totalOps = 0;
+    uint64_t totalErrors = 0;
+
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(8) << "op" << std::right
+              << std::setw(12) << "ops/s" << std::setw(10) << "p50 µs" << std::setw(10) << "p90 µs"
+              << std::setw(10) << "p99 µs" << std::setw(10) << "p99.9 µs" << std::setw(10) << "max µs"
+              << std::setw(10) << "erreurs" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (int op = 0; op < OP_COUNT; op++)
+    {
+        const LatencyHistogram& h = total->latency[op];
+        totalOps += h.GetCount();
+        totalErrors += total->errors[op];
+
+        std::cout << std::left << std::setw(8) << OP_NAMES[op] << std::right
+                  << std::setw(12) << std::setprecision(0) << static_cast<double>(h.GetCount()) / elapsed
+                  << std::setprecision(1)
+                  << std::setw(10) << h.Percentile(0.50) / 1000.0
+                  << std::setw(10) << h.Percentile(0.90) / 1000.0
+                  << std::setw(10) << h.Percentile(0.99) / 1000.0
+                  << std::setw(10) << h.Percentile(0.999) / 1000.0
+                  << std::setw(10) << h.GetMax() / 1000.0
+                  << std::setw(10) << total->errors[op];
+        if (total->lastErrno[op])
+            std::cout << "  (" << strerror(total->lastErrno[op]) << ")";
+        std::cout << std::endl;
+    }
+
+    std::cout << std::string(80, '-') << std::endl;
+    std::cout << std::setprecision(0);
+    std::cout << "Total: " << static_cast<double>(totalOps) / elapsed << " ops/s, "
+              << static_cast<double>(total->cycles) / elapsed << " cycles/s, "
+              << totalErrors << " erreurs" << std::endl;
+
+    if (openFailures > 0)
+        std::cout << "Threads sans accès au device: " << openFailures << std::endl;
+
+    if (wheel.IsCreated())
+    {
+        std::cout << "Volant virtuel: " << wheel.GetUploadCount() << " uploads, "
+                  << wheel.GetEraseCount() << " effacements, "
+                  << wheel.GetPlayEventCount() << " événements EV_FF reçus" << std::endl;
+    }
+
+    return totalErrors ? EXIT_CHURN_ERRORS : EXIT_CHURN_OK;
+}
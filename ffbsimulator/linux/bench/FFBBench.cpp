@@ -0,0 +1,489 @@
+//==============================================================================
+// FFBBench.cpp - Micro-benchmarks des chaînes d'entrée et de force
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Mesure, sans device, les étapes exécutées en boucle par le simulateur :
+//  - décodage des événements evdev (axes et boutons) ;
+//  - construction des structures ff_effect et des enveloppes ADSR ;
+//  - rendu des formes d'onde et des conditions (EvaluateEffect) ;
+//  - tick du mixeur logiciel, enveloppes et modèle de direction ;
+//  - séquenceur (programmation puis retrait d'événements) ;
+//  - anneau de commandes et seqlock d'état de la mémoire partagée ;
+//  - métriques (incrément, observation, export Prometheus) ;
+//  - logger (écriture fichier, texte et binaire) et rendu de l'écran d'état.
+//
+// Usage : ffb_bench [--json] [--quick] [--filter <texte>]
+//==============================================================================
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+
+#include <unistd.h>
+
+#include "BenchHarness.h"
+#include "InputState.h"
+#include "AxisFilter.h"
+#include "StatusScreen.h"
+#include "Logger.h"
+#include "EffectRender.h"
+#include "EffectPresets.h"
+#include "EnvelopeEngine.h"
+#include "SoftwareRenderer.h"
+#include "SteeringModel.h"
+#include "OutputStage.h"
+#include "EffectTimeline.h"
+#include "SharedForceInterface.h"
+#include "Metrics.h"
+
+#ifndef FFB_VERSION
+#define FFB_VERSION "1.0.0"
+#endif
+
+namespace
+{
+
+const size_t INPUT_EVENT_COUNT = 4096;
+const size_t MIXER_LAYER_COUNT = 8;
+const size_t TIMELINE_BATCH = 256;
+
+/**
+ * Flux d'événements représentatif d'une lecture du volant : axes à chaque
+ * rapport, bouton de temps en temps, SYN_REPORT en fin de rapport.
+ */
+std::vector<input_event> MakeInputStream()
+{
+    std::vector<input_event> events;
+    events.reserve(INPUT_EVENT_COUNT);
+
+    uint32_t seed = 12345;
+    while (events.size() + 5 <= INPUT_EVENT_COUNT)
+    {
+        seed = seed * 1103515245u + 12345u;
+        input_event ev = {};
+        ev.type = EV_ABS;
+        ev.code = ABS_X;
+        ev.value = static_cast<int32_t>(seed >> 22);
+        events.push_back(ev);
+        ev.code = ABS_Y;
+        ev.value = static_cast<int32_t>((seed >> 14) & 0xFF);
+        events.push_back(ev);
+        ev.code = ABS_Z;
+        ev.value = static_cast<int32_t>((seed >> 6) & 0xFF);
+        events.push_back(ev);
+        if ((seed & 7) == 0)
+        {
+            ev.type = EV_KEY;
+            ev.code = static_cast<uint16_t>(BTN_JOYSTICK + ((seed >> 3) & 7));
+            ev.value = static_cast<int32_t>((seed >> 9) & 1);
+            events.push_back(ev);
+        }
+        ev.type = EV_SYN;
+        ev.code = SYN_REPORT;
+        ev.value = 0;
+        events.push_back(ev);
+    }
+    return events;
+}
+
+void RunInputBenchmarks(bench::Runner& runner)
+{
+    const std::vector<input_event> events = MakeInputStream();
+    InputSnapshot snapshot;
+
+    runner.Run("input_decode", events.size(), [&]() {
+        for (const input_event& ev : events)
+            ApplyInputEvent(snapshot, ev);
+        bench::KeepValue(snapshot);
+    });
+
+    runner.Run("input_normalize", events.size(), [&]() {
+        int32_t sum = 0;
+        for (const input_event& ev : events)
+            sum += NormalizeAxis(ev.value, 0, 1023);
+        bench::KeepValue(sum);
+    });
+
+    // Une mise à jour par trame, horodatages espacés d'1 ms
+    AxisFilter filter;
+    int64_t frameNs = 0;
+    const size_t frames = 1000;
+    runner.Run("axis_filter_update", frames, [&]() {
+        for (size_t i = 0; i < frames; i++)
+        {
+            frameNs += 1000000;
+            filter.Update(frameNs, static_cast<int32_t>((frameNs / 1000000) % 2000) * 16 - 16000);
+        }
+        bench::KeepValue(filter.GetVelocity() + filter.GetAcceleration());
+    });
+}
+
+void RunEffectBenchmarks(bench::Runner& runner)
+{
+    // Paramètres lus via volatile : la construction se fait à l'exécution
+    volatile int32_t level = 24000;
+    volatile int32_t period = 200;
+    const size_t ops = 256;
+
+    runner.Run("effect_construct", ops, [&]() {
+        for (size_t i = 0; i < ops; i += 4)
+        {
+            ff_effect effects[4] = {
+                ConstantEffect(level),
+                PeriodicEffect(FF_SINE, level, period),
+                RampEffect(level / 4, level, 3000),
+                ConditionEffect(FF_SPRING, level, 32767),
+            };
+            bench::KeepValue(effects);
+        }
+    });
+
+    runner.Run("envelope_from_effect", BUILTIN_EFFECT_COUNT, [&]() {
+        for (size_t i = 0; i < BUILTIN_EFFECT_COUNT; i++)
+        {
+            EnvelopeADSR adsr = EnvelopeFromEffect(BUILTIN_EFFECTS[i].effect);
+            bench::KeepValue(adsr);
+        }
+    });
+}
+
+void RunRenderBenchmarks(bench::Runner& runner)
+{
+    const ff_effect waveforms[] = {
+        PeriodicEffect(FF_SINE, 20000, 200),
+        PeriodicEffect(FF_SQUARE, 22000, 150),
+        PeriodicEffect(FF_TRIANGLE, 18000, 300),
+        PeriodicEffect(FF_SAW_UP, 20000, 180),
+    };
+    const char* names[] = { "render_sine", "render_square", "render_triangle", "render_saw" };
+    const uint32_t ops = 1000;
+
+    AxisState axis;
+    axis.position = 8000;
+    axis.velocity = 2000;
+
+    for (size_t w = 0; w < sizeof(waveforms) / sizeof(waveforms[0]); w++)
+    {
+        runner.Run(names[w], ops, [&]() {
+            int32_t sum = 0;
+            for (uint32_t t = 0; t < ops; t++)
+                sum += EvaluateEffect(waveforms[w], t, axis);
+            bench::KeepValue(sum);
+        });
+    }
+
+    const ff_effect spring = ConditionEffect(FF_SPRING, 24000, 32767);
+    runner.Run("render_condition", ops, [&]() {
+        int32_t sum = 0;
+        AxisState moving;
+        for (uint32_t t = 0; t < ops; t++)
+        {
+            moving.position = static_cast<int32_t>(t * 64) - 32000;
+            sum += EvaluateEffect(spring, t, moving);
+        }
+        bench::KeepValue(sum);
+    });
+}
+
+void RunMixerBenchmarks(bench::Runner& runner)
+{
+    // Couches de durée infinie pour que le mixeur reste plein
+    const ff_effect layers[MIXER_LAYER_COUNT] = {
+        WithEnvelope(ConstantEffect(8000), 300, 4000, 0, 0),
+        PeriodicEffect(FF_SINE, 6000, 200),
+        PeriodicEffect(FF_SQUARE, 4000, 150),
+        PeriodicEffect(FF_TRIANGLE, 5000, 300),
+        ConditionEffect(FF_SPRING, 12000, 32767),
+        ConditionEffect(FF_DAMPER, 10000, 32767),
+        ConditionEffect(FF_INERTIA, 8000, 32767),
+        ConditionEffect(FF_FRICTION, 6000, 32767),
+    };
+
+    SoftwareRenderer renderer;
+    int64_t nowNs = 0;
+    for (size_t i = 0; i < MIXER_LAYER_COUNT; i++)
+    {
+        ff_effect effect = layers[i];
+        effect.id = static_cast<int16_t>(i);
+        renderer.Start(effect, EnvelopeFromEffect(effect), nowNs);
+    }
+
+    AxisState axis;
+    const size_t ticks = 1000;
+    runner.Run("mixer_tick_8_layers", ticks, [&]() {
+        int32_t sum = 0;
+        for (size_t i = 0; i < ticks; i++)
+        {
+            nowNs += 1000000;
+            axis.position = static_cast<int32_t>((nowNs / 1000000) % 2000) * 16 - 16000;
+            sum += renderer.Render(nowNs, axis);
+        }
+        bench::KeepValue(sum);
+    });
+
+    if (renderer.GetActiveCount() != MIXER_LAYER_COUNT)
+        std::cerr << "ATTENTION: couches retirées pendant le benchmark du mixeur" << std::endl;
+
+    EnvelopeBank bank;
+    EnvelopeADSR adsr;
+    adsr.attackMs = 200;
+    adsr.decayMs = 300;
+    adsr.sustainLevel = 20000;
+    adsr.attackCurve = BuiltinCurve(EnvelopeCurve::SCurve);
+    for (size_t i = 0; i < ENVELOPE_MAX_LAYERS; i++)
+        bank.Add(adsr);
+
+    int32_t elapsed[ENVELOPE_MAX_LAYERS];
+    int32_t gains[ENVELOPE_MAX_LAYERS];
+    int32_t tick = 0;
+    runner.Run("envelope_bank_16_layers", ticks, [&]() {
+        for (size_t i = 0; i < ticks; i++)
+        {
+            tick = (tick + 1) % 1000;
+            for (size_t l = 0; l < ENVELOPE_MAX_LAYERS; l++)
+                elapsed[l] = tick + static_cast<int32_t>(l) * 40;
+            bank.EvaluateAll(elapsed, gains);
+            bench::KeepValue(gains);
+        }
+    });
+
+    SteeringModel model;
+    model.SetSpeed(20.0f);
+    int32_t position = 0;
+    runner.Run("steering_tick", ticks, [&]() {
+        int32_t sum = 0;
+        for (size_t i = 0; i < ticks; i++)
+        {
+            position = (position + 37) % 20000;
+            sum += model.Step(position - 10000);
+        }
+        bench::KeepValue(sum);
+    });
+
+    // Étage de sortie sur une sinusoïde bruitée (seuil, cadence et pente actifs)
+    OutputStageParams outputParams;
+    outputParams.maxSlewPerMs = 2000;
+    OutputStage stage;
+    stage.SetParams(outputParams);
+    int64_t outputNs = 0;
+    runner.Run("output_stage_step", ticks, [&]() {
+        int16_t level = 0;
+        for (size_t i = 0; i < ticks; i++)
+        {
+            outputNs += 1000000;
+            const int32_t target = fixp::Sin(static_cast<uint16_t>(outputNs / 4000)) / 2
+                + static_cast<int32_t>(i % 7) * 20;
+            const OutputDecision decision = stage.Step(target, outputNs, level);
+            if (decision == OutputDecision::Send || decision == OutputDecision::Flush)
+                stage.Commit(level, outputNs);
+        }
+        bench::KeepValue(level);
+    });
+}
+
+void RunTimelineBenchmarks(bench::Runner& runner)
+{
+    EffectTimeline timeline(TIMELINE_BATCH);
+    std::vector<TimelineEvent> batch;
+    batch.reserve(TIMELINE_BATCH);
+
+    TimelineEvent event = {};
+    event.action = TimelineAction::Start;
+
+    uint32_t seed = 7;
+    runner.Run("timeline_schedule_pop", TIMELINE_BATCH, [&]() {
+        for (size_t i = 0; i < TIMELINE_BATCH; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            event.dueNs = static_cast<int64_t>(seed >> 8);
+            event.effectId = static_cast<int16_t>(i & 15);
+            timeline.Schedule(event);
+        }
+        batch.clear();
+        timeline.PopDue(INT64_MAX, batch);
+        bench::KeepValue(batch.front());
+    });
+}
+
+void RunSharedBenchmarks(bench::Runner& runner)
+{
+    // Région en mémoire privée : même code que via shm_open, sans le device
+    std::unique_ptr<SharedForceRegion> region(new SharedForceRegion());
+    sharedforce::Initialize(*region);
+
+    SharedCommand command = {};
+    command.type = static_cast<uint16_t>(SharedCommandType::SetForce);
+    const size_t ops = 512;
+
+    runner.Run("shm_ring_push_pop", ops, [&]() {
+        for (size_t i = 0; i < ops; i++)
+        {
+            command.value = static_cast<int32_t>(i);
+            sharedforce::Push(*region, command);
+        }
+        SharedCommand received;
+        int32_t sum = 0;
+        while (sharedforce::Pop(*region, received))
+            sum += received.value;
+        bench::KeepValue(sum);
+    });
+
+    SharedState state = {};
+    runner.Run("shm_state_publish_read", ops, [&]() {
+        SharedState copy;
+        for (size_t i = 0; i < ops; i++)
+        {
+            state.timestampNs = static_cast<int64_t>(i);
+            sharedforce::PublishState(*region, state);
+            sharedforce::ReadState(*region, copy);
+        }
+        bench::KeepValue(copy);
+    });
+}
+
+void RunMetricsBenchmarks(bench::Runner& runner)
+{
+    MetricsRegistry registry;
+    MetricCounter& counter = registry.Counter("bench_events_total", "Compteur");
+    MetricHistogram& histogram = registry.Histogram("bench_lateness_seconds", "Histogramme");
+    for (int i = 0; i < 32; i++)
+        registry.Counter("bench_effect_total", "Par effet", "effect=\"" + std::to_string(i) + "\"");
+    const size_t ops = 1000;
+
+    runner.Run("metrics_counter_add", ops, [&]() {
+        for (size_t i = 0; i < ops; i++)
+            counter.Add();
+    });
+
+    runner.Run("metrics_histogram_observe", ops, [&]() {
+        for (size_t i = 0; i < ops; i++)
+            histogram.Observe(static_cast<int64_t>(i) * 997);
+    });
+
+    runner.Run("metrics_export", 1, [&]() {
+        std::ostringstream out;
+        registry.Export(out);
+        bench::KeepValue(out.tellp());
+    });
+}
+
+void RunOutputBenchmarks(bench::Runner& runner)
+{
+    // Logger texte puis binaire : fichier temporaire, sans écho console
+    const struct { const char* name; LogFormat format; } loggers[] = {
+        { "logger_line", LogFormat::Text },
+        { "logger_line_binary", LogFormat::Binary },
+    };
+    for (const auto& entry : loggers)
+    {
+        char path[] = "/tmp/ffb_bench_XXXXXX";
+        const int fd = mkstemp(path);
+        if (fd < 0)
+            continue;
+        close(fd);
+
+        Logger logger;
+        logger.SetConsoleOutput(false);
+        logger.SetFormat(entry.format);
+        if (logger.Open(path))
+        {
+            const size_t lines = 64;
+            int counter = 0;
+            runner.Run(entry.name, lines, [&]() {
+                for (size_t i = 0; i < lines; i++)
+                    logger.Info("Effet joué: ", "Sinus", " (ID: ", counter++, ")");
+            });
+            logger.Close();
+        }
+        unlink(path);
+    }
+
+    // Écran d'état rendu dans un tampon (pas de terminal)
+    std::vector<std::string> names;
+    for (size_t i = 0; i < BUILTIN_EFFECT_COUNT; i++)
+        names.push_back(BUILTIN_EFFECTS[i].name);
+    const char* devicePath = "/dev/input/event5";
+
+    StatusScreen screen;
+    screen.platform = "Linux";
+    screen.bDeviceOpen = true;
+    screen.devicePath = devicePath;
+    screen.input.steering = 512;
+    screen.input.pedal1 = 128;
+    screen.input.pedal2 = 0;
+    screen.input.buttons = 0x05;
+    screen.effectNames = &names;
+    screen.currentEffect = 4;
+    screen.bEffectPlaying = true;
+    screen.bShowForce = true;
+    screen.force = 12000;
+    screen.intensity = 20000;
+    screen.direction = 0x4000;
+    screen.duration = 0;
+    screen.bSteeringPhysics = true;
+    screen.speedKmh = 72;
+
+    std::ostringstream out;
+    runner.Run("status_screen_render", 1, [&]() {
+        out.str(std::string());
+        RenderStatusScreen(out, screen);
+        bench::KeepValue(out);
+    });
+}
+
+void PrintUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--json] [--quick] [--filter <texte>]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bool bJson = false;
+    bench::Runner runner;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--json")
+            bJson = true;
+        else if (arg == "--quick")
+            runner.SetQuick(true);
+        else if (arg == "--filter" && i + 1 < argc)
+            runner.SetFilter(argv[++i]);
+        else
+        {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    RunInputBenchmarks(runner);
+    RunEffectBenchmarks(runner);
+    RunRenderBenchmarks(runner);
+    RunMixerBenchmarks(runner);
+    RunTimelineBenchmarks(runner);
+    RunSharedBenchmarks(runner);
+    RunMetricsBenchmarks(runner);
+    RunOutputBenchmarks(runner);
+
+    if (runner.GetResults().empty())
+    {
+        std::cerr << "Aucun benchmark ne correspond au filtre" << std::endl;
+        return 1;
+    }
+
+    if (bJson)
+        runner.PrintJson(std::cout, FFB_VERSION);
+    else
+        runner.PrintText(std::cout);
+    return 0;
+}
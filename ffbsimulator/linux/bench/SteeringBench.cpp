@@ -0,0 +1,279 @@
+//==============================================================================
+// SteeringBench.cpp - Mesure du coût d'un tick du modèle de direction
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Le modèle est avancé tick par tick avec un volant synthétique (slalom puis
+// braquage jusqu'en butée, à plusieurs vitesses). Chaque tick est chronométré
+// individuellement ; le programme échoue si le p99 dépasse le budget d'un
+// tick à 1 kHz (1 ms), avec une marge pour le reste du rendu.
+//
+// Il simule ensuite en boucle fermée un volant lâché sur un ressort de gain
+// maximal, avec les latences du simulateur (événements lus toutes les
+// 16 ms, sortie 2 ms après le tick), sans puis avec la prédiction de
+// position (SteeringPredictor.h). Il échoue si la prédiction ne divise pas
+// au moins par deux l'oscillation résiduelle (valeur efficace de la
+// position sur les 2 dernières secondes). --trace écrit les deux courbes en
+// CSV (une ligne par ms).
+//
+// Usage : steering_bench [--ticks N] [--budget-us N] [--trace fichier.csv]
+//==============================================================================
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+
+#include "Clock.h"
+#include "SteeringModel.h"
+#include "SteeringPredictor.h"
+#include "EffectRender.h"
+
+namespace
+{
+
+/**
+ * Position du volant synthétique en Q15 : slalom de 0,5 Hz puis braquage
+ * progressif jusqu'en butée et retour, quantifiée sur 10 bits comme l'ABS_X.
+ */
+int32_t SyntheticPosition(int tick)
+{
+    const float t = static_cast<float>(tick) * STEERING_TICK_SECONDS;
+    const float phase = std::fmod(t, 6.0f);
+    float position = 0.4f * std::sin(2.0f * 3.14159265f * 0.5f * phase);
+    if (phase >= 5.0f)
+        position = (6.0f - phase) * 1.05f;
+    else if (phase >= 4.0f)
+        position = (phase - 4.0f) * 1.05f;
+    position = std::max(-1.0f, std::min(1.0f, position));
+
+    const int raw = static_cast<int>((position + 1.0f) * 511.5f);
+    return static_cast<int32_t>((raw * 2 - 1023) * 32767 / 1023);
+}
+
+//==============================================================================
+// BOUCLE FERMÉE : RESSORT RETARDÉ
+//==============================================================================
+
+const int64_t LOOP_SUBSTEP_NS = 100000;          // Intégration du volant (0,1 ms)
+const int64_t LOOP_TICK_NS = 1000000;            // Échantillonnage ABS_X et rendu (1 kHz)
+const int64_t LOOP_POLL_NS = 16000000;           // Lecture des événements (UPDATE_INTERVAL)
+const int64_t LOOP_OUTPUT_NS = 2000000;          // Tick -> moteur
+const int64_t LOOP_DURATION_NS = 4000000000LL;
+const int64_t LOOP_SETTLED_NS = 2000000000LL;    // Début de la mesure résiduelle
+const double LOOP_MOTOR_GAIN = 600.0;            // Accélération à pleine force (1/s²)
+const double LOOP_DAMPING = 2.0;                 // Frottement visqueux du volant (1/s)
+
+struct LoopResult
+{
+    double rms;                  // Position efficace résiduelle (fraction du débattement)
+    double peak;
+    std::vector<float> trace;    // Position à chaque ms
+};
+
+/**
+ * Volant lâché à mi-course sur un ressort de gain maximal. Le device
+ * horodate chaque changement d'ABS_X (10 bits) ; le simulateur ne lit les
+ * événements qu'à chaque LOOP_POLL_NS et sa force n'agit qu'après
+ * LOOP_OUTPUT_NS. Tout est en temps simulé : le résultat est déterministe.
+ */
+LoopResult RunSpringLoop(bool bPredict)
+{
+    ff_condition_effect spring;
+    memset(&spring, 0, sizeof(spring));
+    spring.right_coeff = 32767;
+    spring.left_coeff = 32767;
+    spring.right_saturation = 32767;
+    spring.left_saturation = 32767;
+
+    SteeringPredictor predictor;
+    std::deque<std::pair<int64_t, int32_t>> events;      // Horodatage, position Q15
+    std::deque<std::pair<int64_t, int32_t>> commands;    // Échéance moteur, force
+    int lastRaw = -1;
+    int32_t measured = 0;
+    int32_t motor = 0;
+
+    double angle = 0.5;
+    double velocity = 0.0;
+    double sumSquares = 0.0;
+    int64_t samples = 0;
+
+    LoopResult result;
+    result.peak = 0.0;
+
+    for (int64_t t = 0; t < LOOP_DURATION_NS; t += LOOP_SUBSTEP_NS)
+    {
+        if (t % LOOP_TICK_NS == 0)
+        {
+            const int raw = static_cast<int>(std::lround((angle + 1.0) * 511.5));
+            if (raw != lastRaw)
+            {
+                lastRaw = raw;
+                events.emplace_back(t, static_cast<int32_t>((raw * 2 - 1023) * 32767 / 1023));
+            }
+            result.trace.push_back(static_cast<float>(angle));
+        }
+
+        if (t % LOOP_POLL_NS == 0)
+        {
+            for (const auto& event : events)
+            {
+                measured = event.second;
+                predictor.Update(event.first, event.second);
+            }
+            events.clear();
+        }
+
+        if (t % LOOP_TICK_NS == 0)
+        {
+            AxisState axis;
+            axis.position = bPredict && predictor.HasSample()
+                ? predictor.Predict(t + LOOP_OUTPUT_NS) : measured;
+            commands.emplace_back(t + LOOP_OUTPUT_NS, EvaluateCondition(FF_SPRING, spring, axis));
+        }
+
+        while (!commands.empty() && commands.front().first <= t)
+        {
+            motor = commands.front().second;
+            commands.pop_front();
+        }
+
+        const double dt = static_cast<double>(LOOP_SUBSTEP_NS) * 1e-9;
+        velocity += (LOOP_MOTOR_GAIN * motor / 32767.0 - LOOP_DAMPING * velocity) * dt;
+        angle += velocity * dt;
+        if (std::fabs(angle) > 1.0)
+        {
+            angle = angle > 0.0 ? 1.0 : -1.0;
+            velocity = 0.0;
+        }
+
+        if (t >= LOOP_SETTLED_NS)
+        {
+            sumSquares += angle * angle;
+            samples++;
+            result.peak = std::max(result.peak, std::fabs(angle));
+        }
+    }
+
+    result.rms = std::sqrt(sumSquares / static_cast<double>(samples));
+    return result;
+}
+
+bool WriteTrace(const std::string& path, const LoopResult& raw, const LoopResult& predicted)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+
+    file << "t_ms,position_sans_prediction,position_avec_prediction\n";
+    for (size_t i = 0; i < raw.trace.size() && i < predicted.trace.size(); i++)
+        file << i << "," << raw.trace[i] << "," << predicted.trace[i] << "\n";
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int ticks = 200000;
+    int64_t budgetUs = 1000;
+    std::string tracePath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--ticks" && i + 1 < argc)
+            ticks = std::max(1000, std::atoi(argv[++i]));
+        else if (arg == "--budget-us" && i + 1 < argc)
+            budgetUs = std::atoll(argv[++i]);
+        else if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--ticks N] [--budget-us N] [--trace fichier.csv]" << std::endl;
+            return 2;
+        }
+    }
+
+    const float speeds[] = { 0.0f, 5.0f, 20.0f, 40.0f };
+    std::vector<int64_t> samples;
+    samples.reserve(static_cast<size_t>(ticks) * 4);
+
+    int64_t checksum = 0;
+    SteeringModel model;
+    std::cout << "Modèle de direction: " << model.GetSubsteps() << " sous-pas par tick" << std::endl;
+
+    for (float speed : speeds)
+    {
+        model.Reset();
+        model.SetSpeed(speed);
+
+        float peakTorque = 0.0f;
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            const int32_t position = SyntheticPosition(tick);
+            const int64_t start = MonotonicNowNs();
+            checksum += model.Step(position);
+            samples.push_back(MonotonicNowNs() - start);
+            peakTorque = std::max(peakTorque, std::fabs(model.GetTorque()));
+        }
+
+        if (!std::isfinite(model.GetTorque()) || !std::isfinite(model.GetRackAngle()))
+        {
+            std::cerr << "ÉCHEC: modèle instable à " << speed << " m/s" << std::endl;
+            return 1;
+        }
+        std::cout << "  " << speed << " m/s: couple max " << peakTorque << " N·m" << std::endl;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&](double p) {
+        return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))];
+    };
+
+    int64_t total = 0;
+    for (int64_t sample : samples)
+        total += sample;
+
+    const int64_t p99 = percentile(0.99);
+    std::cout << "Ticks mesurés: " << samples.size() << " (somme de contrôle " << checksum << ")" << std::endl;
+    std::cout << "  médiane " << percentile(0.5) << " ns, p99 " << p99 << " ns, max "
+              << samples.back() << " ns, moyenne " << total / static_cast<int64_t>(samples.size())
+              << " ns/tick" << std::endl;
+    std::cout << "  p99 = " << (100.0 * static_cast<double>(p99) / (budgetUs * 1000.0))
+              << " % du budget de " << budgetUs << " µs" << std::endl;
+
+    // Le modèle ne doit occuper qu'une petite part du tick (10 %)
+    if (p99 * 10 > budgetUs * 1000)
+    {
+        std::cerr << "ÉCHEC: p99 au-delà de 10 % du budget" << std::endl;
+        return 1;
+    }
+
+    const LoopResult raw = RunSpringLoop(false);
+    const LoopResult predicted = RunSpringLoop(true);
+    std::cout << "Ressort retardé (lecture " << LOOP_POLL_NS / 1000000 << " ms, sortie "
+              << LOOP_OUTPUT_NS / 1000000 << " ms), oscillation résiduelle :" << std::endl;
+    std::cout << "  sans prédiction: efficace " << raw.rms << ", crête " << raw.peak << std::endl;
+    std::cout << "  avec prédiction: efficace " << predicted.rms << ", crête " << predicted.peak << std::endl;
+
+    if (!tracePath.empty() && !WriteTrace(tracePath, raw, predicted))
+    {
+        std::cerr << "Impossible d'écrire " << tracePath << std::endl;
+        return 1;
+    }
+
+    if (predicted.rms * 2.0 > raw.rms)
+    {
+        std::cerr << "ÉCHEC: la prédiction ne réduit pas l'oscillation" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,295 @@
+//==============================================================================
+// UinputLatency.cpp - Latence appel système -> volant virtuel uinput
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Mesure le délai entre l'appel système qui porte une commande de force et
+// sa réception par le volant. Le simulateur n'est pas dans la boucle : les
+// commandes sont émises directement sur le nœud evdev, dans l'ordre où le
+// simulateur les émet, sans décision, rendu ni étage de sortie (leur coût
+// est mesuré par ffb_bench). Un volant virtuel uinput est créé avec le
+// journal de requêtes activé (VirtualWheel::SetRecording), puis :
+//   EVIOCSFF (création) → N × EVIOCSFF (mise à jour) → write EV_FF (lecture)
+//   → write EV_FF (arrêt) → EVIOCRMFF
+// Chaque commande est horodatée juste avant l'appel système et appariée à
+// la requête UI_FF_UPLOAD/UI_FF_ERASE/EV_FF reçue par le volant (même type,
+// même effet). Deux latences sont relevées par type de commande :
+//  - noyau : jusqu'à la mise en file de la requête par uinput ;
+//  - volant : jusqu'à sa lecture par le thread de service du volant.
+// Les deux horloges sont CLOCK_MONOTONIC ; l'horodatage uinput n'a qu'une
+// résolution de 1 µs.
+//
+// Le rapport donne les centiles et un histogramme par octave de la latence
+// volant. Le programme échoue si une requête n'arrive pas ou ne correspond
+// pas à la commande envoyée, et se termine avec le code 77 (test ignoré)
+// quand /dev/uinput n'est pas accessible.
+//
+// Usage : ffb_uinput_latency [--cycles N] [--updates N] [--histogram]
+//==============================================================================
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cerrno>
+
+#include <linux/input.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "Clock.h"
+#include "LatencyHistogram.h"
+#include "EffectPresets.h"
+#include "VirtualWheel.h"
+
+namespace
+{
+
+enum ProbeCommand
+{
+    CMD_UPLOAD,
+    CMD_UPDATE,
+    CMD_PLAY,
+    CMD_STOP,
+    CMD_ERASE,
+    CMD_COUNT
+};
+
+const char* const CMD_NAMES[CMD_COUNT] = { "upload", "update", "play", "stop", "erase" };
+
+const VirtualRequestType CMD_REQUESTS[CMD_COUNT] = {
+    VirtualRequestType::Upload, VirtualRequestType::Update, VirtualRequestType::Play,
+    VirtualRequestType::Stop, VirtualRequestType::Erase
+};
+
+const int EXIT_PROBE_OK = 0;
+const int EXIT_PROBE_ERRORS = 1;      // Commande refusée, perdue ou mal appariée
+const int EXIT_PROBE_SETUP = 3;       // Volant virtuel créé mais inutilisable
+const int EXIT_PROBE_SKIPPED = 77;    // /dev/uinput inaccessible (code « ignoré » de CTest)
+
+const int PROBE_WAIT_MS = 1000;       // Attente max d'une requête côté volant
+const int HISTOGRAM_OCTAVES = 16;        // 1 µs .. 32 ms
+const int HISTOGRAM_WIDTH = 40;
+
+struct CommandStats
+{
+    LatencyHistogram kernel;
+    LatencyHistogram device;
+    uint64_t octaves[HISTOGRAM_OCTAVES];     // Latence volant par puissance de 2 (µs)
+    uint64_t errors;
+    int lastErrno;
+
+    CommandStats() : errors(0), lastErrno(0)
+    {
+        memset(octaves, 0, sizeof(octaves));
+    }
+
+    void Record(int64_t kernelNs, int64_t deviceNs)
+    {
+        kernel.Record(std::max<int64_t>(kernelNs, 0));
+        device.Record(deviceNs);
+
+        int octave = 0;
+        for (int64_t us = deviceNs / 1000; us > 1 && octave < HISTOGRAM_OCTAVES - 1; us >>= 1)
+            octave++;
+        octaves[octave]++;
+    }
+};
+
+class LatencyProbe
+{
+private:
+    VirtualWheel& m_Wheel;
+    int m_Fd;
+    CommandStats m_Stats[CMD_COUNT];
+    uint64_t m_Lost;
+    uint64_t m_Mismatched;
+
+public:
+    LatencyProbe(VirtualWheel& wheel, int fd)
+        : m_Wheel(wheel), m_Fd(fd), m_Lost(0), m_Mismatched(0)
+    {
+    }
+
+    /**
+     * Envoie une commande et attend la requête correspondante côté volant.
+     * Pour EVIOCSFF, l'identifiant n'est connu qu'au retour de l'ioctl :
+     * l'appariement se fait après l'appel.
+     */
+    template<typename Send>
+    bool Run(ProbeCommand cmd, const int16_t& effectId, Send&& send)
+    {
+        CommandStats& stats = m_Stats[cmd];
+        const int64_t sentNs = MonotonicNowNs();
+        if (!send())
+        {
+            stats.errors++;
+            stats.lastErrno = errno;
+            return false;
+        }
+
+        VirtualRequest request;
+        if (!m_Wheel.WaitRequest(request, PROBE_WAIT_MS))
+        {
+            m_Lost++;
+            return false;
+        }
+        if (request.type != CMD_REQUESTS[cmd] || request.effectId != effectId)
+        {
+            m_Mismatched++;
+            return false;
+        }
+
+        stats.Record(request.kernelNs - sentNs, request.receivedNs - sentNs);
+        return true;
+    }
+
+    void Cycle(ff_effect& effect, int updates)
+    {
+        effect.id = -1;
+        if (!Run(CMD_UPLOAD, effect.id, [&]() { return ioctl(m_Fd, EVIOCSFF, &effect) >= 0; }))
+            return;
+
+        for (int i = 0; i < updates; i++)
+        {
+            effect.u.constant.level = static_cast<int16_t>((i & 1) ? -8000 - i * 500 : 8000 + i * 500);
+            Run(CMD_UPDATE, effect.id, [&]() { return ioctl(m_Fd, EVIOCSFF, &effect) >= 0; });
+        }
+
+        struct input_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = EV_FF;
+        ev.code = static_cast<uint16_t>(effect.id);
+        ev.value = 1;
+        Run(CMD_PLAY, effect.id, [&]() { return write(m_Fd, &ev, sizeof(ev)) == sizeof(ev); });
+        ev.value = 0;
+        Run(CMD_STOP, effect.id, [&]() { return write(m_Fd, &ev, sizeof(ev)) == sizeof(ev); });
+
+        Run(CMD_ERASE, effect.id, [&]() { return ioctl(m_Fd, EVIOCRMFF, effect.id) >= 0; });
+    }
+
+    uint64_t GetLost() const { return m_Lost; }
+    uint64_t GetMismatched() const { return m_Mismatched; }
+    const CommandStats& GetStats(int cmd) const { return m_Stats[cmd]; }
+};
+
+void PrintHistogram(const char* name, const CommandStats& stats)
+{
+    uint64_t peak = 0;
+    for (uint64_t count : stats.octaves)
+        peak = std::max(peak, count);
+    if (peak == 0)
+        return;
+
+    std::cout << std::endl << name << " (latence volant)" << std::endl;
+    for (int octave = 0; octave < HISTOGRAM_OCTAVES; octave++)
+    {
+        if (stats.octaves[octave] == 0)
+            continue;
+        const int bar = static_cast<int>(stats.octaves[octave] * HISTOGRAM_WIDTH / peak);
+        std::cout << "  < " << std::setw(6) << (2LL << octave) << " µs " << std::setw(8)
+                  << stats.octaves[octave] << " " << std::string(std::max(bar, 1), '#') << std::endl;
+    }
+}
+
+void PrintUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--cycles N] [--updates N] [--histogram]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int cycles = 500;
+    int updates = 8;
+    bool bHistogram = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--cycles" && i + 1 < argc)
+            cycles = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--updates" && i + 1 < argc)
+            updates = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--histogram")
+            bHistogram = true;
+        else
+        {
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    VirtualWheel wheel;
+    if (!wheel.Create())
+    {
+        std::cerr << "Volant virtuel indisponible (/dev/uinput): " << strerror(errno) << ", test ignoré" << std::endl;
+        return EXIT_PROBE_SKIPPED;
+    }
+
+    const std::string devicePath = wheel.GetEventNode();
+    const int fd = devicePath.empty() ? -1 : open(devicePath.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cerr << "Impossible d'ouvrir le volant virtuel " << devicePath << ": " << strerror(errno) << std::endl;
+        return EXIT_PROBE_SETUP;
+    }
+
+    std::cout << "Cible: " << devicePath << " (volant virtuel)" << std::endl;
+    std::cout << "Cycles: " << cycles << ", mises à jour par cycle: " << updates << std::endl;
+
+    wheel.SetRecording(true);
+    LatencyProbe probe(wheel, fd);
+    ff_effect effect = ConstantEffect(8000);
+    for (int i = 0; i < cycles; i++)
+        probe.Cycle(effect, updates);
+    wheel.SetRecording(false);
+    close(fd);
+
+    uint64_t totalErrors = probe.GetLost() + probe.GetMismatched();
+
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(8) << "cmd" << std::right << std::setw(8) << "n"
+              << std::setw(12) << "noyau p50" << std::setw(12) << "noyau p99"
+              << std::setw(12) << "volant p50" << std::setw(12) << "volant p90"
+              << std::setw(12) << "volant p99" << std::setw(12) << "volant max"
+              << std::setw(10) << "erreurs" << std::endl;
+    std::cout << std::string(94, '-') << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (int cmd = 0; cmd < CMD_COUNT; cmd++)
+    {
+        const CommandStats& stats = probe.GetStats(cmd);
+        totalErrors += stats.errors;
+
+        std::cout << std::left << std::setw(8) << CMD_NAMES[cmd] << std::right
+                  << std::setw(8) << stats.device.GetCount()
+                  << std::setw(12) << stats.kernel.Percentile(0.50) / 1000.0
+                  << std::setw(12) << stats.kernel.Percentile(0.99) / 1000.0
+                  << std::setw(12) << stats.device.Percentile(0.50) / 1000.0
+                  << std::setw(12) << stats.device.Percentile(0.90) / 1000.0
+                  << std::setw(12) << stats.device.Percentile(0.99) / 1000.0
+                  << std::setw(12) << stats.device.GetMax() / 1000.0
+                  << std::setw(10) << stats.errors;
+        if (stats.lastErrno)
+            std::cout << "  (" << strerror(stats.lastErrno) << ")";
+        std::cout << std::endl;
+    }
+    std::cout << std::string(94, '-') << std::endl;
+    std::cout << "Latences en µs depuis l'appel système. Requêtes perdues: " << probe.GetLost()
+              << ", mal appariées: " << probe.GetMismatched() << std::endl;
+
+    if (bHistogram)
+    {
+        for (int cmd = 0; cmd < CMD_COUNT; cmd++)
+            PrintHistogram(CMD_NAMES[cmd], probe.GetStats(cmd));
+    }
+
+    return totalErrors ? EXIT_PROBE_ERRORS : EXIT_PROBE_OK;
+}
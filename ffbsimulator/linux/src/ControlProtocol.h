@@ -0,0 +1,315 @@
+//==============================================================================
+// ControlProtocol.h - Protocole binaire de contrôle (socket Unix)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Socket Unix SOCK_SEQPACKET : chaque message est livré entier, sans
+// découpage à gérer. Une requête porte un en-tête suivi de 1 à 256
+// commandes de 8 octets, exécutées comme un seul lot par le simulateur.
+// La réponse reprend le requestId et donne un statut par commande (plus
+// l'état courant si le lot contient QueryState). Les réponses sont
+// asynchrones : un client peut envoyer plusieurs requêtes sans attendre,
+// et CONTROL_FLAG_NO_REPLY supprime la réponse (flux de consignes).
+//
+// Les effets sont désignés par leur index dans BUILTIN_EFFECTS. Tous les
+// champs sont dans l'ordre d'octets de l'hôte (socket locale).
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const char* const CONTROL_DEFAULT_SOCKET = "/tmp/ffb_simulator.sock";
+const uint16_t CONTROL_MAGIC = 0x4346;                 // "FC"
+const uint8_t CONTROL_VERSION = 1;
+const size_t CONTROL_MAX_COMMANDS = 256;
+
+// Drapeaux de l'en-tête
+const uint8_t CONTROL_FLAG_NO_REPLY = 0x01;            // Requête : pas de réponse
+const uint8_t CONTROL_FLAG_STATE = 0x02;               // Réponse : ControlState en fin de message
+
+//==============================================================================
+// MESSAGES
+//==============================================================================
+
+enum class ControlOp : uint8_t
+{
+    Play = 1,
+    Stop,
+    StopAll,
+    SetLevel,                    // value = niveau Q15
+    LoadPreset,                  // Rétablit les paramètres d'origine de l'effet
+    QueryState,
+};
+
+enum class ControlStatus : uint8_t
+{
+    Ok = 0,
+    UnknownEffect,
+    UnknownOp,
+    DeviceError,
+};
+
+struct ControlHeader
+{
+    uint16_t magic;
+    uint8_t version;
+    uint8_t flags;
+    uint16_t count;              // Nombre de commandes ou de résultats
+    uint16_t reserved;
+    uint32_t requestId;
+};
+
+struct ControlCommand
+{
+    uint8_t op;                  // ControlOp
+    uint8_t reserved;
+    int16_t effect;
+    int32_t value;
+};
+
+struct ControlResult
+{
+    uint8_t op;
+    uint8_t status;              // ControlStatus
+    int16_t effect;
+    int32_t value;
+};
+
+struct ControlState
+{
+    int64_t timestampNs;         // CLOCK_MONOTONIC
+    int32_t position;            // Volant normalisé (Q15)
+    int32_t force;               // Force estimée ou rendue (Q15)
+    int16_t steering;
+    int16_t pedal1;
+    int16_t pedal2;
+    int16_t currentEffect;       // Index dans la liste de navigation
+    uint32_t buttons;
+    uint32_t activeEffects;      // Bit i = effet i actif (rendu logiciel)
+    uint8_t deviceOpen;
+    uint8_t effectPlaying;
+    uint8_t softwareRender;
+    uint8_t reserved;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(ControlHeader) == 12, "En-tête de contrôle : 12 octets");
+static_assert(sizeof(ControlCommand) == 8 && sizeof(ControlResult) == 8, "Commandes de 8 octets");
+
+const size_t CONTROL_MAX_REQUEST = sizeof(ControlHeader) + CONTROL_MAX_COMMANDS * sizeof(ControlCommand);
+const size_t CONTROL_MAX_REPLY = sizeof(ControlHeader) + CONTROL_MAX_COMMANDS * sizeof(ControlResult)
+                               + sizeof(ControlState);
+
+/**
+ * Requête décodée (tampon fixe, réutilisé d'un message à l'autre).
+ */
+struct ControlRequest
+{
+    int client;                  // Descripteur de la connexion
+    ControlHeader header;
+    ControlCommand commands[CONTROL_MAX_COMMANDS];
+};
+
+/**
+ * Réponse en construction.
+ */
+struct ControlReply
+{
+    ControlHeader header;
+    ControlResult results[CONTROL_MAX_COMMANDS];
+    ControlState state;
+
+    void Reset(const ControlHeader& request)
+    {
+        header = request;
+        header.flags = 0;
+        header.count = 0;
+    }
+
+    void Add(const ControlCommand& command, ControlStatus status, int32_t value = 0)
+    {
+        ControlResult& result = results[header.count++];
+        result.op = command.op;
+        result.status = static_cast<uint8_t>(status);
+        result.effect = command.effect;
+        result.value = value;
+    }
+
+    /**
+     * Sérialise dans buffer (CONTROL_MAX_REPLY octets) et retourne la taille.
+     */
+    size_t Encode(uint8_t* buffer) const
+    {
+        size_t size = 0;
+        memcpy(buffer, &header, sizeof(header));
+        size += sizeof(header);
+        memcpy(buffer + size, results, header.count * sizeof(ControlResult));
+        size += header.count * sizeof(ControlResult);
+        if (header.flags & CONTROL_FLAG_STATE)
+        {
+            memcpy(buffer + size, &state, sizeof(state));
+            size += sizeof(state);
+        }
+        return size;
+    }
+};
+
+/**
+ * Valide et décode un message reçu.
+ * @return false si le message est tronqué, mal formé ou d'une autre version.
+ */
+inline bool DecodeControlRequest(const uint8_t* data, size_t size, ControlRequest& request)
+{
+    if (size < sizeof(ControlHeader))
+        return false;
+
+    memcpy(&request.header, data, sizeof(ControlHeader));
+    const ControlHeader& header = request.header;
+    if (header.magic != CONTROL_MAGIC || header.version != CONTROL_VERSION ||
+        header.count == 0 || header.count > CONTROL_MAX_COMMANDS ||
+        size != sizeof(ControlHeader) + header.count * sizeof(ControlCommand))
+        return false;
+
+    memcpy(request.commands, data + sizeof(ControlHeader), header.count * sizeof(ControlCommand));
+    return true;
+}
+
+//==============================================================================
+// CLIENT
+//==============================================================================
+
+class ControlClient
+{
+private:
+    int m_Socket;
+    uint32_t m_NextRequestId;
+    uint8_t m_Buffer[CONTROL_MAX_REPLY];
+
+public:
+    ControlClient() : m_Socket(-1), m_NextRequestId(1) {}
+
+    ~ControlClient()
+    {
+        Close();
+    }
+
+    ControlClient(const ControlClient&) = delete;
+    ControlClient& operator=(const ControlClient&) = delete;
+
+    bool Connect(const std::string& path = CONTROL_DEFAULT_SOCKET)
+    {
+        Close();
+
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        m_Socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (m_Socket < 0)
+            return false;
+
+        if (connect(m_Socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+        {
+            int err = errno;
+            Close();
+            errno = err;
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_Socket >= 0)
+        {
+            close(m_Socket);
+            m_Socket = -1;
+        }
+    }
+
+    bool IsConnected() const { return m_Socket >= 0; }
+
+    /**
+     * Envoie un lot de commandes.
+     * @return requestId attribué, 0 en cas d'échec.
+     */
+    uint32_t Send(const ControlCommand* commands, size_t count, uint8_t flags = 0)
+    {
+        if (count == 0 || count > CONTROL_MAX_COMMANDS)
+        {
+            errno = EINVAL;
+            return 0;
+        }
+
+        uint8_t message[CONTROL_MAX_REQUEST];
+        ControlHeader header;
+        header.magic = CONTROL_MAGIC;
+        header.version = CONTROL_VERSION;
+        header.flags = flags;
+        header.count = static_cast<uint16_t>(count);
+        header.reserved = 0;
+        header.requestId = m_NextRequestId++;
+        if (m_NextRequestId == 0)
+            m_NextRequestId = 1;
+
+        memcpy(message, &header, sizeof(header));
+        memcpy(message + sizeof(header), commands, count * sizeof(ControlCommand));
+
+        const size_t size = sizeof(header) + count * sizeof(ControlCommand);
+        if (send(m_Socket, message, size, MSG_NOSIGNAL) != static_cast<ssize_t>(size))
+            return 0;
+        return header.requestId;
+    }
+
+    /**
+     * Attend une réponse (au plus timeoutMs, -1 = indéfiniment).
+     * @return false sur délai dépassé, déconnexion ou réponse mal formée.
+     */
+    bool Receive(ControlReply& reply, int timeoutMs = -1)
+    {
+        struct pollfd pfd;
+        pfd.fd = m_Socket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, timeoutMs) <= 0)
+            return false;
+
+        const ssize_t size = recv(m_Socket, m_Buffer, sizeof(m_Buffer), 0);
+        if (size < static_cast<ssize_t>(sizeof(ControlHeader)))
+            return false;
+
+        memcpy(&reply.header, m_Buffer, sizeof(ControlHeader));
+        const size_t results = reply.header.count * sizeof(ControlResult);
+        const size_t expected = sizeof(ControlHeader) + results
+                              + ((reply.header.flags & CONTROL_FLAG_STATE) ? sizeof(ControlState) : 0);
+        if (reply.header.magic != CONTROL_MAGIC || reply.header.count > CONTROL_MAX_COMMANDS ||
+            static_cast<size_t>(size) != expected)
+            return false;
+
+        memcpy(reply.results, m_Buffer + sizeof(ControlHeader), results);
+        if (reply.header.flags & CONTROL_FLAG_STATE)
+            memcpy(&reply.state, m_Buffer + sizeof(ControlHeader) + results, sizeof(ControlState));
+        return true;
+    }
+};
@@ -0,0 +1,300 @@
+//==============================================================================
+// ControlServer.h - Serveur epoll du protocole de contrôle (socket Unix)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Un seul thread sert toutes les connexions : epoll sur la socket d'écoute,
+// les clients et un eventfd de réveil (arrêt). Poll() rend les requêtes
+// reçues ; l'appelant les exécute puis renvoie les réponses avec
+// SendReply(). Les sockets sont non bloquantes : une réponse qu'un client
+// ne lit pas (tampon plein) est abandonnée et comptée, sans jamais bloquer
+// le service des autres clients. Un client déconnecté n'est fermé qu'au
+// Poll() suivant : ses requêtes déjà rendues sont exécutées et leur
+// réponse ne peut pas partir vers un autre client ayant reçu le même fd.
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "ControlProtocol.h"
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const int CONTROL_MAX_EVENTS = 32;
+const int CONTROL_LISTEN_BACKLOG = 16;
+const size_t CONTROL_MAX_CLIENTS = 64;
+
+//==============================================================================
+// SERVEUR
+//==============================================================================
+
+class ControlServer
+{
+private:
+    std::string m_Path;
+    int m_Listen;
+    int m_Epoll;
+    int m_Wake;
+    std::vector<int> m_Clients;
+    std::vector<int> m_Closing;          // Retirés d'epoll, fermés au Poll() suivant
+    uint64_t m_RejectedMessages;
+    uint64_t m_DroppedReplies;
+    uint8_t m_Buffer[CONTROL_MAX_REQUEST + 1];
+    uint8_t m_ReplyBuffer[CONTROL_MAX_REPLY];
+
+    bool Watch(int fd)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        return epoll_ctl(m_Epoll, EPOLL_CTL_ADD, fd, &ev) >= 0;
+    }
+
+    void AcceptClients()
+    {
+        for (;;)
+        {
+            const int client = accept4(m_Listen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client < 0)
+                return;
+
+            if (m_Clients.size() >= CONTROL_MAX_CLIENTS || !Watch(client))
+            {
+                close(client);
+                continue;
+            }
+            m_Clients.push_back(client);
+        }
+    }
+
+    /**
+     * Retire un client d'epoll ; le fd reste ouvert (réservé) jusqu'au
+     * Poll() suivant, après l'envoi des réponses en attente.
+     */
+    void DropClient(int client)
+    {
+        epoll_ctl(m_Epoll, EPOLL_CTL_DEL, client, nullptr);
+        m_Closing.push_back(client);
+        for (size_t i = 0; i < m_Clients.size(); i++)
+        {
+            if (m_Clients[i] == client)
+            {
+                m_Clients[i] = m_Clients.back();
+                m_Clients.pop_back();
+                break;
+            }
+        }
+    }
+
+    /**
+     * Lit tous les messages en attente d'un client.
+     */
+    void ReadClient(int client, std::vector<ControlRequest>& requests, size_t& count)
+    {
+        for (;;)
+        {
+            const ssize_t size = recv(client, m_Buffer, sizeof(m_Buffer), MSG_DONTWAIT);
+            if (size == 0 || (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                DropClient(client);
+                return;
+            }
+            if (size < 0)
+                return;
+
+            if (count == requests.size())
+                requests.resize(count + 1);
+
+            ControlRequest& request = requests[count];
+            if (!DecodeControlRequest(m_Buffer, static_cast<size_t>(size), request))
+            {
+                m_RejectedMessages++;
+                continue;
+            }
+            request.client = client;
+            count++;
+        }
+    }
+
+public:
+    ControlServer()
+        : m_Listen(-1)
+        , m_Epoll(-1)
+        , m_Wake(-1)
+        , m_RejectedMessages(0)
+        , m_DroppedReplies(0)
+    {
+        m_Clients.reserve(CONTROL_MAX_CLIENTS);
+        m_Closing.reserve(CONTROL_MAX_CLIENTS);
+    }
+
+    ~ControlServer()
+    {
+        Close();
+    }
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    /**
+     * Crée la socket d'écoute (un fichier socket existant est remplacé).
+     * @return false en cas d'échec (errno renseigné).
+     */
+    bool Open(const std::string& path)
+    {
+        Close();
+
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        m_Listen = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        m_Epoll = epoll_create1(EPOLL_CLOEXEC);
+        m_Wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_Listen < 0 || m_Epoll < 0 || m_Wake < 0)
+        {
+            int err = errno;
+            Close();
+            errno = err;
+            return false;
+        }
+
+        unlink(path.c_str());
+        if (bind(m_Listen, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            listen(m_Listen, CONTROL_LISTEN_BACKLOG) < 0 ||
+            !Watch(m_Listen) || !Watch(m_Wake))
+        {
+            int err = errno;
+            Close();
+            errno = err;
+            return false;
+        }
+
+        m_Path = path;
+        return true;
+    }
+
+    void Close()
+    {
+        for (int client : m_Clients)
+            close(client);
+        m_Clients.clear();
+        for (int client : m_Closing)
+            close(client);
+        m_Closing.clear();
+
+        if (m_Listen >= 0)
+        {
+            close(m_Listen);
+            m_Listen = -1;
+            if (!m_Path.empty())
+                unlink(m_Path.c_str());
+        }
+        if (m_Epoll >= 0)
+        {
+            close(m_Epoll);
+            m_Epoll = -1;
+        }
+        if (m_Wake >= 0)
+        {
+            close(m_Wake);
+            m_Wake = -1;
+        }
+        m_Path.clear();
+    }
+
+    bool IsOpen() const { return m_Listen >= 0; }
+    const std::string& GetPath() const { return m_Path; }
+    size_t GetClientCount() const { return m_Clients.size(); }
+    uint64_t GetRejectedCount() const { return m_RejectedMessages; }
+    uint64_t GetDroppedReplyCount() const { return m_DroppedReplies; }
+
+    /**
+     * Attend des requêtes (au plus timeoutMs). Les requêtes valides sont
+     * écrites dans requests (agrandi au besoin, jamais réduit) ; leurs
+     * réponses doivent être envoyées avant le Poll() suivant.
+     * @return Nombre de requêtes reçues.
+     */
+    size_t Poll(int timeoutMs, std::vector<ControlRequest>& requests)
+    {
+        // Les réponses du Poll() précédent sont parties
+        for (int client : m_Closing)
+            close(client);
+        m_Closing.clear();
+
+        struct epoll_event events[CONTROL_MAX_EVENTS];
+        const int ready = epoll_wait(m_Epoll, events, CONTROL_MAX_EVENTS, timeoutMs);
+
+        size_t count = 0;
+        for (int i = 0; i < ready; i++)
+        {
+            const int fd = events[i].data.fd;
+            if (fd == m_Listen)
+            {
+                AcceptClients();
+            }
+            else if (fd == m_Wake)
+            {
+                uint64_t value;
+                while (read(m_Wake, &value, sizeof(value)) == sizeof(value))
+                {
+                }
+            }
+            else if (events[i].events & (EPOLLHUP | EPOLLERR) && !(events[i].events & EPOLLIN))
+            {
+                DropClient(fd);
+            }
+            else
+            {
+                ReadClient(fd, requests, count);
+            }
+        }
+        return count;
+    }
+
+    /**
+     * Interrompt un Poll() en cours (arrêt du thread de service).
+     */
+    void Wake()
+    {
+        const uint64_t one = 1;
+        if (m_Wake >= 0)
+            write(m_Wake, &one, sizeof(one));
+    }
+
+    /**
+     * Envoie une réponse sans bloquer.
+     * @return false si elle est abandonnée (client saturé ou déconnecté).
+     */
+    bool SendReply(int client, const ControlReply& reply)
+    {
+        const size_t size = reply.Encode(m_ReplyBuffer);
+        if (send(client, m_ReplyBuffer, size, MSG_DONTWAIT | MSG_NOSIGNAL) != static_cast<ssize_t>(size))
+        {
+            m_DroppedReplies++;
+            return false;
+        }
+        return true;
+    }
+};
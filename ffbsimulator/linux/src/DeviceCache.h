@@ -0,0 +1,309 @@
+//==============================================================================
+// DeviceCache.h - Cache persistant des capacités force feedback du volant
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+
+#include <linux/input.h>
+#include <sys/stat.h>
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const char DEVICE_CACHE_MAGIC[4] = { 'F', 'F', 'B', 'C' };
+const uint32_t DEVICE_CACHE_VERSION = 2;
+const uint32_t DEVICE_CACHE_MAX_ENTRIES = 16;
+
+// Taille du bitmap EV_FF en octets (FF_MAX inclus)
+const size_t FF_BITMAP_BYTES = FF_MAX / 8 + 1;
+
+// Axes mémorisés : volant (ABS_X) et pédales (ABS_Y, ABS_Z)
+const int CACHED_AXES[] = { ABS_X, ABS_Y, ABS_Z };
+const size_t CACHED_AXIS_COUNT = sizeof(CACHED_AXES) / sizeof(CACHED_AXES[0]);
+
+//==============================================================================
+// STRUCTURES (format binaire, taille fixe)
+//==============================================================================
+
+/**
+ * Identité d'un périphérique : VID/PID, version, bus et chemin physique.
+ * Un volant rebranché sur un autre port USB est considéré comme différent.
+ */
+struct DeviceIdentity
+{
+    uint16_t bustype;
+    uint16_t vendor;
+    uint16_t product;
+    uint16_t version;
+    char phys[64];
+    char name[128];
+
+    DeviceIdentity()
+        : bustype(0), vendor(0), product(0), version(0)
+    {
+        memset(phys, 0, sizeof(phys));
+        memset(name, 0, sizeof(name));
+    }
+
+    void SetStrings(const std::string& physPath, const std::string& deviceName)
+    {
+        strncpy(phys, physPath.c_str(), sizeof(phys) - 1);
+        strncpy(name, deviceName.c_str(), sizeof(name) - 1);
+    }
+
+    bool operator==(const DeviceIdentity& other) const
+    {
+        return bustype == other.bustype && vendor == other.vendor &&
+               product == other.product && version == other.version &&
+               strncmp(phys, other.phys, sizeof(phys)) == 0 &&
+               strncmp(name, other.name, sizeof(name)) == 0;
+    }
+};
+
+/**
+ * Plage d'un axe (sous-ensemble de struct input_absinfo).
+ */
+struct AxisRange
+{
+    int32_t minimum;
+    int32_t maximum;
+    int32_t fuzz;
+    int32_t flat;
+};
+
+/**
+ * Capacités sondées au démarrage (EVIOCGBIT(EV_FF), EVIOCGEFFECTS, EVIOCGABS)
+ * et cadence de mise à jour mesurée par --calibrate (RateCalibration.h).
+ */
+struct DeviceCapabilities
+{
+    uint8_t ffBits[FF_BITMAP_BYTES];
+    int32_t maxEffects;
+    AxisRange axes[CACHED_AXIS_COUNT];
+    uint32_t updateRateHz;       // 0 = jamais calibré
+    uint32_t updateP99Us;        // Latence EVIOCSFF p99 à cette cadence
+
+    DeviceCapabilities()
+        : maxEffects(0), updateRateHz(0), updateP99Us(0)
+    {
+        memset(ffBits, 0, sizeof(ffBits));
+        memset(axes, 0, sizeof(axes));
+    }
+
+    bool HasFFBit(int bit) const
+    {
+        return (ffBits[bit / 8] >> (bit % 8)) & 1;
+    }
+
+    void SetFFBits(const unsigned long* bits, size_t nLongs)
+    {
+        const size_t bitsPerLong = sizeof(unsigned long) * 8;
+        memset(ffBits, 0, sizeof(ffBits));
+        for (size_t bit = 0; bit <= FF_MAX && bit / bitsPerLong < nLongs; bit++)
+        {
+            if ((bits[bit / bitsPerLong] >> (bit % bitsPerLong)) & 1UL)
+                ffBits[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8));
+        }
+    }
+
+    bool SameFFBits(const unsigned long* bits, size_t nLongs) const
+    {
+        DeviceCapabilities other;
+        other.SetFFBits(bits, nLongs);
+        return memcmp(ffBits, other.ffBits, sizeof(ffBits)) == 0;
+    }
+};
+
+//==============================================================================
+// CACHE
+//==============================================================================
+
+/**
+ * Fichier binaire : en-tête + entrées de taille fixe, chacune protégée par
+ * une somme de contrôle. Une entrée invalide ou d'une autre version est
+ * simplement ignorée (le périphérique sera sondé à nouveau).
+ */
+class DeviceCapabilityCache
+{
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entrySize;
+        uint32_t entryCount;
+    };
+
+    struct Entry
+    {
+        DeviceIdentity identity;
+        DeviceCapabilities caps;
+        uint32_t checksum;
+    };
+
+    // Pas de padding : la somme de contrôle porte sur des octets définis
+    static_assert(sizeof(Entry) == sizeof(DeviceIdentity) + sizeof(DeviceCapabilities) + sizeof(uint32_t),
+                  "Entry ne doit pas contenir de padding");
+
+    std::string m_Filename;
+    std::vector<Entry> m_Entries;
+
+    static uint32_t Checksum(const Entry& entry)
+    {
+        // FNV-1a sur tout sauf le champ checksum
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&entry);
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < offsetof(Entry, checksum); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+public:
+    /**
+     * Emplacement par défaut : $XDG_CACHE_HOME/ffb_simulator/devices.cache
+     * (ou ~/.cache/...). Vide si aucun répertoire n'est utilisable.
+     */
+    static std::string GetDefaultPath()
+    {
+        std::string dir;
+        const char* xdg = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+
+        if (xdg && *xdg)
+            dir = xdg;
+        else if (home && *home)
+            dir = std::string(home) + "/.cache";
+        else
+            return std::string();
+
+        mkdir(dir.c_str(), 0755);
+        dir += "/ffb_simulator";
+        mkdir(dir.c_str(), 0755);
+        return dir + "/devices.cache";
+    }
+
+    /**
+     * Charge le fichier. Un fichier absent ou corrompu donne un cache vide.
+     */
+    bool Load(const std::string& filename)
+    {
+        m_Filename = filename;
+        m_Entries.clear();
+
+        FILE* file = fopen(filename.c_str(), "rb");
+        if (!file)
+            return false;
+
+        Header header;
+        bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                     memcmp(header.magic, DEVICE_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+                     header.version == DEVICE_CACHE_VERSION &&
+                     header.entrySize == sizeof(Entry) &&
+                     header.entryCount <= DEVICE_CACHE_MAX_ENTRIES;
+
+        for (uint32_t i = 0; valid && i < header.entryCount; i++)
+        {
+            Entry entry;
+            if (fread(&entry, sizeof(entry), 1, file) != 1)
+                break;
+            if (entry.checksum == Checksum(entry))
+                m_Entries.push_back(entry);
+        }
+
+        fclose(file);
+        return valid;
+    }
+
+    /**
+     * Écrit le cache (fichier temporaire puis rename, pour rester atomique).
+     */
+    bool Save() const
+    {
+        if (m_Filename.empty())
+            return false;
+
+        std::string tmpName = m_Filename + ".tmp";
+        FILE* file = fopen(tmpName.c_str(), "wb");
+        if (!file)
+            return false;
+
+        Header header;
+        memcpy(header.magic, DEVICE_CACHE_MAGIC, sizeof(header.magic));
+        header.version = DEVICE_CACHE_VERSION;
+        header.entrySize = sizeof(Entry);
+        header.entryCount = static_cast<uint32_t>(m_Entries.size());
+
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        if (ok && !m_Entries.empty())
+            ok = fwrite(m_Entries.data(), sizeof(Entry), m_Entries.size(), file) == m_Entries.size();
+
+        ok = (fclose(file) == 0) && ok;
+        if (!ok || rename(tmpName.c_str(), m_Filename.c_str()) != 0)
+        {
+            remove(tmpName.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool Find(const DeviceIdentity& identity, DeviceCapabilities& caps) const
+    {
+        for (const auto& entry : m_Entries)
+        {
+            if (entry.identity == identity)
+            {
+                caps = entry.caps;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Store(const DeviceIdentity& identity, const DeviceCapabilities& caps)
+    {
+        Entry entry;
+        entry.identity = identity;
+        entry.caps = caps;
+        entry.checksum = Checksum(entry);
+
+        for (auto& existing : m_Entries)
+        {
+            if (existing.identity == identity)
+            {
+                existing = entry;
+                return;
+            }
+        }
+
+        // Les entrées les plus anciennes sont évincées en premier
+        if (m_Entries.size() >= DEVICE_CACHE_MAX_ENTRIES)
+            m_Entries.erase(m_Entries.begin());
+        m_Entries.push_back(entry);
+    }
+
+    void Remove(const DeviceIdentity& identity)
+    {
+        for (auto it = m_Entries.begin(); it != m_Entries.end(); ++it)
+        {
+            if (it->identity == identity)
+            {
+                m_Entries.erase(it);
+                return;
+            }
+        }
+    }
+};
@@ -0,0 +1,2514 @@
+//==============================================================================
+// ForceEffectSimulator.cpp - Simulateur d'effets à retour de force (evdev)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+
+#include "ForceEffectSimulator.h"
+
+// Instance globale du logger
+Logger g_Logger;
+
+//==============================================================================
+// UTILITAIRES TERMINAL
+//==============================================================================
+
+/**
+ * Équivalent de _kbhit() pour Linux.
+ */
+static int kbhit()
+{
+    struct timeval tv = {0, 0};
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(STDIN_FILENO, &readfds);
+    return select(STDIN_FILENO + 1, &readfds, nullptr, nullptr, &tv) > 0;
+}
+
+//==============================================================================
+// IMPLÉMENTATION
+//==============================================================================
+
+ForceEffectSimulator::ForceEffectSimulator()
+    : m_DeviceFd(-1)
+    , m_JoystickFd(-1)
+    , m_bDeviceOpen(false)
+    , m_bHaveIdentity(false)
+    , m_bCapsFromCache(false)
+    , m_bCalibrate(false)
+    , m_bShowingHelp(false)
+    , m_CurrentEffectIndex(0)
+    , m_bEffectPlaying(false)
+    , m_bRunning(false)
+    , m_bShutdown(false)
+    , m_bSoftwareRender(false)
+    , m_bAutoOutputRate(true)
+    , m_RenderedForce(0)
+    , m_bSteeringPhysics(false)
+    , m_bPredict(false)
+    , m_PredictLeadNs(-1)
+    , m_ExternalForce(0)
+    , m_SharedApplied(0)
+    , m_SharedRejected(0)
+    , m_MetricsPeriodMs(METRICS_DEFAULT_PERIOD_MS)
+    , m_ForceIntensity(16000)
+    , m_EffectDuration(EFFECT_DURATION)
+    , m_EffectDirection(0)
+    , m_bMonotonicEvents(false)
+    , m_PendingInputNs(0)
+{
+    memset(&m_OutputEffect, 0, sizeof(m_OutputEffect));
+    m_OutputEffect.id = -1;
+    m_DispatchBatch.reserve(FORCE_BATCH_CAPACITY);
+    m_ControlBatch.reserve(CONTROL_MAX_COMMANDS);
+    m_ControlResults.resize(CONTROL_MAX_COMMANDS);
+    m_PlayEvents.reserve(FORCE_BATCH_CAPACITY);
+    RegisterMetrics();
+}
+
+ForceEffectSimulator::~ForceEffectSimulator()
+{
+    Shutdown();
+}
+
+bool ForceEffectSimulator::Initialize()
+{
+    g_Logger.Info("=== Simulateur Force Feedback Linux evdev ===");
+    g_Logger.Info("Initialisation...");
+    
+    m_Startup.Start();
+    const bool success = RunStartupPhases();
+    m_Startup.Stop();
+    LogStartupProfile();
+    
+    if (success)
+    {
+        g_Logger.Success("Initialisation terminée avec succès!");
+        g_Logger.Info("Effets disponibles: ", m_Effects.size());
+    }
+    return success;
+}
+
+/**
+ * Variante d'Initialize() sur des descripteurs fournis par l'appelant :
+ * ni recherche ni sondage, seulement la plage du volant et les effets.
+ */
+bool ForceEffectSimulator::AttachDescriptors(int deviceFd, int joystickFd, const std::string& label, const AxisRange& steering)
+{
+    m_DeviceFd = deviceFd;
+    m_JoystickFd = joystickFd;
+    m_DevicePath = label;
+    m_bDeviceOpen = true;
+    m_Caps.axes[0] = steering;
+    
+    // ID locaux pour tous les effets, quel que soit le mode de rendu
+    const bool bSoftware = m_bSoftwareRender;
+    m_bSoftwareRender = true;
+    CreateAllEffects();
+    m_bSoftwareRender = bSoftware;
+    
+    g_Logger.Info("Descripteurs attachés: ", label, " (", m_Effects.size(), " effets)");
+    return !m_Effects.empty();
+}
+
+/**
+ * Phases de l'initialisation, chacune chronométrée par m_Startup.
+ */
+bool ForceEffectSimulator::RunStartupPhases()
+{
+    if (!m_Startup.Measure("FindDevice", [this]() { return FindDevice(); }))
+    {
+        g_Logger.Error("Impossible de trouver le volant Sidewinder");
+        return false;
+    }
+    
+    if (!m_Startup.Measure("OpenDevice", [this]() { return OpenDevice(); }))
+    {
+        g_Logger.Error("Impossible d'ouvrir le périphérique");
+        return false;
+    }
+    
+    if (!m_Startup.Measure("SetupForceFeedback", [this]() { return SetupForceFeedback(); }))
+    {
+        g_Logger.Error("Le force feedback n'est pas disponible");
+        return false;
+    }
+    
+    // Avant la création des effets : la calibration a besoin d'un slot libre
+    if (m_bCalibrate && !m_Startup.Measure("CalibrateUpdateRate", [this]() { return CalibrateUpdateRate(); }))
+    {
+        g_Logger.Error("Échec de la calibration de la cadence de mise à jour");
+        return false;
+    }
+    ApplyUpdateRate();
+    if (m_bPredict)
+    {
+        ConfigurePrediction();
+    }
+    
+    if (!m_Startup.Measure("CreateAllEffects", [this]() { return CreateAllEffects(); }))
+    {
+        g_Logger.Error("Impossible de créer les effets force feedback");
+        return false;
+    }
+    
+    if (!m_SharedName.empty())
+    {
+        if (!m_Startup.Measure("SharedMemory", [this]() { return m_Shared.Create(m_SharedName); }))
+        {
+            const int err = errno;
+            g_Logger.Error("Impossible de créer la mémoire partagée ", m_SharedName, ": ", strerror(err));
+            if (err == EEXIST)
+            {
+                g_Logger.Info("Région utilisée par un autre simulateur en cours (--shm <autre nom>)");
+            }
+            return false;
+        }
+        g_Logger.Info("Interface mémoire partagée: ", m_SharedName, " (", SHARED_FORCE_RING_CAPACITY,
+                      " commandes en attente max)");
+    }
+    
+    if (!m_ControlPath.empty())
+    {
+        if (!m_Startup.Measure("ControlSocket", [this]() { return m_Control.Open(m_ControlPath); }))
+        {
+            g_Logger.Error("Impossible d'ouvrir la socket de contrôle ", m_ControlPath, ": ", strerror(errno));
+            return false;
+        }
+        g_Logger.Info("Socket de contrôle: ", m_ControlPath);
+    }
+    
+    if (!m_MetricsSocketPath.empty() || !m_MetricsFilePath.empty())
+    {
+        const bool bStarted = m_Startup.Measure("MetricsExporter", [this]() {
+            return m_MetricsExporter.Start(m_Metrics, m_MetricsSocketPath, m_MetricsFilePath, m_MetricsPeriodMs);
+        });
+        if (!bStarted)
+        {
+            g_Logger.Error("Impossible de démarrer l'export des métriques: ", strerror(errno));
+            return false;
+        }
+        if (!m_MetricsSocketPath.empty())
+            g_Logger.Info("Métriques (socket): ", m_MetricsSocketPath);
+        if (!m_MetricsFilePath.empty())
+            g_Logger.Info("Métriques (fichier): ", m_MetricsFilePath, " toutes les ", m_MetricsPeriodMs, " ms");
+    }
+    
+    return true;
+}
+
+/**
+ * Répartition du temps de démarrage (une ligne par phase, indentée selon
+ * l'imbrication), puis export Chrome trace si demandé.
+ */
+void ForceEffectSimulator::LogStartupProfile()
+{
+    const int64_t totalNs = std::max<int64_t>(m_Startup.GetTotalNs(), 1);
+    g_Logger.Info("Répartition du démarrage: ", totalNs / 1000, " µs");
+    for (const ProfileSpan& span : m_Startup.GetSpans())
+    {
+        const int64_t durationNs = span.endNs - span.startNs;
+        g_Logger.Info(std::string(2 + 2 * span.depth, ' '), span.name, ": ", durationNs / 1000,
+                      " µs (", durationNs * 100 / totalNs, " %)");
+    }
+    
+    if (m_StartupTracePath.empty())
+        return;
+    
+    if (m_Startup.WriteChromeTrace(m_StartupTracePath, "FFB_Simulator"))
+        g_Logger.Info("Trace de démarrage écrite: ", m_StartupTracePath);
+    else
+        g_Logger.Warning("Impossible d'écrire la trace de démarrage ", m_StartupTracePath, ": ", strerror(errno));
+}
+
+/**
+ * Recherche le device event correspondant au Sidewinder.
+ * Utilise sysfs en priorité (aucun nœud ouvert hormis celui retenu) et
+ * se replie sur le scan de /dev/input si sysfs n'est pas disponible.
+ * @return true si trouvé.
+ */
+bool ForceEffectSimulator::FindDevice()
+{
+    if (!m_ForcedDevicePath.empty())
+    {
+        return FindForcedDevice();
+    }
+    
+    bool bSysfsAvailable = false;
+    if (m_Startup.Measure("FindDeviceSysfs", [&]() { return FindDeviceSysfs(bSysfsAvailable); }))
+    {
+        return true;
+    }
+    
+    if (bSysfsAvailable)
+    {
+        g_Logger.Error("Aucun volant Sidewinder trouvé avec support FF");
+        return false;
+    }
+    
+    g_Logger.Warning(SYSFS_INPUT_CLASS, " indisponible, scan de /dev/input...");
+    return m_Startup.Measure("FindDeviceDevInput", [this]() { return FindDeviceDevInput(); });
+}
+
+/**
+ * Utilise le nœud imposé (--device) ; l'identité est lue dans sysfs pour
+ * le cache de capacités.
+ */
+bool ForceEffectSimulator::FindForcedDevice()
+{
+    m_DevicePath = m_ForcedDevicePath;
+    
+    std::string eventName = m_DevicePath.substr(m_DevicePath.find_last_of('/') + 1);
+    SysfsInputDevice device;
+    if (ReadSysfsInputDevice(SYSFS_INPUT_CLASS, eventName, device))
+    {
+        ReadSysfsCapabilities(SYSFS_INPUT_CLASS, device);
+        
+        m_DeviceIdentity = DeviceIdentity();
+        m_DeviceIdentity.bustype = device.bustype;
+        m_DeviceIdentity.vendor = device.vendor;
+        m_DeviceIdentity.product = device.product;
+        m_DeviceIdentity.version = device.version;
+        m_DeviceIdentity.SetStrings(device.phys, device.name);
+        m_bHaveIdentity = true;
+        
+        LookupCachedCapabilities(device.ffBits, FF_BITMAP_LONGS);
+    }
+    
+    g_Logger.Info("Device imposé: ", m_DevicePath);
+    return true;
+}
+
+/**
+ * Vérifie si un nom ou un couple VID/PID correspond au Sidewinder.
+ */
+bool ForceEffectSimulator::IsSidewinderIdentity(const char* name, uint16_t vendor, uint16_t product)
+{
+    // Vérification du nom pour plus de flexibilité
+    bool isNameMatch = (strstr(name, "SideWinder") != nullptr || 
+                       strstr(name, "Sidewinder") != nullptr ||
+                       strstr(name, "SIDEWINDER") != nullptr);
+    
+    bool isVidPidMatch = (vendor == SIDEWINDER_VID && product == SIDEWINDER_PID);
+    
+    return isNameMatch || isVidPidMatch;
+}
+
+/**
+ * Recherche via /sys/class/input/eventX/device : les ids, le nom et le
+ * bitmap capabilities/ff sont lus sans ouvrir les nœuds /dev/input.
+ * @param bSysfsAvailable Mis à false si sysfs n'a pu être parcouru.
+ */
+bool ForceEffectSimulator::FindDeviceSysfs(bool& bSysfsAvailable)
+{
+    SysfsInputDevice device;
+    SysfsScanStats stats;
+    
+    bool bFound = FindSysfsInputDevice(SYSFS_INPUT_CLASS,
+        [](const SysfsInputDevice& candidate)
+        {
+            return IsSidewinderIdentity(candidate.name.c_str(), candidate.vendor, candidate.product);
+        },
+        device, stats);
+    
+    bSysfsAvailable = stats.devicesScanned > 0;
+    
+    g_Logger.Info("Scan sysfs: ", stats.devicesScanned, " périphériques examinés en ",
+                  stats.elapsed.count(), " µs");
+    
+    if (stats.candidatesWithoutFF > 0)
+    {
+        g_Logger.Warning(stats.candidatesWithoutFF, " device(s) Sidewinder trouvé(s) sans support FF");
+    }
+    
+    if (!bFound)
+    {
+        return false;
+    }
+    
+    g_Logger.Info("Device candidat trouvé: ", device.name);
+    g_Logger.Info("  Path: ", device.devNode);
+    g_Logger.Info("  Phys: ", device.phys);
+    g_Logger.Info("  VID/PID: ", Logger::Hex(device.vendor), "/", Logger::Hex(device.product));
+    g_Logger.Info("  FF_CONSTANT: ", device.HasFFBit(FF_CONSTANT) ? "OUI" : "NON");
+    
+    m_DevicePath = device.devNode;
+    
+    m_DeviceIdentity = DeviceIdentity();
+    m_DeviceIdentity.bustype = device.bustype;
+    m_DeviceIdentity.vendor = device.vendor;
+    m_DeviceIdentity.product = device.product;
+    m_DeviceIdentity.version = device.version;
+    m_DeviceIdentity.SetStrings(device.phys, device.name);
+    m_bHaveIdentity = true;
+    
+    LookupCachedCapabilities(device.ffBits, FF_BITMAP_LONGS);
+    
+    g_Logger.Success("Microsoft Sidewinder Force Feedback Wheel détecté!");
+    g_Logger.Info("Device: ", m_DevicePath);
+    return true;
+}
+
+/**
+ * Recherche les capacités du device identifié dans le cache persistant.
+ * L'entrée n'est retenue que si son bitmap FF correspond à celui du device.
+ */
+void ForceEffectSimulator::LookupCachedCapabilities(const unsigned long* ffBits, size_t nLongs)
+{
+    m_bCapsFromCache = false;
+    
+    std::string cachePath = DeviceCapabilityCache::GetDefaultPath();
+    if (cachePath.empty())
+        return;
+    
+    m_CapsCache.Load(cachePath);
+    
+    DeviceCapabilities cached;
+    if (!m_CapsCache.Find(m_DeviceIdentity, cached))
+    {
+        g_Logger.Debug("Capacités absentes du cache ", cachePath);
+        return;
+    }
+    
+    if (!cached.SameFFBits(ffBits, nLongs))
+    {
+        g_Logger.Warning("Cache de capacités obsolète pour ce device, nouveau sondage");
+        m_CapsCache.Remove(m_DeviceIdentity);
+        return;
+    }
+    
+    m_Caps = cached;
+    m_bCapsFromCache = true;
+    g_Logger.Info("Capacités chargées depuis le cache ", cachePath);
+}
+
+/**
+ * Recherche historique : ouvre chaque /dev/input/eventX et interroge
+ * le device par ioctl. Utilisée uniquement si sysfs est absent.
+ */
+bool ForceEffectSimulator::FindDeviceDevInput()
+{
+    auto scanStart = std::chrono::steady_clock::now();
+    
+    DIR* dir = opendir("/dev/input");
+    if (!dir)
+    {
+        g_Logger.Error("Impossible d'ouvrir /dev/input");
+        return false;
+    }
+    
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (strncmp(entry->d_name, "event", 5) != 0)
+            continue;
+        
+        std::string path = std::string("/dev/input/") + entry->d_name;
+        int fd = open(path.c_str(), O_RDWR);
+        if (fd < 0)
+        {
+            g_Logger.Debug("Impossible d'ouvrir ", path, " (", strerror(errno), ")");
+            continue;
+        }
+        
+        // Récupération du nom du device
+        char name[256] = "Unknown";
+        ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+        
+        // Vérification du VID/PID
+        struct input_id device_id;
+        memset(&device_id, 0, sizeof(device_id));
+        
+        if (ioctl(fd, EVIOCGID, &device_id) >= 0)
+        {
+            g_Logger.Debug("Device ", path, ": ", name,
+                          " (VID: ", Logger::Hex(device_id.vendor),
+                          ", PID: ", Logger::Hex(device_id.product), ")");
+            
+            if (IsSidewinderIdentity(name, device_id.vendor, device_id.product))
+            {
+                // Vérification des capacités FF
+                unsigned long features[4];
+                memset(features, 0, sizeof(features));
+                
+                int ff_bits = ioctl(fd, EVIOCGBIT(EV_FF, FF_MAX), features);
+                
+                if (ff_bits >= 0)
+                {
+                    // Debug: afficher toutes les features
+                    g_Logger.Debug("  FF capabilities bits: ",
+                                  Logger::Hex(features[0]), " ",
+                                  Logger::Hex(features[1]), " ",
+                                  Logger::Hex(features[2]), " ",
+                                  Logger::Hex(features[3]));
+                    
+                    // Test plus robuste: vérifier si AU MOINS un effet FF est supporté
+                    bool hasFF = false;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        if (features[i] != 0)
+                        {
+                            hasFF = true;
+                            break;
+                        }
+                    }
+                    
+                    // Test spécifique pour FF_CONSTANT (bit 0x50 = 80)
+                    bool hasConstant = (features[FF_CONSTANT/sizeof(long)/8] & (1UL << (FF_CONSTANT % (sizeof(long)*8))));
+                    
+                    g_Logger.Info("Device candidat trouvé: ", name);
+                    g_Logger.Info("  Path: ", path);
+                    g_Logger.Info("  VID/PID: ", Logger::Hex(device_id.vendor), "/", Logger::Hex(device_id.product));
+                    g_Logger.Info("  Force Feedback: ", hasFF ? "OUI" : "NON");
+                    g_Logger.Info("  FF_CONSTANT: ", hasConstant ? "OUI" : "NON");
+                    
+                    if (hasFF)
+                    {
+                        m_DevicePath = path;
+                        
+                        char phys[64] = "";
+                        ioctl(fd, EVIOCGPHYS(sizeof(phys) - 1), phys);
+                        
+                        m_DeviceIdentity = DeviceIdentity();
+                        m_DeviceIdentity.bustype = device_id.bustype;
+                        m_DeviceIdentity.vendor = device_id.vendor;
+                        m_DeviceIdentity.product = device_id.product;
+                        m_DeviceIdentity.version = device_id.version;
+                        m_DeviceIdentity.SetStrings(phys, name);
+                        m_bHaveIdentity = true;
+                        
+                        LookupCachedCapabilities(features, sizeof(features) / sizeof(features[0]));
+                        
+                        close(fd);
+                        closedir(dir);
+                        
+                        g_Logger.Info("Scan /dev/input terminé en ",
+                                      std::chrono::duration_cast<std::chrono::microseconds>(
+                                          std::chrono::steady_clock::now() - scanStart).count(), " µs");
+                        g_Logger.Success("Microsoft Sidewinder Force Feedback Wheel détecté!");
+                        g_Logger.Info("Device: ", path);
+                        return true;
+                    }
+                    else
+                    {
+                        g_Logger.Warning("Device trouvé mais sans support FF, vérification suivante...");
+                    }
+                }
+                else
+                {
+                    g_Logger.Warning("EVIOCGBIT(EV_FF) a échoué pour ", path, ": ", strerror(errno));
+                }
+            }
+        }
+        else
+        {
+            g_Logger.Debug("EVIOCGID a échoué pour ", path);
+        }
+        
+        close(fd);
+    }
+    
+    closedir(dir);
+    g_Logger.Info("Scan /dev/input terminé en ",
+                  std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - scanStart).count(), " µs");
+    g_Logger.Error("Aucun volant Sidewinder trouvé avec support FF");
+    g_Logger.Info("Devices scannés - vérifiez les logs ci-dessus");
+    return false;
+}
+
+/**
+ * Ouvre le device pour lecture et force feedback.
+ */
+bool ForceEffectSimulator::OpenDevice()
+{
+    m_DeviceFd = open(m_DevicePath.c_str(), O_RDWR);
+    if (m_DeviceFd < 0)
+    {
+        g_Logger.Error("Impossible d'ouvrir ", m_DevicePath, " (permissions?)");
+        g_Logger.Info("Essayez: sudo chmod 666 ", m_DevicePath);
+        return false;
+    }
+    
+    // Ouvrir aussi en lecture pour les axes/boutons
+    m_JoystickFd = open(m_DevicePath.c_str(), O_RDONLY | O_NONBLOCK);
+    SetEventClock();
+    
+    // Récupération du nom du device (déjà connu si identifié via sysfs)
+    if (m_bHaveIdentity)
+    {
+        g_Logger.Info("Device name: ", m_DeviceIdentity.name);
+    }
+    else
+    {
+        char name[256] = "Unknown";
+        ioctl(m_DeviceFd, EVIOCGNAME(sizeof(name)), name);
+        g_Logger.Info("Device name: ", name);
+    }
+    
+    m_bDeviceOpen = true;
+    m_Stats.deviceOpen->Set(1);
+    return true;
+}
+
+/**
+ * Demande des horodatages CLOCK_MONOTONIC sur le descripteur de lecture :
+ * même base que le thread de force, insensible aux corrections NTP.
+ */
+void ForceEffectSimulator::SetEventClock()
+{
+    int clockId = CLOCK_MONOTONIC;
+    m_bMonotonicEvents = m_JoystickFd >= 0 && ioctl(m_JoystickFd, EVIOCSCLOCKID, &clockId) == 0;
+    if (m_JoystickFd >= 0 && !m_bMonotonicEvents)
+    {
+        g_Logger.Warning("EVIOCSCLOCKID refusé (", strerror(errno), "), horodatages CLOCK_REALTIME convertis à la lecture");
+    }
+}
+
+/**
+ * Vérifie et configure les capacités force feedback.
+ */
+bool ForceEffectSimulator::SetupForceFeedback()
+{
+    // Sondage uniquement si le cache n'a rien fourni
+    if (!m_bCapsFromCache)
+    {
+        if (!m_Startup.Measure("ProbeCapabilities", [this]() { return ProbeCapabilities(); }))
+        {
+            return false;
+        }
+        
+        if (m_bHaveIdentity)
+        {
+            m_CapsCache.Store(m_DeviceIdentity, m_Caps);
+            if (!m_CapsCache.Save())
+            {
+                g_Logger.Debug("Impossible d'écrire le cache de capacités");
+            }
+        }
+    }
+    
+    g_Logger.Info("Effets FF simultanés supportés: ", m_Caps.maxEffects);
+    
+    g_Logger.Debug("Types d'effets supportés:");
+    if (m_Caps.HasFFBit(FF_CONSTANT))
+        g_Logger.Debug("  - FF_CONSTANT");
+    if (m_Caps.HasFFBit(FF_PERIODIC))
+        g_Logger.Debug("  - FF_PERIODIC");
+    if (m_Caps.HasFFBit(FF_RAMP))
+        g_Logger.Debug("  - FF_RAMP");
+    if (m_Caps.HasFFBit(FF_SPRING))
+        g_Logger.Debug("  - FF_SPRING");
+    if (m_Caps.HasFFBit(FF_DAMPER))
+        g_Logger.Debug("  - FF_DAMPER");
+    
+    const AxisRange& steering = m_Caps.axes[0];
+    g_Logger.Debug("Axe volant: [", steering.minimum, ", ", steering.maximum, "]");
+    
+    m_Startup.Measure("DisableAutocenter", [this]() { DisableAutocenter(); });
+    
+    return true;
+}
+
+/**
+ * Interroge le device : nombre d'effets simultanés, types d'effets et
+ * plages des axes. Le résultat est placé dans m_Caps.
+ */
+bool ForceEffectSimulator::ProbeCapabilities()
+{
+    DeviceCapabilities caps;
+    
+    // Vérification du nombre d'effets simultanés
+    int n_effects = 0;
+    if (ioctl(m_DeviceFd, EVIOCGEFFECTS, &n_effects) < 0)
+    {
+        g_Logger.Error("EVIOCGEFFECTS failed");
+        return false;
+    }
+    caps.maxEffects = n_effects;
+    
+    // Vérification des types d'effets supportés
+    unsigned long features[FF_BITMAP_LONGS];
+    memset(features, 0, sizeof(features));
+    ioctl(m_DeviceFd, EVIOCGBIT(EV_FF, sizeof(features)), features);
+    caps.SetFFBits(features, FF_BITMAP_LONGS);
+    
+    // Plages des axes (volant et pédales)
+    for (size_t i = 0; i < CACHED_AXIS_COUNT; i++)
+    {
+        struct input_absinfo absinfo;
+        memset(&absinfo, 0, sizeof(absinfo));
+        if (ioctl(m_DeviceFd, EVIOCGABS(CACHED_AXES[i]), &absinfo) >= 0)
+        {
+            caps.axes[i].minimum = absinfo.minimum;
+            caps.axes[i].maximum = absinfo.maximum;
+            caps.axes[i].fuzz = absinfo.fuzz;
+            caps.axes[i].flat = absinfo.flat;
+        }
+    }
+    
+    m_Caps = caps;
+    return true;
+}
+
+/**
+ * Monte la cadence des mises à jour d'un effet de test jusqu'à ce que le
+ * device ne suive plus (RateCalibration.h), puis mémorise la dernière
+ * cadence soutenable dans le cache du device.
+ */
+bool ForceEffectSimulator::CalibrateUpdateRate()
+{
+    g_Logger.Info("Calibration de la cadence de mise à jour (le volant vibre légèrement)...");
+    
+    RateCalibrator calibrator;
+    RateCalibrationResult result;
+    if (!calibrator.Run(m_DeviceFd, result))
+    {
+        g_Logger.Error("  Effet de test impossible: ", strerror(result.lastErrno));
+        return false;
+    }
+    
+    for (const RateCalibrationStep& step : result.steps)
+    {
+        g_Logger.Info("  ", step.rateHz, " Hz: EVIOCSFF p50 ", step.p50Ns / 1000, " µs, p99 ",
+                      step.p99Ns / 1000, " µs, retard max ", step.maxLatenessNs / 1000, " µs, erreurs ",
+                      step.errors, "/", step.updates, step.bSustained ? "" : " -> non soutenable");
+    }
+    
+    if (result.rateHz == 0)
+    {
+        g_Logger.Error("  Aucune cadence soutenable (dernière erreur: ", strerror(result.lastErrno), ")");
+        return false;
+    }
+    
+    m_Caps.updateRateHz = result.rateHz;
+    m_Caps.updateP99Us = static_cast<uint32_t>(result.p99Ns / 1000);
+    g_Logger.Success("Cadence soutenable: ", result.rateHz, " Hz (p99 ", m_Caps.updateP99Us, " µs)");
+    
+    if (m_bHaveIdentity)
+    {
+        m_CapsCache.Store(m_DeviceIdentity, m_Caps);
+        if (!m_CapsCache.Save())
+        {
+            g_Logger.Warning("Impossible d'écrire la calibration dans le cache");
+        }
+    }
+    return true;
+}
+
+/**
+ * Cadence max de l'étage de sortie : celle calibrée pour ce device, sauf
+ * si --output-rate l'impose.
+ */
+void ForceEffectSimulator::ApplyUpdateRate()
+{
+    if (m_Caps.updateRateHz == 0)
+    {
+        if (m_bSoftwareRender && m_bAutoOutputRate)
+        {
+            g_Logger.Debug("Device non calibré (--calibrate) : cadence de sortie par défaut");
+        }
+        return;
+    }
+    
+    g_Logger.Info("Cadence calibrée du device: ", m_Caps.updateRateHz, " Hz (p99 ", m_Caps.updateP99Us, " µs)");
+    if (m_bAutoOutputRate)
+    {
+        OutputStageParams params = m_OutputStage.GetParams();
+        params.minIntervalNs = 1000000000LL / m_Caps.updateRateHz;
+        m_OutputStage.SetParams(params);
+    }
+}
+
+/**
+ * Avance de la prédiction : latence de sortie (p99 calibré d'EVIOCSFF, ou
+ * valeur par défaut) plus la moitié de l'intervalle de l'étage de sortie.
+ * La latence d'entrée est déjà couverte par l'horodatage des événements.
+ */
+void ForceEffectSimulator::ConfigurePrediction()
+{
+    if (m_PredictLeadNs < 0)
+    {
+        const int64_t outputNs = m_Caps.updateRateHz
+            ? static_cast<int64_t>(m_Caps.updateP99Us) * 1000
+            : PREDICT_DEFAULT_OUTPUT_NS;
+        m_PredictLeadNs = outputNs + m_OutputStage.GetParams().minIntervalNs / 2;
+    }
+    g_Logger.Info("Prédiction du volant: avance de ", m_PredictLeadNs / 1000, " µs");
+}
+
+/**
+ * Désactive l'autocenter pour avoir le contrôle total.
+ */
+void ForceEffectSimulator::DisableAutocenter()
+{
+    struct input_event ie;
+    ie.type = EV_FF;
+    ie.code = FF_AUTOCENTER;
+    ie.value = 0;
+    if (write(m_DeviceFd, &ie, sizeof(ie)) != sizeof(ie))
+    {
+        g_Logger.Warning("Impossible de désactiver l'autocenter");
+    }
+    else
+    {
+        g_Logger.Info("Autocenter désactivé (sera réactivé automatiquement lors de l'arrêt des effets)");
+    }
+}
+
+bool ForceEffectSimulator::CreateAllEffects()
+{
+    g_Logger.Info("Création des effets...");
+    
+    bool success = true;
+    
+    // Bibliothèque intégrée (ff_effect construits à la compilation)
+    for (const EffectPreset& preset : BUILTIN_EFFECTS)
+    {
+        success &= CreateEffect(preset);
+    }
+    
+    g_Logger.Info("Effets créés: ", m_Effects.size());
+    
+    if (m_bSoftwareRender)
+    {
+        success &= m_Startup.Measure("CreateOutputEffect", [this]() { return CreateOutputEffect(); });
+    }
+    
+    // Construction de la liste des noms pour navigation
+    for (const auto& pair : m_Effects)
+    {
+        m_EffectNames.push_back(pair.first);
+    }
+    
+    // Accès par index de préréglage (protocole de contrôle, mémoire partagée)
+    m_PresetEffects.clear();
+    for (const EffectPreset& preset : BUILTIN_EFFECTS)
+    {
+        auto it = m_Effects.find(preset.name);
+        m_PresetEffects.push_back(it != m_Effects.end() ? &it->second : nullptr);
+    }
+    
+    return success && !m_Effects.empty();
+}
+
+/**
+ * Envoie un préréglage au kernel. Seul l'ID est renseigné à l'exécution.
+ */
+bool ForceEffectSimulator::CreateEffect(const EffectPreset& preset)
+{
+    struct ff_effect effect = preset.effect;
+    
+    // En rendu logiciel, l'effet reste en userspace : ID local
+    if (m_bSoftwareRender)
+    {
+        effect.id = static_cast<int16_t>(m_Effects.size());
+    }
+    else if (m_Startup.Measure(preset.name, [&]() { return ioctl(m_DeviceFd, EVIOCSFF, &effect); }, "ioctl") < 0)
+    {
+        m_Stats.uploadErrors->Add();
+        g_Logger.Error("  Erreur création effet ", preset.name, ": ", strerror(errno));
+        return false;
+    }
+    
+    m_Effects[preset.name] = effect;
+    
+    switch (effect.type)
+    {
+    case FF_CONSTANT:
+        g_Logger.Info("  Effet constant créé: ", preset.name, " (Force: ", effect.u.constant.level,
+                      ", ID: ", effect.id, ")");
+        break;
+    case FF_PERIODIC:
+        g_Logger.Info("  Effet périodique créé: ", preset.name, " (Magnitude: ", effect.u.periodic.magnitude,
+                      ", Période: ", effect.u.periodic.period, "ms, ID: ", effect.id, ")");
+        break;
+    case FF_RAMP:
+        g_Logger.Info("  Effet rampe créé: ", preset.name, " (", effect.u.ramp.start_level, " -> ",
+                      effect.u.ramp.end_level, ", ID: ", effect.id, ")");
+        break;
+    default:
+        g_Logger.Info("  Effet condition créé: ", preset.name, " (Coeff: ", effect.u.condition[0].right_coeff,
+                      ", DeadBand: ", effect.u.condition[0].deadband, ", ID: ", effect.id, ")");
+        break;
+    }
+    
+    return true;
+}
+
+/**
+ * Rendu logiciel : envoie l'effet constant qui porte la force mixée et le
+ * démarre une fois pour toutes (seul son niveau change ensuite).
+ */
+bool ForceEffectSimulator::CreateOutputEffect()
+{
+    m_OutputEffect = ConstantEffect(0);
+    m_OutputStage.Reset(0, MonotonicNowNs());
+    
+    if (m_Startup.Measure("EVIOCSFF sortie", [this]() { return ioctl(m_DeviceFd, EVIOCSFF, &m_OutputEffect); }, "ioctl") < 0)
+    {
+        m_Stats.uploadErrors->Add();
+        g_Logger.Error("  Erreur création de l'effet de sortie: ", strerror(errno));
+        return false;
+    }
+    
+    struct input_event play;
+    memset(&play, 0, sizeof(play));
+    play.type = EV_FF;
+    play.code = m_OutputEffect.id;
+    play.value = 1;
+    if (write(m_DeviceFd, &play, sizeof(play)) != sizeof(play))
+    {
+        m_Stats.playErrors->Add();
+        g_Logger.Error("  Impossible de démarrer l'effet de sortie: ", strerror(errno));
+        return false;
+    }
+    
+    g_Logger.Info("  Rendu logiciel: effet de sortie constant (ID: ", m_OutputEffect.id, ")");
+    return true;
+}
+
+const struct ff_effect* ForceEffectSimulator::FindEffectById(int16_t id) const
+{
+    for (const auto& pair : m_Effects)
+    {
+        if (pair.second.id == id)
+            return &pair.second;
+    }
+    return nullptr;
+}
+
+/**
+ * Effet créé à partir du préréglage BUILTIN_EFFECTS[index], nullptr si
+ * l'index est invalide ou si sa création a échoué.
+ */
+const struct ff_effect* ForceEffectSimulator::FindPresetEffect(int16_t index) const
+{
+    if (index < 0 || static_cast<size_t>(index) >= m_PresetEffects.size())
+        return nullptr;
+    return m_PresetEffects[index];
+}
+
+/**
+ * Boucle principale du simulateur.
+ */
+void ForceEffectSimulator::Run()
+{
+    if (m_Effects.empty())
+    {
+        std::cerr << "Aucun effet disponible" << std::endl;
+        return;
+    }
+    
+    m_bRunning = true;
+    
+    // Configuration du terminal en mode raw
+    m_TerminalMode.SetRaw();
+    
+    // Démarrage des threads de mise à jour, de force et de contrôle
+    m_UpdateThread = std::thread(&ForceEffectSimulator::UpdateLoop, this);
+    StartForceThread();
+    StartControlThread();
+    
+    // Démarrage de la surveillance hotplug
+    if (m_HotplugMonitor.Open())
+    {
+        m_HotplugThread = std::thread(&ForceEffectSimulator::HotplugLoop, this);
+    }
+    else
+    {
+        g_Logger.Warning("Surveillance hotplug indisponible: ", strerror(errno));
+    }
+    
+    DisplayHelp();
+    DisplayStatus();
+    
+    // Boucle principale d'interface utilisateur
+    while (m_bRunning)
+    {
+        if (kbhit())
+        {
+            char key;
+            read(STDIN_FILENO, &key, 1);
+            
+            switch (key)
+            {
+            case 27: // ESC
+                if (m_bShowingHelp)
+                {
+                    m_bShowingHelp = false;
+                }
+                else
+                {
+                    m_bRunning = false;
+                }
+                break;
+                
+            case ' ': // SPACE
+                if (!m_bShowingHelp)
+                {
+                    if (m_bEffectPlaying)
+                        StopCurrentEffect();
+                    else
+                        PlayCurrentEffect();
+                }
+                break;
+                
+            case 's':
+            case 'S':
+                if (!m_bShowingHelp)
+                {
+                    StopAllEffects();
+                }
+                break;
+                
+            case 'n':
+            case 'N':
+                if (!m_bShowingHelp)
+                {
+                    NextEffect();
+                }
+                break;
+                
+            case 'p':
+            case 'P':
+                if (!m_bShowingHelp)
+                {
+                    PreviousEffect();
+                }
+                break;
+                
+            case '+':
+            case '=':
+                if (!m_bShowingHelp)
+                {
+                    AdjustIntensity(2000);
+                }
+                break;
+                
+            case '-':
+            case '_':
+                if (!m_bShowingHelp)
+                {
+                    AdjustIntensity(-2000);
+                }
+                break;
+                
+            case 'h':
+            case 'H':
+                m_bShowingHelp = !m_bShowingHelp;
+                break;
+            }
+            
+            // Affichage conditionnel
+            if (m_bShowingHelp)
+            {
+                DisplayHelp();
+            }
+            else
+            {
+                DisplayStatus();
+            }
+        }
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    
+    // Arrêt propre
+    StopControlThread();
+    StopForceThread();
+    StopAllEffects();
+    
+    if (m_UpdateThread.joinable())
+    {
+        m_UpdateThread.join();
+    }
+    
+    if (m_HotplugThread.joinable())
+    {
+        m_HotplugThread.join();
+    }
+}
+
+/**
+ * Thread de lecture : bloque sur le descripteur du volant (poll) et lit
+ * chaque trame dès sa livraison par le kernel ; la latence d'entrée mesure
+ * cette livraison, pas une période d'échantillonnage. Sans événement, le
+ * réveil toutes les UPDATE_INTERVAL ms maintient le filtre d'axe (Hold) et
+ * voit l'arrêt.
+ */
+void ForceEffectSimulator::UpdateLoop()
+{
+    while (m_bRunning)
+    {
+        int fd;
+        {
+            std::lock_guard<std::mutex> lock(m_DeviceMutex);
+            fd = m_JoystickFd;
+        }
+        
+        // Volant déconnecté : le hotplug rouvrira le nœud
+        if (fd < 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(UPDATE_INTERVAL));
+            continue;
+        }
+        
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        const int ready = poll(&pfd, 1, UPDATE_INTERVAL);
+        UpdateDeviceState();
+        
+        // Nœud retiré : POLLHUP/POLLERR jusqu'à sa fermeture par le thread hotplug
+        if (ready > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(UPDATE_INTERVAL));
+        }
+    }
+}
+
+/**
+ * Met à jour l'état du périphérique (lecture des axes/boutons).
+ */
+void ForceEffectSimulator::UpdateDeviceState()
+{
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    
+    if (m_JoystickFd < 0) return;
+    
+    // Sans EVIOCSCLOCKID, horodatages CLOCK_REALTIME ramenés sur l'horloge monotone
+    const int64_t nowNs = MonotonicNowNs();
+    const int64_t clockOffsetNs = m_bMonotonicEvents ? 0 : nowNs - RealtimeNowNs();
+    
+    struct input_event ev;
+    uint64_t count = 0;
+    bool bSteeringChanged = false;   // ABS_X reçu dans la trame en cours
+    bool bSteeringFrame = false;     // Au moins une trame avec ABS_X lue
+    while (read(m_JoystickFd, &ev, sizeof(ev)) == sizeof(ev))
+    {
+        ApplyInputEvent(m_Input, ev);
+        if (ev.type == EV_ABS && ev.code == ABS_X)
+        {
+            bSteeringChanged = true;
+        }
+        else if (ev.type == EV_SYN && ev.code == SYN_REPORT)
+        {
+            // Latence kernel -> userspace (attente de la lecture comprise)
+            const int64_t frameNs = EventTimeNs(ev) + clockOffsetNs;
+            const int64_t latencyNs = std::max<int64_t>(MonotonicNowNs() - frameNs, 0);
+            m_InputLatency.Record(latencyNs);
+            m_Stats.inputLatency->Observe(latencyNs);
+            m_Input.timestampNs = frameNs;
+        }
+        
+        if (ev.type == EV_SYN && ev.code == SYN_REPORT && bSteeringChanged)
+        {
+            // Une mise à jour par trame, à l'horodatage de la trame
+            const int64_t frameNs = m_Input.timestampNs;
+            if (m_PendingInputNs == 0)
+            {
+                m_PendingInputNs = frameNs;
+            }
+            const int32_t position = NormalizeAxis(m_Input.steering, m_Caps.axes[0].minimum, m_Caps.axes[0].maximum);
+            m_SteeringFilter.Update(frameNs, position);
+            if (m_bPredict)
+            {
+                m_Predictor.Update(frameNs, position);
+            }
+            bSteeringChanged = false;
+            bSteeringFrame = true;
+        }
+        count++;
+    }
+    m_Stats.inputEvents->Add(count);
+    
+    // Aucun événement : le volant n'a pas bougé jusqu'à maintenant
+    if (!bSteeringFrame)
+    {
+        m_SteeringFilter.Hold(nowNs, NormalizeAxis(m_Input.steering, m_Caps.axes[0].minimum, m_Caps.axes[0].maximum));
+    }
+    m_Input.steeringPosition = m_SteeringFilter.GetPosition();
+    m_Input.steeringVelocity = m_SteeringFilter.GetVelocity();
+    m_Input.steeringAcceleration = m_SteeringFilter.GetAcceleration();
+}
+
+/**
+ * Thread hotplug : attend les uevents du kernel et gère le retrait et le
+ * retour du volant sans redémarrer le programme.
+ */
+void ForceEffectSimulator::HotplugLoop()
+{
+    UeventMessage msg;
+    
+    while (m_bRunning)
+    {
+        if (!m_HotplugMonitor.WaitEvent(HOTPLUG_POLL_INTERVAL, msg))
+            continue;
+        
+        if (msg.subsystem != "input")
+            continue;
+        
+        std::string eventName = msg.GetEventName();
+        if (eventName.empty())
+            continue;
+        
+        // L'état du device est relu sous m_DeviceMutex par les handlers
+        if (msg.action == "remove")
+        {
+            HandleDeviceRemoved(eventName);
+        }
+        else if (msg.action == "add")
+        {
+            HandleDeviceArrived(eventName);
+        }
+    }
+    
+    m_HotplugMonitor.Close();
+}
+
+/**
+ * Le nœud a disparu : s'il s'agit du device ouvert, les descripteurs sont
+ * fermés, les effets (et l'état de lecture) sont conservés pour être
+ * restaurés à la reconnexion.
+ */
+void ForceEffectSimulator::HandleDeviceRemoved(const std::string& eventName)
+{
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    
+    if (!m_bDeviceOpen || m_DevicePath != "/dev/input/" + eventName)
+    {
+        return;
+    }
+    
+    if (m_JoystickFd >= 0)
+    {
+        close(m_JoystickFd);
+        m_JoystickFd = -1;
+    }
+    
+    if (m_DeviceFd >= 0)
+    {
+        close(m_DeviceFd);
+        m_DeviceFd = -1;
+    }
+    
+    m_bDeviceOpen = false;
+    m_Stats.deviceOpen->Set(0);
+    m_Predictor.Reset();
+    m_SteeringFilter.Reset();
+    m_PendingInputNs = 0;
+    m_Input.steeringVelocity = 0;
+    m_Input.steeringAcceleration = 0;
+    g_Logger.Warning("Volant déconnecté (", m_DevicePath, "), en attente de reconnexion...");
+}
+
+/**
+ * Un nœud eventX est apparu : s'il s'agit du Sidewinder et qu'aucun device
+ * n'est ouvert, il est rouvert et les effets ainsi que l'effet en cours
+ * sont restaurés.
+ */
+bool ForceEffectSimulator::HandleDeviceArrived(const std::string& eventName)
+{
+    auto start = std::chrono::steady_clock::now();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_DeviceMutex);
+        if (m_bDeviceOpen)
+        {
+            return false;
+        }
+    }
+    
+    // Identification via sysfs, sans ouvrir le nœud
+    SysfsInputDevice device;
+    if (!ReadSysfsInputDevice(SYSFS_INPUT_CLASS, eventName, device) ||
+        !IsSidewinderIdentity(device.name.c_str(), device.vendor, device.product))
+    {
+        return false;
+    }
+    
+    ReadSysfsCapabilities(SYSFS_INPUT_CLASS, device);
+    if (!device.HasFF())
+    {
+        return false;
+    }
+    
+    // udev peut appliquer les permissions juste après l'uevent kernel ;
+    // attente hors verrou : le rendu, le séquenceur et l'interface continuent
+    int fd = -1;
+    auto deadline = start + std::chrono::milliseconds(HOTPLUG_OPEN_TIMEOUT);
+    while ((fd = open(device.devNode.c_str(), O_RDWR)) < 0 &&
+           (errno == EACCES || errno == ENOENT) &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    
+    if (fd < 0)
+    {
+        g_Logger.Error("Reconnexion: impossible d'ouvrir ", device.devNode, " (", strerror(errno), ")");
+        return false;
+    }
+    
+    const int joystickFd = open(device.devNode.c_str(), O_RDONLY | O_NONBLOCK);
+    if (joystickFd < 0)
+    {
+        g_Logger.Error("Reconnexion: impossible d'ouvrir ", device.devNode, " en lecture (", strerror(errno), ")");
+        close(fd);
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    
+    // Ouvert entre-temps par un autre chemin
+    if (m_bDeviceOpen)
+    {
+        close(joystickFd);
+        close(fd);
+        return false;
+    }
+    
+    m_DeviceFd = fd;
+    m_JoystickFd = joystickFd;
+    SetEventClock();
+    m_DevicePath = device.devNode;
+    m_bDeviceOpen = true;
+    m_Stats.deviceOpen->Set(1);
+    
+    DisableAutocenter();
+    
+    if (!UploadAllEffects())
+    {
+        g_Logger.Warning("Reconnexion: certains effets n'ont pas pu être restaurés");
+    }
+    
+    // Reprise de l'effet en cours au moment de la déconnexion (en rendu
+    // logiciel, les couches n'ont pas quitté l'userspace)
+    if (!m_bSoftwareRender && m_bEffectPlaying && !m_EffectNames.empty())
+    {
+        auto it = m_Effects.find(m_EffectNames[m_CurrentEffectIndex]);
+        if (it != m_Effects.end())
+        {
+            struct input_event play;
+            memset(&play, 0, sizeof(play));
+            play.type = EV_FF;
+            play.code = it->second.id;
+            play.value = 1;
+            if (write(m_DeviceFd, &play, sizeof(play)) != sizeof(play))
+            {
+                m_Stats.playErrors->Add();
+                g_Logger.Warning("Reconnexion: reprise de ", it->first, " impossible");
+                m_bEffectPlaying = false;
+            }
+        }
+    }
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    g_Logger.Success("Volant reconnecté sur ", m_DevicePath, " en ", elapsed.count(), " µs (",
+                     m_Effects.size(), " effets restaurés)");
+    return true;
+}
+
+/**
+ * Réenvoie au kernel tous les effets connus (les IDs de l'ancien nœud ne
+ * sont plus valides). Doit être appelé avec m_DeviceMutex verrouillé.
+ */
+bool ForceEffectSimulator::UploadAllEffects()
+{
+    if (m_bSoftwareRender)
+    {
+        return CreateOutputEffect();
+    }
+    
+    bool success = true;
+    
+    for (auto& pair : m_Effects)
+    {
+        pair.second.id = -1;
+        if (ioctl(m_DeviceFd, EVIOCSFF, &pair.second) < 0)
+        {
+            m_Stats.uploadErrors->Add();
+            g_Logger.Error("  Erreur restauration effet ", pair.first, ": ", strerror(errno));
+            success = false;
+        }
+    }
+    
+    return success;
+}
+
+void ForceEffectSimulator::PlayCurrentEffect()
+{
+    if (m_EffectNames.empty()) return;
+    
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    
+    StopAllEffectsLocked();
+    
+    const std::string& effectName = m_EffectNames[m_CurrentEffectIndex];
+    auto it = m_Effects.find(effectName);
+    
+    if (it != m_Effects.end())
+    {
+        if (!SetEffectPlaying(it->second, true))
+        {
+            g_Logger.Error("Erreur lors de la lecture de l'effet: ", strerror(errno));
+        }
+        else
+        {
+            m_bEffectPlaying = true;
+            m_EffectStartTime = std::chrono::steady_clock::now();
+            g_Logger.Success(">>> EFFET JOUÉ: ", effectName, " <<<");
+        }
+    }
+}
+
+void ForceEffectSimulator::StopCurrentEffect()
+{
+    if (m_EffectNames.empty()) return;
+    
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    
+    const std::string& effectName = m_EffectNames[m_CurrentEffectIndex];
+    auto it = m_Effects.find(effectName);
+    
+    if (it != m_Effects.end())
+    {
+        SetEffectPlaying(it->second, false);
+        m_bEffectPlaying = false;
+        g_Logger.Info(">>> EFFET ARRÊTÉ <<<");
+    }
+}
+
+void ForceEffectSimulator::StopAllEffects()
+{
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    StopAllEffectsLocked();
+}
+
+void ForceEffectSimulator::StopAllEffectsLocked()
+{
+    const int64_t nowNs = MonotonicNowNs();
+    m_bEffectPlaying = false;
+    NoteAllEffectsStopped(nowNs);
+    
+    if (m_bSoftwareRender)
+    {
+        m_Renderer.ReleaseAll(nowNs);
+        return;
+    }
+    
+    for (auto& pair : m_Effects)
+    {
+        struct input_event stop;
+        stop.type = EV_FF;
+        stop.code = pair.second.id;
+        stop.value = 0;
+        m_Stats.playCommands->Add();
+        if (write(m_DeviceFd, &stop, sizeof(stop)) != sizeof(stop))
+            m_Stats.playErrors->Add();
+    }
+}
+
+/**
+ * Démarre ou arrête un effet : écriture EV_FF, ou couche du rendu logiciel
+ * (l'arrêt déclenche alors la relâche de l'enveloppe au lieu d'une coupure).
+ * Doit être appelé avec m_DeviceMutex verrouillé.
+ */
+bool ForceEffectSimulator::SetEffectPlaying(const struct ff_effect& effect, bool bPlay)
+{
+    const int64_t nowNs = MonotonicNowNs();
+    bool success;
+    
+    if (m_bSoftwareRender)
+    {
+        if (bPlay)
+        {
+            success = m_Renderer.Start(effect, EnvelopeFromEffect(effect), nowNs);
+        }
+        else
+        {
+            m_Renderer.Release(effect.id, nowNs);
+            success = true;
+        }
+    }
+    else
+    {
+        struct input_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.type = EV_FF;
+        ev.code = effect.id;
+        ev.value = bPlay ? 1 : 0;
+        m_Stats.playCommands->Add();
+        success = write(m_DeviceFd, &ev, sizeof(ev)) == sizeof(ev);
+        if (!success)
+            m_Stats.playErrors->Add();
+    }
+    
+    if (success && bPlay)
+        NoteEffectStarted(effect.id, nowNs);
+    else if (success)
+        NoteEffectStopped(effect.id, nowNs);
+    return success;
+}
+
+/**
+ * Applique un niveau à une copie d'effet : niveau pour un effet constant,
+ * magnitude pour un périodique, niveau de fin pour une rampe, coefficients
+ * pour une condition.
+ */
+void ForceEffectSimulator::ApplyEffectLevel(struct ff_effect& effect, int32_t level)
+{
+    // Plage symétrique : |-32768| ne tiendrait pas dans une magnitude int16
+    int16_t value = static_cast<int16_t>(fixp::Clamp(level, -fixp::Q15_MAX, fixp::Q15_MAX));
+    
+    switch (effect.type)
+    {
+    case FF_CONSTANT:
+        effect.u.constant.level = value;
+        break;
+    case FF_PERIODIC:
+        effect.u.periodic.magnitude = static_cast<int16_t>(fixp::Abs(value));
+        break;
+    case FF_RAMP:
+        effect.u.ramp.end_level = value;
+        break;
+    default:
+        effect.u.condition[0].right_coeff = value;
+        effect.u.condition[0].left_coeff = value;
+        break;
+    }
+}
+
+/**
+ * Compile le script en événements du séquenceur (échéances absolues
+ * CLOCK_MONOTONIC), puis laisse le thread de force les envoyer par lots.
+ * Les instants d'envoi sont relevés par le thread de force et journalisés
+ * après l'exécution, afin que l'écriture du log ne perturbe pas
+ * l'ordonnancement.
+ */
+int ForceEffectSimulator::RunScript(const EffectScript& script, int64_t toleranceUs)
+{
+    const std::vector<ScriptStep>& steps = script.GetSteps();
+    
+    // Tous les effets référencés doivent exister avant de démarrer
+    for (const ScriptStep& step : steps)
+    {
+        if (!step.effectName.empty() && m_Effects.find(step.effectName) == m_Effects.end())
+        {
+            g_Logger.Error("Script: effet inconnu '", step.effectName, "' (ligne ", step.lineNumber, ")");
+            return EXIT_SCRIPT_ERROR;
+        }
+    }
+    
+    g_Logger.Info("Exécution du script: ", steps.size(), " étapes, durée prévue ",
+                  script.GetDurationNs() / 1000000, " ms");
+    
+    // Les niveaux successifs s'appliquent à une copie de travail de chaque effet
+    std::map<std::string, struct ff_effect> working = m_Effects;
+    std::vector<TimelineResult> results(steps.size(), TimelineResult{0, false});
+    std::vector<TimelineEvent> events(steps.size());
+    
+    const int64_t startNs = MonotonicNowNs() + SCRIPT_START_LEAD_NS;
+    
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        const ScriptStep& step = steps[i];
+        TimelineEvent& event = events[i];
+        memset(&event, 0, sizeof(event));
+        event.dueNs = startNs + step.plannedNs;
+        event.result = &results[i];
+        
+        if (!step.effectName.empty())
+            event.effectId = working[step.effectName].id;
+        
+        switch (step.action)
+        {
+        case ScriptAction::Start:
+            event.action = TimelineAction::Start;
+            break;
+        case ScriptAction::Stop:
+            event.action = TimelineAction::Stop;
+            break;
+        case ScriptAction::StopAll:
+            event.action = TimelineAction::StopAll;
+            break;
+        case ScriptAction::SetLevel:
+            event.action = TimelineAction::Update;
+            ApplyEffectLevel(working[step.effectName], step.value);
+            event.effect = working[step.effectName];
+            break;
+        }
+    }
+    
+    m_bRunning = true;
+    StartForceThread();
+    m_Timeline.ScheduleBatch(events);
+    
+    // Rattrapage des attentes finales (wait en fin de script), puis attente
+    // des événements encore en file si le device a pris du retard
+    SleepUntilNs(startNs + script.GetDurationNs());
+    while (m_Timeline.GetPendingCount() > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    
+    // Le join garantit que le dernier lot est envoyé et ses résultats visibles
+    StopForceThread();
+    StopAllEffects();
+    
+    // Rapport : prévu / réel / écart pour chaque étape
+    int64_t maxErrorNs = 0;
+    int64_t totalErrorNs = 0;
+    size_t lateSteps = 0;
+    size_t failedSteps = 0;
+    
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        const ScriptStep& step = steps[i];
+        const TimelineResult& result = results[i];
+        const int64_t actualNs = result.dispatchNs - startNs;
+        const int64_t errorNs = actualNs - step.plannedNs;
+        
+        maxErrorNs = std::max(maxErrorNs, std::abs(errorNs));
+        totalErrorNs += std::abs(errorNs);
+        if (std::abs(errorNs) > toleranceUs * 1000)
+            lateSteps++;
+        if (!result.success)
+            failedSteps++;
+        
+        g_Logger.Info("[script] ligne ", step.lineNumber, " ", ScriptActionName(step.action), " ",
+                      step.effectName, step.action == ScriptAction::SetLevel ? " " + std::to_string(step.value) : "",
+                      " | prévu ", step.plannedNs / 1000, " µs, réel ", actualNs / 1000,
+                      " µs, écart ", errorNs / 1000, " µs",
+                      result.success ? "" : " [ÉCHEC]");
+    }
+    
+    g_Logger.Info("Script terminé: écart max ", maxErrorNs / 1000, " µs, moyen ",
+                  steps.empty() ? 0 : totalErrorNs / 1000 / static_cast<int64_t>(steps.size()),
+                  " µs, ", lateSteps, " étape(s) hors tolérance (", toleranceUs, " µs), ",
+                  failedSteps, " échec(s)");
+    
+    if (failedSteps > 0)
+        return EXIT_SCRIPT_FAILED;
+    if (lateSteps > 0)
+        return EXIT_SCRIPT_LATE;
+    return EXIT_SCRIPT_OK;
+}
+
+//==============================================================================
+// THREAD DE FORCE (SÉQUENCEUR)
+//==============================================================================
+
+void ForceEffectSimulator::StartForceThread()
+{
+    if (!m_ForceThread.joinable())
+    {
+        m_ForceThread = std::thread(&ForceEffectSimulator::ForceLoop, this);
+    }
+}
+
+/**
+ * Arrête le thread de force ; les événements non échus sont abandonnés.
+ */
+void ForceEffectSimulator::StopForceThread()
+{
+    m_bRunning = false;
+    m_Timeline.Wake();
+    
+    if (m_ForceThread.joinable())
+    {
+        m_ForceThread.join();
+    }
+    m_Timeline.Clear();
+}
+
+/**
+ * Thread de force : attend la prochaine échéance du séquenceur, puis
+ * envoie d'un coup tous les événements échus.
+ */
+void ForceEffectSimulator::ForceLoop()
+{
+    int64_t nextRenderNs = MonotonicNowNs() + RENDER_PERIOD_NS;
+    
+    while (m_bRunning)
+    {
+        // En rendu logiciel, l'attente est bornée par le prochain tick
+        int64_t maxWaitNs = FORCE_THREAD_MAX_WAIT_NS;
+        if (m_bSoftwareRender)
+        {
+            maxWaitNs = std::max<int64_t>(nextRenderNs - MonotonicNowNs(), 0);
+        }
+        
+        if (m_Timeline.WaitForDue(m_bRunning, maxWaitNs))
+        {
+            DispatchDueEvents(MonotonicNowNs());
+        }
+        
+        const int64_t nowNs = MonotonicNowNs();
+        if (m_bSoftwareRender && nowNs >= nextRenderNs)
+        {
+            m_Stats.renderLateness->Observe(nowNs - nextRenderNs);
+            
+            if (m_Shared.IsOpen())
+            {
+                DrainSharedCommands(nowNs);
+            }
+            RenderTick(nowNs);
+            
+            // Ticks manqués abandonnés plutôt que rattrapés en rafale
+            nextRenderNs += RENDER_PERIOD_NS;
+            if (nextRenderNs <= nowNs)
+            {
+                m_Stats.renderMisses->Add(static_cast<uint64_t>((nowNs - nextRenderNs) / RENDER_PERIOD_NS) + 1);
+                nextRenderNs = nowNs + RENDER_PERIOD_NS;
+            }
+        }
+    }
+}
+
+/**
+ * Retire du séquenceur les événements échus à nowNs et les envoie en un lot.
+ * @return nombre d'événements envoyés.
+ */
+size_t ForceEffectSimulator::DispatchDueEvents(int64_t nowNs)
+{
+    m_DispatchBatch.clear();
+    const size_t count = m_Timeline.PopDue(nowNs, m_DispatchBatch);
+    if (count > 0)
+    {
+        DispatchTimelineBatch(m_DispatchBatch);
+    }
+    return count;
+}
+
+/**
+ * Tick du rendu logiciel : mixe les couches actives et reporte la force
+ * sur l'effet de sortie, à travers l'étage de sortie (seuil, cadence, pente).
+ */
+void ForceEffectSimulator::RenderTick(int64_t nowNs)
+{
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    
+    // Position mesurée, ou extrapolée à l'instant où la force atteindra le moteur
+    const int32_t measured = NormalizeAxis(m_Input.steering, m_Caps.axes[0].minimum, m_Caps.axes[0].maximum);
+    AxisState axis;
+    axis.position = m_bPredict && m_Predictor.HasSample() ? m_Predictor.Predict(nowNs + m_PredictLeadNs) : measured;
+    axis.velocity = m_Input.steeringVelocity;
+    axis.acceleration = m_Input.steeringAcceleration;
+    
+    int32_t force = m_Renderer.Render(nowNs, axis);
+    if (m_bSteeringPhysics)
+    {
+        force = fixp::SaturateQ15(force + m_Steering.Step(axis.position));
+    }
+    if (m_Shared.IsOpen())
+    {
+        force = fixp::SaturateQ15(force + m_ExternalForce);
+        PublishSharedState(nowNs, measured, force);
+    }
+    m_RenderedForce = force;
+    m_Stats.renderTicks->Add();
+    m_Stats.renderedForce->Set(force);
+    m_Stats.activeLayers->Set(__builtin_popcount(m_Renderer.GetActiveMask()));
+    
+    if (m_bDeviceOpen)
+    {
+        UpdateOutputEffect(force, nowNs);
+    }
+    
+    // Latence événement -> force : la plus ancienne trame pas encore rendue
+    const int64_t endNs = MonotonicNowNs();
+    if (m_PendingInputNs != 0)
+    {
+        const int64_t latencyNs = std::max<int64_t>(endNs - m_PendingInputNs, 0);
+        m_InputToForce.Record(latencyNs);
+        m_Stats.inputToForce->Observe(latencyNs);
+        m_PendingInputNs = 0;
+    }
+    
+    m_Stats.renderDuration->Observe(endNs - nowNs);
+}
+
+/**
+ * Passe la force rendue par l'étage de sortie et ne met à jour l'effet de
+ * sortie que si l'étage le décide. m_DeviceMutex verrouillé.
+ */
+void ForceEffectSimulator::UpdateOutputEffect(int32_t force, int64_t nowNs)
+{
+    int16_t level = 0;
+    switch (m_OutputStage.Step(force, nowNs, level))
+    {
+    case OutputDecision::Idle:
+        return;
+    case OutputDecision::SuppressedThreshold:
+        m_Stats.outputSuppressedThreshold->Add();
+        return;
+    case OutputDecision::SuppressedRate:
+        m_Stats.outputSuppressedRate->Add();
+        return;
+    case OutputDecision::Flush:
+        m_Stats.outputFlushes->Add();
+        break;
+    case OutputDecision::Send:
+        break;
+    }
+    
+    // Pas de log ici (1 kHz) : un échec est retenté au tick suivant
+    const int16_t previous = m_OutputEffect.u.constant.level;
+    m_OutputEffect.u.constant.level = level;
+    if (ioctl(m_DeviceFd, EVIOCSFF, &m_OutputEffect) < 0)
+    {
+        m_OutputEffect.u.constant.level = previous;
+        m_Stats.uploadErrors->Add();
+        return;
+    }
+    
+    m_OutputStage.Commit(level, nowNs);
+    m_Stats.forceUpdates->Add();
+    if (m_OutputStage.IsSlewLimited())
+    {
+        m_Stats.outputSlewLimited->Add();
+    }
+}
+
+/**
+ * Dépile les commandes des clients de la mémoire partagée (au plus un lot
+ * par tick) et les envoie comme des événements échus du séquenceur.
+ */
+void ForceEffectSimulator::DrainSharedCommands(int64_t nowNs)
+{
+    m_DispatchBatch.clear();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_DeviceMutex);
+        
+        SharedCommand command;
+        while (m_DispatchBatch.size() < FORCE_BATCH_CAPACITY && m_Shared.Pop(command))
+        {
+            const SharedCommandType type = static_cast<SharedCommandType>(command.type);
+            if (type == SharedCommandType::SetForce)
+            {
+                m_ExternalForce = fixp::SaturateQ15(command.value);
+                m_SharedApplied++;
+                continue;
+            }
+            
+            TimelineEvent event;
+            memset(&event, 0, sizeof(event));
+            event.dueNs = nowNs;
+            
+            const struct ff_effect* effect = FindPresetEffect(command.effect);
+            event.effectId = effect ? effect->id : -1;
+            if (type == SharedCommandType::StopAll)
+            {
+                event.action = TimelineAction::StopAll;
+            }
+            else if (effect && type == SharedCommandType::Play)
+            {
+                event.action = TimelineAction::Start;
+            }
+            else if (effect && type == SharedCommandType::Stop)
+            {
+                event.action = TimelineAction::Stop;
+            }
+            else if (effect && type == SharedCommandType::SetLevel)
+            {
+                event.action = TimelineAction::Update;
+                event.effect = *effect;
+                ApplyEffectLevel(event.effect, command.value);
+            }
+            else
+            {
+                m_SharedRejected++;
+                continue;
+            }
+            
+            m_DispatchBatch.push_back(event);
+            m_SharedApplied++;
+        }
+    }
+    
+    if (!m_DispatchBatch.empty())
+    {
+        DispatchTimelineBatch(m_DispatchBatch);
+    }
+}
+
+/**
+ * Publie l'état courant dans le bloc seqlock de la mémoire partagée.
+ * Appelé par RenderTick, m_DeviceMutex verrouillé.
+ */
+void ForceEffectSimulator::PublishSharedState(int64_t nowNs, int32_t position, int32_t force)
+{
+    SharedState state;
+    memset(&state, 0, sizeof(state));
+    state.timestampNs = nowNs;
+    state.position = position;
+    state.steering = m_Input.steering;
+    state.pedal1 = m_Input.pedal1;
+    state.pedal2 = m_Input.pedal2;
+    state.buttons = m_Input.buttons;
+    state.force = force;
+    state.activeEffects = m_Renderer.GetActiveMask();
+    state.commandsApplied = m_SharedApplied;
+    state.commandsRejected = m_SharedRejected;
+    m_Shared.PublishState(state);
+}
+
+/**
+ * Envoie un lot d'événements sous un seul verrou. Les démarrages et arrêts
+ * consécutifs partent en un seul write() ; une mise à jour (EVIOCSFF)
+ * force l'envoi des précédents pour conserver l'ordre du lot.
+ */
+void ForceEffectSimulator::DispatchTimelineBatch(std::vector<TimelineEvent>& batch)
+{
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    
+    // Retard de chaque événement sur son échéance
+    const int64_t startNs = MonotonicNowNs();
+    for (const TimelineEvent& event : batch)
+    {
+        const int64_t latenessNs = std::max<int64_t>(startNs - event.dueNs, 0);
+        m_Stats.timelineLateness->Observe(latenessNs);
+        if (latenessNs > DEADLINE_MISS_NS)
+            m_Stats.timelineMisses->Add();
+    }
+    m_Stats.timelineEvents->Add(batch.size());
+    
+    m_PlayEvents.clear();
+    size_t groupStart = 0;
+    
+    for (size_t i = 0; i <= batch.size(); i++)
+    {
+        const bool bEnd = i == batch.size();
+        if (!bEnd && batch[i].action != TimelineAction::Update)
+        {
+            QueuePlayEvents(batch[i]);
+            continue;
+        }
+        
+        // Envoi groupé des démarrages/arrêts accumulés
+        if (groupStart < i)
+        {
+            const bool success = FlushPlayEvents();
+            const int64_t dispatchNs = MonotonicNowNs();
+            for (size_t j = groupStart; j < i; j++)
+            {
+                if (batch[j].result)
+                    *batch[j].result = TimelineResult{dispatchNs, success};
+            }
+        }
+        
+        if (bEnd)
+            break;
+        
+        TimelineEvent& event = batch[i];
+        event.effect.id = event.effectId;
+        bool success = true;
+        if (m_bSoftwareRender)
+            m_Renderer.Update(event.effect);
+        else
+        {
+            success = m_bDeviceOpen && ioctl(m_DeviceFd, EVIOCSFF, &event.effect) >= 0;
+            if (success)
+                m_Stats.forceUpdates->Add();
+            else
+                m_Stats.uploadErrors->Add();
+        }
+        if (event.result)
+            *event.result = TimelineResult{MonotonicNowNs(), success};
+        
+        if (success)
+        {
+            for (auto& pair : m_Effects)
+            {
+                if (pair.second.id == event.effectId)
+                {
+                    pair.second = event.effect;
+                    break;
+                }
+            }
+        }
+        
+        groupStart = i + 1;
+    }
+}
+
+/**
+ * Ajoute les input_event EV_FF d'un démarrage/arrêt au lot en cours
+ * (StopAll s'étend à un arrêt par effet). En rendu logiciel, les couches
+ * sont démarrées/relâchées directement.
+ */
+void ForceEffectSimulator::QueuePlayEvents(const TimelineEvent& event)
+{
+    const int64_t nowNs = MonotonicNowNs();
+    if (event.action == TimelineAction::StopAll)
+        NoteAllEffectsStopped(nowNs);
+    else if (event.action == TimelineAction::Stop)
+        NoteEffectStopped(event.effectId, nowNs);
+    else
+        NoteEffectStarted(event.effectId, nowNs);
+    
+    if (m_bSoftwareRender)
+    {
+        if (event.action == TimelineAction::StopAll)
+        {
+            m_Renderer.ReleaseAll(nowNs);
+            m_bEffectPlaying = false;
+        }
+        else if (event.action == TimelineAction::Stop)
+        {
+            m_Renderer.Release(event.effectId, nowNs);
+        }
+        else if (const struct ff_effect* effect = FindEffectById(event.effectId))
+        {
+            m_Renderer.Start(*effect, EnvelopeFromEffect(*effect), nowNs);
+        }
+        return;
+    }
+    
+
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = EV_FF;
+    
+    if (event.action == TimelineAction::StopAll)
+    {
+        for (const auto& pair : m_Effects)
+        {
+            ev.code = pair.second.id;
+            ev.value = 0;
+            m_PlayEvents.push_back(ev);
+        }
+        m_bEffectPlaying = false;
+        return;
+    }
+    
+    ev.code = event.effectId;
+    ev.value = event.action == TimelineAction::Start ? 1 : 0;
+    m_PlayEvents.push_back(ev);
+}
+
+bool ForceEffectSimulator::FlushPlayEvents()
+{
+    if (m_PlayEvents.empty())
+        return true;
+    
+    const ssize_t size = static_cast<ssize_t>(m_PlayEvents.size() * sizeof(struct input_event));
+    const bool success = m_bDeviceOpen && write(m_DeviceFd, m_PlayEvents.data(), size) == size;
+    m_Stats.playCommands->Add(m_PlayEvents.size());
+    if (!success)
+        m_Stats.playErrors->Add();
+    m_PlayEvents.clear();
+    return success;
+}
+
+//==============================================================================
+// PROTOCOLE DE CONTRÔLE
+//==============================================================================
+
+void ForceEffectSimulator::StartControlThread()
+{
+    if (m_Control.IsOpen() && !m_ControlThread.joinable())
+    {
+        m_ControlThread = std::thread(&ForceEffectSimulator::ControlLoop, this);
+    }
+}
+
+void ForceEffectSimulator::StopControlThread()
+{
+    m_bRunning = false;
+    m_Control.Wake();
+    
+    if (m_ControlThread.joinable())
+    {
+        m_ControlThread.join();
+    }
+}
+
+/**
+ * Thread de contrôle : sert toutes les connexions (epoll) et exécute
+ * chaque requête comme un lot.
+ */
+void ForceEffectSimulator::ControlLoop()
+{
+    while (m_bRunning)
+    {
+        const size_t count = m_Control.Poll(CONTROL_POLL_INTERVAL, m_ControlRequests);
+        for (size_t i = 0; i < count; i++)
+        {
+            HandleControlRequest(m_ControlRequests[i]);
+        }
+    }
+}
+
+/**
+ * Traduit les commandes d'une requête en événements échus, les envoie
+ * en un seul lot (démarrages/arrêts groupés dans un write()), puis répond
+ * avec un statut par commande.
+ */
+void ForceEffectSimulator::HandleControlRequest(const ControlRequest& request)
+{
+    const ControlHeader& header = request.header;
+    const int64_t nowNs = MonotonicNowNs();
+    int eventIndex[CONTROL_MAX_COMMANDS];
+    bool bQueryState = false;
+    
+    m_Stats.controlRequests->Add();
+    m_ControlBatch.clear();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_DeviceMutex);
+        
+        for (size_t i = 0; i < header.count; i++)
+        {
+            const ControlCommand& command = request.commands[i];
+            const ControlOp op = static_cast<ControlOp>(command.op);
+            eventIndex[i] = -1;
+            
+            if (op == ControlOp::QueryState)
+            {
+                bQueryState = true;
+                continue;
+            }
+            
+            TimelineEvent event;
+            memset(&event, 0, sizeof(event));
+            event.dueNs = nowNs;
+            
+            const struct ff_effect* effect = FindPresetEffect(command.effect);
+            event.effectId = effect ? effect->id : -1;
+            
+            if (op == ControlOp::StopAll)
+            {
+                event.action = TimelineAction::StopAll;
+            }
+            else if (effect && op == ControlOp::Play)
+            {
+                event.action = TimelineAction::Start;
+            }
+            else if (effect && op == ControlOp::Stop)
+            {
+                event.action = TimelineAction::Stop;
+            }
+            else if (effect && op == ControlOp::SetLevel)
+            {
+                event.action = TimelineAction::Update;
+                event.effect = *effect;
+                ApplyEffectLevel(event.effect, command.value);
+            }
+            else if (effect && op == ControlOp::LoadPreset)
+            {
+                event.action = TimelineAction::Update;
+                event.effect = BUILTIN_EFFECTS[command.effect].effect;
+            }
+            else
+            {
+                continue;
+            }
+            
+            const size_t slot = m_ControlBatch.size();
+            m_ControlResults[slot] = TimelineResult{0, false};
+            event.result = &m_ControlResults[slot];
+            eventIndex[i] = static_cast<int>(slot);
+            m_ControlBatch.push_back(event);
+        }
+    }
+    
+    if (!m_ControlBatch.empty())
+    {
+        DispatchTimelineBatch(m_ControlBatch);
+    }
+    
+    if (header.flags & CONTROL_FLAG_NO_REPLY)
+        return;
+    
+    m_ControlReply.Reset(header);
+    for (size_t i = 0; i < header.count; i++)
+    {
+        const ControlCommand& command = request.commands[i];
+        ControlStatus status = ControlStatus::Ok;
+        
+        if (eventIndex[i] >= 0)
+        {
+            status = m_ControlResults[eventIndex[i]].success ? ControlStatus::Ok : ControlStatus::DeviceError;
+        }
+        else if (command.op != static_cast<uint8_t>(ControlOp::QueryState))
+        {
+            const bool bKnownOp = command.op >= static_cast<uint8_t>(ControlOp::Play) &&
+                                  command.op <= static_cast<uint8_t>(ControlOp::LoadPreset);
+            status = bKnownOp ? ControlStatus::UnknownEffect : ControlStatus::UnknownOp;
+        }
+        m_ControlReply.Add(command, status);
+    }
+    
+    if (bQueryState)
+    {
+        FillControlState(m_ControlReply.state);
+        m_ControlReply.header.flags |= CONTROL_FLAG_STATE;
+    }
+    
+    m_Control.SendReply(request.client, m_ControlReply);
+}
+
+void ForceEffectSimulator::FillControlState(ControlState& state)
+{
+    memset(&state, 0, sizeof(state));
+    
+    // Les effets et l'entrée sont modifiés par le thread de force
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    state.force = ComputeCurrentForce();
+    state.timestampNs = MonotonicNowNs();
+    state.position = NormalizeAxis(m_Input.steering, m_Caps.axes[0].minimum, m_Caps.axes[0].maximum);
+    state.steering = m_Input.steering;
+    state.pedal1 = m_Input.pedal1;
+    state.pedal2 = m_Input.pedal2;
+    state.buttons = m_Input.buttons;
+    state.currentEffect = static_cast<int16_t>(m_CurrentEffectIndex);
+    state.activeEffects = m_bSoftwareRender ? m_Renderer.GetActiveMask() : 0;
+    state.deviceOpen = m_bDeviceOpen ? 1 : 0;
+    state.effectPlaying = m_bEffectPlaying ? 1 : 0;
+    state.softwareRender = m_bSoftwareRender ? 1 : 0;
+}
+
+//==============================================================================
+// MÉTRIQUES
+//==============================================================================
+
+void ForceEffectSimulator::RegisterMetrics()
+{
+    m_Stats.inputEvents = &m_Metrics.Counter("ffb_input_events_total",
+        "Événements evdev lus (axes, boutons, synchronisation)");
+    m_Stats.inputLatency = &m_Metrics.Histogram("ffb_input_latency_seconds",
+        "Délai entre l'horodatage kernel d'une trame d'entrée et sa lecture");
+    m_Stats.inputToForce = &m_Metrics.Histogram("ffb_input_to_force_seconds",
+        "Délai entre l'horodatage kernel d'une trame ABS_X et la fin du premier tick de rendu qui l'utilise");
+    m_Stats.forceUpdates = &m_Metrics.Counter("ffb_force_updates_total",
+        "Mises à jour d'effet envoyées au device (EVIOCSFF)");
+    m_Stats.playCommands = &m_Metrics.Counter("ffb_play_commands_total",
+        "Démarrages et arrêts d'effet envoyés au device (EV_FF)");
+    m_Stats.uploadErrors = &m_Metrics.Counter("ffb_device_errors_total",
+        "Échecs des appels au device", "op=\"upload\"");
+    m_Stats.playErrors = &m_Metrics.Counter("ffb_device_errors_total", "", "op=\"play\"");
+    m_Stats.eraseErrors = &m_Metrics.Counter("ffb_device_errors_total", "", "op=\"erase\"");
+    m_Stats.renderTicks = &m_Metrics.Counter("ffb_render_ticks_total",
+        "Ticks du rendu logiciel exécutés");
+    m_Stats.renderMisses = &m_Metrics.Counter("ffb_render_deadline_misses_total",
+        "Ticks du rendu logiciel abandonnés (retard supérieur à la période)");
+    m_Stats.renderLateness = &m_Metrics.Histogram("ffb_render_lateness_seconds",
+        "Retard du tick du rendu logiciel sur son échéance");
+    m_Stats.renderDuration = &m_Metrics.Histogram("ffb_render_duration_seconds",
+        "Durée d'un tick du rendu logiciel (mixage et envoi)");
+    m_Stats.outputSuppressedThreshold = &m_Metrics.Counter("ffb_output_suppressed_total",
+        "Mises à jour de l'effet de sortie supprimées par l'étage de sortie", "reason=\"threshold\"");
+    m_Stats.outputSuppressedRate = &m_Metrics.Counter("ffb_output_suppressed_total", "", "reason=\"rate\"");
+    m_Stats.outputSlewLimited = &m_Metrics.Counter("ffb_output_slew_limited_total",
+        "Mises à jour de l'effet de sortie bornées par la pente max");
+    m_Stats.outputFlushes = &m_Metrics.Counter("ffb_output_flushes_total",
+        "Cibles stables envoyées malgré un écart sous le seuil");
+    m_Stats.timelineEvents = &m_Metrics.Counter("ffb_timeline_events_total",
+        "Événements du séquenceur envoyés");
+    m_Stats.timelineMisses = &m_Metrics.Counter("ffb_timeline_deadline_misses_total",
+        "Événements du séquenceur envoyés plus d'1 ms après leur échéance");
+    m_Stats.timelineLateness = &m_Metrics.Histogram("ffb_timeline_lateness_seconds",
+        "Retard des événements du séquenceur sur leur échéance");
+    m_Stats.controlRequests = &m_Metrics.Counter("ffb_control_requests_total",
+        "Requêtes reçues sur la socket de contrôle");
+    m_Stats.deviceOpen = &m_Metrics.Gauge("ffb_device_open", "1 si le volant est ouvert");
+    m_Stats.renderedForce = &m_Metrics.Gauge("ffb_rendered_force", "Force rendue (Q15)");
+    m_Stats.activeLayers = &m_Metrics.Gauge("ffb_active_layers", "Couches actives du rendu logiciel");
+    
+    for (size_t i = 0; i < BUILTIN_EFFECT_COUNT; i++)
+    {
+        const std::string label = std::string("effect=\"") + BUILTIN_EFFECTS[i].name + "\"";
+        m_Stats.effectStarts[i] = &m_Metrics.Counter("ffb_effect_starts_total",
+            "Démarrages par effet", label);
+        m_Stats.effectStartNs[i] = 0;
+    }
+    for (size_t i = 0; i < BUILTIN_EFFECT_COUNT; i++)
+    {
+        const std::string label = std::string("effect=\"") + BUILTIN_EFFECTS[i].name + "\"";
+        m_Stats.effectPlayNs[i] = &m_Metrics.Counter("ffb_effect_play_seconds_total",
+            "Temps de lecture cumulé par effet (compté à l'arrêt)", label, 1e-9);
+    }
+}
+
+/**
+ * Index dans BUILTIN_EFFECTS de l'effet d'ID donné, -1 si inconnu.
+ */
+int ForceEffectSimulator::FindPresetIndex(int16_t effectId) const
+{
+    for (size_t i = 0; i < m_PresetEffects.size(); i++)
+    {
+        if (m_PresetEffects[i] && m_PresetEffects[i]->id == effectId)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+/**
+ * Suivi du temps de lecture par effet. Un redémarrage compte la lecture en
+ * cours ; une lecture à durée finie est bornée à replay.length. Appelé avec
+ * m_DeviceMutex verrouillé.
+ */
+void ForceEffectSimulator::NoteEffectStarted(int16_t effectId, int64_t nowNs)
+{
+    const int index = FindPresetIndex(effectId);
+    if (index < 0)
+        return;
+    
+    NoteEffectStopped(effectId, nowNs);
+    m_Stats.effectStarts[index]->Add();
+    m_Stats.effectStartNs[index] = nowNs;
+}
+
+void ForceEffectSimulator::NoteEffectStopped(int16_t effectId, int64_t nowNs)
+{
+    const int index = FindPresetIndex(effectId);
+    if (index < 0 || m_Stats.effectStartNs[index] == 0)
+        return;
+    
+    int64_t playedNs = nowNs - m_Stats.effectStartNs[index];
+    const int64_t lengthNs = static_cast<int64_t>(m_PresetEffects[index]->replay.length) * 1000000;
+    if (lengthNs > 0)
+        playedNs = std::min(playedNs, lengthNs);
+    
+    m_Stats.effectPlayNs[index]->Add(static_cast<uint64_t>(std::max<int64_t>(playedNs, 0)));
+    m_Stats.effectStartNs[index] = 0;
+}
+
+void ForceEffectSimulator::NoteAllEffectsStopped(int64_t nowNs)
+{
+    for (size_t i = 0; i < m_PresetEffects.size(); i++)
+    {
+        if (m_PresetEffects[i])
+            NoteEffectStopped(m_PresetEffects[i]->id, nowNs);
+    }
+}
+
+/**
+ * Résumé des distributions de latence d'entrée, journalisé à l'arrêt.
+ */
+void ForceEffectSimulator::LogInputLatency()
+{
+    std::lock_guard<std::mutex> lock(m_DeviceMutex);
+    
+    const struct
+    {
+        const char* label;
+        const LatencyHistogram* histogram;
+    } distributions[] = {
+        { "Latence kernel -> lecture", &m_InputLatency },
+        { "Latence événement -> force", &m_InputToForce },
+    };
+    
+    g_Logger.Info("Horodatages d'entrée: ", m_bMonotonicEvents ? "CLOCK_MONOTONIC" : "CLOCK_REALTIME (converti)");
+    for (const auto& entry : distributions)
+    {
+        const LatencyHistogram& histogram = *entry.histogram;
+        if (histogram.GetCount() == 0)
+            continue;
+        g_Logger.Info(entry.label, ": ", histogram.GetCount(), " trames, p50 ",
+                      histogram.Percentile(0.50) / 1000, " µs, p99 ", histogram.Percentile(0.99) / 1000,
+                      " µs, max ", histogram.GetMax() / 1000, " µs");
+    }
+}
+
+void ForceEffectSimulator::NextEffect()
+{
+    if (m_EffectNames.empty()) return;
+    
+    StopCurrentEffect();
+    m_CurrentEffectIndex = (m_CurrentEffectIndex + 1) % m_EffectNames.size();
+}
+
+void ForceEffectSimulator::PreviousEffect()
+{
+    if (m_EffectNames.empty()) return;
+    
+    StopCurrentEffect();
+    m_CurrentEffectIndex = (m_CurrentEffectIndex - 1 + m_EffectNames.size()) % m_EffectNames.size();
+}
+
+void ForceEffectSimulator::AdjustIntensity(int delta)
+{
+    m_ForceIntensity += delta;
+    m_ForceIntensity = std::max(static_cast<int16_t>(-MAX_FORCE), 
+                                std::min(static_cast<int16_t>(MAX_FORCE), m_ForceIntensity));
+    
+    // Note: Modifier l'intensité d'un effet en cours nécessiterait de
+    // le recréer avec les nouveaux paramètres sous Linux
+}
+
+void ForceEffectSimulator::AdjustDirection(int delta)
+{
+    m_EffectDirection += delta;
+    m_EffectDirection = std::max(static_cast<int16_t>(-MAX_FORCE), 
+                                 std::min(static_cast<int16_t>(MAX_FORCE), m_EffectDirection));
+}
+
+void ForceEffectSimulator::AdjustDuration(int delta)
+{
+    if (m_EffectDuration == INFINITE_DURATION)
+    {
+        m_EffectDuration = 2000;
+    }
+    else
+    {
+        m_EffectDuration += delta;
+        m_EffectDuration = std::max(100u, std::min(10000u, m_EffectDuration));
+    }
+}
+
+void ForceEffectSimulator::DisplayStatus()
+{
+    // Instantané sous le verrou, affichage (lent) en dehors
+    StatusScreen screen;
+    char devicePath[256];
+    {
+        std::lock_guard<std::mutex> lock(m_DeviceMutex);
+        snprintf(devicePath, sizeof(devicePath), "%s", m_DevicePath.c_str());
+        screen.platform = "Linux";
+        screen.bDeviceOpen = m_bDeviceOpen;
+        screen.input = m_Input;
+        screen.currentEffect = m_CurrentEffectIndex;
+        screen.bEffectPlaying = m_bEffectPlaying;
+        screen.bShowForce = m_bEffectPlaying || m_bSoftwareRender;
+        screen.force = screen.bShowForce ? static_cast<int16_t>(ComputeCurrentForce()) : 0;
+        screen.intensity = m_ForceIntensity;
+        screen.direction = m_EffectDirection;
+        screen.duration = m_EffectDuration;
+        screen.bSteeringPhysics = m_bSteeringPhysics;
+        screen.speedKmh = static_cast<int>(m_Steering.GetSpeed() * 3.6f + 0.5f);
+    }
+    screen.devicePath = devicePath;
+    screen.effectNames = &m_EffectNames;
+    
+    RenderStatusScreen(std::cout, screen);
+}
+
+/**
+ * Force produite par l'effet en cours à cet instant, évaluée en virgule
+ * fixe à partir de sa description et de la position du volant.
+ */
+int32_t ForceEffectSimulator::ComputeCurrentForce()
+{
+    if (m_bSoftwareRender)
+        return m_RenderedForce;
+    
+    if (!m_bEffectPlaying || m_EffectNames.empty())
+        return 0;
+    
+    auto it = m_Effects.find(m_EffectNames[m_CurrentEffectIndex]);
+    if (it == m_Effects.end())
+        return 0;
+    
+    AxisState axis;
+    axis.position = NormalizeAxis(m_Input.steering, m_Caps.axes[0].minimum, m_Caps.axes[0].maximum);
+    axis.velocity = m_Input.steeringVelocity;
+    axis.acceleration = m_Input.steeringAcceleration;
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - m_EffectStartTime);
+    
+    return EvaluateEffect(it->second, static_cast<uint32_t>(elapsed.count()), axis);
+}
+
+void ForceEffectSimulator::DisplayHelp()
+{
+    HelpScreen help;
+    help.platform = "Linux";
+    help.intensityStep = 2000;
+    help.bArrowKeys = false;
+    help.devicePath = m_DevicePath.c_str();
+    RenderHelpScreen(std::cout, help);
+}
+
+void ForceEffectSimulator::CleanupEffects()
+{
+    if (m_bSoftwareRender)
+    {
+        // Seul l'effet de sortie existe côté kernel
+        m_Renderer.Clear();
+        if (m_OutputEffect.id >= 0 && ioctl(m_DeviceFd, EVIOCRMFF, m_OutputEffect.id) < 0)
+        {
+            m_Stats.eraseErrors->Add();
+            g_Logger.Warning("Erreur suppression de l'effet de sortie");
+        }
+        m_OutputEffect.id = -1;
+        m_Effects.clear();
+        m_EffectNames.clear();
+        m_PresetEffects.clear();
+        return;
+    }
+    
+    for (auto& pair : m_Effects)
+    {
+        // Suppression de l'effet du kernel
+        if (ioctl(m_DeviceFd, EVIOCRMFF, pair.second.id) < 0)
+        {
+            m_Stats.eraseErrors->Add();
+            g_Logger.Warning("Erreur suppression effet ", pair.first);
+        }
+    }
+    m_Effects.clear();
+    m_EffectNames.clear();
+    m_PresetEffects.clear();
+}
+
+void ForceEffectSimulator::Shutdown()
+{
+    if (m_bShutdown)
+    {
+        return;
+    }
+    m_bShutdown = true;
+    
+    StopControlThread();
+    m_Control.Close();
+    StopForceThread();
+    m_Shared.Destroy();
+    
+    if (m_UpdateThread.joinable())
+    {
+        m_UpdateThread.join();
+    }
+    
+    if (m_HotplugThread.joinable())
+    {
+        m_HotplugThread.join();
+    }
+    
+    if (m_DeviceFd >= 0)
+    {
+        StopAllEffects();
+        CleanupEffects();
+    }
+    
+    if (m_JoystickFd >= 0)
+    {
+        close(m_JoystickFd);
+        m_JoystickFd = -1;
+    }
+    
+    if (m_DeviceFd >= 0)
+    {
+        // Réactivation de l'autocenter avant de quitter
+        struct input_event ie;
+        ie.type = EV_FF;
+        ie.code = FF_AUTOCENTER;
+        ie.value = 0xFFFF;
+        write(m_DeviceFd, &ie, sizeof(ie));
+        
+        close(m_DeviceFd);
+        m_DeviceFd = -1;
+    }
+    
+    LogInputLatency();
+    
+    // En dernier : le fichier final reflète l'arrêt complet
+    m_MetricsExporter.Stop();
+}
@@ -0,0 +1,494 @@
+//==============================================================================
+// ForceEffectSimulator.h - Simulateur d'effets à retour de force (evdev)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Déclaration du simulateur Linux : recherche et ouverture du volant,
+// effets, threads de mise à jour, de force, hotplug et contrôle. Le main
+// (FFB_Simulator.cpp) et les bancs (ffb_alloc_check) sont liés à la même
+// unité de compilation, ForceEffectSimulator.cpp.
+//==============================================================================
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+// Linux-specific headers
+#include <linux/input.h>
+#include <linux/uinput.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <dirent.h>
+#include <termios.h>
+
+#include "Logger.h"
+#include "SysfsDiscovery.h"
+#include "HotplugMonitor.h"
+#include "DeviceCache.h"
+#include "RateCalibration.h"
+#include "EffectRender.h"
+#include "EffectPresets.h"
+#include "EffectScript.h"
+#include "EffectTimeline.h"
+#include "SoftwareRenderer.h"
+#include "OutputStage.h"
+#include "SteeringModel.h"
+#include "SteeringPredictor.h"
+#include "AxisFilter.h"
+#include "InputState.h"
+#include "StatusScreen.h"
+#include "SharedForceInterface.h"
+#include "ControlServer.h"
+#include "Metrics.h"
+#include "LatencyHistogram.h"
+#include "PhaseProfiler.h"
+#include "MetricsExporter.h"
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+// IDs Microsoft Sidewinder Force Feedback Wheel
+const uint16_t SIDEWINDER_VID = 0x045E;
+const uint16_t SIDEWINDER_PID = 0x0034;
+
+// Paramètres de force
+const int16_t MAX_FORCE = 32767;         // Force maximale Linux FF
+const uint32_t EFFECT_DURATION = 2000;   // Durée par défaut (ms)
+const uint32_t INFINITE_DURATION = 0;    // 0 = infini sous Linux
+
+// Refresh rate
+const uint32_t UPDATE_INTERVAL = 16;     // ~60 FPS, attente max d'une trame d'entrée
+
+// Mode batch : codes de sortie
+const int EXIT_SCRIPT_OK = 0;
+const int EXIT_SCRIPT_LATE = 1;          // Au moins une étape hors tolérance
+const int EXIT_SCRIPT_FAILED = 2;        // Au moins une commande refusée par le device
+const int EXIT_SCRIPT_ERROR = 3;         // Script invalide ou initialisation impossible
+const int64_t DEFAULT_SCRIPT_TOLERANCE_US = 1000;
+const int64_t SCRIPT_START_LEAD_NS = 5000000;    // Marge avant la première échéance
+
+// Thread de force (séquenceur)
+const int64_t FORCE_THREAD_MAX_WAIT_NS = 100000000;  // Réveil périodique (arrêt)
+const size_t FORCE_BATCH_CAPACITY = 256;             // Événements par lot
+const int64_t RENDER_PERIOD_NS = 1000000;            // Tick du rendu logiciel (1 kHz)
+const int64_t PREDICT_DEFAULT_OUTPUT_NS = 2000000;   // Latence de sortie supposée (non calibrée)
+
+// Protocole de contrôle
+const int CONTROL_POLL_INTERVAL = 100;       // Attente max d'une requête (ms, arrêt)
+
+// Métriques
+const int64_t DEADLINE_MISS_NS = 1000000;    // Retard au-delà duquel une échéance est manquée
+
+// Hotplug
+const uint32_t HOTPLUG_POLL_INTERVAL = 200;  // Attente max d'un uevent (ms)
+const uint32_t HOTPLUG_OPEN_TIMEOUT = 1000;  // Délai max pour rouvrir le nœud (ms)
+
+// Instance globale du logger (ForceEffectSimulator.cpp)
+extern Logger g_Logger;
+
+//==============================================================================
+// UTILITAIRES TERMINAL
+//==============================================================================
+
+/**
+ * Désactive le mode canonique et l'echo du terminal pour _kbhit() style.
+ */
+class TerminalMode
+{
+private:
+    struct termios m_OldSettings;
+    bool m_Modified;
+
+public:
+    TerminalMode() : m_Modified(false) {}
+
+    void SetRaw()
+    {
+        struct termios newSettings;
+        tcgetattr(STDIN_FILENO, &m_OldSettings);
+        newSettings = m_OldSettings;
+        newSettings.c_lflag &= ~(ICANON | ECHO);
+        newSettings.c_cc[VMIN] = 0;
+        newSettings.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &newSettings);
+        m_Modified = true;
+    }
+
+    ~TerminalMode()
+    {
+        if (m_Modified)
+        {
+            tcsetattr(STDIN_FILENO, TCSANOW, &m_OldSettings);
+        }
+    }
+};
+
+//==============================================================================
+// CLASSE PRINCIPALE
+//==============================================================================
+
+/**
+ * Séries du registre mises à jour par le simulateur. Enregistrées une fois
+ * dans le constructeur : sur le chemin chaud, un simple incrément atomique.
+ */
+struct SimulatorMetrics
+{
+    MetricCounter* inputEvents;
+    MetricHistogram* inputLatency;       // Horodatage kernel -> lecture
+    MetricHistogram* inputToForce;       // Horodatage kernel -> fin du tick qui l'utilise
+    MetricCounter* forceUpdates;         // EVIOCSFF de mise à jour (sortie ou effet)
+    MetricCounter* playCommands;         // Démarrages/arrêts envoyés
+    MetricCounter* uploadErrors;         // Échecs EVIOCSFF
+    MetricCounter* playErrors;           // Échecs d'écriture EV_FF
+    MetricCounter* eraseErrors;          // Échecs EVIOCRMFF
+    MetricCounter* renderTicks;
+    MetricCounter* renderMisses;         // Ticks abandonnés (retard > période)
+    MetricHistogram* renderLateness;
+    MetricHistogram* renderDuration;
+    MetricCounter* outputSuppressedThreshold;    // Écart sous le seuil
+    MetricCounter* outputSuppressedRate;         // Cadence max atteinte
+    MetricCounter* outputSlewLimited;            // Envois bornés en pente
+    MetricCounter* outputFlushes;                // Cibles finales envoyées sous le seuil
+    MetricCounter* timelineEvents;
+    MetricCounter* timelineMisses;       // Retard > DEADLINE_MISS_NS
+    MetricHistogram* timelineLateness;
+    MetricCounter* controlRequests;
+    MetricGauge* deviceOpen;
+    MetricGauge* renderedForce;
+    MetricGauge* activeLayers;
+
+    // Par préréglage (index de BUILTIN_EFFECTS)
+    MetricCounter* effectStarts[BUILTIN_EFFECT_COUNT];
+    MetricCounter* effectPlayNs[BUILTIN_EFFECT_COUNT];
+    int64_t effectStartNs[BUILTIN_EFFECT_COUNT];         // 0 = arrêté
+};
+
+class ForceEffectSimulator
+{
+private:
+    // État du périphérique
+    int m_DeviceFd;              // File descriptor du device event
+    int m_JoystickFd;            // File descriptor pour lire les axes/boutons
+    std::string m_DevicePath;
+    std::string m_ForcedDevicePath;
+    bool m_bDeviceOpen;
+
+    // Protège les descripteurs et les IDs d'effets (UI, update et hotplug)
+    std::mutex m_DeviceMutex;
+
+    // Identité et capacités (éventuellement issues du cache)
+    DeviceIdentity m_DeviceIdentity;
+    DeviceCapabilities m_Caps;
+    DeviceCapabilityCache m_CapsCache;
+    bool m_bHaveIdentity;
+    bool m_bCapsFromCache;
+    bool m_bCalibrate;           // --calibrate : mesure la cadence soutenable
+
+    // Chronométrage du démarrage (--startup-trace : export Chrome trace)
+    PhaseProfiler m_Startup;
+    std::string m_StartupTracePath;
+
+    // Mode d'affichage
+    bool m_bShowingHelp;
+
+    // Gestion des effets
+    std::map<std::string, struct ff_effect> m_Effects;
+    std::vector<std::string> m_EffectNames;
+    std::vector<struct ff_effect*> m_PresetEffects;     // Index de BUILTIN_EFFECTS
+    int m_CurrentEffectIndex;
+    bool m_bEffectPlaying;
+    std::chrono::steady_clock::time_point m_EffectStartTime;
+
+    // Thread de mise à jour
+    std::thread m_UpdateThread;
+    std::atomic<bool> m_bRunning;
+    bool m_bShutdown;            // Shutdown() déjà exécuté (main puis destructeur)
+
+    // Surveillance hotplug (uevents netlink)
+    std::thread m_HotplugThread;
+    HotplugMonitor m_HotplugMonitor;
+
+    // Séquenceur d'effets, dépilé par le thread de force
+    EffectTimeline m_Timeline;
+    std::thread m_ForceThread;
+    std::vector<TimelineEvent> m_DispatchBatch;
+    std::vector<struct input_event> m_PlayEvents;
+
+    // Rendu logiciel : couches mixées dans un unique effet constant
+    bool m_bSoftwareRender;
+    SoftwareRenderer m_Renderer;
+    struct ff_effect m_OutputEffect;
+    OutputStage m_OutputStage;   // Filtre les mises à jour de m_OutputEffect
+    bool m_bAutoOutputRate;      // Cadence de l'étage prise dans la calibration
+    std::atomic<int32_t> m_RenderedForce;
+
+    // Modèle physique de direction (ajouté au mixage logiciel)
+    bool m_bSteeringPhysics;
+    SteeringModel m_Steering;
+
+    // Prédiction de la position du volant à l'instant d'actionnement
+    bool m_bPredict;
+    SteeringPredictor m_Predictor;
+    int64_t m_PredictLeadNs;     // Avance sur le tick (-1 = déduite de la sortie)
+
+    // Interface de commande en mémoire partagée (autres processus), servie
+    // par le thread de force à chaque tick du rendu logiciel
+    std::string m_SharedName;
+    SharedForceServer m_Shared;
+    int32_t m_ExternalForce;     // Dernière commande SetForce (Q15)
+    uint64_t m_SharedApplied;
+    uint64_t m_SharedRejected;
+
+    // Protocole de contrôle (socket Unix), servi par son propre thread
+    std::string m_ControlPath;
+    ControlServer m_Control;
+    std::thread m_ControlThread;
+    std::vector<ControlRequest> m_ControlRequests;
+    std::vector<TimelineEvent> m_ControlBatch;
+    std::vector<TimelineResult> m_ControlResults;
+    ControlReply m_ControlReply;
+
+    // Métriques (exportées au format Prometheus par leur propre thread)
+    MetricsRegistry m_Metrics;
+    SimulatorMetrics m_Stats;
+    MetricsExporter m_MetricsExporter;
+    std::string m_MetricsSocketPath;
+    std::string m_MetricsFilePath;
+    int m_MetricsPeriodMs;
+
+    // Paramètres d'effet ajustables
+    int16_t m_ForceIntensity;
+    uint32_t m_EffectDuration;
+    int16_t m_EffectDirection;
+
+    // État des contrôles
+    InputSnapshot m_Input;
+    AxisFilter m_SteeringFilter; // Vitesse et accélération du volant (par trame)
+
+    // Horodatage des événements (CLOCK_MONOTONIC via EVIOCSCLOCKID)
+    bool m_bMonotonicEvents;     // Sinon CLOCK_REALTIME, converti à la lecture
+    int64_t m_PendingInputNs;    // Plus ancienne trame ABS_X pas encore rendue (0 = aucune)
+    LatencyHistogram m_InputLatency;
+    LatencyHistogram m_InputToForce;
+
+    // Terminal mode
+    TerminalMode m_TerminalMode;
+
+public:
+    ForceEffectSimulator();
+    ~ForceEffectSimulator();
+
+    /**
+     * Initialise le simulateur (device, effets).
+     * @return true si succès.
+     */
+    bool Initialize();
+    void Shutdown();
+    void Run();
+
+    /**
+     * Mode batch : exécute un script d'effets sans interface.
+     * @param toleranceUs Écart maximal toléré entre instant prévu et réel.
+     * @return Code de sortie EXIT_SCRIPT_*.
+     */
+    int RunScript(const EffectScript& script, int64_t toleranceUs);
+
+    /**
+     * Impose le nœud /dev/input/eventX à utiliser (pas de recherche).
+     */
+    void SetDevicePath(const std::string& path) { m_ForcedDevicePath = path; }
+
+    /**
+     * Active le rendu logiciel (enveloppes et mixage en userspace).
+     * À appeler avant Initialize().
+     */
+    void SetSoftwareRender(bool bEnabled) { m_bSoftwareRender = bEnabled; }
+
+    /**
+     * Règle l'étage de sortie du rendu logiciel (seuil, cadence, pente).
+     * Si bAutoRate, la cadence calibrée du device remplace celle de params.
+     */
+    void SetOutputStage(const OutputStageParams& params, bool bAutoRate)
+    {
+        m_OutputStage.SetParams(params);
+        m_bAutoOutputRate = bAutoRate;
+    }
+
+    /**
+     * Calibre la cadence de mise à jour soutenable à l'initialisation et
+     * la mémorise dans le cache du device.
+     */
+    void SetCalibration(bool bEnabled) { m_bCalibrate = bEnabled; }
+
+    /**
+     * Écrit le chronométrage des phases de démarrage au format Chrome trace.
+     */
+    void SetStartupTrace(const std::string& path) { m_StartupTracePath = path; }
+
+    /**
+     * Active le modèle physique de direction à la vitesse donnée (km/h).
+     * Implique le rendu logiciel.
+     */
+    void SetSteeringPhysics(float speedKmh)
+    {
+        m_bSteeringPhysics = true;
+        m_bSoftwareRender = true;
+        m_Steering.SetSpeed(speedKmh / 3.6f);
+    }
+
+    /**
+     * Active la prédiction de la position du volant, extrapolée de leadNs
+     * au-delà du tick (-1 : latence de sortie calibrée, ou par défaut).
+     * Implique le rendu logiciel.
+     */
+    void SetPrediction(int64_t leadNs)
+    {
+        m_bPredict = true;
+        m_bSoftwareRender = true;
+        m_PredictLeadNs = leadNs;
+    }
+
+    /**
+     * Ouvre l'interface de commande en mémoire partagée sous ce nom
+     * (shm_open). Implique le rendu logiciel.
+     */
+    void SetSharedInterface(const std::string& name)
+    {
+        m_SharedName = name;
+        m_bSoftwareRender = true;
+    }
+
+    /**
+     * Ouvre le protocole de contrôle sur cette socket Unix.
+     */
+    void SetControlSocket(const std::string& path) { m_ControlPath = path; }
+
+    /**
+     * Exporte les métriques sur une socket Unix et/ou dans un fichier
+     * réécrit toutes les periodMs (chemin vide = sortie désactivée).
+     */
+    void SetMetricsExport(const std::string& socketPath, const std::string& filePath, int periodMs)
+    {
+        m_MetricsSocketPath = socketPath;
+        m_MetricsFilePath = filePath;
+        m_MetricsPeriodMs = periodMs;
+    }
+
+    /**
+     * Reprend des descripteurs déjà ouverts au lieu de chercher et sonder
+     * le volant (banc sans uinput : ffb_alloc_check). Le simulateur en
+     * devient propriétaire. Les effets reçoivent des ID locaux, comme en
+     * rendu logiciel, deviceFd pouvant refuser EVIOCSFF.
+     * @return true si au moins un effet a été créé.
+     */
+    bool AttachDescriptors(int deviceFd, int joystickFd, const std::string& label, const AxisRange& steering);
+
+    // Pilotage pas à pas, à la place des threads de Run() (bancs) : un
+    // tour de UpdateLoop, puis un tour de ForceLoop
+    void UpdateDeviceState();
+    size_t DispatchDueEvents(int64_t nowNs);
+    void RenderTick(int64_t nowNs);
+    void ScheduleEvent(const TimelineEvent& event) { m_Timeline.Schedule(event); }
+    bool IsSoftwareRender() const { return m_bSoftwareRender; }
+    const DeviceCapabilities& GetCapabilities() const { return m_Caps; }
+    const struct ff_effect* FindPresetEffect(int16_t index) const;
+    static void ApplyEffectLevel(struct ff_effect& effect, int32_t level);
+
+    // Commandes de l'interface (touches N, Espace, S) et écran d'état
+    void NextEffect();
+    void PlayCurrentEffect();
+    void StopAllEffects();
+    void DisplayStatus();
+
+private:
+    // Initialisation
+    bool RunStartupPhases();
+    void LogStartupProfile();
+    bool FindDevice();
+    bool FindForcedDevice();
+    bool FindDeviceSysfs(bool& bSysfsAvailable);
+    bool FindDeviceDevInput();
+    static bool IsSidewinderIdentity(const char* name, uint16_t vendor, uint16_t product);
+    bool OpenDevice();
+    void SetEventClock();
+    bool SetupForceFeedback();
+    bool CalibrateUpdateRate();
+    void ApplyUpdateRate();
+    void ConfigurePrediction();
+    bool ProbeCapabilities();
+    void LookupCachedCapabilities(const unsigned long* ffBits, size_t nLongs);
+    void DisableAutocenter();
+
+    // Hotplug et reconnexion
+    void HotplugLoop();
+    void HandleDeviceRemoved(const std::string& eventName);
+    bool HandleDeviceArrived(const std::string& eventName);
+    bool UploadAllEffects();
+
+    // Gestion des effets
+    bool CreateAllEffects();
+    bool CreateEffect(const EffectPreset& preset);
+    bool CreateOutputEffect();
+    const struct ff_effect* FindEffectById(int16_t id) const;
+
+    // Contrôle des effets
+    void StopCurrentEffect();
+    void StopAllEffectsLocked();
+    bool SetEffectPlaying(const struct ff_effect& effect, bool bPlay);
+    void PreviousEffect();
+    void AdjustIntensity(int delta);
+    void AdjustDirection(int delta);
+    void AdjustDuration(int delta);
+
+    // Thread de force (séquenceur)
+    void StartForceThread();
+    void StopForceThread();
+    void ForceLoop();
+    void DispatchTimelineBatch(std::vector<TimelineEvent>& batch);
+    void QueuePlayEvents(const TimelineEvent& event);
+    bool FlushPlayEvents();
+    void UpdateOutputEffect(int32_t force, int64_t nowNs);
+    void DrainSharedCommands(int64_t nowNs);
+    void PublishSharedState(int64_t nowNs, int32_t position, int32_t force);
+
+    // Protocole de contrôle
+    void StartControlThread();
+    void StopControlThread();
+    void ControlLoop();
+    void HandleControlRequest(const ControlRequest& request);
+    void FillControlState(ControlState& state);
+
+    // Métriques
+    void RegisterMetrics();
+    int FindPresetIndex(int16_t effectId) const;
+    void NoteEffectStarted(int16_t effectId, int64_t nowNs);
+    void NoteEffectStopped(int16_t effectId, int64_t nowNs);
+    void NoteAllEffectsStopped(int64_t nowNs);
+    void LogInputLatency();
+
+    // Mise à jour et affichage
+    void UpdateLoop();
+    void DisplayHelp();
+    int32_t ComputeCurrentForce();
+
+    // Utilitaires
+    void CleanupEffects();
+};
@@ -0,0 +1,199 @@
+//==============================================================================
+// HotplugMonitor.h - Surveillance des branchements via les uevents netlink
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+
+//==============================================================================
+// MESSAGE UEVENT
+//==============================================================================
+
+/**
+ * Champs utiles d'un uevent kernel ("add@/devices/...\0ACTION=add\0...").
+ */
+struct UeventMessage
+{
+    std::string action;          // "add", "remove", "change"...
+    std::string subsystem;       // "input", "usb"...
+    std::string devPath;         // DEVPATH (chemin sysfs sans /sys)
+    std::string devName;         // DEVNAME ("input/event5"), vide si pas de nœud
+
+    void Clear()
+    {
+        action.clear();
+        subsystem.clear();
+        devPath.clear();
+        devName.clear();
+    }
+
+    /**
+     * Nom du nœud eventX concerné ("event5"), vide si ce n'en est pas un.
+     */
+    std::string GetEventName() const
+    {
+        const char* prefix = "input/event";
+        if (devName.compare(0, strlen(prefix), prefix) != 0)
+            return std::string();
+        return devName.substr(strlen("input/"));
+    }
+};
+
+//==============================================================================
+// MONITEUR NETLINK
+//==============================================================================
+
+/**
+ * Écoute le groupe multicast des uevents kernel (NETLINK_KOBJECT_UEVENT).
+ * Ne dépend pas de libudev : les messages bruts du kernel suffisent pour
+ * détecter l'arrivée et le retrait d'un nœud /dev/input/eventX.
+ */
+class HotplugMonitor
+{
+private:
+    int m_Socket;
+
+    // Groupe multicast des uevents émis directement par le kernel
+    static const unsigned int KERNEL_UEVENT_GROUP = 1;
+
+public:
+    HotplugMonitor() : m_Socket(-1) {}
+
+    ~HotplugMonitor()
+    {
+        Close();
+    }
+
+    HotplugMonitor(const HotplugMonitor&) = delete;
+    HotplugMonitor& operator=(const HotplugMonitor&) = delete;
+
+    bool Open()
+    {
+        Close();
+
+        m_Socket = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                          NETLINK_KOBJECT_UEVENT);
+        if (m_Socket < 0)
+            return false;
+
+        struct sockaddr_nl addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.nl_family = AF_NETLINK;
+        addr.nl_pid = 0; // Le kernel assigne le port
+        addr.nl_groups = KERNEL_UEVENT_GROUP;
+
+        if (bind(m_Socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+        {
+            int err = errno;
+            Close();
+            errno = err;
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_Socket >= 0)
+        {
+            close(m_Socket);
+            m_Socket = -1;
+        }
+    }
+
+    bool IsOpen() const { return m_Socket >= 0; }
+
+    /**
+     * Attend un uevent au plus timeoutMs millisecondes.
+     * @return true si un message a été reçu et décodé.
+     */
+    bool WaitEvent(int timeoutMs, UeventMessage& msg)
+    {
+        if (m_Socket < 0)
+            return false;
+
+        struct pollfd pfd;
+        pfd.fd = m_Socket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (poll(&pfd, 1, timeoutMs) <= 0 || !(pfd.revents & POLLIN))
+            return false;
+
+        return ReadEvent(msg);
+    }
+
+    /**
+     * Lit un uevent déjà disponible sur la socket.
+     */
+    bool ReadEvent(UeventMessage& msg)
+    {
+        char buf[8192];
+        struct sockaddr_nl sender;
+        struct iovec iov = { buf, sizeof(buf) - 1 };
+        struct msghdr hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_name = &sender;
+        hdr.msg_namelen = sizeof(sender);
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+
+        ssize_t len = recvmsg(m_Socket, &hdr, 0);
+        if (len <= 0)
+            return false;
+
+        // Seuls les messages émis par le kernel (port 0) sont acceptés
+        if (hdr.msg_namelen != sizeof(sender) || sender.nl_pid != 0)
+            return false;
+
+        buf[len] = '\0';
+        return ParseUevent(buf, static_cast<size_t>(len), msg);
+    }
+
+    /**
+     * Décode un uevent kernel : une en-tête "action@devpath" suivie de
+     * paires CLE=valeur séparées par des '\0'.
+     */
+    static bool ParseUevent(const char* buf, size_t len, UeventMessage& msg)
+    {
+        msg.Clear();
+
+        // Les messages relayés par udev commencent par "libudev" (format binaire)
+        if (len >= 7 && memcmp(buf, "libudev", 7) == 0)
+            return false;
+
+        size_t headerLen = strnlen(buf, len);
+        if (headerLen == len || memchr(buf, '@', headerLen) == nullptr)
+            return false;
+
+        for (size_t pos = headerLen + 1; pos < len; )
+        {
+            const char* field = buf + pos;
+            size_t fieldLen = strnlen(field, len - pos);
+
+            if (strncmp(field, "ACTION=", 7) == 0)
+                msg.action.assign(field + 7, fieldLen - 7);
+            else if (strncmp(field, "SUBSYSTEM=", 10) == 0)
+                msg.subsystem.assign(field + 10, fieldLen - 10);
+            else if (strncmp(field, "DEVPATH=", 8) == 0)
+                msg.devPath.assign(field + 8, fieldLen - 8);
+            else if (strncmp(field, "DEVNAME=", 8) == 0)
+                msg.devName.assign(field + 8, fieldLen - 8);
+
+            pos += fieldLen + 1;
+        }
+
+        return !msg.action.empty();
+    }
+};
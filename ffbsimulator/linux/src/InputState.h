@@ -0,0 +1,62 @@
+//==============================================================================
+// InputState.h - Décodage des événements evdev du volant
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+
+#pragma once
+
+#include <cstdint>
+
+#include <linux/input.h>
+
+#include "InputSnapshot.h"
+
+//==============================================================================
+// DÉCODAGE EVDEV
+//==============================================================================
+
+/**
+ * Horodatage d'un événement en ns (horloge du nœud evdev).
+ */
+inline int64_t EventTimeNs(const struct input_event& ev)
+{
+    return static_cast<int64_t>(ev.input_event_sec) * 1000000000LL +
+           static_cast<int64_t>(ev.input_event_usec) * 1000;
+}
+
+/**
+ * Applique un événement evdev à l'instantané.
+ * @return true si l'événement concerne un axe ou un bouton suivi.
+ */
+inline bool ApplyInputEvent(InputSnapshot& snapshot, const struct input_event& ev)
+{
+    if (ev.type == EV_ABS)
+    {
+        switch (ev.code)
+        {
+        case ABS_X:
+            snapshot.steering = static_cast<int16_t>(ev.value);
+            return true;
+        case ABS_Y:
+            snapshot.pedal1 = static_cast<int16_t>(ev.value);
+            return true;
+        case ABS_Z:
+            snapshot.pedal2 = static_cast<int16_t>(ev.value);
+            return true;
+        }
+    }
+    else if (ev.type == EV_KEY)
+    {
+        if (ev.code >= BTN_JOYSTICK && ev.code < BTN_JOYSTICK + 32)
+        {
+            const uint32_t mask = 1u << (ev.code - BTN_JOYSTICK);
+            if (ev.value)
+                snapshot.buttons |= mask;
+            else
+                snapshot.buttons &= ~mask;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,287 @@
+//==============================================================================
+// MetricsExporter.h - Export des métriques (socket Unix, fichier périodique)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Un thread dédié, hors du chemin chaud, sert deux sorties indépendantes :
+//  - socket Unix SOCK_STREAM : chaque connexion reçoit l'export texte
+//    Prometheus complet puis est fermée (socat - UNIX-CONNECT:<chemin>) ;
+//  - fichier réécrit périodiquement de façon atomique (écriture dans
+//    <chemin>.tmp puis rename), lisible par le collecteur textfile de
+//    node_exporter.
+//==============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <cstdio>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "Clock.h"
+#include "Metrics.h"
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const int METRICS_DEFAULT_PERIOD_MS = 5000;
+const int METRICS_LISTEN_BACKLOG = 8;
+const int METRICS_SEND_TIMEOUT_MS = 1000;
+
+//==============================================================================
+// EXPORTATEUR
+//==============================================================================
+
+class MetricsExporter
+{
+private:
+    const MetricsRegistry* m_Registry;
+    std::string m_SocketPath;
+    std::string m_FilePath;
+    int m_PeriodMs;
+    int m_Listen;
+    int m_Wake;
+    std::thread m_Thread;
+    std::atomic<bool> m_bRunning;
+    std::atomic<uint64_t> m_Scrapes;
+    std::atomic<uint64_t> m_FileWrites;
+    std::atomic<uint64_t> m_Errors;
+
+    bool OpenSocket(const std::string& path)
+    {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        m_Listen = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_Listen < 0)
+            return false;
+
+        unlink(path.c_str());
+        if (bind(m_Listen, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            listen(m_Listen, METRICS_LISTEN_BACKLOG) < 0)
+        {
+            int err = errno;
+            close(m_Listen);
+            m_Listen = -1;
+            errno = err;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Envoie l'export complet à un client puis ferme la connexion. Le
+     * délai d'envoi borne le temps qu'un lecteur lent peut retenir le thread.
+     */
+    void ServeClient(int client)
+    {
+        struct timeval timeout;
+        timeout.tv_sec = METRICS_SEND_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (METRICS_SEND_TIMEOUT_MS % 1000) * 1000;
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        const std::string text = m_Registry->ExportText();
+        size_t sent = 0;
+        while (sent < text.size())
+        {
+            const ssize_t n = send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                m_Errors.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        close(client);
+        m_Scrapes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void WriteFile()
+    {
+        const std::string tmpPath = m_FilePath + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::trunc);
+            if (!out)
+            {
+                m_Errors.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            m_Registry->Export(out);
+            if (!out.good())
+            {
+                m_Errors.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        if (rename(tmpPath.c_str(), m_FilePath.c_str()) < 0)
+        {
+            m_Errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m_FileWrites.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Loop()
+    {
+        struct pollfd fds[2];
+        fds[0].fd = m_Wake;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_Listen;
+        fds[1].events = POLLIN;
+        const nfds_t count = (m_Listen >= 0) ? 2 : 1;
+        const int64_t periodNs = static_cast<int64_t>(m_PeriodMs) * 1000000;
+        int64_t nextWriteNs = MonotonicNowNs() + periodNs;
+
+        while (m_bRunning.load())
+        {
+            // Délai jusqu'à la prochaine écriture du fichier (arrondi au-dessus)
+            int timeoutMs = -1;
+            if (!m_FilePath.empty())
+            {
+                const int64_t leftNs = std::max<int64_t>(nextWriteNs - MonotonicNowNs(), 0);
+                timeoutMs = static_cast<int>((leftNs + 999999) / 1000000);
+            }
+
+            fds[0].revents = 0;
+            fds[1].revents = 0;
+            const int ready = poll(fds, count, timeoutMs);
+            if (!m_bRunning.load())
+                break;
+
+            if (ready > 0 && count > 1 && (fds[1].revents & POLLIN))
+            {
+                int client;
+                while ((client = accept4(m_Listen, nullptr, nullptr, SOCK_CLOEXEC)) >= 0)
+                    ServeClient(client);
+            }
+
+            // À échéance, quel que soit le réveil : des scrapes plus fréquents
+            // que la période ne retardent ni n'accélèrent le fichier
+            const int64_t nowNs = MonotonicNowNs();
+            if (!m_FilePath.empty() && nowNs >= nextWriteNs)
+            {
+                WriteFile();
+                nextWriteNs += periodNs;
+                if (nextWriteNs <= nowNs)
+                    nextWriteNs = nowNs + periodNs;
+            }
+        }
+
+        // Dernier état connu à l'arrêt
+        if (!m_FilePath.empty())
+            WriteFile();
+    }
+
+public:
+    MetricsExporter()
+        : m_Registry(nullptr)
+        , m_PeriodMs(METRICS_DEFAULT_PERIOD_MS)
+        , m_Listen(-1)
+        , m_Wake(-1)
+        , m_bRunning(false)
+        , m_Scrapes(0)
+        , m_FileWrites(0)
+        , m_Errors(0)
+    {
+    }
+
+    ~MetricsExporter()
+    {
+        Stop();
+    }
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * Démarre l'export. socketPath ou filePath peut être vide (sortie
+     * désactivée), pas les deux.
+     * @return false en cas d'échec (errno renseigné).
+     */
+    bool Start(const MetricsRegistry& registry, const std::string& socketPath,
+               const std::string& filePath, int periodMs = METRICS_DEFAULT_PERIOD_MS)
+    {
+        Stop();
+        if (socketPath.empty() && filePath.empty())
+        {
+            errno = EINVAL;
+            return false;
+        }
+
+        m_Registry = &registry;
+        m_FilePath = filePath;
+        m_PeriodMs = (periodMs > 0) ? periodMs : METRICS_DEFAULT_PERIOD_MS;
+
+        m_Wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_Wake < 0)
+            return false;
+
+        if (!socketPath.empty())
+        {
+            if (!OpenSocket(socketPath))
+            {
+                int err = errno;
+                close(m_Wake);
+                m_Wake = -1;
+                errno = err;
+                return false;
+            }
+            m_SocketPath = socketPath;
+        }
+
+        m_bRunning = true;
+        m_Thread = std::thread(&MetricsExporter::Loop, this);
+        return true;
+    }
+
+    void Stop()
+    {
+        if (m_bRunning.exchange(false))
+        {
+            const uint64_t one = 1;
+            write(m_Wake, &one, sizeof(one));
+        }
+        if (m_Thread.joinable())
+            m_Thread.join();
+
+        if (m_Listen >= 0)
+        {
+            close(m_Listen);
+            m_Listen = -1;
+            unlink(m_SocketPath.c_str());
+        }
+        if (m_Wake >= 0)
+        {
+            close(m_Wake);
+            m_Wake = -1;
+        }
+        m_SocketPath.clear();
+    }
+
+    bool IsRunning() const { return m_bRunning.load(); }
+    uint64_t GetScrapeCount() const { return m_Scrapes.load(std::memory_order_relaxed); }
+    uint64_t GetFileWriteCount() const { return m_FileWrites.load(std::memory_order_relaxed); }
+    uint64_t GetErrorCount() const { return m_Errors.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,178 @@
+//==============================================================================
+// RateCalibration.h - Calibration de la cadence de mise à jour soutenable
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Chaque volant (et chaque pilote) accepte les mises à jour d'effet à une
+// cadence différente avant que les écritures ne s'accumulent ou que la
+// latence d'EVIOCSFF n'explose. La calibration envoie un effet constant de
+// faible niveau et le met à jour à des cadences croissantes (paliers de
+// RATE_CALIBRATION_RATES) en mesurant :
+//  - la latence de chaque ioctl EVIOCSFF (p50, p99) ;
+//  - le glissement du planning : retard de chaque mise à jour sur son
+//    créneau. Un retard qui dépasse la période signale une file qui se
+//    remplit (le device n'absorbe plus la cadence).
+// Un palier est soutenable sans erreur, avec un p99 de latence inférieur à
+// la moitié de la période et un retard max inférieur à une période. La
+// cadence retenue est le dernier palier soutenable ; la montée s'arrête au
+// premier échec.
+//==============================================================================
+
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+#include <linux/input.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "Clock.h"
+#include "EffectPresets.h"
+#include "LatencyHistogram.h"
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const uint32_t RATE_CALIBRATION_RATES[] = { 60, 125, 250, 500, 1000 };     // Hz
+const size_t RATE_CALIBRATION_STEP_COUNT = sizeof(RATE_CALIBRATION_RATES) / sizeof(RATE_CALIBRATION_RATES[0]);
+const int64_t RATE_CALIBRATION_STEP_NS = 250000000;     // Durée d'un palier
+const int32_t RATE_CALIBRATION_LEVEL = 3000;            // Niveau Q15 alterné (faible)
+
+//==============================================================================
+// RÉSULTATS
+//==============================================================================
+
+struct RateCalibrationStep
+{
+    uint32_t rateHz;
+    uint32_t updates;
+    uint32_t errors;             // EVIOCSFF refusés
+    int64_t p50Ns;               // Latence EVIOCSFF
+    int64_t p99Ns;
+    int64_t maxLatenessNs;       // Plus grand retard sur le créneau prévu
+    bool bSustained;
+};
+
+struct RateCalibrationResult
+{
+    std::vector<RateCalibrationStep> steps;
+    uint32_t rateHz;             // Cadence retenue (0 = aucun palier soutenable)
+    int64_t p99Ns;               // Latence p99 au palier retenu
+    int lastErrno;
+
+    RateCalibrationResult() : rateHz(0), p99Ns(0), lastErrno(0) {}
+};
+
+//==============================================================================
+// CALIBRATION
+//==============================================================================
+
+class RateCalibrator
+{
+private:
+    int64_t m_StepNs;
+
+    static bool IsSustained(const RateCalibrationStep& step, int64_t periodNs)
+    {
+        return step.errors == 0 && step.p99Ns * 2 <= periodNs && step.maxLatenessNs <= periodNs;
+    }
+
+    /**
+     * Un palier : mises à jour aux créneaux nowNs + k * période, niveau
+     * alterné pour que chaque ioctl porte un vrai changement.
+     */
+    RateCalibrationStep RunStep(int fd, struct ff_effect& effect, uint32_t rateHz, int& lastErrno)
+    {
+        const int64_t periodNs = 1000000000LL / rateHz;
+        const uint32_t updates = static_cast<uint32_t>(m_StepNs / periodNs);
+
+        RateCalibrationStep step;
+        memset(&step, 0, sizeof(step));
+        step.rateHz = rateHz;
+        step.updates = updates;
+
+        LatencyHistogram latency;
+        int64_t slotNs = MonotonicNowNs() + periodNs;
+        for (uint32_t i = 0; i < updates; i++)
+        {
+            SleepUntilNs(slotNs);
+
+            effect.u.constant.level = static_cast<int16_t>((i & 1) ? -RATE_CALIBRATION_LEVEL : RATE_CALIBRATION_LEVEL);
+            const int64_t startNs = MonotonicNowNs();
+            if (ioctl(fd, EVIOCSFF, &effect) < 0)
+            {
+                step.errors++;
+                lastErrno = errno;
+            }
+            const int64_t endNs = MonotonicNowNs();
+
+            latency.Record(endNs - startNs);
+            if (startNs - slotNs > step.maxLatenessNs)
+                step.maxLatenessNs = startNs - slotNs;
+
+            // Créneaux fixes : si le device n'absorbe pas la cadence, le
+            // retard s'accumule d'une mise à jour à l'autre
+            slotNs += periodNs;
+        }
+
+        step.p50Ns = latency.Percentile(0.50);
+        step.p99Ns = latency.Percentile(0.99);
+        step.bSustained = IsSustained(step, periodNs);
+        return step;
+    }
+
+public:
+    RateCalibrator() : m_StepNs(RATE_CALIBRATION_STEP_NS) {}
+
+    void SetStepDuration(int64_t stepNs) { m_StepNs = stepNs; }
+
+    /**
+     * Calibre le device ouvert en écriture (un slot d'effet doit être
+     * libre). L'effet de test est effacé à la fin.
+     * @return false si l'effet de test n'a pas pu être créé ou démarré
+     * (errno conservé dans result.lastErrno).
+     */
+    bool Run(int fd, RateCalibrationResult& result)
+    {
+        result = RateCalibrationResult();
+
+        struct ff_effect effect = ConstantEffect(0);
+        if (ioctl(fd, EVIOCSFF, &effect) < 0)
+        {
+            result.lastErrno = errno;
+            return false;
+        }
+
+        struct input_event play;
+        memset(&play, 0, sizeof(play));
+        play.type = EV_FF;
+        play.code = effect.id;
+        play.value = 1;
+        bool bStarted = write(fd, &play, sizeof(play)) == sizeof(play);
+        if (!bStarted)
+        {
+            result.lastErrno = errno;
+        }
+
+        for (size_t i = 0; bStarted && i < RATE_CALIBRATION_STEP_COUNT; i++)
+        {
+            const RateCalibrationStep step = RunStep(fd, effect, RATE_CALIBRATION_RATES[i], result.lastErrno);
+            result.steps.push_back(step);
+            if (!step.bSustained)
+                break;
+
+            result.rateHz = step.rateHz;
+            result.p99Ns = step.p99Ns;
+        }
+
+        play.value = 0;
+        write(fd, &play, sizeof(play));
+        ioctl(fd, EVIOCRMFF, effect.id);
+        return bStarted;
+    }
+};
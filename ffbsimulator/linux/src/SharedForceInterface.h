@@ -0,0 +1,449 @@
+//==============================================================================
+// SharedForceInterface.h - Interface de commande en mémoire partagée
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Permet à d'autres processus (plateforme de mouvement, passerelle de
+// télémétrie...) de piloter le volant sans appel système sur le chemin
+// rapide. La région POSIX (shm_open) contient :
+//  - un anneau borné de commandes multi-producteurs / consommateur unique
+//    (file de Vyukov : un numéro de séquence par case, un CAS par envoi ;
+//    avec un seul client, c'est un anneau SPSC sans contention) ;
+//  - un bloc d'état protégé par un seqlock (position, pédales, force
+//    rendue, effets actifs), publié à chaque tick par le thread de force.
+//
+// Le serveur (simulateur) crée la région ; les clients l'ouvrent avec
+// SharedForceClient, qui ne dépend que de cet en-tête.
+//==============================================================================
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <new>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const char* const SHARED_FORCE_DEFAULT_NAME = "/ffb_simulator";
+const uint32_t SHARED_FORCE_MAGIC = 0x53424646;          // "FFBS"
+const uint32_t SHARED_FORCE_VERSION = 1;
+const uint32_t SHARED_FORCE_RING_CAPACITY = 1024;         // Puissance de 2
+const size_t SHARED_FORCE_CACHE_LINE = 64;
+
+static_assert((SHARED_FORCE_RING_CAPACITY & (SHARED_FORCE_RING_CAPACITY - 1)) == 0,
+              "La capacité de l'anneau doit être une puissance de 2");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Les atomiques partagés entre processus doivent être sans verrou");
+
+//==============================================================================
+// COMMANDES ET ÉTAT
+//==============================================================================
+
+enum class SharedCommandType : uint16_t
+{
+    Play = 1,                    // Démarre l'effet 'effect' (index dans BUILTIN_EFFECTS)
+    Stop,                        // Arrête l'effet 'effect'
+    StopAll,
+    SetLevel,                    // Niveau 'value' (Q15) de l'effet 'effect'
+    SetForce,                    // Force directe 'value' (Q15), ajoutée au mixage
+};
+
+struct SharedCommand
+{
+    uint16_t type;               // SharedCommandType
+    int16_t effect;
+    int32_t value;
+    int64_t clientNs;            // Horodatage client (CLOCK_MONOTONIC), informatif
+};
+
+struct SharedState
+{
+    int64_t timestampNs;         // Dernière publication (CLOCK_MONOTONIC)
+    int32_t position;            // Volant normalisé (Q15)
+    int16_t steering;            // ABS_X brut
+    int16_t pedal1;
+    int16_t pedal2;
+    int16_t reserved;
+    uint32_t buttons;
+    int32_t force;               // Force envoyée au volant (Q15)
+    uint32_t activeEffects;      // Bit i = effet i actif
+    uint64_t commandsApplied;
+    uint64_t commandsRejected;
+};
+
+//==============================================================================
+// RÉGION PARTAGÉE
+//==============================================================================
+
+struct alignas(SHARED_FORCE_CACHE_LINE) SharedCommandSlot
+{
+    std::atomic<uint64_t> sequence;
+    SharedCommand command;
+};
+
+const size_t SHARED_STATE_WORDS = (sizeof(SharedState) + 7) / 8;
+
+struct SharedForceRegion
+{
+    std::atomic<uint32_t> magic; // Écrit en dernier (release), lu en premier (acquire)
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t serverPid;
+
+    alignas(SHARED_FORCE_CACHE_LINE) std::atomic<uint64_t> enqueuePos;
+    std::atomic<uint64_t> droppedFull;                    // Envois refusés (anneau plein)
+    alignas(SHARED_FORCE_CACHE_LINE) std::atomic<uint64_t> dequeuePos;
+
+    // Seqlock : impair pendant l'écriture. Les données sont copiées mot par
+    // mot avec des accès atomiques relâchés (pas de course au sens C++).
+    alignas(SHARED_FORCE_CACHE_LINE) std::atomic<uint32_t> stateSequence;
+    std::atomic<uint64_t> stateWords[SHARED_STATE_WORDS];
+
+    SharedCommandSlot slots[SHARED_FORCE_RING_CAPACITY];
+};
+
+//==============================================================================
+// ACCÈS COMMUNS
+//==============================================================================
+
+namespace sharedforce
+{
+
+/**
+ * Initialise une région neuve (anneau vide, état nul). Le magic est écrit
+ * en dernier : un client ne voit qu'une région prête.
+ */
+inline void Initialize(SharedForceRegion& region)
+{
+    region.capacity = SHARED_FORCE_RING_CAPACITY;
+    region.serverPid = static_cast<uint32_t>(getpid());
+    region.enqueuePos.store(0, std::memory_order_relaxed);
+    region.droppedFull.store(0, std::memory_order_relaxed);
+    region.dequeuePos.store(0, std::memory_order_relaxed);
+    region.stateSequence.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < SHARED_STATE_WORDS; i++)
+        region.stateWords[i].store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < SHARED_FORCE_RING_CAPACITY; i++)
+        region.slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    region.version = SHARED_FORCE_VERSION;
+    region.magic.store(SHARED_FORCE_MAGIC, std::memory_order_release);
+}
+
+/**
+ * Envoi sans attente ni appel système (plusieurs producteurs possibles).
+ * @return false si l'anneau est plein.
+ */
+inline bool Push(SharedForceRegion& region, const SharedCommand& command)
+{
+    const uint64_t mask = SHARED_FORCE_RING_CAPACITY - 1;
+    uint64_t pos = region.enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        SharedCommandSlot& slot = region.slots[pos & mask];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const int64_t diff = static_cast<int64_t>(sequence - pos);
+
+        if (diff == 0)
+        {
+            if (region.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.command = command;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            region.droppedFull.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = region.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * Retrait par le consommateur unique.
+ * @return false si l'anneau est vide.
+ */
+inline bool Pop(SharedForceRegion& region, SharedCommand& command)
+{
+    const uint64_t pos = region.dequeuePos.load(std::memory_order_relaxed);
+    SharedCommandSlot& slot = region.slots[pos & (SHARED_FORCE_RING_CAPACITY - 1)];
+
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+        return false;
+
+    command = slot.command;
+    slot.sequence.store(pos + SHARED_FORCE_RING_CAPACITY, std::memory_order_release);
+    region.dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Publication de l'état (écrivain unique).
+ */
+inline void PublishState(SharedForceRegion& region, const SharedState& state)
+{
+    uint64_t words[SHARED_STATE_WORDS] = {};
+    memcpy(words, &state, sizeof(state));
+
+    const uint32_t sequence = region.stateSequence.load(std::memory_order_relaxed);
+    region.stateSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < SHARED_STATE_WORDS; i++)
+        region.stateWords[i].store(words[i], std::memory_order_relaxed);
+
+    region.stateSequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * Lecture cohérente de l'état (recommence si une publication est en cours).
+ * @return false si aucune lecture cohérente après maxAttempts essais.
+ */
+inline bool ReadState(const SharedForceRegion& region, SharedState& state, int maxAttempts = 1000)
+{
+    uint64_t words[SHARED_STATE_WORDS];
+
+    for (int attempt = 0; attempt < maxAttempts; attempt++)
+    {
+        const uint32_t before = region.stateSequence.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+
+        for (size_t i = 0; i < SHARED_STATE_WORDS; i++)
+            words[i] = region.stateWords[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (region.stateSequence.load(std::memory_order_relaxed) == before)
+        {
+            memcpy(&state, words, sizeof(state));
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace sharedforce
+
+//==============================================================================
+// SERVEUR (SIMULATEUR)
+//==============================================================================
+
+class SharedForceServer
+{
+private:
+    std::string m_Name;
+    SharedForceRegion* m_Region;
+
+public:
+    SharedForceServer() : m_Region(nullptr) {}
+
+    ~SharedForceServer()
+    {
+        Destroy();
+    }
+
+    SharedForceServer(const SharedForceServer&) = delete;
+    SharedForceServer& operator=(const SharedForceServer&) = delete;
+
+    /**
+     * Crée la région nommée et l'initialise. Une région laissée par un
+     * simulateur arrêté est remplacée ; celle d'un simulateur en cours
+     * n'est jamais réinitialisée.
+     * @return false en cas d'échec (errno renseigné, EEXIST si la région
+     *         appartient à un simulateur en cours).
+     */
+    bool Create(const std::string& name)
+    {
+        Destroy();
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0660);
+        if (fd < 0 && errno == EEXIST)
+        {
+            if (IsOwnedByLiveServer(name))
+            {
+                errno = EEXIST;
+                return false;
+            }
+            shm_unlink(name.c_str());
+            fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0660);
+        }
+        if (fd < 0)
+            return false;
+
+        if (ftruncate(fd, sizeof(SharedForceRegion)) < 0)
+        {
+            const int err = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            errno = err;
+            return false;
+        }
+
+        void* memory = mmap(nullptr, sizeof(SharedForceRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED)
+        {
+            const int err = errno;
+            shm_unlink(name.c_str());
+            errno = err;
+            return false;
+        }
+
+        m_Region = new (memory) SharedForceRegion();
+        sharedforce::Initialize(*m_Region);
+
+        m_Name = name;
+        return true;
+    }
+
+    void Destroy()
+    {
+        if (m_Region)
+        {
+            m_Region->magic.store(0, std::memory_order_release);
+            munmap(m_Region, sizeof(SharedForceRegion));
+            m_Region = nullptr;
+            shm_unlink(m_Name.c_str());
+        }
+        m_Name.clear();
+    }
+
+    bool IsOpen() const { return m_Region != nullptr; }
+    const std::string& GetName() const { return m_Name; }
+
+    /**
+     * La région existante est-elle initialisée par un processus encore
+     * vivant ? (région d'une autre instance, et pas un reste d'un arrêt
+     * brutal)
+     */
+    static bool IsOwnedByLiveServer(const std::string& name)
+    {
+        const int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(SharedForceRegion))
+        {
+            close(fd);
+            return false;
+        }
+
+        void* memory = mmap(nullptr, sizeof(SharedForceRegion), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED)
+            return false;
+
+        const SharedForceRegion* region = static_cast<const SharedForceRegion*>(memory);
+        const bool bInitialized = region->magic.load(std::memory_order_acquire) == SHARED_FORCE_MAGIC;
+        const pid_t pid = static_cast<pid_t>(region->serverPid);
+        munmap(memory, sizeof(SharedForceRegion));
+
+        return bInitialized && pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+    }
+
+    bool Pop(SharedCommand& command) { return sharedforce::Pop(*m_Region, command); }
+    void PublishState(const SharedState& state) { sharedforce::PublishState(*m_Region, state); }
+    uint64_t GetDroppedCount() const { return m_Region->droppedFull.load(std::memory_order_relaxed); }
+};
+
+//==============================================================================
+// CLIENT
+//==============================================================================
+
+class SharedForceClient
+{
+private:
+    SharedForceRegion* m_Region;
+
+public:
+    SharedForceClient() : m_Region(nullptr) {}
+
+    ~SharedForceClient()
+    {
+        Close();
+    }
+
+    SharedForceClient(const SharedForceClient&) = delete;
+    SharedForceClient& operator=(const SharedForceClient&) = delete;
+
+    /**
+     * Ouvre la région créée par le simulateur.
+     * @return false si elle n'existe pas ou n'a pas le format attendu.
+     */
+    bool Open(const std::string& name = SHARED_FORCE_DEFAULT_NAME)
+    {
+        Close();
+
+        const int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(SharedForceRegion))
+        {
+            close(fd);
+            errno = EPROTO;
+            return false;
+        }
+
+        void* memory = mmap(nullptr, sizeof(SharedForceRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED)
+            return false;
+
+        m_Region = static_cast<SharedForceRegion*>(memory);
+        if (m_Region->magic.load(std::memory_order_acquire) != SHARED_FORCE_MAGIC ||
+            m_Region->version != SHARED_FORCE_VERSION)
+        {
+            Close();
+            errno = EPROTO;
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_Region)
+        {
+            munmap(m_Region, sizeof(SharedForceRegion));
+            m_Region = nullptr;
+        }
+    }
+
+    bool IsOpen() const { return m_Region != nullptr; }
+
+    bool Push(const SharedCommand& command) { return sharedforce::Push(*m_Region, command); }
+    bool ReadState(SharedState& state) const { return sharedforce::ReadState(*m_Region, state); }
+
+    bool Play(int16_t effect) { return Push(SharedCommand{ uint16_t(SharedCommandType::Play), effect, 0, 0 }); }
+    bool Stop(int16_t effect) { return Push(SharedCommand{ uint16_t(SharedCommandType::Stop), effect, 0, 0 }); }
+    bool StopAll() { return Push(SharedCommand{ uint16_t(SharedCommandType::StopAll), 0, 0, 0 }); }
+    bool SetForce(int32_t force) { return Push(SharedCommand{ uint16_t(SharedCommandType::SetForce), 0, force, 0 }); }
+
+    bool SetLevel(int16_t effect, int32_t level)
+    {
+        return Push(SharedCommand{ uint16_t(SharedCommandType::SetLevel), effect, level, 0 });
+    }
+};
@@ -0,0 +1,261 @@
+//==============================================================================
+// SysfsDiscovery.h - Détection des périphériques d'entrée via /sys/class/input
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+
+#include <linux/input.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+// Racine sysfs des périphériques d'entrée
+const char* const SYSFS_INPUT_CLASS = "/sys/class/input";
+
+// Nombre de mots nécessaires pour le bitmap EV_FF (FF_MAX inclus)
+const size_t FF_BITMAP_LONGS = FF_MAX / (sizeof(unsigned long) * 8) + 1;
+
+//==============================================================================
+// DESCRIPTION D'UN PÉRIPHÉRIQUE
+//==============================================================================
+
+/**
+ * Identité et capacités FF d'un nœud eventX, lues uniquement depuis sysfs.
+ */
+struct SysfsInputDevice
+{
+    std::string eventName;       // "event5"
+    std::string devNode;         // "/dev/input/event5"
+    std::string name;            // device/name
+    std::string phys;            // device/phys (chemin physique USB)
+    uint16_t bustype;
+    uint16_t vendor;
+    uint16_t product;
+    uint16_t version;
+    unsigned long ffBits[FF_BITMAP_LONGS];
+
+    SysfsInputDevice()
+        : bustype(0), vendor(0), product(0), version(0)
+    {
+        memset(ffBits, 0, sizeof(ffBits));
+    }
+
+    bool HasFF() const
+    {
+        for (size_t i = 0; i < FF_BITMAP_LONGS; i++)
+        {
+            if (ffBits[i] != 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool HasFFBit(int bit) const
+    {
+        const size_t bitsPerLong = sizeof(unsigned long) * 8;
+        return (ffBits[bit / bitsPerLong] >> (bit % bitsPerLong)) & 1UL;
+    }
+};
+
+/**
+ * Statistiques d'un scan (pour le diagnostic du temps de démarrage).
+ */
+struct SysfsScanStats
+{
+    size_t devicesScanned;
+    size_t candidatesWithoutFF;
+    std::chrono::microseconds elapsed;
+
+    SysfsScanStats() : devicesScanned(0), candidatesWithoutFF(0), elapsed(0) {}
+};
+
+//==============================================================================
+// LECTURE DES ATTRIBUTS SYSFS
+//==============================================================================
+
+/**
+ * Lit un attribut sysfs (petit fichier texte) sans passer par iostream.
+ * Le '\n' final est retiré.
+ */
+inline bool ReadSysfsAttribute(const std::string& path, std::string& out)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    char buf[512];
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+
+    if (len < 0)
+        return false;
+
+    while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == ' '))
+        len--;
+
+    out.assign(buf, static_cast<size_t>(len));
+    return true;
+}
+
+/**
+ * Lit un attribut hexadécimal 16 bits (id/vendor, id/product...).
+ */
+inline bool ReadSysfsHex16(const std::string& path, uint16_t& value)
+{
+    std::string text;
+    if (!ReadSysfsAttribute(path, text) || text.empty())
+        return false;
+
+    char* end = nullptr;
+    unsigned long parsed = strtoul(text.c_str(), &end, 16);
+    if (end == text.c_str() || parsed > 0xFFFF)
+        return false;
+
+    value = static_cast<uint16_t>(parsed);
+    return true;
+}
+
+/**
+ * Décode un bitmap de capacités sysfs ("capabilities/ff").
+ * Le kernel écrit des mots hexadécimaux séparés par des espaces,
+ * le mot de poids fort en premier.
+ */
+inline bool ParseSysfsBitmap(const std::string& text, unsigned long* bits, size_t nLongs)
+{
+    memset(bits, 0, nLongs * sizeof(unsigned long));
+
+    std::vector<unsigned long> words;
+    const char* p = text.c_str();
+    while (*p)
+    {
+        while (*p == ' ')
+            p++;
+        if (!*p)
+            break;
+
+        char* end = nullptr;
+        unsigned long word = strtoul(p, &end, 16);
+        if (end == p)
+            return false;
+
+        words.push_back(word);
+        p = end;
+    }
+
+    // Le dernier mot lu correspond aux bits 0..(BITS_PER_LONG-1)
+    for (size_t i = 0; i < words.size() && i < nLongs; i++)
+    {
+        bits[i] = words[words.size() - 1 - i];
+    }
+
+    return !words.empty();
+}
+
+/**
+ * Lit l'identité d'un nœud eventX (ids et nom).
+ * @param classRoot Racine sysfs (SYSFS_INPUT_CLASS).
+ * @param eventName Nom du nœud ("event5").
+ */
+inline bool ReadSysfsInputDevice(const std::string& classRoot, const std::string& eventName,
+                                 SysfsInputDevice& device)
+{
+    const std::string base = classRoot + "/" + eventName + "/device/";
+
+    device = SysfsInputDevice();
+    device.eventName = eventName;
+    device.devNode = "/dev/input/" + eventName;
+
+    if (!ReadSysfsHex16(base + "id/vendor", device.vendor) ||
+        !ReadSysfsHex16(base + "id/product", device.product))
+    {
+        return false;
+    }
+
+    ReadSysfsHex16(base + "id/bustype", device.bustype);
+    ReadSysfsHex16(base + "id/version", device.version);
+    ReadSysfsAttribute(base + "name", device.name);
+    return true;
+}
+
+/**
+ * Complète un périphérique avec son bitmap capabilities/ff et son phys.
+ */
+inline void ReadSysfsCapabilities(const std::string& classRoot, SysfsInputDevice& device)
+{
+    const std::string base = classRoot + "/" + device.eventName + "/device/";
+
+    std::string ff;
+    if (ReadSysfsAttribute(base + "capabilities/ff", ff))
+    {
+        ParseSysfsBitmap(ff, device.ffBits, FF_BITMAP_LONGS);
+    }
+    ReadSysfsAttribute(base + "phys", device.phys);
+}
+
+/**
+ * Parcourt les nœuds eventX de sysfs et retourne le premier dont l'identité
+ * est acceptée par le prédicat et qui supporte le force feedback.
+ * Les capacités ne sont lues que pour les candidats et aucun nœud
+ * /dev/input n'est ouvert.
+ * @return false si aucun périphérique ne correspond ou si sysfs est absent
+ *         (stats.devicesScanned vaut alors 0).
+ */
+inline bool FindSysfsInputDevice(const std::string& classRoot,
+                                 const std::function<bool(const SysfsInputDevice&)>& identityMatches,
+                                 SysfsInputDevice& found, SysfsScanStats& stats)
+{
+    auto start = std::chrono::steady_clock::now();
+    stats = SysfsScanStats();
+
+    DIR* dir = opendir(classRoot.c_str());
+    if (!dir)
+        return false;
+
+    bool bFound = false;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (strncmp(entry->d_name, "event", 5) != 0)
+            continue;
+
+        SysfsInputDevice device;
+        if (!ReadSysfsInputDevice(classRoot, entry->d_name, device))
+            continue;
+
+        stats.devicesScanned++;
+
+        if (!identityMatches(device))
+            continue;
+
+        ReadSysfsCapabilities(classRoot, device);
+        if (!device.HasFF())
+        {
+            stats.candidatesWithoutFF++;
+            continue;
+        }
+
+        found = device;
+        bFound = true;
+        break;
+    }
+
+    closedir(dir);
+
+    stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    return bFound;
+}
@@ -0,0 +1,373 @@
+//==============================================================================
+// VirtualWheel.h - Volant Sidewinder virtuel (uinput) avec force feedback
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Crée via /dev/uinput un périphérique qui se présente comme le Sidewinder
+// (même VID/PID, nom contenant "SideWinder", mêmes types d'effets). Le
+// simulateur le détecte comme le vrai volant, ce qui permet de tester le
+// chemin EVIOCSFF/EVIOCRMFF/lecture sans matériel. Les demandes
+// d'upload/effacement sont acceptées par un thread de service.
+//
+// SetRecording(true) fait en plus journaliser chaque requête reçue (upload,
+// mise à jour, effacement, lecture, arrêt) avec l'horodatage posé par le
+// kernel à sa mise en file (CLOCK_MONOTONIC, côté uinput) et l'instant de
+// sa lecture par le thread de service, pour mesurer la latence de bout en
+// bout depuis l'émetteur (WaitRequest).
+//==============================================================================
+
+#pragma once
+
+#include <string>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+#include <linux/input.h>
+#include <linux/uinput.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+
+#include "Clock.h"
+
+//==============================================================================
+// CONSTANTES
+//==============================================================================
+
+const char* const VIRTUAL_WHEEL_NAME = "Virtual SideWinder Force Feedback Wheel";
+const int VIRTUAL_WHEEL_MAX_EFFECTS = 16;
+const size_t VIRTUAL_WHEEL_RECORD_CAPACITY = 4096;   // Requêtes journalisées non lues
+
+enum class VirtualRequestType
+{
+    Upload,                      // Nouvel effet (UI_FF_UPLOAD sans ancien effet)
+    Update,                      // Effet existant modifié
+    Erase,
+    Play,                        // EV_FF, valeur non nulle
+    Stop                         // EV_FF, valeur nulle
+};
+
+/**
+ * Requête reçue par le volant virtuel.
+ */
+struct VirtualRequest
+{
+    VirtualRequestType type;
+    int16_t effectId;
+    int32_t value;               // Nombre de répétitions pour Play
+    int64_t kernelNs;            // Mise en file par uinput (CLOCK_MONOTONIC, µs)
+    int64_t receivedNs;          // Lecture par le thread de service (CLOCK_MONOTONIC)
+};
+
+//==============================================================================
+// VOLANT VIRTUEL
+//==============================================================================
+
+class VirtualWheel
+{
+private:
+    int m_Fd;
+    std::string m_SysName;       // "input42"
+    std::thread m_ServiceThread;
+    std::atomic<bool> m_bRunning;
+
+    // Compteurs de requêtes reçues par le volant
+    std::atomic<uint64_t> m_Uploads;
+    std::atomic<uint64_t> m_Erases;
+    std::atomic<uint64_t> m_PlayEvents;
+
+    // Journal des requêtes (SetRecording)
+    std::atomic<bool> m_bRecording;
+    std::mutex m_RecordMutex;
+    std::condition_variable m_RecordReady;
+    std::deque<VirtualRequest> m_Records;
+
+    void Record(VirtualRequestType type, int16_t effectId, int32_t value, const struct input_event& ev)
+    {
+        if (!m_bRecording)
+            return;
+
+        VirtualRequest request;
+        request.type = type;
+        request.effectId = effectId;
+        request.value = value;
+        request.kernelNs = static_cast<int64_t>(ev.input_event_sec) * 1000000000LL +
+                           static_cast<int64_t>(ev.input_event_usec) * 1000;
+        request.receivedNs = MonotonicNowNs();
+
+        {
+            std::lock_guard<std::mutex> lock(m_RecordMutex);
+            if (m_Records.size() >= VIRTUAL_WHEEL_RECORD_CAPACITY)
+                m_Records.pop_front();
+            m_Records.push_back(request);
+        }
+        m_RecordReady.notify_one();
+    }
+
+    bool Ioctl(unsigned long request, int value)
+    {
+        return ioctl(m_Fd, request, value) >= 0;
+    }
+
+    /**
+     * Thread de service : répond aux requêtes UI_FF_UPLOAD/UI_FF_ERASE du
+     * kernel (sinon EVIOCSFF bloque côté client) et compte les EV_FF.
+     */
+    void ServiceLoop()
+    {
+        while (m_bRunning)
+        {
+            struct pollfd pfd;
+            pfd.fd = m_Fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+
+            if (poll(&pfd, 1, 50) <= 0)
+                continue;
+
+            struct input_event ev;
+            while (read(m_Fd, &ev, sizeof(ev)) == sizeof(ev))
+            {
+                if (ev.type == EV_UINPUT && ev.code == UI_FF_UPLOAD)
+                {
+                    struct uinput_ff_upload upload;
+                    memset(&upload, 0, sizeof(upload));
+                    upload.request_id = ev.value;
+                    if (ioctl(m_Fd, UI_BEGIN_FF_UPLOAD, &upload) >= 0)
+                    {
+                        // Ancien effet vide : création, sinon mise à jour
+                        Record(upload.old.type ? VirtualRequestType::Update : VirtualRequestType::Upload,
+                               upload.effect.id, 0, ev);
+                        upload.retval = 0;
+                        ioctl(m_Fd, UI_END_FF_UPLOAD, &upload);
+                        m_Uploads++;
+                    }
+                }
+                else if (ev.type == EV_UINPUT && ev.code == UI_FF_ERASE)
+                {
+                    struct uinput_ff_erase erase;
+                    memset(&erase, 0, sizeof(erase));
+                    erase.request_id = ev.value;
+                    if (ioctl(m_Fd, UI_BEGIN_FF_ERASE, &erase) >= 0)
+                    {
+                        Record(VirtualRequestType::Erase, static_cast<int16_t>(erase.effect_id), 0, ev);
+                        erase.retval = 0;
+                        ioctl(m_Fd, UI_END_FF_ERASE, &erase);
+                        m_Erases++;
+                    }
+                }
+                else if (ev.type == EV_FF)
+                {
+                    // Gain et autocenter sont des EV_FF sans effet associé
+                    if (ev.code < FF_GAIN)
+                    {
+                        Record(ev.value ? VirtualRequestType::Play : VirtualRequestType::Stop,
+                               static_cast<int16_t>(ev.code), ev.value, ev);
+                    }
+                    m_PlayEvents++;
+                }
+            }
+        }
+    }
+
+public:
+    VirtualWheel()
+        : m_Fd(-1)
+        , m_bRunning(false)
+        , m_Uploads(0)
+        , m_Erases(0)
+        , m_PlayEvents(0)
+        , m_bRecording(false)
+    {
+    }
+
+    ~VirtualWheel()
+    {
+        Destroy();
+    }
+
+    VirtualWheel(const VirtualWheel&) = delete;
+    VirtualWheel& operator=(const VirtualWheel&) = delete;
+
+    /**
+     * Crée le périphérique uinput et démarre le thread de service.
+     * @return false si /dev/uinput est inaccessible ou si la création échoue
+     *         (errno renseigné).
+     */
+    bool Create(const char* name = VIRTUAL_WHEEL_NAME)
+    {
+        Destroy();
+
+        m_Fd = open("/dev/uinput", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (m_Fd < 0)
+            return false;
+
+        bool ok = Ioctl(UI_SET_EVBIT, EV_KEY) && Ioctl(UI_SET_EVBIT, EV_ABS) &&
+                  Ioctl(UI_SET_EVBIT, EV_SYN) && Ioctl(UI_SET_EVBIT, EV_FF);
+
+        for (int button = 0; ok && button < 8; button++)
+            ok = Ioctl(UI_SET_KEYBIT, BTN_JOYSTICK + button);
+
+        const int ffBits[] = {
+            FF_CONSTANT, FF_PERIODIC, FF_RAMP, FF_SPRING, FF_FRICTION, FF_DAMPER,
+            FF_INERTIA, FF_SQUARE, FF_TRIANGLE, FF_SINE, FF_SAW_UP, FF_SAW_DOWN,
+            FF_GAIN, FF_AUTOCENTER
+        };
+        for (int bit : ffBits)
+            ok = ok && Ioctl(UI_SET_FFBIT, bit);
+
+        // Volant sur 10 bits, pédales sur 8 bits (comme le Sidewinder)
+        const struct { int code; int minimum; int maximum; } axes[] = {
+            { ABS_X, 0, 1023 }, { ABS_Y, 0, 255 }, { ABS_Z, 0, 255 }
+        };
+        for (const auto& axis : axes)
+        {
+            ok = ok && Ioctl(UI_SET_ABSBIT, axis.code);
+
+            struct uinput_abs_setup abs;
+            memset(&abs, 0, sizeof(abs));
+            abs.code = static_cast<__u16>(axis.code);
+            abs.absinfo.minimum = axis.minimum;
+            abs.absinfo.maximum = axis.maximum;
+            ok = ok && ioctl(m_Fd, UI_ABS_SETUP, &abs) >= 0;
+        }
+
+        struct uinput_setup setup;
+        memset(&setup, 0, sizeof(setup));
+        setup.id.bustype = BUS_USB;
+        setup.id.vendor = 0x045E;
+        setup.id.product = 0x0034;
+        setup.id.version = 1;
+        setup.ff_effects_max = VIRTUAL_WHEEL_MAX_EFFECTS;
+        strncpy(setup.name, name, UINPUT_MAX_NAME_SIZE - 1);
+
+        ok = ok && ioctl(m_Fd, UI_DEV_SETUP, &setup) >= 0 && ioctl(m_Fd, UI_DEV_CREATE) >= 0;
+        if (!ok)
+        {
+            int err = errno;
+            close(m_Fd);
+            m_Fd = -1;
+            errno = err;
+            return false;
+        }
+
+        char sysName[64] = "";
+        if (ioctl(m_Fd, UI_GET_SYSNAME(sizeof(sysName)), sysName) >= 0)
+            m_SysName = sysName;
+
+        m_bRunning = true;
+        m_ServiceThread = std::thread(&VirtualWheel::ServiceLoop, this);
+        return true;
+    }
+
+    void Destroy()
+    {
+        m_bRunning = false;
+        if (m_ServiceThread.joinable())
+            m_ServiceThread.join();
+
+        if (m_Fd >= 0)
+        {
+            ioctl(m_Fd, UI_DEV_DESTROY);
+            close(m_Fd);
+            m_Fd = -1;
+        }
+        m_SysName.clear();
+    }
+
+    bool IsCreated() const { return m_Fd >= 0; }
+
+    /**
+     * Nœud /dev/input/eventX du volant virtuel (attend au plus timeoutMs
+     * que devtmpfs l'ait créé). Vide si introuvable.
+     */
+    std::string GetEventNode(int timeoutMs = 1000) const
+    {
+        if (m_SysName.empty())
+            return std::string();
+
+        const std::string sysDir = "/sys/devices/virtual/input/" + m_SysName;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+        do
+        {
+            DIR* dir = opendir(sysDir.c_str());
+            if (dir)
+            {
+                std::string node;
+                struct dirent* entry;
+                while ((entry = readdir(dir)) != nullptr)
+                {
+                    if (strncmp(entry->d_name, "event", 5) == 0)
+                    {
+                        node = std::string("/dev/input/") + entry->d_name;
+                        break;
+                    }
+                }
+                closedir(dir);
+
+                if (!node.empty() && access(node.c_str(), F_OK) == 0)
+                    return node;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        while (std::chrono::steady_clock::now() < deadline);
+
+        return std::string();
+    }
+
+    /**
+     * Injecte une position de volant (ABS_X) suivie d'un SYN_REPORT.
+     */
+    bool EmitSteering(int32_t value)
+    {
+        struct input_event events[2];
+        memset(events, 0, sizeof(events));
+        events[0].type = EV_ABS;
+        events[0].code = ABS_X;
+        events[0].value = value;
+        events[1].type = EV_SYN;
+        events[1].code = SYN_REPORT;
+        return write(m_Fd, events, sizeof(events)) == sizeof(events);
+    }
+
+    /**
+     * Active le journal des requêtes reçues (vidé à chaque activation).
+     */
+    void SetRecording(bool bEnabled)
+    {
+        std::lock_guard<std::mutex> lock(m_RecordMutex);
+        m_Records.clear();
+        m_bRecording = bEnabled;
+    }
+
+    /**
+     * Retire la plus ancienne requête journalisée, en l'attendant au plus
+     * timeoutMs. @return false si aucune n'est arrivée.
+     */
+    bool WaitRequest(VirtualRequest& request, int timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(m_RecordMutex);
+        if (!m_RecordReady.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                    [this]() { return !m_Records.empty(); }))
+            return false;
+
+        request = m_Records.front();
+        m_Records.pop_front();
+        return true;
+    }
+
+    uint64_t GetUploadCount() const { return m_Uploads; }
+    uint64_t GetEraseCount() const { return m_Erases; }
+    uint64_t GetPlayEventCount() const { return m_PlayEvents; }
+};
@@ -0,0 +1,129 @@
+//==============================================================================
+// AxisFilterTest.cpp - Précision de l'estimation de vitesse (AxisFilter.h)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Le filtre reçoit une sinusoïde connue, quantifiée sur 10 bits comme
+// l'ABS_X, à des horodatages irréguliers autour de 1 kHz. Après la
+// convergence, la vitesse et l'accélération estimées sont comparées aux
+// dérivées exactes : erreur efficace et erreur maximale bornées, en
+// pourcentage de la pleine échelle (c'est elle qui fixe l'erreur de force
+// des conditions amortisseur et inertie). Un volant immobile (Hold) doit
+// ramener la vitesse à zéro.
+//==============================================================================
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "AxisFilter.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const double PI = 3.14159265358979;
+const double SINE_AMPLITUDE = 16384.0;           // Demi-course (Q15)
+const double SETTLE_SECONDS = 0.5;               // Convergence ignorée
+
+// Bornes (% de la pleine échelle), environ le double des erreurs mesurées
+const double MAX_VELOCITY_RMS = 1.5;
+const double MAX_VELOCITY_PEAK = 4.0;
+const double MAX_ACCELERATION_RMS = 6.0;
+
+/**
+ * Position quantifiée sur 10 bits (0..1023) puis ramenée en Q15, comme
+ * NormalizeAxis pour l'ABS_X.
+ */
+int32_t QuantizedPosition(double position)
+{
+    const int raw = static_cast<int>(std::lround((position / 32767.0 + 1.0) * 511.5));
+    return static_cast<int32_t>((std::min(1023, std::max(0, raw)) * 2 - 1023) * 32767 / 1023);
+}
+
+struct SineErrors
+{
+    double velocityRms;          // % de la pleine échelle
+    double velocityMax;
+    double accelerationRms;
+};
+
+/**
+ * Suit une sinusoïde de fréquence donnée pendant 3 s ; trames espacées de
+ * 0,7 à 1,3 ms (suite déterministe).
+ */
+SineErrors TrackSine(double frequency)
+{
+    const double omega = 2.0 * PI * frequency;
+    AxisFilter filter;
+    SineErrors errors = { 0.0, 0.0, 0.0 };
+    double velocitySquares = 0.0;
+    double accelerationSquares = 0.0;
+    int samples = 0;
+
+    int64_t timeNs = 0;
+    for (int frame = 0; timeNs < 3000000000LL; frame++)
+    {
+        timeNs += 700000 + (frame * 7919 % 13) * 50000;
+        const double t = static_cast<double>(timeNs) * 1e-9;
+        filter.Update(timeNs, QuantizedPosition(SINE_AMPLITUDE * std::sin(omega * t)));
+        if (t < SETTLE_SECONDS)
+            continue;
+
+        const double velocity = SINE_AMPLITUDE * omega * std::cos(omega * t) / AXIS_VELOCITY_FULL_SCALE;
+        const double acceleration = -SINE_AMPLITUDE * omega * omega * std::sin(omega * t) / AXIS_ACCELERATION_FULL_SCALE;
+        const double velocityError = (filter.GetVelocity() - velocity) / 32767.0 * 100.0;
+        const double accelerationError = (filter.GetAcceleration() - acceleration) / 32767.0 * 100.0;
+
+        velocitySquares += velocityError * velocityError;
+        accelerationSquares += accelerationError * accelerationError;
+        errors.velocityMax = std::max(errors.velocityMax, std::fabs(velocityError));
+        samples++;
+    }
+
+    errors.velocityRms = std::sqrt(velocitySquares / samples);
+    errors.accelerationRms = std::sqrt(accelerationSquares / samples);
+    return errors;
+}
+
+} // namespace
+
+int main()
+{
+    // Mouvements de conduite typiques : slalom lent et contre-braquage
+    const SineErrors slow = TrackSine(0.5);
+    TEST_CHECK(slow.velocityRms < MAX_VELOCITY_RMS);
+    TEST_CHECK(slow.velocityMax < MAX_VELOCITY_PEAK);
+    TEST_CHECK(slow.accelerationRms < MAX_ACCELERATION_RMS);
+
+    const SineErrors fast = TrackSine(2.0);
+    TEST_CHECK(fast.velocityRms < MAX_VELOCITY_RMS);
+    TEST_CHECK(fast.velocityMax < MAX_VELOCITY_PEAK);
+    TEST_CHECK(fast.accelerationRms < MAX_ACCELERATION_RMS);
+
+    // Volant lâché puis immobile : plus d'événements, Hold() à chaque lecture
+    AxisFilter filter;
+    int64_t timeNs = 0;
+    for (int frame = 0; frame < 500; frame++)
+    {
+        timeNs += 1000000;
+        filter.Update(timeNs, QuantizedPosition(frame * 20.0));
+    }
+    TEST_CHECK(filter.GetVelocity() > 0);
+
+    const int32_t restPosition = QuantizedPosition(499 * 20.0);
+    for (int read = 0; read < 50; read++)
+    {
+        timeNs += 16000000;
+        filter.Hold(timeNs, restPosition);
+    }
+    TEST_CHECK_NEAR(filter.GetVelocity(), 0.0, 16.0);
+
+    // Horodatage antérieur : mesure ignorée
+    const int32_t before = filter.GetPosition();
+    filter.Update(timeNs - 1000000, 30000);
+    TEST_CHECK(filter.GetPosition() == before);
+
+    return test::Finish("axis_filter_test");
+}
@@ -0,0 +1,253 @@
+//==============================================================================
+// BinaryLogTest.cpp - Aller-retour du log binaire (Logger.h, ffblog)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Écrit un log binaire avec le Logger (entiers aux limites des varints et du
+// zigzag, flottants, chaînes dont une dépasse la capacité d'un
+// enregistrement, hexadécimal, booléens), le décode avec ffblog et compare
+// chaque message au texte que produirait le log texte. Vérifie aussi :
+//  - le cache des formats : une description par appel, pas par ligne ;
+//  - un tampon const rempli à l'exécution (pris pour un littéral par son
+//    type) : redécrit à chaque ligne, décodé avec son contenu courant ;
+//  - les horodatages delta : croissants d'une ligne à l'autre ;
+//  - un fichier coupé au milieu d'un enregistrement : lignes précédentes
+//    restituées, code de sortie 1.
+//
+// Usage : binary_log_test <chemin de ffblog>
+//==============================================================================
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdio>
+#include <cstdint>
+#include <sys/wait.h>
+
+#include "Logger.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const char* const LOG_FILE = "binary_log_test.ffblog";
+const char* const TRUNCATED_FILE = "binary_log_test.truncated.ffblog";
+const int CACHED_REPEATS = 50;
+const int BUFFER_REPEATS = 5;
+const size_t CALL_SITES = 10;            // Appels Info() distincts ci-dessous
+
+/**
+ * Écrit la ligne et garde le message attendu (formatage du log texte).
+ */
+template<typename... Args>
+void LogLine(Logger& logger, std::vector<std::string>& expected, Args&&... args)
+{
+    std::ostringstream oss;
+    (oss << ... << args);
+    expected.push_back(oss.str());
+    logger.Info(std::forward<Args>(args)...);
+}
+
+/**
+ * Lance ffblog et récupère ses lignes.
+ * @return Code de sortie de ffblog (-1 si le lancement échoue).
+ */
+int RunDecoder(const std::string& ffblog, const char* path, std::vector<std::string>& lines)
+{
+    const std::string command = "\"" + ffblog + "\" " + path + " 2>/dev/null";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe)
+        return -1;
+
+    std::string line;
+    int c;
+    while ((c = fgetc(pipe)) != EOF)
+    {
+        if (c == '\n')
+        {
+            lines.push_back(line);
+            line.clear();
+        }
+        else
+        {
+            line += static_cast<char>(c);
+        }
+    }
+    const int status = pclose(pipe);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * Nombre d'enregistrements de chaque type dans le fichier, et position du
+ * dernier enregistrement Line.
+ */
+bool CountRecords(const std::string& data, size_t counts[4], size_t& lastLine)
+{
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        const size_t start = offset;
+        size_t payload = static_cast<uint8_t>(data[offset]) & 0x7F;
+        if (static_cast<uint8_t>(data[offset++]) & 0x80)
+            payload |= static_cast<size_t>(static_cast<uint8_t>(data[offset++])) << 7;
+        if (payload == 0 || offset + payload > data.size())
+            return false;
+        const uint8_t type = static_cast<uint8_t>(data[offset]);
+        if (type > static_cast<uint8_t>(BinaryLogRecord::End))
+            return false;
+        counts[type]++;
+        if (type == static_cast<uint8_t>(BinaryLogRecord::Line))
+            lastLine = start;
+        offset += payload;
+    }
+    return true;
+}
+
+/**
+ * "[horodatage] [NIVEAU] message" -> horodatage et message.
+ */
+bool SplitLine(const std::string& line, std::string& timestamp, std::string& message)
+{
+    const size_t level = line.find("] [");
+    const size_t text = line.find("] ", level + 3);
+    if (line.empty() || line[0] != '[' || level == std::string::npos || text == std::string::npos)
+        return false;
+    timestamp = line.substr(1, level - 1);
+    message = line.substr(text + 2);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <chemin de ffblog>" << std::endl;
+        return 2;
+    }
+    const std::string ffblog = argv[1];
+
+    std::remove(LOG_FILE);
+    Logger logger;
+    LogRotationParams rotation;
+    rotation.maxBytes = 0;
+    rotation.bCompress = false;
+    logger.SetRotation(rotation);
+    logger.SetFormat(LogFormat::Binary);
+    logger.SetConsoleOutput(false);
+    if (!TEST_CHECK(logger.Open(LOG_FILE)))
+        return test::Finish("binary_log_test");
+
+    std::vector<std::string> expected;
+
+    // Entiers : limites des varints (1, 2 et 10 octets) et du zigzag
+    const int64_t signedValues[] = {
+        0, -1, 1, 63, -64, 64, -65, 8191, -8192,
+        std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()
+    };
+    for (int64_t value : signedValues)
+        LogLine(logger, expected, "int64 ", value);
+    LogLine(logger, expected, "int16 ", static_cast<int16_t>(-32768), " int32 ", static_cast<int32_t>(-2147483647 - 1));
+    LogLine(logger, expected, "uint ", 127u, " ", 128u, " ", std::numeric_limits<uint64_t>::max());
+
+    // Flottants (f32 et f64)
+    LogLine(logger, expected, "float ", 0.1f, " ", -3.5f, " ", 1e-20f, " ", 3.4e38f);
+    LogLine(logger, expected, "double ", 3.14159265358979, " ", -2.5e-300, " ", 0.0);
+
+    // Chaînes, caractères, hexadécimal, booléens
+    const std::string name = "Sidewinder";
+    const char* path = "/dev/input/event7";
+    LogLine(logger, expected, "Volant ", name, " sur ", path, " ", 'X', " ", Logger::Hex(0xBEEF), " ", true, false);
+    LogLine(logger, expected, "vide [", std::string(), "]");
+
+    // Chaîne plus longue qu'un enregistrement : tronquée, sans corrompre la suite
+    const std::string longText(3000, 'a');
+    logger.Info("long ", longText, " fin");
+    const size_t truncatedLine = expected.size();
+    expected.push_back(std::string());
+    LogLine(logger, expected, "après la chaîne longue ", 42);
+
+    // Même appel répété : décrit une seule fois dans le segment
+    for (int i = 0; i < CACHED_REPEATS; i++)
+        LogLine(logger, expected, "répété ", i, " ", i * 0.5);
+
+    // Membre char[N] vu à travers une référence const : même type qu'un
+    // littéral, même adresse, contenu différent à chaque ligne
+    struct DeviceName
+    {
+        char text[32];
+    };
+    DeviceName device;
+    for (int i = 0; i < BUFFER_REPEATS; i++)
+    {
+        snprintf(device.text, sizeof(device.text), "Volant %d", i);
+        const DeviceName& view = device;
+        LogLine(logger, expected, "nom ", view.text);
+    }
+
+    logger.Close();
+
+    // Structure du fichier : une description par appel, une par ligne du tampon
+    std::ifstream file(LOG_FILE, std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t counts[4] = { 0, 0, 0, 0 };
+    size_t lastLine = 0;
+    TEST_CHECK(CountRecords(data, counts, lastLine));
+    TEST_CHECK(counts[static_cast<int>(BinaryLogRecord::Header)] == 1);
+    TEST_CHECK(counts[static_cast<int>(BinaryLogRecord::Line)] == expected.size());
+    TEST_CHECK(counts[static_cast<int>(BinaryLogRecord::Format)] == CALL_SITES + BUFFER_REPEATS);
+    TEST_CHECK(counts[static_cast<int>(BinaryLogRecord::End)] == 1);
+
+    // Décodage complet
+    std::vector<std::string> lines;
+    TEST_CHECK(RunDecoder(ffblog, LOG_FILE, lines) == 0);
+    if (!TEST_CHECK(lines.size() == expected.size() + 2))
+        return test::Finish("binary_log_test");
+
+    TEST_CHECK(lines.front().rfind("=== Segment démarré: ", 0) == 0);
+    TEST_CHECK(lines.back().rfind("=== Session terminée: ", 0) == 0);
+
+    std::string previousTimestamp;
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        std::string timestamp;
+        std::string message;
+        if (!TEST_CHECK(SplitLine(lines[i + 1], timestamp, message)))
+            continue;
+
+        TEST_CHECK(timestamp >= previousTimestamp);
+        previousTimestamp = timestamp;
+
+        if (i == truncatedLine)
+        {
+            // Valeur coupée à la place restante ; les littéraux viennent du format
+            const size_t kept = message.size() - std::string("long  fin").size();
+            TEST_CHECK(kept < BINARY_LOG_RECORD_CAPACITY);
+            TEST_CHECK(kept > BINARY_LOG_RECORD_CAPACITY / 2);
+            TEST_CHECK(message == "long " + longText.substr(0, kept) + " fin");
+        }
+        else if (message != expected[i])
+        {
+            TEST_CHECK(message == expected[i]);
+            std::cerr << "    décodé  : " << message << "\n    attendu : " << expected[i] << std::endl;
+        }
+    }
+
+    // Fichier coupé au milieu de la dernière ligne
+    std::ofstream truncated(TRUNCATED_FILE, std::ios::binary | std::ios::trunc);
+    truncated.write(data.data(), static_cast<std::streamsize>(lastLine + 2));
+    truncated.close();
+
+    std::vector<std::string> partial;
+    TEST_CHECK(RunDecoder(ffblog, TRUNCATED_FILE, partial) == 1);
+    TEST_CHECK(partial.size() == expected.size());
+
+    std::remove(LOG_FILE);
+    std::remove(TRUNCATED_FILE);
+    return test::Finish("binary_log_test");
+}
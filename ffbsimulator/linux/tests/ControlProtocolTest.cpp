@@ -0,0 +1,220 @@
+//==============================================================================
+// ControlProtocolTest.cpp - Décodage du protocole de contrôle
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// DecodeControlRequest doit accepter un lot bien formé (1 à 256 commandes)
+// et refuser tout le reste : message tronqué, magic ou version inconnus,
+// compte nul ou trop grand, taille qui ne correspond pas au compte. Un
+// aller-retour ControlClient -> socket SOCK_SEQPACKET -> décodage, puis
+// ControlReply::Encode -> ControlClient::Receive, vérifie l'assemblage des
+// deux côtés, état compris ; une réponse de taille incohérente est refusée.
+//==============================================================================
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "ControlProtocol.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+/**
+ * Requête brute de count commandes (op Play, effet i, valeur -i).
+ */
+size_t BuildRequest(uint8_t* buffer, uint16_t count, uint32_t requestId)
+{
+    ControlHeader header;
+    header.magic = CONTROL_MAGIC;
+    header.version = CONTROL_VERSION;
+    header.flags = 0;
+    header.count = count;
+    header.reserved = 0;
+    header.requestId = requestId;
+    memcpy(buffer, &header, sizeof(header));
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        ControlCommand command;
+        command.op = static_cast<uint8_t>(ControlOp::Play);
+        command.reserved = 0;
+        command.effect = static_cast<int16_t>(i);
+        command.value = -static_cast<int32_t>(i);
+        memcpy(buffer + sizeof(header) + i * sizeof(command), &command, sizeof(command));
+    }
+    return sizeof(header) + count * sizeof(ControlCommand);
+}
+
+void CheckDecode()
+{
+    static uint8_t buffer[CONTROL_MAX_REQUEST + sizeof(ControlCommand)];
+    static ControlRequest request;
+
+    // Lot d'une commande et lot maximal
+    size_t size = BuildRequest(buffer, 1, 7);
+    TEST_CHECK(DecodeControlRequest(buffer, size, request));
+    TEST_CHECK(request.header.requestId == 7 && request.header.count == 1);
+    TEST_CHECK(request.commands[0].op == static_cast<uint8_t>(ControlOp::Play));
+
+    size = BuildRequest(buffer, CONTROL_MAX_COMMANDS, 8);
+    TEST_CHECK(size == CONTROL_MAX_REQUEST);
+    TEST_CHECK(DecodeControlRequest(buffer, size, request));
+    TEST_CHECK(request.commands[255].effect == 255 && request.commands[255].value == -255);
+
+    // Tronqué : en-tête incomplet, dernière commande incomplète
+    TEST_CHECK(!DecodeControlRequest(buffer, 0, request));
+    TEST_CHECK(!DecodeControlRequest(buffer, sizeof(ControlHeader) - 1, request));
+    size = BuildRequest(buffer, 3, 9);
+    TEST_CHECK(!DecodeControlRequest(buffer, size - 1, request));
+    TEST_CHECK(!DecodeControlRequest(buffer, sizeof(ControlHeader), request));
+
+    // Octets en trop après les commandes
+    TEST_CHECK(!DecodeControlRequest(buffer, size + sizeof(ControlCommand), request));
+
+    // Magic, version
+    ControlHeader* header = reinterpret_cast<ControlHeader*>(buffer);
+    header->magic = 0x4643;
+    TEST_CHECK(!DecodeControlRequest(buffer, size, request));
+    header->magic = CONTROL_MAGIC;
+    header->version = CONTROL_VERSION + 1;
+    TEST_CHECK(!DecodeControlRequest(buffer, size, request));
+    header->version = CONTROL_VERSION;
+    TEST_CHECK(DecodeControlRequest(buffer, size, request));
+
+    // Compte nul ou au-delà du maximum (taille cohérente avec le compte)
+    size = BuildRequest(buffer, 0, 10);
+    TEST_CHECK(!DecodeControlRequest(buffer, size, request));
+    size = BuildRequest(buffer, CONTROL_MAX_COMMANDS, 11);
+    header->count = CONTROL_MAX_COMMANDS + 1;
+    TEST_CHECK(!DecodeControlRequest(buffer, size + sizeof(ControlCommand), request));
+}
+
+void CheckReplyEncode()
+{
+    static ControlReply reply;
+    static uint8_t buffer[CONTROL_MAX_REPLY];
+
+    ControlHeader request;
+    memset(&request, 0, sizeof(request));
+    request.magic = CONTROL_MAGIC;
+    request.version = CONTROL_VERSION;
+    request.flags = CONTROL_FLAG_NO_REPLY;
+    request.requestId = 42;
+
+    reply.Reset(request);
+    TEST_CHECK(reply.header.flags == 0 && reply.header.count == 0);
+    TEST_CHECK(reply.Encode(buffer) == sizeof(ControlHeader));
+
+    ControlCommand command;
+    command.op = static_cast<uint8_t>(ControlOp::SetLevel);
+    command.reserved = 0;
+    command.effect = 3;
+    command.value = 16384;
+    reply.Add(command, ControlStatus::Ok, 16384);
+    reply.Add(command, ControlStatus::UnknownEffect);
+    TEST_CHECK(reply.Encode(buffer) == sizeof(ControlHeader) + 2 * sizeof(ControlResult));
+
+    reply.header.flags |= CONTROL_FLAG_STATE;
+    TEST_CHECK(reply.Encode(buffer) == sizeof(ControlHeader) + 2 * sizeof(ControlResult) + sizeof(ControlState));
+
+    ControlResult second;
+    memcpy(&second, buffer + sizeof(ControlHeader) + sizeof(ControlResult), sizeof(second));
+    TEST_CHECK(second.status == static_cast<uint8_t>(ControlStatus::UnknownEffect));
+    TEST_CHECK(second.effect == 3 && second.value == 0);
+}
+
+/**
+ * Aller-retour par une vraie socket : le client envoie, le « serveur »
+ * décode et répond avec l'état.
+ */
+void CheckRoundTrip()
+{
+    const std::string path = "/tmp/ffb_control_test." + std::to_string(getpid()) + ".sock";
+    unlink(path.c_str());
+
+    const int listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (!TEST_CHECK(listener >= 0 &&
+                    bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+                    listen(listener, 1) == 0))
+    {
+        if (listener >= 0)
+            close(listener);
+        return;
+    }
+
+    static ControlClient client;
+    static ControlRequest request;
+    static ControlReply reply;
+    static uint8_t buffer[CONTROL_MAX_REPLY];
+
+    TEST_CHECK(client.Connect(path));
+    const int server = accept(listener, nullptr, nullptr);
+    TEST_CHECK(server >= 0);
+
+    ControlCommand commands[2];
+    memset(commands, 0, sizeof(commands));
+    commands[0].op = static_cast<uint8_t>(ControlOp::SetLevel);
+    commands[0].effect = 1;
+    commands[0].value = -32767;
+    commands[1].op = static_cast<uint8_t>(ControlOp::QueryState);
+    commands[1].effect = -1;
+    const uint32_t requestId = client.Send(commands, 2);
+    TEST_CHECK(requestId != 0);
+    TEST_CHECK(client.Send(commands, 0) == 0);
+    TEST_CHECK(client.Send(commands, CONTROL_MAX_COMMANDS + 1) == 0);
+
+    const ssize_t received = recv(server, buffer, sizeof(buffer), 0);
+    TEST_CHECK(received == static_cast<ssize_t>(sizeof(ControlHeader) + 2 * sizeof(ControlCommand)));
+    TEST_CHECK(DecodeControlRequest(buffer, static_cast<size_t>(received), request));
+    TEST_CHECK(request.header.requestId == requestId);
+    TEST_CHECK(request.commands[0].value == -32767 && request.commands[1].effect == -1);
+
+    reply.Reset(request.header);
+    reply.Add(request.commands[0], ControlStatus::Ok, request.commands[0].value);
+    reply.Add(request.commands[1], ControlStatus::Ok);
+    memset(&reply.state, 0, sizeof(reply.state));
+    reply.state.position = -1234;
+    reply.state.activeEffects = 0x80000001u;
+    reply.header.flags |= CONTROL_FLAG_STATE;
+    const size_t size = reply.Encode(buffer);
+    TEST_CHECK(send(server, buffer, size, MSG_NOSIGNAL) == static_cast<ssize_t>(size));
+
+    static ControlReply answer;
+    TEST_CHECK(client.Receive(answer, 1000));
+    TEST_CHECK(answer.header.requestId == requestId && answer.header.count == 2);
+    TEST_CHECK(answer.results[0].value == -32767);
+    TEST_CHECK((answer.header.flags & CONTROL_FLAG_STATE) != 0);
+    TEST_CHECK(answer.state.position == -1234 && answer.state.activeEffects == 0x80000001u);
+
+    // Drapeau d'état sans l'état : refusée
+    TEST_CHECK(send(server, buffer, size - sizeof(ControlState), MSG_NOSIGNAL) > 0);
+    TEST_CHECK(!client.Receive(answer, 1000));
+
+    // Rien à lire : délai dépassé
+    TEST_CHECK(!client.Receive(answer, 10));
+
+    client.Close();
+    close(server);
+    close(listener);
+    unlink(path.c_str());
+}
+
+} // namespace
+
+int main()
+{
+    CheckDecode();
+    CheckReplyEncode();
+    CheckRoundTrip();
+    return test::Finish("control_protocol_test");
+}
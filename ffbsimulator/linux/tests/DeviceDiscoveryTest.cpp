@@ -0,0 +1,341 @@
+//==============================================================================
+// DeviceDiscoveryTest.cpp - Détection du volant et cache des capacités
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Sans matériel ni /sys réel :
+//  - ParseSysfsBitmap : mot de poids fort en premier, mots en trop ignorés,
+//    texte invalide ou vide refusé ;
+//  - ParseUevent : champs utiles d'un add/remove, nœud eventX ou non,
+//    messages udev, en-tête sans '@' ou sans champs refusés ;
+//  - FindSysfsInputDevice sur une arborescence sysfs factice : premier
+//    candidat avec FF, candidats sans FF comptés, racine absente ;
+//  - DeviceCapabilityCache : absent puis trouvé après Save/Load, volant
+//    rebranché ailleurs (phys) non trouvé, remplacement, retrait,
+//    éviction de la plus ancienne entrée, entrée corrompue ignorée,
+//    fichier d'une autre version rejeté.
+//==============================================================================
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include "SysfsDiscovery.h"
+#include "HotplugMonitor.h"
+#include "DeviceCache.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const size_t BITS_PER_LONG = sizeof(unsigned long) * 8;
+
+/**
+ * Bitmap au format sysfs (mot de poids fort en premier) à partir de bits.
+ */
+std::string FormatBitmap(const std::vector<int>& setBits, size_t nWords)
+{
+    std::vector<unsigned long> words(nWords, 0);
+    for (int bit : setBits)
+        words[bit / BITS_PER_LONG] |= 1UL << (bit % BITS_PER_LONG);
+
+    std::string text;
+    for (size_t i = nWords; i-- > 0; )
+    {
+        char word[32];
+        snprintf(word, sizeof(word), "%lx", words[i]);
+        text += word;
+        if (i > 0)
+            text += " ";
+    }
+    return text;
+}
+
+void CheckSysfsBitmap()
+{
+    SysfsInputDevice device;
+    const std::string text = FormatBitmap({ FF_CONSTANT, FF_PERIODIC, FF_SPRING, FF_GAIN }, FF_BITMAP_LONGS);
+    TEST_CHECK(ParseSysfsBitmap(text, device.ffBits, FF_BITMAP_LONGS));
+    TEST_CHECK(device.HasFF());
+    TEST_CHECK(device.HasFFBit(FF_CONSTANT) && device.HasFFBit(FF_PERIODIC));
+    TEST_CHECK(device.HasFFBit(FF_SPRING) && device.HasFFBit(FF_GAIN));
+    TEST_CHECK(!device.HasFFBit(FF_RUMBLE) && !device.HasFFBit(FF_DAMPER));
+
+    // Un seul mot : bits de poids faible, le reste remis à zéro
+    unsigned long bits[FF_BITMAP_LONGS];
+    memset(bits, 0xff, sizeof(bits));
+    TEST_CHECK(ParseSysfsBitmap("  5 ", bits, FF_BITMAP_LONGS));
+    TEST_CHECK(bits[0] == 5);
+    for (size_t i = 1; i < FF_BITMAP_LONGS; i++)
+        TEST_CHECK(bits[i] == 0);
+
+    // Plus de mots que de place : les mots de poids fort sont ignorés
+    const std::string wide = "ff " + FormatBitmap({ 0, 3 }, FF_BITMAP_LONGS);
+    TEST_CHECK(ParseSysfsBitmap(wide, bits, FF_BITMAP_LONGS));
+    TEST_CHECK(bits[0] == 9);
+    TEST_CHECK(bits[FF_BITMAP_LONGS - 1] == 0);
+
+    TEST_CHECK(!ParseSysfsBitmap("", bits, FF_BITMAP_LONGS));
+    TEST_CHECK(!ParseSysfsBitmap("   ", bits, FF_BITMAP_LONGS));
+    TEST_CHECK(!ParseSysfsBitmap("30000 zz", bits, FF_BITMAP_LONGS));
+
+    // Conversion vers le bitmap octet par octet du cache
+    DeviceCapabilities caps;
+    caps.SetFFBits(device.ffBits, FF_BITMAP_LONGS);
+    TEST_CHECK(caps.HasFFBit(FF_CONSTANT) && caps.HasFFBit(FF_GAIN) && !caps.HasFFBit(FF_RUMBLE));
+    TEST_CHECK(caps.SameFFBits(device.ffBits, FF_BITMAP_LONGS));
+    device.ffBits[FF_RUMBLE / BITS_PER_LONG] |= 1UL << (FF_RUMBLE % BITS_PER_LONG);
+    TEST_CHECK(!caps.SameFFBits(device.ffBits, FF_BITMAP_LONGS));
+}
+
+bool ParseUevent(const char* buf, size_t len, UeventMessage& msg)
+{
+    return HotplugMonitor::ParseUevent(buf, len, msg);
+}
+
+void CheckUevent()
+{
+    static const char add[] =
+        "add@/devices/pci0000:00/usb1/1-2/1-2:1.0/input/input7/event5\0"
+        "ACTION=add\0"
+        "DEVPATH=/devices/pci0000:00/usb1/1-2/1-2:1.0/input/input7/event5\0"
+        "SUBSYSTEM=input\0"
+        "MAJOR=13\0"
+        "MINOR=69\0"
+        "DEVNAME=input/event5\0"
+        "SEQNUM=4242\0";
+
+    UeventMessage msg;
+    TEST_CHECK(ParseUevent(add, sizeof(add) - 1, msg));
+    TEST_CHECK(msg.action == "add");
+    TEST_CHECK(msg.subsystem == "input");
+    TEST_CHECK(msg.devPath == "/devices/pci0000:00/usb1/1-2/1-2:1.0/input/input7/event5");
+    TEST_CHECK(msg.devName == "input/event5");
+    TEST_CHECK(msg.GetEventName() == "event5");
+
+    // Retrait d'un nœud inputN (sans DEVNAME) : les champs précédents sont effacés
+    static const char remove[] =
+        "remove@/devices/virtual/input/input9\0"
+        "ACTION=remove\0"
+        "DEVPATH=/devices/virtual/input/input9\0"
+        "SUBSYSTEM=input\0";
+    TEST_CHECK(ParseUevent(remove, sizeof(remove) - 1, msg));
+    TEST_CHECK(msg.action == "remove");
+    TEST_CHECK(msg.devName.empty() && msg.GetEventName().empty());
+
+    // Nœud joystick : pas un eventX
+    static const char joystick[] = "add@/devices/x/js0\0ACTION=add\0DEVNAME=input/js0\0";
+    TEST_CHECK(ParseUevent(joystick, sizeof(joystick) - 1, msg));
+    TEST_CHECK(msg.GetEventName().empty());
+
+    // Dernier champ sans '\0' final (longueur reçue exacte)
+    static const char unterminated[] = "change@/devices/x\0ACTION=change";
+    TEST_CHECK(ParseUevent(unterminated, sizeof(unterminated) - 1, msg));
+    TEST_CHECK(msg.action == "change");
+
+    static const char udev[] = "libudev\0\xfe\xed\xca\xfe";
+    static const char noAt[] = "add /devices/x\0ACTION=add\0";
+    static const char headerOnly[] = "add@/devices/x";
+    static const char noAction[] = "add@/devices/x\0SUBSYSTEM=input\0";
+    TEST_CHECK(!ParseUevent(udev, sizeof(udev) - 1, msg));
+    TEST_CHECK(!ParseUevent(noAt, sizeof(noAt) - 1, msg));
+    TEST_CHECK(!ParseUevent(headerOnly, sizeof(headerOnly) - 1, msg));
+    TEST_CHECK(!ParseUevent(noAction, sizeof(noAction) - 1, msg));
+    TEST_CHECK(msg.action.empty());
+}
+
+bool WriteFile(const std::string& path, const std::string& content)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    const bool bWritten = fwrite(content.data(), 1, content.size(), file) == content.size();
+    return (fclose(file) == 0) && bWritten;
+}
+
+/**
+ * Crée classRoot/eventName/device/ avec ids, nom, phys et (si ff n'est pas
+ * vide) capabilities/ff.
+ */
+void MakeSysfsNode(const std::string& classRoot, const std::string& eventName,
+                   const char* vendor, const char* product, const std::string& ff)
+{
+    const std::string base = classRoot + "/" + eventName;
+    mkdir(base.c_str(), 0755);
+    mkdir((base + "/device").c_str(), 0755);
+    mkdir((base + "/device/id").c_str(), 0755);
+    mkdir((base + "/device/capabilities").c_str(), 0755);
+
+    if (vendor)
+        TEST_CHECK(WriteFile(base + "/device/id/vendor", std::string(vendor) + "\n"));
+    if (product)
+        TEST_CHECK(WriteFile(base + "/device/id/product", std::string(product) + "\n"));
+    TEST_CHECK(WriteFile(base + "/device/id/bustype", "0003\n"));
+    TEST_CHECK(WriteFile(base + "/device/id/version", "0100\n"));
+    TEST_CHECK(WriteFile(base + "/device/name", "Microsoft SideWinder Force Feedback Wheel\n"));
+    TEST_CHECK(WriteFile(base + "/device/phys", "usb-0000:00:14.0-2/input0\n"));
+    if (!ff.empty())
+        TEST_CHECK(WriteFile(base + "/device/capabilities/ff", ff + "\n"));
+}
+
+void CheckSysfsScan(const std::string& dir)
+{
+    const std::string classRoot = dir + "/class_input";
+    mkdir(classRoot.c_str(), 0755);
+
+    const std::string ff = FormatBitmap({ FF_CONSTANT, FF_SPRING }, FF_BITMAP_LONGS);
+    MakeSysfsNode(classRoot, "event0", "046d", "c31c", std::string());
+    MakeSysfsNode(classRoot, "event1", "045e", "001b", std::string());
+    MakeSysfsNode(classRoot, "event2", "045e", "0034", ff);
+    MakeSysfsNode(classRoot, "event9", nullptr, nullptr, ff);
+    MakeSysfsNode(classRoot, "mouse0", "045e", "0034", ff);
+
+    SysfsInputDevice found;
+    SysfsScanStats stats;
+    auto isMicrosoft = [](const SysfsInputDevice& device) { return device.vendor == 0x045e; };
+    TEST_CHECK(FindSysfsInputDevice(classRoot, isMicrosoft, found, stats));
+    TEST_CHECK(found.eventName == "event2" && found.devNode == "/dev/input/event2");
+    TEST_CHECK(found.vendor == 0x045e && found.product == 0x0034);
+    TEST_CHECK(found.bustype == 0x0003 && found.version == 0x0100);
+    TEST_CHECK(found.name == "Microsoft SideWinder Force Feedback Wheel");
+    TEST_CHECK(found.phys == "usb-0000:00:14.0-2/input0");
+    TEST_CHECK(found.HasFFBit(FF_CONSTANT) && found.HasFFBit(FF_SPRING));
+
+    // event1 accepté par le prédicat mais sans FF ; event9 sans ids non compté
+    auto isGamepad = [](const SysfsInputDevice& device) { return device.product == 0x001b; };
+    TEST_CHECK(!FindSysfsInputDevice(classRoot, isGamepad, found, stats));
+    TEST_CHECK(stats.devicesScanned == 3);
+    TEST_CHECK(stats.candidatesWithoutFF == 1);
+
+    TEST_CHECK(!FindSysfsInputDevice(dir + "/absent", isMicrosoft, found, stats));
+    TEST_CHECK(stats.devicesScanned == 0);
+}
+
+DeviceIdentity MakeIdentity(const std::string& phys, uint16_t product)
+{
+    DeviceIdentity identity;
+    identity.bustype = 0x0003;
+    identity.vendor = 0x045e;
+    identity.product = product;
+    identity.version = 0x0100;
+    identity.SetStrings(phys, "Microsoft SideWinder Force Feedback Wheel");
+    return identity;
+}
+
+DeviceCapabilities MakeCaps(int32_t maxEffects)
+{
+    unsigned long bits[FF_BITMAP_LONGS] = {};
+    bits[FF_CONSTANT / BITS_PER_LONG] |= 1UL << (FF_CONSTANT % BITS_PER_LONG);
+
+    DeviceCapabilities caps;
+    caps.SetFFBits(bits, FF_BITMAP_LONGS);
+    caps.maxEffects = maxEffects;
+    caps.axes[0].minimum = -512;
+    caps.axes[0].maximum = 511;
+    caps.updateRateHz = 500;
+    caps.updateP99Us = 850;
+    return caps;
+}
+
+void CheckCache(const std::string& dir)
+{
+    const std::string path = dir + "/devices.cache";
+    const DeviceIdentity wheel = MakeIdentity("usb-0000:00:14.0-2/input0", 0x0034);
+
+    DeviceCapabilityCache cache;
+    DeviceCapabilities caps;
+    TEST_CHECK(!cache.Load(path));
+    TEST_CHECK(!cache.Find(wheel, caps));
+
+    cache.Store(wheel, MakeCaps(16));
+    TEST_CHECK(cache.Save());
+
+    DeviceCapabilityCache reloaded;
+    TEST_CHECK(reloaded.Load(path));
+    if (TEST_CHECK(reloaded.Find(wheel, caps)))
+    {
+        TEST_CHECK(caps.maxEffects == 16);
+        TEST_CHECK(caps.HasFFBit(FF_CONSTANT) && !caps.HasFFBit(FF_SPRING));
+        TEST_CHECK(caps.axes[0].minimum == -512 && caps.axes[0].maximum == 511);
+        TEST_CHECK(caps.updateRateHz == 500 && caps.updateP99Us == 850);
+    }
+
+    // Même volant sur un autre port USB : absent
+    TEST_CHECK(!reloaded.Find(MakeIdentity("usb-0000:00:14.0-3/input0", 0x0034), caps));
+
+    // Nouveau sondage : l'entrée est remplacée, pas dupliquée
+    reloaded.Store(wheel, MakeCaps(32));
+    TEST_CHECK(reloaded.Find(wheel, caps) && caps.maxEffects == 32);
+    reloaded.Remove(wheel);
+    TEST_CHECK(!reloaded.Find(wheel, caps));
+
+    // Cache plein : la plus ancienne entrée est évincée
+    for (uint32_t i = 0; i <= DEVICE_CACHE_MAX_ENTRIES; i++)
+        reloaded.Store(MakeIdentity("usb-port-" + std::to_string(i), 0x0034), MakeCaps(static_cast<int32_t>(i)));
+    TEST_CHECK(!reloaded.Find(MakeIdentity("usb-port-0", 0x0034), caps));
+    TEST_CHECK(reloaded.Find(MakeIdentity("usb-port-1", 0x0034), caps) && caps.maxEffects == 1);
+    TEST_CHECK(reloaded.Find(MakeIdentity("usb-port-16", 0x0034), caps) && caps.maxEffects == 16);
+    TEST_CHECK(reloaded.Save());
+
+    // Un octet modifié dans la première entrée : seule celle-ci est perdue
+    FILE* file = fopen(path.c_str(), "r+b");
+    if (TEST_CHECK(file != nullptr))
+    {
+        const long offset = 16 + 8 + 12;     // En-tête (4 x 32 bits), ids, puis phys[12]
+        fseek(file, offset, SEEK_SET);
+        const int byte = fgetc(file);
+        fseek(file, offset, SEEK_SET);
+        fputc(byte ^ 0x01, file);
+        fclose(file);
+    }
+    DeviceCapabilityCache damaged;
+    TEST_CHECK(damaged.Load(path));
+    TEST_CHECK(!damaged.Find(MakeIdentity("usb-port-1", 0x0034), caps));
+    TEST_CHECK(damaged.Find(MakeIdentity("usb-port-2", 0x0034), caps) && caps.maxEffects == 2);
+
+    // Autre version du format : fichier entièrement ignoré
+    file = fopen(path.c_str(), "r+b");
+    if (TEST_CHECK(file != nullptr))
+    {
+        const uint32_t version = DEVICE_CACHE_VERSION + 1;
+        fseek(file, 4, SEEK_SET);
+        fwrite(&version, sizeof(version), 1, file);
+        fclose(file);
+    }
+    DeviceCapabilityCache outdated;
+    TEST_CHECK(!outdated.Load(path));
+    TEST_CHECK(!outdated.Find(MakeIdentity("usb-port-2", 0x0034), caps));
+
+    // Sans Load(), aucun emplacement où écrire
+    DeviceCapabilityCache unnamed;
+    TEST_CHECK(!unnamed.Save());
+}
+
+int RemoveEntry(const char* path, const struct stat*, int, struct FTW*)
+{
+    return remove(path);
+}
+
+} // namespace
+
+int main()
+{
+    CheckSysfsBitmap();
+    CheckUevent();
+
+    char dirTemplate[] = "/tmp/ffb_device_discovery.XXXXXX";
+    if (!TEST_CHECK(mkdtemp(dirTemplate) != nullptr))
+        return test::Finish("device_discovery_test");
+    const std::string dir = dirTemplate;
+
+    CheckSysfsScan(dir);
+    CheckCache(dir);
+
+    nftw(dir.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+    return test::Finish("device_discovery_test");
+}
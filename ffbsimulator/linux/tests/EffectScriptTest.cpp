@@ -0,0 +1,175 @@
+//==============================================================================
+// EffectScriptTest.cpp - Compilation des scripts d'effets (EffectScript.h)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Étapes produites par Parse() :
+//  - curseur : play et wait le font avancer, start/stop/level/stopall non ;
+//    commentaires et lignes vides ignorés, durée totale = curseur final ;
+//  - sweep : pas+1 niveaux répartis sur la durée, extrémités exactes ;
+//  - ordre : tri par instant, ordre du script conservé à instant égal ;
+//  - erreurs : numéro de ligne du source (commentaires compris), commande
+//    inconnue, argument manquant ou en trop, niveau hors Q15 ; un script
+//    valide analysé ensuite efface l'erreur et les étapes précédentes.
+//==============================================================================
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "EffectScript.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const int64_t MS = 1000000;
+
+bool IsStep(const ScriptStep& step, int64_t plannedNs, ScriptAction action,
+            const char* effect, int32_t value, int line)
+{
+    return step.plannedNs == plannedNs && step.action == action &&
+           step.effectName == effect && step.value == value && step.lineNumber == line;
+}
+
+/**
+ * Analyse un script qui doit échouer et renvoie le message d'erreur.
+ */
+std::string ParseError(const std::string& text)
+{
+    EffectScript script;
+    TEST_CHECK(!script.Parse(text));
+    return script.GetError();
+}
+
+void CheckCursor()
+{
+    EffectScript script;
+    const bool bParsed = script.Parse(
+        "# démarrage\n"
+        "\n"
+        "start spring      # ressort en fond\n"
+        "play constant 100\n"
+        "level spring 1000\n"
+        "wait 50\n"
+        "stop spring\n"
+        "stopall\n");
+    if (!TEST_CHECK(bParsed))
+        return;
+
+    const std::vector<ScriptStep>& steps = script.GetSteps();
+    if (!TEST_CHECK(steps.size() == 6))
+        return;
+
+    TEST_CHECK(IsStep(steps[0], 0, ScriptAction::Start, "spring", 0, 3));
+    TEST_CHECK(IsStep(steps[1], 0, ScriptAction::Start, "constant", 0, 4));
+    TEST_CHECK(IsStep(steps[2], 100 * MS, ScriptAction::Stop, "constant", 0, 4));
+    TEST_CHECK(IsStep(steps[3], 100 * MS, ScriptAction::SetLevel, "spring", 1000, 5));
+    TEST_CHECK(IsStep(steps[4], 150 * MS, ScriptAction::Stop, "spring", 0, 7));
+    TEST_CHECK(IsStep(steps[5], 150 * MS, ScriptAction::StopAll, "", 0, 8));
+    TEST_CHECK(script.GetDurationNs() == 150 * MS);
+    TEST_CHECK(script.GetError().empty());
+}
+
+void CheckSweep()
+{
+    EffectScript script;
+    if (!TEST_CHECK(script.Parse("sweep constant -1000 1000 90 4\nstart spring\n")))
+        return;
+
+    const std::vector<ScriptStep>& steps = script.GetSteps();
+    if (!TEST_CHECK(steps.size() == 6))
+        return;
+
+    // 5 niveaux sur 90 ms : arrondi vers zéro à chaque pas
+    const int64_t expectedNs[5] = { 0, 22500000, 45 * MS, 67500000, 90 * MS };
+    const int32_t expectedLevel[5] = { -1000, -500, 0, 500, 1000 };
+    for (int i = 0; i < 5; i++)
+        TEST_CHECK(IsStep(steps[i], expectedNs[i], ScriptAction::SetLevel, "constant", expectedLevel[i], 1));
+
+    // Le curseur avance de la durée du balayage
+    TEST_CHECK(IsStep(steps[5], 90 * MS, ScriptAction::Start, "spring", 0, 2));
+    TEST_CHECK(script.GetDurationNs() == 90 * MS);
+
+    // Pas qui ne divisent pas l'écart : la dernière valeur reste exacte
+    if (TEST_CHECK(script.Parse("sweep damper 0 10 30 3\n")))
+    {
+        const std::vector<ScriptStep>& thirds = script.GetSteps();
+        TEST_CHECK(thirds.size() == 4);
+        TEST_CHECK(thirds[1].value == 3 && thirds[2].value == 6 && thirds[3].value == 10);
+        TEST_CHECK(thirds[1].plannedNs == 10 * MS && thirds[3].plannedNs == 30 * MS);
+    }
+}
+
+void CheckStableOrder()
+{
+    // Plusieurs étapes au même instant (0 puis 10 ms) : le tri garde
+    // l'ordre des lignes, le stop du play avant les lignes suivantes
+    EffectScript script;
+    const bool bParsed = script.Parse(
+        "level a 1\n"
+        "level b 2\n"
+        "start c\n"
+        "play d 10\n"
+        "start e\n"
+        "stop a\n");
+    if (!TEST_CHECK(bParsed))
+        return;
+
+    const std::vector<ScriptStep>& steps = script.GetSteps();
+    if (!TEST_CHECK(steps.size() == 7))
+        return;
+
+    const char* expectedEffect[7] = { "a", "b", "c", "d", "d", "e", "a" };
+    const int expectedLine[7] = { 1, 2, 3, 4, 4, 5, 6 };
+    bool bSorted = true;
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        TEST_CHECK(steps[i].effectName == expectedEffect[i]);
+        TEST_CHECK(steps[i].lineNumber == expectedLine[i]);
+        if (i > 0)
+            bSorted &= steps[i - 1].plannedNs <= steps[i].plannedNs;
+    }
+    TEST_CHECK(bSorted);
+    TEST_CHECK(steps[3].plannedNs == 0 && steps[4].plannedNs == 10 * MS);
+}
+
+void CheckErrors()
+{
+    TEST_CHECK(ParseError("# en-tête\n\nstart a\nvibrate a 10\n") == "ligne 4: commande inconnue 'vibrate'");
+    TEST_CHECK(ParseError("play a\n") == "ligne 1: usage: play <effet> <durée_ms>");
+    TEST_CHECK(ParseError("wait 10\nplay a 0\n") == "ligne 2: usage: play <effet> <durée_ms>");
+    TEST_CHECK(ParseError("wait -1\n") == "ligne 1: usage: wait <durée_ms>");
+    TEST_CHECK(ParseError("start\n") == "ligne 1: usage: start <effet>");
+    TEST_CHECK(ParseError("stop\n") == "ligne 1: usage: stop <effet>");
+    TEST_CHECK(ParseError("level a 32768\n") == "ligne 1: usage: level <effet> <niveau -32767..32767>");
+    TEST_CHECK(ParseError("level a -32768\n") == "ligne 1: usage: level <effet> <niveau -32767..32767>");
+    TEST_CHECK(ParseError("sweep a 0 100 10 0\n") == "ligne 1: usage: sweep <effet> <de> <à> <durée_ms> <pas>");
+    TEST_CHECK(ParseError("sweep a 0 40000 10 2\n") == "ligne 1: usage: sweep <effet> <de> <à> <durée_ms> <pas>");
+    TEST_CHECK(ParseError("start a\nstopall now\n") == "ligne 2: argument inattendu 'now'");
+
+    // Un échec n'empêche pas de réutiliser l'objet
+    EffectScript script;
+    TEST_CHECK(!script.Parse("start a\nbogus\n"));
+    TEST_CHECK(script.GetError() == "ligne 2: commande inconnue 'bogus'");
+    TEST_CHECK(script.Parse("play a 5\n"));
+    TEST_CHECK(script.GetError().empty());
+    TEST_CHECK(script.GetSteps().size() == 2);
+    TEST_CHECK(script.GetDurationNs() == 5 * MS);
+
+    // Fichier absent : erreur explicite
+    TEST_CHECK(!script.LoadFile("/nonexistent/ffb_script.txt"));
+    TEST_CHECK(script.GetError() == "impossible d'ouvrir /nonexistent/ffb_script.txt");
+}
+
+} // namespace
+
+int main()
+{
+    CheckCursor();
+    CheckSweep();
+    CheckStableOrder();
+    CheckErrors();
+    return test::Finish("effect_script_test");
+}
@@ -0,0 +1,164 @@
+//==============================================================================
+// EffectTimelineTest.cpp - Tas de minuteries du séquenceur (EffectTimeline.h)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Sur des échéances fixées (sans attendre l'horloge) :
+//  - ordre du tas : événements insérés dans le désordre, retirés par
+//    échéance croissante ;
+//  - ex aequo : même échéance retirée dans l'ordre d'insertion, que l'ajout
+//    passe par Schedule() ou ScheduleBatch(), quelle que soit la séquence
+//    fournie par l'appelant ;
+//  - PopDue : seuls les événements échus (échéance <= now, borne comprise),
+//    ajoutés à la suite du lot ; Clear() et GetPendingCount() ;
+//  - WaitForDue : immédiat si un événement est échu, false sur tas vide ou
+//    à l'arrêt.
+//==============================================================================
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "EffectTimeline.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const int64_t MS = 1000000;
+
+TimelineEvent MakeEvent(int64_t dueNs, int16_t effectId)
+{
+    TimelineEvent event;
+    memset(&event, 0, sizeof(event));
+    event.dueNs = dueNs;
+    event.sequence = 0;
+    event.action = TimelineAction::Start;
+    event.effectId = effectId;
+    event.result = nullptr;
+    return event;
+}
+
+void CheckHeapOrder()
+{
+    EffectTimeline timeline;
+
+    // Permutation de 0..99 (pas premier avec 100) : insertion dans le désordre
+    for (int i = 0; i < 100; i++)
+    {
+        const int slot = (i * 37) % 100;
+        timeline.Schedule(MakeEvent(slot * MS, static_cast<int16_t>(slot)));
+    }
+    TEST_CHECK(timeline.GetPendingCount() == 100);
+
+    std::vector<TimelineEvent> batch;
+    TEST_CHECK(timeline.PopDue(1000 * MS, batch) == 100);
+    if (!TEST_CHECK(batch.size() == 100))
+        return;
+
+    bool bOrdered = true;
+    for (int i = 0; i < 100; i++)
+        bOrdered &= batch[i].dueNs == i * MS && batch[i].effectId == i;
+    TEST_CHECK(bOrdered);
+    TEST_CHECK(timeline.GetPendingCount() == 0);
+}
+
+void CheckTieBreak()
+{
+    EffectTimeline timeline;
+
+    // Séquences fournies par l'appelant décroissantes : ignorées
+    for (int16_t id = 0; id < 5; id++)
+    {
+        TimelineEvent event = MakeEvent(10 * MS, id);
+        event.sequence = 100 - id;
+        timeline.Schedule(event);
+    }
+
+    std::vector<TimelineEvent> events;
+    for (int16_t id = 5; id < 10; id++)
+        events.push_back(MakeEvent(10 * MS, id));
+    events.push_back(MakeEvent(5 * MS, 99));
+    timeline.ScheduleBatch(events);
+    timeline.Schedule(MakeEvent(10 * MS, 10));
+
+    std::vector<TimelineEvent> batch;
+    TEST_CHECK(timeline.PopDue(10 * MS, batch) == 12);
+    if (!TEST_CHECK(batch.size() == 12))
+        return;
+
+    TEST_CHECK(batch[0].effectId == 99);
+    bool bInsertionOrder = true;
+    for (int i = 1; i < 12; i++)
+    {
+        bInsertionOrder &= batch[i].effectId == i - 1;
+        bInsertionOrder &= batch[i].sequence > batch[i - 1].sequence || i == 1;
+    }
+    TEST_CHECK(bInsertionOrder);
+}
+
+void CheckPopDue()
+{
+    EffectTimeline timeline;
+    timeline.Schedule(MakeEvent(30 * MS, 3));
+    timeline.Schedule(MakeEvent(10 * MS, 1));
+    timeline.Schedule(MakeEvent(20 * MS, 2));
+
+    // Le lot n'est pas vidé : les événements s'ajoutent à la suite
+    std::vector<TimelineEvent> batch;
+    batch.push_back(MakeEvent(0, -1));
+
+    TEST_CHECK(timeline.PopDue(10 * MS - 1, batch) == 0);
+    TEST_CHECK(batch.size() == 1);
+
+    TEST_CHECK(timeline.PopDue(20 * MS, batch) == 2);
+    TEST_CHECK(batch.size() == 3);
+    TEST_CHECK(batch[0].effectId == -1 && batch[1].effectId == 1 && batch[2].effectId == 2);
+    TEST_CHECK(timeline.GetPendingCount() == 1);
+
+    // Un événement plus précoce ajouté après coup passe en tête
+    timeline.Schedule(MakeEvent(25 * MS, 4));
+    batch.clear();
+    TEST_CHECK(timeline.PopDue(25 * MS, batch) == 1);
+    TEST_CHECK(batch.size() == 1 && batch[0].effectId == 4);
+
+    timeline.Clear();
+    TEST_CHECK(timeline.GetPendingCount() == 0);
+    TEST_CHECK(timeline.PopDue(1000 * MS, batch) == 0);
+}
+
+void CheckWaitForDue()
+{
+    EffectTimeline timeline;
+    std::atomic<bool> bRunning(true);
+
+    // Tas vide : attente bornée par maxWaitNs
+    TEST_CHECK(!timeline.WaitForDue(bRunning, 2 * MS));
+
+    // Événement déjà échu : retour immédiat
+    const int64_t nowNs = MonotonicNowNs();
+    timeline.Schedule(MakeEvent(nowNs - MS, 1));
+    TEST_CHECK(timeline.WaitForDue(bRunning, 1000 * MS));
+    std::vector<TimelineEvent> batch;
+    TEST_CHECK(timeline.PopDue(MonotonicNowNs(), batch) == 1);
+
+    // Arrêt demandé : pas d'attente de l'échéance
+    timeline.Schedule(MakeEvent(nowNs + 1000 * MS, 2));
+    bRunning = false;
+    TEST_CHECK(!timeline.WaitForDue(bRunning, 1000 * MS));
+    TEST_CHECK(MonotonicNowNs() - nowNs < 500 * MS);
+    TEST_CHECK(timeline.GetPendingCount() == 1);
+}
+
+} // namespace
+
+int main()
+{
+    CheckHeapOrder();
+    CheckTieBreak();
+    CheckPopDue();
+    CheckWaitForDue();
+    return test::Finish("effect_timeline_test");
+}
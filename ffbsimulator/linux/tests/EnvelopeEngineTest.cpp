@@ -0,0 +1,254 @@
+//==============================================================================
+// EnvelopeEngineTest.cpp - Enveloppes ADSR logicielles (EnvelopeEngine.h)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Gains Q15 aux frontières de segment :
+//  - attaque / déclin / maintien : valeur exacte au début de chaque segment,
+//    à une unité près en fin de segment (progression tronquée), milieu
+//    des segments linéaires ;
+//  - effet à durée finie : enveloppe kernel traduite (niveaux relatifs à la
+//    magnitude), relâche automatique à length - fade_length ;
+//  - durée infinie (length 0) : maintien sans fin, relâche à l'arrêt depuis
+//    le gain courant, même en pleine attaque ;
+//  - saturation : niveaux kernel supérieurs à la magnitude ramenés à
+//    Q15_ONE, gains bornés à [0, Q15_ONE] pour toutes les courbes ;
+//  - banque : EvaluateAll() identique à GainAt(), Remove() déplace la
+//    dernière couche.
+//==============================================================================
+
+#include <cstdint>
+#include <cstring>
+
+#include "EnvelopeEngine.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const int32_t ONE = fixp::Q15_ONE;
+const int32_t HALF = fixp::Q15_ONE / 2;
+
+ff_effect MakeConstant(int16_t level, uint16_t lengthMs)
+{
+    ff_effect effect;
+    memset(&effect, 0, sizeof(effect));
+    effect.type = FF_CONSTANT;
+    effect.u.constant.level = level;
+    effect.replay.length = lengthMs;
+    return effect;
+}
+
+void CheckSegments()
+{
+    EnvelopeADSR adsr;
+    adsr.attackMs = 100;
+    adsr.decayMs = 100;
+    adsr.attackLevel = 0;
+    adsr.sustainLevel = HALF;
+
+    EnvelopeBank bank;
+    const size_t i = bank.Add(adsr);
+    if (!TEST_CHECK(i == 0))
+        return;
+
+    // Attaque 0 → 1, déclin 1 → sustain, puis maintien
+    TEST_CHECK(bank.GainAt(i, 0) == 0);
+    TEST_CHECK_NEAR(bank.GainAt(i, 50), HALF, 1);
+    TEST_CHECK_NEAR(bank.GainAt(i, 99), ONE * 99 / 100, 2);
+    TEST_CHECK(bank.GainAt(i, 100) == ONE);
+    TEST_CHECK_NEAR(bank.GainAt(i, 150), (ONE + HALF) / 2, 1);
+    TEST_CHECK(bank.GainAt(i, 200) == HALF);
+    TEST_CHECK(bank.GainAt(i, 10000000) == HALF);
+    TEST_CHECK(!bank.IsFinished(i, 10000000));
+
+    // Attaque monotone sur toute sa durée
+    bool bMonotonic = true;
+    for (int32_t t = 1; t < 100; t++)
+        bMonotonic &= bank.GainAt(i, t) >= bank.GainAt(i, t - 1);
+    TEST_CHECK(bMonotonic);
+}
+
+void CheckFiniteEffect()
+{
+    // 1 s, attaque 200 ms depuis 5000/20000, fondu de 300 ms vers 0
+    ff_effect effect = MakeConstant(-20000, 1000);
+    effect.u.constant.envelope.attack_length = 200;
+    effect.u.constant.envelope.attack_level = 5000;
+    effect.u.constant.envelope.fade_length = 300;
+    effect.u.constant.envelope.fade_level = 0;
+
+    const EnvelopeADSR adsr = EnvelopeFromEffect(effect);
+    TEST_CHECK(adsr.attackMs == 200);
+    TEST_CHECK(adsr.attackLevel == ONE / 4);
+    TEST_CHECK(adsr.releaseMs == 300);
+    TEST_CHECK(adsr.releaseLevel == 0);
+    TEST_CHECK(adsr.autoReleaseMs == 700);
+
+    // L'enveloppe passe en logiciel : le device reçoit l'effet sans elle
+    const ff_effect stripped = StripEnvelope(effect);
+    TEST_CHECK(stripped.u.constant.level == -20000);
+    TEST_CHECK(stripped.u.constant.envelope.attack_length == 0);
+    TEST_CHECK(stripped.u.constant.envelope.fade_length == 0);
+
+    EnvelopeBank bank;
+    const size_t i = bank.Add(adsr);
+    TEST_CHECK(bank.GainAt(i, 0) == ONE / 4);
+    TEST_CHECK(bank.GainAt(i, 200) == ONE);
+    TEST_CHECK(bank.GainAt(i, 699) == ONE);
+    TEST_CHECK(bank.GainAt(i, 700) == ONE);
+    TEST_CHECK_NEAR(bank.GainAt(i, 850), HALF, 1);
+    TEST_CHECK_NEAR(bank.GainAt(i, 999), ONE / 300, 2);
+    TEST_CHECK(!bank.IsFinished(i, 999));
+    TEST_CHECK(bank.IsFinished(i, 1000));
+
+    // Release() après le début de la relâche automatique : sans effet
+    bank.Release(i, 900);
+    TEST_CHECK(bank.IsFinished(i, 1000));
+}
+
+void CheckInfiniteEffect()
+{
+    // length 0 : durée infinie, le fondu n'a pas d'échéance
+    ff_effect effect = MakeConstant(16000, 0);
+    effect.u.constant.envelope.attack_length = 100;
+    effect.u.constant.envelope.attack_level = 0;
+    effect.u.constant.envelope.fade_length = 200;
+    effect.u.constant.envelope.fade_level = 0;
+
+    const EnvelopeADSR adsr = EnvelopeFromEffect(effect);
+    TEST_CHECK(adsr.autoReleaseMs == 0);
+
+    EnvelopeBank bank;
+    const size_t i = bank.Add(adsr);
+    TEST_CHECK(bank.GainAt(i, 100) == ONE);
+    TEST_CHECK(bank.GainAt(i, 1000000) == ONE);
+    TEST_CHECK(!bank.IsFinished(i, 1000000));
+
+    // Arrêt en pleine attaque : la relâche part du gain courant, sans saut
+    const int32_t current = bank.GainAt(i, 40);
+    bank.Release(i, 40);
+    TEST_CHECK(bank.GainAt(i, 40) == current);
+    TEST_CHECK_NEAR(bank.GainAt(i, 140), current / 2, 2);
+    TEST_CHECK(!bank.IsFinished(i, 239));
+    TEST_CHECK(bank.IsFinished(i, 240));
+
+    // Fondu plus long que l'effet : pas de relâche automatique
+    ff_effect shortEffect = MakeConstant(16000, 100);
+    shortEffect.u.constant.envelope.fade_length = 100;
+    TEST_CHECK(EnvelopeFromEffect(shortEffect).autoReleaseMs == 0);
+}
+
+void CheckSaturation()
+{
+    // Niveaux kernel au-delà de la magnitude : gain unitaire
+    ff_effect effect = MakeConstant(10000, 500);
+    effect.u.constant.envelope.attack_length = 50;
+    effect.u.constant.envelope.attack_level = 40000;
+    effect.u.constant.envelope.fade_length = 50;
+    effect.u.constant.envelope.fade_level = 65535;
+    EnvelopeADSR adsr = EnvelopeFromEffect(effect);
+    TEST_CHECK(adsr.attackLevel == ONE);
+    TEST_CHECK(adsr.releaseLevel == ONE);
+
+    // Magnitude extrême (-32768) et magnitude nulle
+    ff_effect periodic;
+    memset(&periodic, 0, sizeof(periodic));
+    periodic.type = FF_PERIODIC;
+    periodic.u.periodic.magnitude = -32768;
+    periodic.u.periodic.envelope.attack_length = 10;
+    periodic.u.periodic.envelope.attack_level = 65535;
+    TEST_CHECK(EffectMagnitude(periodic) == ONE);
+    TEST_CHECK(EnvelopeFromEffect(periodic).attackLevel == ONE);
+    periodic.u.periodic.magnitude = 0;
+    TEST_CHECK(EnvelopeFromEffect(periodic).attackLevel == ONE);
+
+    // Toutes les courbes restent dans [0, Q15_ONE], extrémités exactes
+    const EnvelopeCurve curves[] = { EnvelopeCurve::Linear, EnvelopeCurve::EaseIn,
+                                     EnvelopeCurve::EaseOut, EnvelopeCurve::SCurve,
+                                     EnvelopeCurve::Exponential };
+    for (EnvelopeCurve curve : curves)
+    {
+        EnvelopeADSR shaped;
+        shaped.attackMs = 64;
+        shaped.attackLevel = 0;
+        shaped.releaseMs = 64;
+        shaped.attackCurve = BuiltinCurve(curve);
+        shaped.releaseCurve = BuiltinCurve(curve);
+
+        EnvelopeBank bank;
+        const size_t i = bank.Add(shaped);
+        bool bInRange = true;
+        for (int32_t t = 0; t <= 64; t++)
+        {
+            const int32_t gain = bank.GainAt(i, t);
+            bInRange &= gain >= 0 && gain <= ONE;
+        }
+        bank.Release(i, 64);
+        for (int32_t t = 64; t <= 128; t++)
+        {
+            const int32_t gain = bank.GainAt(i, t);
+            bInRange &= gain >= 0 && gain <= ONE;
+        }
+        TEST_CHECK(bInRange);
+        TEST_CHECK(ShapeCurve(*BuiltinCurve(curve), 0) == 0);
+        TEST_CHECK(ShapeCurve(*BuiltinCurve(curve), ONE) == ONE);
+    }
+}
+
+void CheckBank()
+{
+    // Condition (ressort) : attaque et relâche en S par défaut
+    ff_effect spring;
+    memset(&spring, 0, sizeof(spring));
+    spring.type = FF_SPRING;
+    const EnvelopeADSR condition = EnvelopeFromEffect(spring);
+    TEST_CHECK(condition.attackMs == ENVELOPE_CONDITION_ATTACK_MS);
+    TEST_CHECK(condition.attackLevel == 0);
+    TEST_CHECK(condition.releaseMs == ENVELOPE_CONDITION_RELEASE_MS);
+
+    EnvelopeADSR flat;
+    EnvelopeADSR ramp;
+    ramp.attackMs = 100;
+    ramp.attackLevel = 0;
+
+    EnvelopeBank bank;
+    bank.Add(flat);
+    bank.Add(condition);
+    bank.Add(ramp);
+    TEST_CHECK(bank.GetCount() == 3);
+
+    const int32_t elapsed[3] = { 10, 50, 25 };
+    int32_t gains[3] = { -1, -1, -1 };
+    bank.EvaluateAll(elapsed, gains);
+    TEST_CHECK(gains[0] == ONE);
+    TEST_CHECK_NEAR(gains[1], HALF, 4);
+    TEST_CHECK(gains[2] == bank.GainAt(2, 25));
+    TEST_CHECK(gains[1] == bank.GainAt(1, 50));
+
+    // La dernière couche prend la place de la couche retirée
+    bank.Remove(0);
+    TEST_CHECK(bank.GetCount() == 2);
+    TEST_CHECK(bank.GainAt(0, 25) == gains[2]);
+    TEST_CHECK(bank.GainAt(1, 50) == gains[1]);
+
+    while (!bank.IsFull())
+        bank.Add(flat);
+    TEST_CHECK(bank.Add(flat) == ENVELOPE_MAX_LAYERS);
+    bank.Clear();
+    TEST_CHECK(bank.GetCount() == 0);
+    TEST_CHECK(!bank.IsFinished(0, 1000000));
+}
+
+} // namespace
+
+int main()
+{
+    CheckSegments();
+    CheckFiniteEffect();
+    CheckInfiniteEffect();
+    CheckSaturation();
+    CheckBank();
+    return test::Finish("envelope_engine_test");
+}
@@ -0,0 +1,279 @@
+//==============================================================================
+// LogRotationTest.cpp - Rotation et compression du log (Logger.h)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Dans un répertoire temporaire :
+//  - log texte avec un segment de 4 Ko : segments fermés numérotés, taille
+//    au moins maxBytes, compressés en gzip quand zlib est disponible (le
+//    segment en clair disparaît) ; relus dans l'ordre, ils contiennent
+//    chaque ligne une seule fois, avec les lignes de liaison entre segments ;
+//  - log binaire : chaque segment fermé se décode seul (en-tête et
+//    dictionnaire propres), lignes dans l'ordre d'un segment à l'autre ;
+//  - LogCompressor : un segment introuvable compte comme un échec et le
+//    thread s'arrête proprement.
+//==============================================================================
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "Logger.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const uint64_t TEXT_SEGMENT_BYTES = 4096;
+const uint64_t BINARY_SEGMENT_BYTES = 1024;
+const int TEXT_LINES = 500;
+const int BINARY_LINES = 1000;
+const size_t MAX_LINE_BYTES = 256;               // Dernière ligne + liaison
+
+bool FileExists(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+uint64_t FileSize(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+}
+
+/**
+ * Contenu d'un segment, décompressé si le nom finit par .gz.
+ */
+bool ReadSegment(const std::string& path, std::string& content)
+{
+    content.clear();
+    if (path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0)
+    {
+#if defined(FFB_HAVE_ZLIB)
+        gzFile in = gzopen(path.c_str(), "rb");
+        if (!in)
+            return false;
+        char buffer[4096];
+        int n;
+        while ((n = gzread(in, buffer, sizeof(buffer))) > 0)
+            content.append(buffer, static_cast<size_t>(n));
+        return gzclose(in) == Z_OK && n == 0;
+#else
+        return false;
+#endif
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::ostringstream out;
+    out << in.rdbuf();
+    content = out.str();
+    return true;
+}
+
+/**
+ * Numéro de la ligne "ligne N" ou -1.
+ */
+int LineNumber(const std::string& line)
+{
+    const size_t pos = line.find("] ligne ");
+    return pos == std::string::npos ? -1 : std::atoi(line.c_str() + pos + 8);
+}
+
+Logger& OpenLogger(Logger& logger, LogFormat format, uint64_t maxBytes, bool bCompress)
+{
+    LogRotationParams rotation;
+    rotation.maxBytes = maxBytes;
+    rotation.bCompress = bCompress;
+    logger.SetRotation(rotation);
+    logger.SetFormat(format);
+    logger.SetConsoleOutput(false);
+    return logger;
+}
+
+void CheckTextRotation(const std::string& dir)
+{
+    const std::string path = dir + "/texte.log";
+    Logger logger;
+    OpenLogger(logger, LogFormat::Text, TEXT_SEGMENT_BYTES, true);
+    if (!TEST_CHECK(logger.Open(path)))
+        return;
+
+    for (int i = 0; i < TEXT_LINES; i++)
+        logger.Info("ligne ", i, " du test de rotation");
+    const int segments = logger.GetClosedSegmentCount();
+    logger.Close();          // Attend la fin des compressions
+
+    TEST_CHECK(segments >= 3);
+
+    // Segments fermés, du plus ancien au plus récent, puis le segment actif
+    std::vector<std::string> files;
+    for (int n = 1; n <= segments; n++)
+    {
+        const std::string plain = dir + "/texte." + std::to_string(n) + ".log";
+        if (LogCompressor::IsAvailable())
+        {
+            TEST_CHECK(!FileExists(plain));
+            TEST_CHECK(FileExists(plain + ".gz"));
+            files.push_back(plain + ".gz");
+        }
+        else
+        {
+            TEST_CHECK(FileExists(plain));
+            const uint64_t size = FileSize(plain);
+            TEST_CHECK(size >= TEXT_SEGMENT_BYTES && size < TEXT_SEGMENT_BYTES + MAX_LINE_BYTES);
+            files.push_back(plain);
+        }
+    }
+    TEST_CHECK(!FileExists(dir + "/texte." + std::to_string(segments + 1) + ".log"));
+    files.push_back(path);
+
+    int next = 0;
+    for (size_t n = 0; n < files.size(); n++)
+    {
+        std::string content;
+        if (!TEST_CHECK(ReadSegment(files[n], content)))
+            continue;
+        if (n + 1 < files.size())
+        {
+            TEST_CHECK(content.size() >= TEXT_SEGMENT_BYTES);
+            TEST_CHECK(content.size() < TEXT_SEGMENT_BYTES + MAX_LINE_BYTES);
+            TEST_CHECK(content.find("Suite: segment " + std::to_string(n + 2) + "\n") != std::string::npos);
+        }
+        if (n > 0)
+        {
+            TEST_CHECK(content.rfind("Segment " + std::to_string(n + 1) + ", précédent: ", 0) == 0);
+        }
+
+        std::istringstream lines(content);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            const int number = LineNumber(line);
+            if (number >= 0)
+            {
+                TEST_CHECK(number == next);
+                next = number + 1;
+            }
+        }
+    }
+    TEST_CHECK(next == TEXT_LINES);
+}
+
+void CheckBinaryRotation(const std::string& dir)
+{
+    const std::string path = dir + "/binaire.ffblog";
+    Logger logger;
+    OpenLogger(logger, LogFormat::Binary, BINARY_SEGMENT_BYTES, false);
+    if (!TEST_CHECK(logger.Open(path)))
+        return;
+
+    for (int i = 0; i < BINARY_LINES; i++)
+        logger.Info("ligne ", i, " valeur ", i * 0.25f);
+    const int segments = logger.GetClosedSegmentCount();
+    logger.Close();
+
+    TEST_CHECK(segments >= 3);
+
+    int next = 0;
+    for (int n = 1; n <= segments + 1; n++)
+    {
+        const std::string file = n <= segments ? dir + "/binaire." + std::to_string(n) + ".ffblog" : path;
+        std::ifstream in(file, std::ios::binary);
+        if (!TEST_CHECK(in.is_open()))
+            continue;
+        if (n <= segments)
+        {
+            TEST_CHECK(FileSize(file) >= BINARY_SEGMENT_BYTES);
+        }
+
+        BinaryLogReader reader(in);
+        std::string line;
+        bool bFirst = true;
+        while (reader.Next(line))
+        {
+            if (bFirst)
+                TEST_CHECK(line.rfind("=== Segment démarré: ", 0) == 0);
+            bFirst = false;
+
+            const int number = LineNumber(line);
+            if (number >= 0)
+            {
+                TEST_CHECK(number == next);
+                TEST_CHECK(line.find(" valeur " + std::to_string(number / 4)) != std::string::npos);
+                next = number + 1;
+            }
+        }
+        TEST_CHECK(reader.GetError().empty());
+    }
+    TEST_CHECK(next == BINARY_LINES);
+}
+
+void CheckCompressorFailure(const std::string& dir)
+{
+    LogCompressor compressor;
+    compressor.Enqueue(dir + "/absent.log");
+    compressor.Stop();
+    TEST_CHECK(compressor.GetFailedCount() == 1);
+    TEST_CHECK(compressor.GetCompressedCount() == 0);
+
+    // Le thread repart après un arrêt
+    const std::string segment = dir + "/seul.log";
+    std::ofstream(segment) << "contenu\n";
+    compressor.Enqueue(segment);
+    compressor.Stop();
+    if (LogCompressor::IsAvailable())
+    {
+        TEST_CHECK(compressor.GetCompressedCount() == 1);
+        std::string content;
+        TEST_CHECK(ReadSegment(segment + ".gz", content) && content == "contenu\n");
+    }
+    else
+    {
+        TEST_CHECK(compressor.GetFailedCount() == 2 && FileExists(segment));
+    }
+}
+
+void RemoveDirectory(const std::string& dir)
+{
+    DIR* handle = opendir(dir.c_str());
+    if (handle)
+    {
+        struct dirent* entry;
+        while ((entry = readdir(handle)) != nullptr)
+        {
+            const std::string name = entry->d_name;
+            if (name != "." && name != "..")
+                unlink((dir + "/" + name).c_str());
+        }
+        closedir(handle);
+    }
+    rmdir(dir.c_str());
+}
+
+} // namespace
+
+int main()
+{
+    char dirTemplate[] = "/tmp/ffb_log_rotation.XXXXXX";
+    if (!TEST_CHECK(mkdtemp(dirTemplate) != nullptr))
+        return test::Finish("log_rotation_test");
+    const std::string dir = dirTemplate;
+
+    CheckTextRotation(dir);
+    CheckBinaryRotation(dir);
+    CheckCompressorFailure(dir);
+
+    RemoveDirectory(dir);
+    return test::Finish("log_rotation_test");
+}
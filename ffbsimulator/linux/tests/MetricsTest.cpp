@@ -0,0 +1,127 @@
+//==============================================================================
+// MetricsTest.cpp - Registre de métriques et export Prometheus (Metrics.h)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Sur un registre local, sans exporteur HTTP :
+//  - classes de l'histogramme : une valeur égale à une borne tombe dans
+//    cette classe (le="..." inclusif), une nanoseconde de plus dans la
+//    suivante, au-delà de la dernière borne dans le dépassement ;
+//  - rendu texte : HELP/TYPE une seule fois par nom, séries avec et sans
+//    libellés, compteur mis à l'échelle (ns → s), classes cumulées, +Inf,
+//    _sum en secondes et _count ; comparé octet pour octet.
+//==============================================================================
+
+#include <string>
+#include <cstdint>
+
+#include "Metrics.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+void CheckBucketBoundaries()
+{
+    for (size_t b = 0; b < METRIC_DURATION_BUCKETS; b++)
+    {
+        MetricHistogram histogram;
+        histogram.Observe(METRIC_DURATION_BOUNDS_NS[b]);
+        histogram.Observe(METRIC_DURATION_BOUNDS_NS[b] + 1);
+
+        TEST_CHECK(histogram.GetBucket(b) == 1);
+        TEST_CHECK(histogram.GetBucket(b + 1) == 1);
+        TEST_CHECK(histogram.GetCount() == 2);
+        TEST_CHECK(histogram.GetSumNs() == 2 * METRIC_DURATION_BOUNDS_NS[b] + 1);
+    }
+
+    // Durées nulles ou négatives (horloges décalées) : première classe
+    MetricHistogram histogram;
+    histogram.Observe(0);
+    histogram.Observe(-5);
+    TEST_CHECK(histogram.GetBucket(0) == 2);
+    TEST_CHECK(histogram.GetSumNs() == -5);
+
+    // Bornes strictement croissantes, de 10 µs à 1 s
+    bool bIncreasing = true;
+    for (size_t b = 1; b < METRIC_DURATION_BUCKETS; b++)
+        bIncreasing &= METRIC_DURATION_BOUNDS_NS[b] > METRIC_DURATION_BOUNDS_NS[b - 1];
+    TEST_CHECK(bIncreasing);
+    TEST_CHECK(METRIC_DURATION_BOUNDS_NS[0] == 10000);
+    TEST_CHECK(METRIC_DURATION_BOUNDS_NS[METRIC_DURATION_BUCKETS - 1] == 1000000000);
+}
+
+void CheckExport()
+{
+    MetricsRegistry registry;
+    registry.Counter("ffb_commands_total", "Commandes appliquées").Add(3);
+    registry.Counter("ffb_busy_seconds_total", "Temps occupé", "", 1e-9).Add(1500000000);
+    registry.Gauge("ffb_effect_level", "Niveau par effet", "effect=\"Sinus\"").Set(-4);
+    registry.Gauge("ffb_effect_level", "Niveau par effet", "effect=\"Ressort\"").Set(2);
+
+    MetricHistogram& latency = registry.Histogram("ffb_latency_seconds", "Latence", "stage=\"upload\"");
+    latency.Observe(10000);
+    latency.Observe(10001);
+    latency.Observe(1000000000);
+    latency.Observe(2000000000);
+
+    const std::string expected =
+        "# HELP ffb_commands_total Commandes appliquées\n"
+        "# TYPE ffb_commands_total counter\n"
+        "ffb_commands_total 3\n"
+        "# HELP ffb_busy_seconds_total Temps occupé\n"
+        "# TYPE ffb_busy_seconds_total counter\n"
+        "ffb_busy_seconds_total 1.5\n"
+        "# HELP ffb_effect_level Niveau par effet\n"
+        "# TYPE ffb_effect_level gauge\n"
+        "ffb_effect_level{effect=\"Sinus\"} -4\n"
+        "ffb_effect_level{effect=\"Ressort\"} 2\n"
+        "# HELP ffb_latency_seconds Latence\n"
+        "# TYPE ffb_latency_seconds histogram\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"1e-05\"} 1\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"2.5e-05\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"5e-05\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.0001\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.00025\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.0005\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.001\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.0025\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.005\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.01\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.025\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.05\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.1\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"0.25\"} 2\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"1\"} 3\n"
+        "ffb_latency_seconds_bucket{stage=\"upload\",le=\"+Inf\"} 4\n"
+        "ffb_latency_seconds_sum{stage=\"upload\"} 3.00002\n"
+        "ffb_latency_seconds_count{stage=\"upload\"} 4\n";
+
+    const std::string text = registry.ExportText();
+    if (!TEST_CHECK(text == expected))
+        std::cerr << text;
+}
+
+void CheckUnlabelledHistogram()
+{
+    // Sans libellé, le seul libellé de classe est le
+    MetricsRegistry registry;
+    registry.Histogram("ffb_tick_seconds", "Tick").Observe(30000000);
+
+    const std::string text = registry.ExportText();
+    TEST_CHECK(text.find("ffb_tick_seconds_bucket{le=\"0.025\"} 0\n") != std::string::npos);
+    TEST_CHECK(text.find("ffb_tick_seconds_bucket{le=\"0.05\"} 1\n") != std::string::npos);
+    TEST_CHECK(text.find("ffb_tick_seconds_sum 0.03\n") != std::string::npos);
+    TEST_CHECK(text.find("ffb_tick_seconds_count 1\n") != std::string::npos);
+}
+
+} // namespace
+
+int main()
+{
+    CheckBucketBoundaries();
+    CheckExport();
+    CheckUnlabelledHistogram();
+    return test::Finish("metrics_test");
+}
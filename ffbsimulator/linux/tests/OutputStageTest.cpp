@@ -0,0 +1,163 @@
+//==============================================================================
+// OutputStageTest.cpp - Décisions de l'étage de sortie (OutputStage.h)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Scénarios tick par tick sur une horloge simulée :
+//  - seuil : petit écart supprimé, puis envoyé tel quel (Flush) une fois la
+//    cible stable depuis flushNs ; un changement de cible relance l'attente ;
+//  - cadence : pas deux envois à moins de minIntervalNs ;
+//  - pente : paliers de maxSlewPerMs par ms écoulée, bornés à 1 s de pause ;
+//  - saturation Q15 de la cible, et proposition refaite sans Commit().
+//==============================================================================
+
+#include <cstdint>
+
+#include "OutputStage.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const int64_t MS = 1000000;
+
+OutputStageParams MakeParams(int32_t threshold, int64_t minIntervalNs, int32_t maxSlewPerMs, int64_t flushNs)
+{
+    OutputStageParams params;
+    params.threshold = threshold;
+    params.minIntervalNs = minIntervalNs;
+    params.maxSlewPerMs = maxSlewPerMs;
+    params.flushNs = flushNs;
+    return params;
+}
+
+void CheckThreshold()
+{
+    OutputStage stage;
+    stage.SetParams(MakeParams(128, 0, 0, 10 * MS));
+    stage.Reset(0, 0);
+
+    int16_t value = -1;
+    TEST_CHECK(stage.Step(0, 1 * MS, value) == OutputDecision::Idle);
+
+    // Écart sous le seuil : supprimé tant que la cible n'est pas stable
+    TEST_CHECK(stage.Step(100, 1 * MS, value) == OutputDecision::SuppressedThreshold);
+    TEST_CHECK(stage.Step(100, 10 * MS, value) == OutputDecision::SuppressedThreshold);
+    TEST_CHECK(value == -1);
+
+    // La cible change : l'attente repart
+    TEST_CHECK(stage.Step(90, 10 * MS, value) == OutputDecision::SuppressedThreshold);
+    TEST_CHECK(stage.Step(90, 19 * MS, value) == OutputDecision::SuppressedThreshold);
+    TEST_CHECK(stage.Step(90, 20 * MS, value) == OutputDecision::Flush);
+    TEST_CHECK(value == 90);
+    stage.Commit(value, 20 * MS);
+    TEST_CHECK(stage.GetSent() == 90);
+    TEST_CHECK(stage.Step(90, 21 * MS, value) == OutputDecision::Idle);
+
+    // Écart au-delà du seuil (dans les deux sens) : envoyé immédiatement
+    TEST_CHECK(stage.Step(90 + 128, 22 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 218);
+    stage.Commit(value, 22 * MS);
+    TEST_CHECK(stage.Step(-5000, 23 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == -5000);
+
+    // Seuil nul : tout changement part
+    stage.SetParams(MakeParams(0, 0, 0, 10 * MS));
+    stage.Reset(0, 0);
+    TEST_CHECK(stage.Step(1, 1 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 1);
+}
+
+void CheckRate()
+{
+    OutputStage stage;
+    stage.SetParams(MakeParams(0, 2 * MS, 0, 10 * MS));
+    stage.Reset(0, 0);
+
+    int16_t value = 0;
+    TEST_CHECK(stage.Step(5000, 1 * MS, value) == OutputDecision::SuppressedRate);
+    TEST_CHECK(stage.Step(5000, 2 * MS, value) == OutputDecision::Send);
+    stage.Commit(value, 2 * MS);
+
+    TEST_CHECK(stage.Step(6000, 3 * MS, value) == OutputDecision::SuppressedRate);
+    TEST_CHECK(stage.Step(6000, 4 * MS - 1, value) == OutputDecision::SuppressedRate);
+    TEST_CHECK(stage.Step(6000, 4 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 6000);
+
+    // Envoi non confirmé : même proposition au tick suivant, sans attente
+    TEST_CHECK(stage.Step(6000, 5 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 6000 && stage.GetSent() == 5000);
+
+    // Une cible revenue à la valeur envoyée n'envoie rien
+    TEST_CHECK(stage.Step(5000, 6 * MS, value) == OutputDecision::Idle);
+
+    // Cible différente à chaque tick de 250 µs : un envoi par intervalle
+    int sends = 0;
+    for (int64_t t = 10 * MS; t < 30 * MS; t += MS / 4)
+    {
+        if (stage.Step(static_cast<int32_t>(t / 1000), t, value) == OutputDecision::Send)
+        {
+            stage.Commit(value, t);
+            sends++;
+        }
+    }
+    TEST_CHECK(sends == 10);
+}
+
+void CheckSlew()
+{
+    OutputStage stage;
+    stage.SetParams(MakeParams(0, 0, 100, 10 * MS));
+    stage.Reset(0, 0);
+
+    // 100 par ms écoulée depuis le dernier envoi
+    int16_t value = 0;
+    TEST_CHECK(stage.Step(10000, 1 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 100 && stage.IsSlewLimited());
+    stage.Commit(value, 1 * MS);
+    TEST_CHECK(stage.Step(10000, 4 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 400);
+    stage.Commit(value, 4 * MS);
+
+    // Vers le bas, et palier d'au moins 1 sans temps écoulé
+    TEST_CHECK(stage.Step(-10000, 5 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 300);
+    stage.Commit(value, 5 * MS);
+    TEST_CHECK(stage.Step(-10000, 5 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 299);
+    stage.Commit(value, 5 * MS);
+
+    // Cible atteinte dans la limite : pas de bornage
+    TEST_CHECK(stage.Step(350, 6 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 350 && !stage.IsSlewLimited());
+
+    // Longue pause : écart borné à 1 s de pente (100000), sans débordement
+    stage.Reset(-32768, 0);
+    TEST_CHECK(stage.Step(32767, 3600LL * 1000 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 32767 && !stage.IsSlewLimited());
+}
+
+void CheckSaturation()
+{
+    OutputStage stage;
+    stage.SetParams(MakeParams(128, 0, 0, 10 * MS));
+    stage.Reset(0, 0);
+
+    int16_t value = 0;
+    TEST_CHECK(stage.Step(100000, 1 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == 32767 && stage.GetTarget() == 32767);
+    TEST_CHECK(stage.Step(-100000, 1 * MS, value) == OutputDecision::Send);
+    TEST_CHECK(value == -32768 && stage.GetTarget() == -32768);
+}
+
+} // namespace
+
+int main()
+{
+    CheckThreshold();
+    CheckRate();
+    CheckSlew();
+    CheckSaturation();
+    return test::Finish("output_stage_test");
+}
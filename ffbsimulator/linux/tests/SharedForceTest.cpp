@@ -0,0 +1,277 @@
+//==============================================================================
+// SharedForceTest.cpp - Anneau de commandes et seqlock (SharedForceInterface.h)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Sur une région en mémoire du processus :
+//  - anneau : ordre conservé sur plusieurs tours (numéros de séquence qui
+//    dépassent la capacité), anneau plein refusé et compté dans
+//    droppedFull, place libérée par un retrait ;
+//  - plusieurs producteurs concurrents et le consommateur : chaque commande
+//    reçue une seule fois, dans l'ordre de chaque producteur ;
+//  - seqlock : un lecteur concurrent d'un écrivain ne voit jamais un état
+//    à moitié publié, et renonce si une écriture ne se termine pas.
+// Puis par shm_open : un client ouvre la région du serveur, une seconde
+// création sous le même nom échoue (EEXIST) tant que le serveur vit, et une
+// région abandonnée est remplacée.
+//==============================================================================
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+#include "SharedForceInterface.h"
+#include "TestHarness.h"
+
+namespace
+{
+
+const int PRODUCERS = 4;
+const int COMMANDS_PER_PRODUCER = 50000;
+const int STATE_PUBLICATIONS = 200000;
+
+// Hors pile : plus de 64 Ko
+SharedForceRegion g_Region;
+
+SharedCommand MakeCommand(int16_t effect, int32_t value)
+{
+    SharedCommand command;
+    command.type = static_cast<uint16_t>(SharedCommandType::SetLevel);
+    command.effect = effect;
+    command.value = value;
+    command.clientNs = 0;
+    return command;
+}
+
+void CheckWraparound()
+{
+    sharedforce::Initialize(g_Region);
+
+    // Trois tours complets, par paquets qui ne tombent pas sur la capacité
+    SharedCommand command;
+    int32_t next = 0;
+    int32_t sent = 0;
+    while (sent < 3 * static_cast<int32_t>(SHARED_FORCE_RING_CAPACITY))
+    {
+        for (int i = 0; i < 7; i++)
+            TEST_CHECK(sharedforce::Push(g_Region, MakeCommand(1, sent++)));
+        while (sharedforce::Pop(g_Region, command))
+        {
+            TEST_CHECK(command.value == next);
+            next++;
+        }
+    }
+    TEST_CHECK(next == sent);
+    TEST_CHECK(g_Region.enqueuePos.load() == static_cast<uint64_t>(sent));
+    TEST_CHECK(g_Region.droppedFull.load() == 0);
+}
+
+void CheckFullRing()
+{
+    sharedforce::Initialize(g_Region);
+
+    for (uint32_t i = 0; i < SHARED_FORCE_RING_CAPACITY; i++)
+        TEST_CHECK(sharedforce::Push(g_Region, MakeCommand(2, static_cast<int32_t>(i))));
+
+    TEST_CHECK(!sharedforce::Push(g_Region, MakeCommand(2, -1)));
+    TEST_CHECK(!sharedforce::Push(g_Region, MakeCommand(2, -2)));
+    TEST_CHECK(g_Region.droppedFull.load() == 2);
+
+    // Un retrait libère exactement une case
+    SharedCommand command;
+    TEST_CHECK(sharedforce::Pop(g_Region, command) && command.value == 0);
+    TEST_CHECK(sharedforce::Push(g_Region, MakeCommand(2, 1000000)));
+    TEST_CHECK(!sharedforce::Push(g_Region, MakeCommand(2, -3)));
+
+    int32_t last = 0;
+    uint32_t count = 0;
+    while (sharedforce::Pop(g_Region, command))
+    {
+        last = command.value;
+        count++;
+    }
+    TEST_CHECK(count == SHARED_FORCE_RING_CAPACITY);
+    TEST_CHECK(last == 1000000);
+    TEST_CHECK(!sharedforce::Pop(g_Region, command));
+}
+
+void CheckMultipleProducers()
+{
+    sharedforce::Initialize(g_Region);
+
+    std::atomic<bool> bStart(false);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back([p, &bStart]() {
+            while (!bStart.load())
+                std::this_thread::yield();
+            for (int32_t i = 0; i < COMMANDS_PER_PRODUCER; i++)
+            {
+                // Anneau plein : le client réessaie
+                while (!sharedforce::Push(g_Region, MakeCommand(static_cast<int16_t>(p), i)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    int32_t expected[PRODUCERS] = {};
+    bool bOrdered = true;
+    bool bKnownProducer = true;
+    int received = 0;
+    bStart = true;
+
+    SharedCommand command;
+    while (received < PRODUCERS * COMMANDS_PER_PRODUCER)
+    {
+        if (!sharedforce::Pop(g_Region, command))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (command.effect < 0 || command.effect >= PRODUCERS)
+        {
+            bKnownProducer = false;
+            break;
+        }
+        bOrdered &= command.value == expected[command.effect];
+        expected[command.effect] = command.value + 1;
+        received++;
+    }
+
+    for (std::thread& producer : producers)
+        producer.join();
+
+    TEST_CHECK(bKnownProducer);
+    TEST_CHECK(bOrdered);
+    for (int p = 0; p < PRODUCERS; p++)
+        TEST_CHECK(expected[p] == COMMANDS_PER_PRODUCER);
+    TEST_CHECK(!sharedforce::Pop(g_Region, command));
+    TEST_CHECK(g_Region.enqueuePos.load() == g_Region.dequeuePos.load());
+}
+
+/**
+ * État dont tous les champs dérivent de n : un mélange de deux
+ * publications se voit immédiatement.
+ */
+SharedState MakeState(int32_t n)
+{
+    SharedState state;
+    memset(&state, 0, sizeof(state));
+    state.timestampNs = n * 1000LL;
+    state.position = n;
+    state.steering = static_cast<int16_t>(n);
+    state.buttons = static_cast<uint32_t>(n) * 3u;
+    state.force = -n;
+    state.activeEffects = ~static_cast<uint32_t>(n);
+    state.commandsApplied = static_cast<uint64_t>(n) << 20;
+    state.commandsRejected = static_cast<uint64_t>(n);
+    return state;
+}
+
+bool IsConsistent(const SharedState& state)
+{
+    const SharedState expected = MakeState(state.position);
+    return memcmp(&state, &expected, sizeof(state)) == 0;
+}
+
+void CheckSeqlock()
+{
+    sharedforce::Initialize(g_Region);
+
+    SharedState state;
+    TEST_CHECK(sharedforce::ReadState(g_Region, state));
+    TEST_CHECK(state.position == 0 && state.force == 0);
+    sharedforce::PublishState(g_Region, MakeState(0));
+
+    std::atomic<bool> bDone(false);
+    std::thread writer([&bDone]() {
+        for (int32_t n = 1; n <= STATE_PUBLICATIONS; n++)
+            sharedforce::PublishState(g_Region, MakeState(n));
+        bDone = true;
+    });
+
+    int reads = 0;
+    int torn = 0;
+    int32_t previous = 0;
+    bool bMonotonic = true;
+    while (!bDone.load())
+    {
+        if (!sharedforce::ReadState(g_Region, state))
+            continue;
+        reads++;
+        if (!IsConsistent(state))
+            torn++;
+        bMonotonic &= state.position >= previous;
+        previous = state.position;
+    }
+    writer.join();
+
+    TEST_CHECK(reads > 0);
+    TEST_CHECK(torn == 0);
+    TEST_CHECK(bMonotonic);
+    TEST_CHECK(sharedforce::ReadState(g_Region, state) && state.position == STATE_PUBLICATIONS);
+
+    // Écriture jamais terminée (séquence impaire) : le lecteur abandonne
+    g_Region.stateSequence.fetch_add(1);
+    TEST_CHECK(!sharedforce::ReadState(g_Region, state, 10));
+    g_Region.stateSequence.fetch_add(1);
+    TEST_CHECK(sharedforce::ReadState(g_Region, state, 10));
+}
+
+void CheckNamedRegion()
+{
+    const std::string name = "/ffb_shared_test." + std::to_string(getpid());
+    shm_unlink(name.c_str());
+
+    SharedForceServer server;
+    if (!TEST_CHECK(server.Create(name)))
+        return;
+
+    SharedForceClient client;
+    TEST_CHECK(client.Open(name));
+    TEST_CHECK(client.SetForce(1234));
+    SharedCommand command;
+    TEST_CHECK(server.Pop(command) && command.value == 1234);
+
+    // Région d'un simulateur vivant (celui-ci) : jamais réinitialisée
+    SharedForceServer second;
+    errno = 0;
+    TEST_CHECK(!second.Create(name));
+    TEST_CHECK(errno == EEXIST);
+    TEST_CHECK(client.SetForce(5678));
+    TEST_CHECK(server.Pop(command) && command.value == 5678);
+
+    client.Close();
+    server.Destroy();
+
+    // Région abandonnée, jamais initialisée : remplacée
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    TEST_CHECK(fd >= 0 && ftruncate(fd, sizeof(SharedForceRegion)) == 0);
+    if (fd >= 0)
+        close(fd);
+    TEST_CHECK(!SharedForceServer::IsOwnedByLiveServer(name));
+    TEST_CHECK(second.Create(name));
+    TEST_CHECK(client.Open(name));
+    client.Close();
+    second.Destroy();
+    TEST_CHECK(!client.Open(name));
+}
+
+} // namespace
+
+int main()
+{
+    CheckWraparound();
+    CheckFullRing();
+    CheckMultipleProducers();
+    CheckSeqlock();
+    CheckNamedRegion();
+    return test::Finish("shared_force_test");
+}
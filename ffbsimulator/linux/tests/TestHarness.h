@@ -0,0 +1,68 @@
+//==============================================================================
+// TestHarness.h - Vérifications des tests unitaires
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Un test est un exécutable enregistré dans CTest : chaque vérification
+// échouée est affichée (expression, fichier, ligne) et le test continue ;
+// Finish() résume et renvoie le code de sortie (0 si tout est passé).
+//==============================================================================
+
+#pragma once
+
+#include <iostream>
+#include <cmath>
+
+namespace test
+{
+
+struct Counters
+{
+    int checks;
+    int failures;
+};
+
+inline Counters& GetCounters()
+{
+    static Counters counters = { 0, 0 };
+    return counters;
+}
+
+inline bool Check(bool bOk, const char* expression, const char* file, int line)
+{
+    Counters& counters = GetCounters();
+    counters.checks++;
+    if (!bOk)
+    {
+        counters.failures++;
+        std::cerr << "ÉCHEC: " << expression << " (" << file << ":" << line << ")" << std::endl;
+    }
+    return bOk;
+}
+
+inline bool CheckNear(double actual, double expected, double tolerance,
+                      const char* expression, const char* file, int line)
+{
+    const bool bOk = std::fabs(actual - expected) <= tolerance;
+    if (!Check(bOk, expression, file, line))
+    {
+        std::cerr << "    valeur " << actual << ", attendu " << expected
+                  << " ± " << tolerance << std::endl;
+    }
+    return bOk;
+}
+
+inline int Finish(const char* name)
+{
+    const Counters& counters = GetCounters();
+    std::cout << name << ": " << counters.checks << " vérifications, "
+              << counters.failures << " échecs" << std::endl;
+    return counters.failures ? 1 : 0;
+}
+
+} // namespace test
+
+#define TEST_CHECK(expression) test::Check((expression), #expression, __FILE__, __LINE__)
+#define TEST_CHECK_NEAR(actual, expected, tolerance) \
+    test::CheckNear((actual), (expected), (tolerance), #actual " ≈ " #expected, __FILE__, __LINE__)
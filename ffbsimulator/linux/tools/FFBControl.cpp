@@ -0,0 +1,364 @@
+//==============================================================================
+// FFBControl.cpp - Client en ligne de commande du protocole de contrôle
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Les commandes données sur la ligne partent dans une seule requête (un
+// lot), exécutée d'un bloc par le simulateur :
+//   ffbctl play Sinus level Sinus 12000 state
+// Les effets sont désignés par leur nom ou leur index (voir "list").
+//
+// "bench" mesure le débit : requêtes de --batch commandes SetLevel, dont
+// au plus --window sont en vol (réponses asynchrones), et rapporte les
+// commandes/s et la latence aller-retour par requête.
+//
+// Usage : ffbctl [--socket <chemin>] <commande>...
+//         ffbctl [--socket <chemin>] bench [--count N] [--batch N] [--window N]
+//==============================================================================
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+
+#include "Clock.h"
+#include "ControlProtocol.h"
+#include "EffectPresets.h"
+#include "LatencyHistogram.h"
+
+namespace
+{
+
+const int EXIT_CONTROL_OK = 0;
+const int EXIT_CONTROL_FAILED = 1;       // Au moins une commande refusée
+const int EXIT_CONTROL_USAGE = 2;
+const int EXIT_CONTROL_CONNECT = 3;      // Simulateur injoignable
+
+const int CONTROL_REPLY_TIMEOUT_MS = 2000;
+
+const char* StatusName(uint8_t status)
+{
+    switch (static_cast<ControlStatus>(status))
+    {
+    case ControlStatus::Ok:             return "OK";
+    case ControlStatus::UnknownEffect:  return "effet inconnu";
+    case ControlStatus::UnknownOp:      return "commande inconnue";
+    case ControlStatus::DeviceError:    return "refusée par le device";
+    }
+    return "?";
+}
+
+const char* OpName(uint8_t op)
+{
+    switch (static_cast<ControlOp>(op))
+    {
+    case ControlOp::Play:       return "play";
+    case ControlOp::Stop:       return "stop";
+    case ControlOp::StopAll:    return "stopall";
+    case ControlOp::SetLevel:   return "level";
+    case ControlOp::LoadPreset: return "preset";
+    case ControlOp::QueryState: return "state";
+    }
+    return "?";
+}
+
+/**
+ * Index d'un préréglage par nom ou par numéro, -1 si inconnu.
+ */
+int ParseEffect(const std::string& text)
+{
+    for (size_t i = 0; i < BUILTIN_EFFECT_COUNT; i++)
+    {
+        if (text == BUILTIN_EFFECTS[i].name)
+            return static_cast<int>(i);
+    }
+
+    char* end = nullptr;
+    const long index = std::strtol(text.c_str(), &end, 10);
+    if (end && *end == '\0' && !text.empty() && index >= 0 && index < static_cast<long>(BUILTIN_EFFECT_COUNT))
+        return static_cast<int>(index);
+    return -1;
+}
+
+/**
+ * Traduit les arguments en commandes.
+ * @return false (avec message) si un argument est invalide.
+ */
+bool ParseCommands(int argc, char* argv[], int first, std::vector<ControlCommand>& commands)
+{
+    for (int i = first; i < argc; i++)
+    {
+        const std::string word = argv[i];
+        ControlCommand command;
+        memset(&command, 0, sizeof(command));
+
+        bool bNeedsEffect = true;
+        if (word == "play")
+            command.op = static_cast<uint8_t>(ControlOp::Play);
+        else if (word == "stop")
+            command.op = static_cast<uint8_t>(ControlOp::Stop);
+        else if (word == "level")
+            command.op = static_cast<uint8_t>(ControlOp::SetLevel);
+        else if (word == "preset")
+            command.op = static_cast<uint8_t>(ControlOp::LoadPreset);
+        else if (word == "stopall" || word == "state")
+        {
+            command.op = static_cast<uint8_t>(word == "stopall" ? ControlOp::StopAll : ControlOp::QueryState);
+            bNeedsEffect = false;
+        }
+        else
+        {
+            std::cerr << "Commande inconnue: " << word << std::endl;
+            return false;
+        }
+
+        if (bNeedsEffect)
+        {
+            const int effect = i + 1 < argc ? ParseEffect(argv[i + 1]) : -1;
+            if (effect < 0)
+            {
+                std::cerr << word << ": effet manquant ou inconnu (voir 'list')" << std::endl;
+                return false;
+            }
+            command.effect = static_cast<int16_t>(effect);
+            i++;
+        }
+
+        if (command.op == static_cast<uint8_t>(ControlOp::SetLevel))
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "level: niveau manquant" << std::endl;
+                return false;
+            }
+            command.value = std::atoi(argv[++i]);
+        }
+
+        commands.push_back(command);
+    }
+
+    if (commands.size() > CONTROL_MAX_COMMANDS)
+    {
+        std::cerr << "Trop de commandes (max " << CONTROL_MAX_COMMANDS << ")" << std::endl;
+        return false;
+    }
+    return !commands.empty();
+}
+
+void PrintState(const ControlState& state)
+{
+    std::cout << "État:" << std::endl;
+    std::cout << "  Device: " << (state.deviceOpen ? "connecté" : "déconnecté")
+              << (state.softwareRender ? " (rendu logiciel)" : "") << std::endl;
+    std::cout << "  Volant: " << state.steering << " (Q15 " << state.position << ")" << std::endl;
+    std::cout << "  Pédales: Acc=" << state.pedal1 << " Frein=" << state.pedal2 << std::endl;
+    std::cout << "  Boutons: 0x" << std::hex << state.buttons << std::dec << std::endl;
+    std::cout << "  Force: " << state.force << std::endl;
+    std::cout << "  Effet courant: " << state.currentEffect << (state.effectPlaying ? " [EN COURS]" : "") << std::endl;
+
+    if (state.softwareRender)
+    {
+        std::cout << "  Effets actifs:";
+        for (size_t i = 0; i < BUILTIN_EFFECT_COUNT; i++)
+        {
+            if (state.activeEffects & (1u << i))
+                std::cout << " " << BUILTIN_EFFECTS[i].name;
+        }
+        std::cout << std::endl;
+    }
+}
+
+int RunCommands(ControlClient& client, const std::vector<ControlCommand>& commands)
+{
+    const uint32_t requestId = client.Send(commands.data(), commands.size());
+    if (requestId == 0)
+    {
+        std::cerr << "Envoi impossible: " << strerror(errno) << std::endl;
+        return EXIT_CONTROL_CONNECT;
+    }
+
+    ControlReply reply;
+    if (!client.Receive(reply, CONTROL_REPLY_TIMEOUT_MS) || reply.header.requestId != requestId)
+    {
+        std::cerr << "Pas de réponse du simulateur" << std::endl;
+        return EXIT_CONTROL_CONNECT;
+    }
+
+    bool bFailed = false;
+    for (size_t i = 0; i < reply.header.count; i++)
+    {
+        const ControlResult& result = reply.results[i];
+        if (result.op == static_cast<uint8_t>(ControlOp::QueryState))
+            continue;
+
+        std::cout << OpName(result.op);
+        if (result.op != static_cast<uint8_t>(ControlOp::StopAll) &&
+            result.effect >= 0 && static_cast<size_t>(result.effect) < BUILTIN_EFFECT_COUNT)
+            std::cout << " " << BUILTIN_EFFECTS[result.effect].name;
+        std::cout << ": " << StatusName(result.status) << std::endl;
+        bFailed |= result.status != static_cast<uint8_t>(ControlStatus::Ok);
+    }
+
+    if (reply.header.flags & CONTROL_FLAG_STATE)
+        PrintState(reply.state);
+
+    return bFailed ? EXIT_CONTROL_FAILED : EXIT_CONTROL_OK;
+}
+
+/**
+ * Mesure de débit : fenêtre glissante de requêtes en vol.
+ */
+int RunBench(ControlClient& client, int count, int batch, int window)
+{
+    std::vector<ControlCommand> commands(static_cast<size_t>(batch));
+    for (int i = 0; i < batch; i++)
+    {
+        memset(&commands[i], 0, sizeof(ControlCommand));
+        commands[i].op = static_cast<uint8_t>(ControlOp::SetLevel);
+        commands[i].effect = 0;
+        commands[i].value = 8000 + (i % 16) * 1000;
+    }
+
+    // Instant d'envoi par requestId (modulo la fenêtre)
+    std::vector<int64_t> sentAt(static_cast<size_t>(window), 0);
+    std::vector<uint32_t> sentId(static_cast<size_t>(window), 0);
+    LatencyHistogram latency;
+    ControlReply reply;
+
+    int sent = 0;
+    int received = 0;
+    uint64_t failures = 0;
+    const int64_t start = MonotonicNowNs();
+
+    while (received < count)
+    {
+        while (sent < count && sent - received < window)
+        {
+            const uint32_t id = client.Send(commands.data(), commands.size());
+            if (id == 0)
+            {
+                std::cerr << "Envoi impossible: " << strerror(errno) << std::endl;
+                return EXIT_CONTROL_CONNECT;
+            }
+            sentAt[id % window] = MonotonicNowNs();
+            sentId[id % window] = id;
+            sent++;
+        }
+
+        if (!client.Receive(reply, CONTROL_REPLY_TIMEOUT_MS))
+        {
+            std::cerr << "Réponse manquante après " << received << " requêtes" << std::endl;
+            return EXIT_CONTROL_CONNECT;
+        }
+
+        const uint32_t id = reply.header.requestId;
+        if (sentId[id % window] == id)
+            latency.Record(MonotonicNowNs() - sentAt[id % window]);
+        for (size_t i = 0; i < reply.header.count; i++)
+            failures += reply.results[i].status != static_cast<uint8_t>(ControlStatus::Ok);
+        received++;
+    }
+
+    const double elapsed = static_cast<double>(MonotonicNowNs() - start) / 1e9;
+    const double commandsPerSec = static_cast<double>(count) * batch / elapsed;
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "Requêtes: " << count << " × " << batch << " commandes, fenêtre " << window << std::endl;
+    std::cout << "Débit: " << commandsPerSec << " commandes/s ("
+              << static_cast<double>(count) / elapsed << " requêtes/s)" << std::endl;
+    std::cout << std::setprecision(1);
+    std::cout << "Aller-retour par requête: p50 " << latency.Percentile(0.5) / 1000.0
+              << " µs, p99 " << latency.Percentile(0.99) / 1000.0
+              << " µs, max " << latency.GetMax() / 1000.0 << " µs" << std::endl;
+    std::cout << "Commandes refusées: " << failures << std::endl;
+
+    return failures ? EXIT_CONTROL_FAILED : EXIT_CONTROL_OK;
+}
+
+void PrintUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--socket <chemin>] <commande>..." << std::endl;
+    std::cerr << "  list                   Liste des effets (index et nom)" << std::endl;
+    std::cerr << "  play <effet>           Démarre un effet" << std::endl;
+    std::cerr << "  stop <effet>           Arrête un effet" << std::endl;
+    std::cerr << "  stopall                Arrête tous les effets" << std::endl;
+    std::cerr << "  level <effet> <n>      Niveau de l'effet (-32767..32767)" << std::endl;
+    std::cerr << "  preset <effet>         Rétablit les paramètres d'origine" << std::endl;
+    std::cerr << "  state                  État courant du simulateur" << std::endl;
+    std::cerr << "  bench [--count N] [--batch N] [--window N]" << std::endl;
+    std::cerr << "Plusieurs commandes sur la ligne partent dans une seule requête." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string socketPath = CONTROL_DEFAULT_SOCKET;
+    int first = 1;
+
+    if (argc > 2 && std::string(argv[1]) == "--socket")
+    {
+        socketPath = argv[2];
+        first = 3;
+    }
+
+    if (first >= argc)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_CONTROL_USAGE;
+    }
+
+    const std::string command = argv[first];
+    if (command == "list")
+    {
+        for (size_t i = 0; i < BUILTIN_EFFECT_COUNT; i++)
+            std::cout << std::setw(3) << i << "  " << BUILTIN_EFFECTS[i].name << std::endl;
+        return EXIT_CONTROL_OK;
+    }
+
+    int benchCount = 10000;
+    int benchBatch = 16;
+    int benchWindow = 32;
+    std::vector<ControlCommand> commands;
+
+    if (command == "bench")
+    {
+        for (int i = first + 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--count" && i + 1 < argc)
+                benchCount = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--batch" && i + 1 < argc)
+                benchBatch = std::max(1, std::min(static_cast<int>(CONTROL_MAX_COMMANDS), std::atoi(argv[++i])));
+            else if (arg == "--window" && i + 1 < argc)
+                benchWindow = std::max(1, std::atoi(argv[++i]));
+            else
+            {
+                PrintUsage(argv[0]);
+                return EXIT_CONTROL_USAGE;
+            }
+        }
+    }
+    else if (!ParseCommands(argc, argv, first, commands))
+    {
+        PrintUsage(argv[0]);
+        return EXIT_CONTROL_USAGE;
+    }
+
+    ControlClient client;
+    if (!client.Connect(socketPath))
+    {
+        std::cerr << "Connexion impossible à " << socketPath << ": " << strerror(errno) << std::endl;
+        std::cerr << "Le simulateur doit être lancé avec --control " << socketPath << std::endl;
+        return EXIT_CONTROL_CONNECT;
+    }
+
+    if (command == "bench")
+        return RunBench(client, benchCount, benchBatch, benchWindow);
+    return RunCommands(client, commands);
+}
@@ -0,0 +1,96 @@
+//==============================================================================
+// FFBLogDecode.cpp - Décodeur du log binaire
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Restitue un log binaire (FFB_Simulator --log-binary) au format du log
+// texte, sur la sortie standard. "-" lit l'entrée standard, ce qui permet
+// de décoder des segments compressés :
+//   zcat FFB_Simulator_*.1.ffblog.gz | ffblog -
+//
+// Usage : ffblog <fichier|->...
+//==============================================================================
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "BinaryLog.h"
+
+namespace
+{
+
+const int EXIT_DECODE_OK = 0;
+const int EXIT_DECODE_FAILED = 1;        // Fichier illisible ou corrompu
+const int EXIT_DECODE_USAGE = 2;
+
+void PrintUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " <fichier|->..." << std::endl;
+    std::cout << "Décode un log binaire (.ffblog) vers la sortie standard." << std::endl;
+}
+
+/**
+ * Décode un flux ; en cas d'erreur, les lignes déjà décodées restent
+ * affichées.
+ * @return false si le flux est corrompu.
+ */
+bool Decode(std::istream& in, const std::string& name)
+{
+    BinaryLogReader reader(in);
+    std::string line;
+    while (reader.Next(line))
+        std::cout << line << '\n';
+
+    if (!reader.GetError().empty())
+    {
+        std::cout.flush();
+        std::cerr << name << ": " << reader.GetError() << " (après "
+                  << reader.GetLineCount() << " lignes)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_DECODE_USAGE;
+    }
+
+    int result = EXIT_DECODE_OK;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            PrintUsage(argv[0]);
+            return EXIT_DECODE_OK;
+        }
+
+        if (arg == "-")
+        {
+            if (!Decode(std::cin, "stdin"))
+                result = EXIT_DECODE_FAILED;
+            continue;
+        }
+
+        std::ifstream file(arg, std::ios::binary);
+        if (!file)
+        {
+            std::cerr << arg << ": impossible d'ouvrir le fichier" << std::endl;
+            result = EXIT_DECODE_FAILED;
+            continue;
+        }
+        if (!Decode(file, arg))
+            result = EXIT_DECODE_FAILED;
+    }
+
+    std::cout.flush();
+    return result;
+}
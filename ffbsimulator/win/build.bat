@@ -21,7 +21,7 @@ if %ERRORLEVEL% NEQ 0 (
 )
 
 REM Compilation
-cl.exe /EHsc /std:c++17 /O2 /Fe:FFB_Simulator.exe FFB_Simulator.cpp dinput8.lib dxguid.lib user32.lib kernel32.lib
+cl.exe /EHsc /std:c++17 /O2 /I "%~dp0..\core\src" /Fe:FFB_Simulator.exe FFB_Simulator.cpp dinput8.lib dxguid.lib user32.lib kernel32.lib
 
 if %ERRORLEVEL% EQU 0 (
     echo Compilation réussie!
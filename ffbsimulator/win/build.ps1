@@ -37,7 +37,7 @@ if %ERRORLEVEL% NEQ 0 (
 )
 
 echo Compilation en cours...
-cl.exe /EHsc /std:c++17 /O2 /MD /Fe:FFB_Simulator.exe FFB_Simulator.cpp dinput8.lib dxguid.lib user32.lib kernel32.lib
+cl.exe /EHsc /std:c++17 /O2 /MD /I "$PSScriptRoot\..\core\src" /Fe:FFB_Simulator.exe FFB_Simulator.cpp dinput8.lib dxguid.lib user32.lib kernel32.lib
 exit /b %ERRORLEVEL%
 "@
 
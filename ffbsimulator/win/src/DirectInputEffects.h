@@ -0,0 +1,187 @@
+//==============================================================================
+// DirectInputEffects.h - Conversion ff_effect -> DIEFFECT (backend Windows)
+// Compatible Microsoft Sidewinder Force Feedback Wheel
+// Copyright (c) 2024
+//==============================================================================
+//
+// Les préréglages du cœur (EffectPresets.h) sont décrits en ff_effect :
+// niveaux Q15 (±32767), durées et périodes en ms, direction 0x4000 = droite.
+// DirectInput attend des niveaux sur ±DI_FFNOMINALMAX (10000) et des durées
+// en µs ; la direction est projetée sur l'unique axe du volant (DIJOFS_X)
+// comme le fait le rendu logiciel (EffectRender.h).
+//==============================================================================
+
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "FFEffect.h"
+#include "FixedPoint.h"
+
+//==============================================================================
+// PARAMÈTRES
+//==============================================================================
+
+/**
+ * DIEFFECT prêt pour CreateEffect. Les pointeurs de effect désignent les
+ * champs de cette structure : elle ne doit pas être copiée une fois remplie.
+ */
+struct DirectInputEffectParams
+{
+    GUID guid;
+    DIEFFECT effect;
+    DWORD axes[1];
+    LONG directions[1];
+    DIENVELOPE envelope;
+
+    union
+    {
+        DICONSTANTFORCE constant;
+        DIRAMPFORCE ramp;
+        DIPERIODIC periodic;
+        DICONDITION condition;
+    } specific;
+
+    DirectInputEffectParams() = default;
+    DirectInputEffectParams(const DirectInputEffectParams&) = delete;
+    DirectInputEffectParams& operator=(const DirectInputEffectParams&) = delete;
+};
+
+/**
+ * Niveau Q15 vers l'échelle DirectInput (±DI_FFNOMINALMAX).
+ */
+inline LONG ScaleToDirectInput(int32_t level)
+{
+    return static_cast<LONG>(fixp::SaturateQ15(level) * static_cast<int32_t>(DI_FFNOMINALMAX) / 32767);
+}
+
+/**
+ * Échelle DirectInput vers Q15 (réglages affichés par l'écran d'état).
+ */
+inline int16_t ScaleFromDirectInput(LONG value)
+{
+    return static_cast<int16_t>(fixp::SaturateQ15(static_cast<int32_t>(value) * 32767 / static_cast<int32_t>(DI_FFNOMINALMAX)));
+}
+
+inline DWORD MsToDirectInputDuration(uint16_t ms)
+{
+    return ms == 0 ? INFINITE : static_cast<DWORD>(ms) * 1000;
+}
+
+/**
+ * Remplit params à partir d'un ff_effect.
+ * @return false pour un type sans équivalent DirectInput (rumble, custom).
+ */
+inline bool BuildDirectInputEffect(const ff_effect& source, DirectInputEffectParams& params)
+{
+    memset(&params.effect, 0, sizeof(params.effect));
+    memset(&params.envelope, 0, sizeof(params.envelope));
+    memset(&params.specific, 0, sizeof(params.specific));
+
+    DIEFFECT& eff = params.effect;
+    eff.dwSize = sizeof(DIEFFECT);
+    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
+    eff.dwDuration = MsToDirectInputDuration(source.replay.length);
+    eff.dwStartDelay = static_cast<DWORD>(source.replay.delay) * 1000;
+    eff.dwSamplePeriod = 0;
+    eff.dwGain = DI_FFNOMINALMAX;
+    eff.dwTriggerButton = DIEB_NOTRIGGER;
+    eff.dwTriggerRepeatInterval = 0;
+    eff.cAxes = 1;
+    params.axes[0] = DIJOFS_X;
+    params.directions[0] = 1;
+    eff.rgdwAxes = params.axes;
+    eff.rglDirection = params.directions;
+
+    // Projection sur l'axe du volant (niveaux signés, direction fixe)
+    const int32_t projection = fixp::Sin(source.direction);
+    const ff_envelope* envelope = nullptr;
+
+    switch (source.type)
+    {
+    case FF_CONSTANT:
+        params.guid = GUID_ConstantForce;
+        params.specific.constant.lMagnitude = ScaleToDirectInput(fixp::MulSat(source.u.constant.level, projection));
+        eff.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
+        envelope = &source.u.constant.envelope;
+        break;
+
+    case FF_RAMP:
+        params.guid = GUID_RampForce;
+        params.specific.ramp.lStart = ScaleToDirectInput(fixp::MulSat(source.u.ramp.start_level, projection));
+        params.specific.ramp.lEnd = ScaleToDirectInput(fixp::MulSat(source.u.ramp.end_level, projection));
+        eff.cbTypeSpecificParams = sizeof(DIRAMPFORCE);
+        envelope = &source.u.ramp.envelope;
+        break;
+
+    case FF_PERIODIC:
+    {
+        switch (source.u.periodic.waveform)
+        {
+        case FF_SQUARE:   params.guid = GUID_Square; break;
+        case FF_TRIANGLE: params.guid = GUID_Triangle; break;
+        case FF_SINE:     params.guid = GUID_Sine; break;
+        case FF_SAW_UP:   params.guid = GUID_SawtoothUp; break;
+        case FF_SAW_DOWN: params.guid = GUID_SawtoothDown; break;
+        default:          return false;
+        }
+        // Magnitude non signée : le signe de la projection passe dans la direction
+        const int32_t magnitude = fixp::MulSat(source.u.periodic.magnitude, projection);
+        params.directions[0] = magnitude < 0 ? -1 : 1;
+        params.specific.periodic.dwMagnitude = static_cast<DWORD>(ScaleToDirectInput(fixp::Abs(magnitude)));
+        params.specific.periodic.lOffset = ScaleToDirectInput(source.u.periodic.offset);
+        params.specific.periodic.dwPhase = static_cast<DWORD>(source.u.periodic.phase) * 36000 / 65536;
+        params.specific.periodic.dwPeriod = static_cast<DWORD>(source.u.periodic.period) * 1000;
+        eff.cbTypeSpecificParams = sizeof(DIPERIODIC);
+        envelope = &source.u.periodic.envelope;
+        break;
+    }
+
+    case FF_SPRING:
+    case FF_DAMPER:
+    case FF_INERTIA:
+    case FF_FRICTION:
+    {
+        if (source.type == FF_SPRING)
+            params.guid = GUID_Spring;
+        else if (source.type == FF_DAMPER)
+            params.guid = GUID_Damper;
+        else if (source.type == FF_INERTIA)
+            params.guid = GUID_Inertia;
+        else
+            params.guid = GUID_Friction;
+
+        const ff_condition_effect& condition = source.u.condition[0];
+        DICONDITION& target = params.specific.condition;
+        target.lOffset = ScaleToDirectInput(condition.center);
+        target.lPositiveCoefficient = ScaleToDirectInput(condition.right_coeff);
+        target.lNegativeCoefficient = ScaleToDirectInput(condition.left_coeff);
+        target.dwPositiveSaturation = static_cast<DWORD>(ScaleToDirectInput(condition.right_saturation));
+        target.dwNegativeSaturation = static_cast<DWORD>(ScaleToDirectInput(condition.left_saturation));
+        target.lDeadBand = ScaleToDirectInput(condition.deadband);
+        eff.cbTypeSpecificParams = sizeof(DICONDITION);
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    eff.lpvTypeSpecificParams = &params.specific;
+
+    if (envelope && (envelope->attack_length || envelope->fade_length))
+    {
+        params.envelope.dwSize = sizeof(DIENVELOPE);
+        params.envelope.dwAttackLevel = static_cast<DWORD>(ScaleToDirectInput(envelope->attack_level));
+        params.envelope.dwAttackTime = static_cast<DWORD>(envelope->attack_length) * 1000;
+        params.envelope.dwFadeLevel = static_cast<DWORD>(ScaleToDirectInput(envelope->fade_level));
+        params.envelope.dwFadeTime = static_cast<DWORD>(envelope->fade_length) * 1000;
+        eff.lpEnvelope = &params.envelope;
+    }
+
+    return true;
+}
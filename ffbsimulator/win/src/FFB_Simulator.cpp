@@ -23,6 +23,12 @@
 #include <iomanip>
 #include <ctime>
 
+#include "Logger.h"
+#include "EffectPresets.h"
+#include "InputSnapshot.h"
+#include "StatusScreen.h"
+#include "DirectInputEffects.h"
+
 #pragma comment(lib, "dinput8.lib")
 #pragma comment(lib, "dxguid.lib")
 #pragma comment(lib, "Shlwapi.lib")
@@ -43,152 +49,6 @@ const DWORD INFINITE_DURATION = INFINITE;
 // Refresh rate
 const DWORD UPDATE_INTERVAL = 16;      // ~60 FPS
 
-//==============================================================================
-// CLASSE DE LOGGING
-//==============================================================================
-
-class Logger
-{
-private:
-    std::ofstream m_LogFile;
-    std::string m_LogFilename;
-    bool m_IsOpen;
-    
-    std::string GetTimestamp()
-    {
-        auto now = std::chrono::system_clock::now();
-        auto time_t_now = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()) % 1000;
-        
-        struct tm timeinfo;
-        localtime_s(&timeinfo, &time_t_now);
-        
-        std::ostringstream oss;
-        oss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S")
-            << '.' << std::setfill('0') << std::setw(3) << ms.count();
-        return oss.str();
-    }
-    
-    // Helper pour construire le message à partir des arguments
-    template<typename T>
-    void BuildMessage(std::ostringstream& oss, T&& arg)
-    {
-        oss << std::forward<T>(arg);
-    }
-    
-    template<typename T, typename... Args>
-    void BuildMessage(std::ostringstream& oss, T&& first, Args&&... args)
-    {
-        oss << std::forward<T>(first);
-        BuildMessage(oss, std::forward<Args>(args)...);
-    }
-    
-public:
-    Logger() : m_IsOpen(false) {}
-    
-    ~Logger()
-    {
-        Close();
-    }
-    
-    bool Open(const std::string& filename)
-    {
-        m_LogFilename = filename;
-        m_LogFile.open(filename, std::ios::out | std::ios::app);
-        m_IsOpen = m_LogFile.is_open();
-        
-        if (m_IsOpen)
-        {
-            m_LogFile << "\n========================================\n";
-            m_LogFile << "Session démarrée: " << GetTimestamp() << "\n";
-            m_LogFile << "========================================\n";
-            m_LogFile.flush();
-        }
-        
-        return m_IsOpen;
-    }
-    
-    void Close()
-    {
-        if (m_IsOpen)
-        {
-            m_LogFile << "========================================\n";
-            m_LogFile << "Session terminée: " << GetTimestamp() << "\n";
-            m_LogFile << "========================================\n\n";
-            m_LogFile.close();
-            m_IsOpen = false;
-        }
-    }
-    
-    // Méthode template principale
-    template<typename... Args>
-    void Log(const std::string& level, Args&&... args)
-    {
-        std::ostringstream oss;
-        BuildMessage(oss, std::forward<Args>(args)...);
-        
-        std::string fullMessage = "[" + GetTimestamp() + "] [" + level + "] " + oss.str();
-        
-        // Affichage console
-        std::cout << fullMessage << std::endl;
-        
-        // Écriture fichier
-        if (m_IsOpen)
-        {
-            m_LogFile << fullMessage << std::endl;
-            m_LogFile.flush();
-        }
-    }
-    
-    // Méthodes pratiques avec templates variadiques
-    template<typename... Args>
-    void Info(Args&&... args)
-    {
-        Log("INFO", std::forward<Args>(args)...);
-    }
-    
-    template<typename... Args>
-    void Warning(Args&&... args)
-    {
-        Log("WARN", std::forward<Args>(args)...);
-    }
-    
-    template<typename... Args>
-    void Error(Args&&... args)
-    {
-        Log("ERROR", std::forward<Args>(args)...);
-    }
-    
-    template<typename... Args>
-    void Debug(Args&&... args)
-    {
-        Log("DEBUG", std::forward<Args>(args)...);
-    }
-    
-    template<typename... Args>
-    void Success(Args&&... args)
-    {
-        Log("OK", std::forward<Args>(args)...);
-    }
-    
-    // Helper pour formater en hexadécimal
-    struct Hex
-    {
-        HRESULT value;
-        explicit Hex(HRESULT v) : value(v) {}
-    };
-    
-    std::string GetFilename() const { return m_LogFilename; }
-};
-
-// Surcharge de l'opérateur << pour Logger::Hex
-inline std::ostream& operator<<(std::ostream& os, const Logger::Hex& hex)
-{
-    os << "0x" << std::hex << std::uppercase << hex.value << std::dec;
-    return os;
-}
-
 // Instance globale du logger
 static Logger g_Logger;
 
@@ -205,6 +65,7 @@ private:
     
     // État du périphérique
     DIJOYSTATE2 m_JoyState;
+    InputSnapshot m_Input;       // m_JoyState dans les unités du cœur
     bool m_bDeviceAcquired;
     
     // Mode d'affichage
@@ -248,12 +109,7 @@ private:
     
     // Gestion des effets
     bool CreateAllEffects();
-    bool CreateConstantEffect(const std::string& name, LONG force, LONG direction = 0);
-    bool CreatePeriodicEffect(const std::string& name, const GUID& effectType, 
-                            DWORD magnitude, DWORD period, DWORD phase = 0);
-    bool CreateRampEffect(const std::string& name, LONG startForce, LONG endForce);
-    bool CreateConditionEffect(const std::string& name, const GUID& effectType,
-                             LONG coefficient, LONG saturation);
+    bool CreateEffect(const EffectPreset& preset);
     
     // Contrôle des effets
     void PlayCurrentEffect();
@@ -272,9 +128,7 @@ private:
     void DisplayHelp();
     
     // Utilitaires
-    static std::string FormatForce(LONG force);
-    static std::string FormatDirection(LONG direction);
-    static std::string FormatDuration(DWORD duration);
+    static int16_t ClampAxis(LONG value);
     void CleanupEffects();
     
     // Callback pour énumération des périphériques
@@ -561,27 +415,11 @@ bool ForceEffectSimulator::CreateAllEffects()
     
     bool success = true;
     
-    // Effets constants (forces plus importantes)
-    success &= CreateConstantEffect("Constant_Droite", 8000, 0);
-    success &= CreateConstantEffect("Constant_Gauche", -8000, 0);
-    success &= CreateConstantEffect("Constant_Fort", 10000, 0);
-    success &= CreateConstantEffect("Constant_Faible", 4000, 0);
-    
-    // Effets périodiques
-    success &= CreatePeriodicEffect("Sinus", GUID_Sine, 6000, 200);
-    success &= CreatePeriodicEffect("Carre", GUID_Square, 7000, 150);
-    success &= CreatePeriodicEffect("Triangle", GUID_Triangle, 5000, 300);
-    success &= CreatePeriodicEffect("Dent_Scie", GUID_SawtoothUp, 6000, 180);
-    
-    // Effets rampe (valeurs augmentées)
-    success &= CreateRampEffect("Rampe_Montante", 2000, 10000);
-    success &= CreateRampEffect("Rampe_Descendante", 10000, 2000);
-    
-    // Effets de condition (coefficient plus élevé)
-    success &= CreateConditionEffect("Ressort", GUID_Spring, 8000, MAX_FORCE);
-    success &= CreateConditionEffect("Amortissement", GUID_Damper, 7000, MAX_FORCE);
-    success &= CreateConditionEffect("Inertie", GUID_Inertia, 6000, MAX_FORCE);
-    success &= CreateConditionEffect("Friction", GUID_Friction, 5000, MAX_FORCE);
+    // Bibliothèque intégrée du cœur, commune avec la version Linux
+    for (const EffectPreset& preset : BUILTIN_EFFECTS)
+    {
+        success &= CreateEffect(preset);
+    }
     
     g_Logger.Info("Effets créés: " + std::to_string(m_Effects.size()));
     
@@ -594,203 +432,51 @@ bool ForceEffectSimulator::CreateAllEffects()
     return success && !m_Effects.empty();
 }
 
-bool ForceEffectSimulator::CreateConstantEffect(const std::string& name, LONG force, LONG direction)
+/**
+ * Crée l'effet DirectInput correspondant à un préréglage (ff_effect converti
+ * par DirectInputEffects.h).
+ */
+bool ForceEffectSimulator::CreateEffect(const EffectPreset& preset)
 {
-    DIEFFECT eff;
-    ZeroMemory(&eff, sizeof(eff));
-    
-    // Structure de base
-    eff.dwSize = sizeof(DIEFFECT);
-    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
-    eff.dwDuration = INFINITE_DURATION; // Les effets constants doivent être infinis
-    eff.dwSamplePeriod = 0;
-    eff.dwGain = DI_FFNOMINALMAX;
-    eff.dwTriggerButton = DIEB_NOTRIGGER;
-    eff.dwTriggerRepeatInterval = 0;
-    eff.cAxes = 1; // Axe du volant uniquement
-    
-    // Configuration des axes
-    DWORD axes = DIJOFS_X; // Axe principal du volant
-    eff.rgdwAxes = &axes;
-    
-    // Direction en coordonnées cartésiennes (pas polaire)
-    LONG directions = force; // La direction est intégrée dans la force (+ = droite, - = gauche)
-    eff.rglDirection = &directions;
-    
-    // Paramètres spécifiques à l'effet constant
-    DICONSTANTFORCE constantForce;
-    constantForce.lMagnitude = abs(force); // Magnitude toujours positive
-    
-    eff.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
-    eff.lpvTypeSpecificParams = &constantForce;
-    
-    // Création de l'effet
-    IDirectInputEffect* pEffect = nullptr;
-    HRESULT hr = m_pDevice->CreateEffect(GUID_ConstantForce, &eff, &pEffect, nullptr);
-    
-    if (SUCCEEDED(hr))
+    DirectInputEffectParams params;
+    if (!BuildDirectInputEffect(preset.effect, params))
     {
-        m_Effects[name] = pEffect;
-        g_Logger.Info("  Effet constant créé: ", name, " (Force: ", force, ")");
-        return true;
-    }
-    else
-    {
-        g_Logger.Error("  Erreur création effet constant ", name, ": ", Logger::Hex(hr));
+        g_Logger.Error("  Type d'effet non supporté par DirectInput: ", preset.name);
         return false;
     }
-}
-
-bool ForceEffectSimulator::CreatePeriodicEffect(const std::string& name, const GUID& effectType, 
-                                               DWORD magnitude, DWORD period, DWORD phase)
-{
-    DIEFFECT eff;
-    ZeroMemory(&eff, sizeof(eff));
-    
-    eff.dwSize = sizeof(DIEFFECT);
-    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
-    eff.dwDuration = INFINITE_DURATION; // Effets périodiques en continu
-    eff.dwSamplePeriod = 0;
-    eff.dwGain = DI_FFNOMINALMAX;
-    eff.dwTriggerButton = DIEB_NOTRIGGER;
-    eff.dwTriggerRepeatInterval = 0;
-    eff.cAxes = 1;
-    
-    DWORD axes = DIJOFS_X;
-    eff.rgdwAxes = &axes;
-    
-    LONG directions = 0;
-    eff.rglDirection = &directions;
-    
-    // Paramètres périodiques
-    DIPERIODIC periodicParams;
-    ZeroMemory(&periodicParams, sizeof(periodicParams));
-    periodicParams.dwMagnitude = magnitude;
-    periodicParams.lOffset = 0;
-    periodicParams.dwPhase = phase;
-    periodicParams.dwPeriod = period * 1000; // Conversion en microsecondes
-    
-    eff.cbTypeSpecificParams = sizeof(DIPERIODIC);
-    eff.lpvTypeSpecificParams = &periodicParams;
     
     IDirectInputEffect* pEffect = nullptr;
-    HRESULT hr = m_pDevice->CreateEffect(effectType, &eff, &pEffect, nullptr);
+    HRESULT hr = m_pDevice->CreateEffect(params.guid, &params.effect, &pEffect, nullptr);
     
-    if (SUCCEEDED(hr))
-    {
-        m_Effects[name] = pEffect;
-        g_Logger.Info("  Effet périodique créé: ", name, 
-                     " (Magnitude: ", magnitude, ", Période: ", period, "ms)");
-        return true;
-    }
-    else
+    if (FAILED(hr))
     {
-        g_Logger.Error("  Erreur création effet périodique ", name, ": ", Logger::Hex(hr));
+        g_Logger.Error("  Erreur création effet ", preset.name, ": ", Logger::Hex(hr));
         return false;
     }
-}
-
-bool ForceEffectSimulator::CreateRampEffect(const std::string& name, LONG startForce, LONG endForce)
-{
-    DIEFFECT eff;
-    ZeroMemory(&eff, sizeof(eff));
-    
-    eff.dwSize = sizeof(DIEFFECT);
-    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
-    eff.dwDuration = 3000; // 3 secondes pour mieux sentir la rampe
-    eff.dwSamplePeriod = 0;
-    eff.dwGain = DI_FFNOMINALMAX;
-    eff.dwTriggerButton = DIEB_NOTRIGGER;
-    eff.dwTriggerRepeatInterval = 0;
-    eff.cAxes = 1;
-    
-    DWORD axes = DIJOFS_X;
-    eff.rgdwAxes = &axes;
     
-    LONG directions = startForce > 0 ? 1 : -1; // Direction basée sur le signe
-    eff.rglDirection = &directions;
-    
-    // Paramètres rampe
-    DIRAMPFORCE rampParams;
-    rampParams.lStart = abs(startForce);
-    rampParams.lEnd = abs(endForce);
-    
-    eff.cbTypeSpecificParams = sizeof(DIRAMPFORCE);
-    eff.lpvTypeSpecificParams = &rampParams;
-    
-    IDirectInputEffect* pEffect = nullptr;
-    HRESULT hr = m_pDevice->CreateEffect(GUID_RampForce, &eff, &pEffect, nullptr);
+    m_Effects[preset.name] = pEffect;
     
-    if (SUCCEEDED(hr))
+    switch (preset.effect.type)
     {
-        m_Effects[name] = pEffect;
-        g_Logger.Info("  Effet rampe créé: ", name, " (", startForce, " -> ", endForce, ")");
-        return true;
-    }
-    else
-    {
-        g_Logger.Error("  Erreur création effet rampe ", name, ": ", Logger::Hex(hr));
-        return false;
+    case FF_CONSTANT:
+        g_Logger.Info("  Effet constant créé: ", preset.name, " (Force: ", params.specific.constant.lMagnitude, ")");
+        break;
+    case FF_PERIODIC:
+        g_Logger.Info("  Effet périodique créé: ", preset.name, " (Magnitude: ", params.specific.periodic.dwMagnitude,
+                      ", Période: ", preset.effect.u.periodic.period, "ms)");
+        break;
+    case FF_RAMP:
+        g_Logger.Info("  Effet rampe créé: ", preset.name, " (", params.specific.ramp.lStart, " -> ",
+                      params.specific.ramp.lEnd, ")");
+        break;
+    default:
+        g_Logger.Info("  Effet condition créé: ", preset.name, " (Coeff: ",
+                      params.specific.condition.lPositiveCoefficient, ", DeadBand: ",
+                      params.specific.condition.lDeadBand, ")");
+        break;
     }
-}
-
-/**
- * Crée un effet de condition (ressort, amortissement, etc.).
- * @param name Nom de l'effet.
- * @param effectType Type GUID.
- * @param coefficient Coefficient de résistance.
- * @param saturation Saturation maximale.
- * @return true si succès.
- */
-bool ForceEffectSimulator::CreateConditionEffect(const std::string& name, const GUID& effectType,
-                                                LONG coefficient, LONG saturation)
-{
-    DIEFFECT eff;
-    ZeroMemory(&eff, sizeof(eff));
-    
-    eff.dwSize = sizeof(DIEFFECT);
-    eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
-    eff.dwDuration = INFINITE_DURATION; // Conditions permanentes
-    eff.dwSamplePeriod = 0;
-    eff.dwGain = DI_FFNOMINALMAX;
-    eff.dwTriggerButton = DIEB_NOTRIGGER;
-    eff.dwTriggerRepeatInterval = 0;
-    eff.cAxes = 1;
-    
-    DWORD axes = DIJOFS_X;
-    eff.rgdwAxes = &axes;
-    
-    LONG directions = 0;
-    eff.rglDirection = &directions;
-    
-    // Paramètres de condition - CRITIQUE pour les effets de condition
-    DICONDITION conditionParams;
-    ZeroMemory(&conditionParams, sizeof(conditionParams));
-    conditionParams.lOffset = 0; // Pas de décalage
-    conditionParams.lPositiveCoefficient = coefficient; // Force dans le sens positif
-    conditionParams.lNegativeCoefficient = coefficient; // Force dans le sens négatif
-    conditionParams.dwPositiveSaturation = (DWORD)saturation; // Saturation maximale
-    conditionParams.dwNegativeSaturation = (DWORD)saturation; // Saturation maximale
-    conditionParams.lDeadBand = 500; // Zone morte réduite pour plus de réactivité
-    
-    eff.cbTypeSpecificParams = sizeof(DICONDITION);
-    eff.lpvTypeSpecificParams = &conditionParams;
     
-    IDirectInputEffect* pEffect = nullptr;
-    HRESULT hr = m_pDevice->CreateEffect(effectType, &eff, &pEffect, nullptr);
-    
-    if (SUCCEEDED(hr))
-    {
-        m_Effects[name] = pEffect;
-        g_Logger.Info("  Effet condition créé: ", name, 
-                     " (Coeff: ", coefficient, ", DeadBand: ", conditionParams.lDeadBand, ")");
-        return true;
-    }
-    else
-    {
-        g_Logger.Error("  Erreur création effet condition ", name, ": ", Logger::Hex(hr));
-        return false;
-    }
+    return true;
 }
 
 /**
@@ -984,6 +670,18 @@ void ForceEffectSimulator::UpdateDeviceState()
     if (FAILED(hr))
     {
         m_bDeviceAcquired = false;
+        return;
+    }
+    
+    // Instantané du cœur (écran d'état partagé avec le frontend Linux)
+    m_Input.steering = ClampAxis(m_JoyState.lX);
+    m_Input.pedal1 = ClampAxis(m_JoyState.lY);
+    m_Input.pedal2 = ClampAxis(m_JoyState.lZ);
+    m_Input.buttons = 0;
+    for (int i = 0; i < 32; i++)
+    {
+        if (m_JoyState.rgbButtons[i] & 0x80)
+            m_Input.buttons |= 1u << i;
     }
 }
 
@@ -1172,127 +870,42 @@ void ForceEffectSimulator::AdjustDuration(int delta)
 
 void ForceEffectSimulator::DisplayStatus()
 {
-    system("cls"); // Clear screen sur Windows
-    
-    std::cout << "=== SIMULATEUR FORCE FEEDBACK SIDEWINDER ===" << std::endl;
-    std::cout << "=============================================" << std::endl;
-    
-    // État du périphérique
-    std::cout << "Device: " << (m_bDeviceAcquired ? "CONNECTÉ" : "DÉCONNECTÉ") << std::endl;
-    
-    if (m_bDeviceAcquired)
-    {
-        std::cout << "Position volant: " << m_JoyState.lX << std::endl;
-        std::cout << "Pédales: Acc=" << m_JoyState.lY << " Frein=" << m_JoyState.lZ << std::endl;
-        
-        // Affichage des boutons pressés
-        std::cout << "Boutons: ";
-        bool hasButtons = false;
-        for (int i = 0; i < 32; i++)
-        {
-            if (m_JoyState.rgbButtons[i] & 0x80)
-            {
-                std::cout << i << " ";
-                hasButtons = true;
-            }
-        }
-        if (!hasButtons) std::cout << "Aucun";
-        std::cout << std::endl;
-    }
-    
-    std::cout << "=============================================" << std::endl;
-    
-    // Effet courant
-    if (!m_EffectNames.empty())
-    {
-        std::cout << "Effet courant: [" << (m_CurrentEffectIndex + 1) << "/" << m_EffectNames.size() << "] ";
-        std::cout << m_EffectNames[m_CurrentEffectIndex];
-        std::cout << " " << (m_bEffectPlaying ? "[EN COURS]" : "[ARRÊTÉ]") << std::endl;
-    }
-    
-    // Paramètres
-    std::cout << "Intensité: " << FormatForce(m_ForceIntensity) << std::endl;
-    std::cout << "Direction: " << FormatDirection(m_EffectDirection) << std::endl;
-    std::cout << "Durée: " << FormatDuration(m_EffectDuration) << std::endl;
-    
-    std::cout << "=============================================" << std::endl;
-    
-    // Liste des effets disponibles
-    std::cout << "Effets disponibles:" << std::endl;
-    for (size_t i = 0; i < m_EffectNames.size(); i++)
-    {
-        std::cout << "  " << (i == m_CurrentEffectIndex ? "►" : " ") << " " << m_EffectNames[i] << std::endl;
-    }
-    
-    std::cout << "=============================================" << std::endl;
+    StatusScreen screen;
+    screen.platform = "Windows";
+    screen.bDeviceOpen = m_bDeviceAcquired;
+    screen.devicePath = "DirectInput";
+    screen.input = m_Input;
+    screen.effectNames = &m_EffectNames;
+    screen.currentEffect = static_cast<size_t>(m_CurrentEffectIndex);
+    screen.bEffectPlaying = m_bEffectPlaying;
+    screen.bShowForce = false;           // Effets rendus par le périphérique
+    screen.force = 0;
+    screen.intensity = ScaleFromDirectInput(m_ForceIntensity);
+    screen.direction = ScaleFromDirectInput(m_EffectDirection);
+    screen.duration = m_EffectDuration == INFINITE_DURATION ? 0 : m_EffectDuration;
+    screen.bSteeringPhysics = false;
+    screen.speedKmh = 0;
+    
+    RenderStatusScreen(std::cout, screen);
 }
 
 void ForceEffectSimulator::DisplayHelp()
 {
-    system("cls"); // Clear screen sur Windows
-    
-    std::cout << "===============================================" << std::endl;
-    std::cout << "           AIDE - SIMULATEUR FFB              " << std::endl;
-    std::cout << "===============================================" << std::endl;
-    std::cout << std::endl;
-    
-    std::cout << "CONTRÔLES PRINCIPAUX:" << std::endl;
-    std::cout << "  ESPACE      Jouer/Arrêter l'effet courant" << std::endl;
-    std::cout << "  N           Effet suivant" << std::endl;
-    std::cout << "  P           Effet précédent" << std::endl;
-    std::cout << "  S           Arrêter tous les effets" << std::endl;
-    std::cout << std::endl;
-    
-    std::cout << "AJUSTEMENTS:" << std::endl;
-    std::cout << "  +  =        Augmenter l'intensité (+500)" << std::endl;
-    std::cout << "  -  _        Diminuer l'intensité (-500)" << std::endl;
-    std::cout << "  ← →         Ajuster la direction (±1000)" << std::endl;
-    std::cout << "  ↑ ↓         Ajuster la durée (±500ms)" << std::endl;
-    std::cout << std::endl;
-    
-    std::cout << "NAVIGATION:" << std::endl;
-    std::cout << "  H           Basculer aide ON/OFF" << std::endl;
-    std::cout << "  ESC         Quitter l'aide ou le programme" << std::endl;
-    std::cout << std::endl;
-    
-    std::cout << "EFFETS DISPONIBLES:" << std::endl;
-    std::cout << "  • Effets constants (résistance directionnelle)" << std::endl;
-    std::cout << "  • Effets périodiques (vibrations rythmées)" << std::endl;
-    std::cout << "  • Effets rampe (force progressive)" << std::endl;
-    std::cout << "  • Effets condition (ressort, amortissement)" << std::endl;
-    std::cout << std::endl;
-    
-    std::cout << "CONSEILS D'UTILISATION:" << std::endl;
-    std::cout << "  1. Commencez par 'Constant_Droite' ou 'Sinus'" << std::endl;
-    std::cout << "  2. Ajustez l'intensité selon votre confort" << std::endl;
-    std::cout << "  3. Les effets 'Condition' simulent des résistances" << std::endl;
-    std::cout << "  4. Utilisez 'S' pour arrêter rapidement si nécessaire" << std::endl;
-    std::cout << std::endl;
-    
-    std::cout << "===============================================" << std::endl;
-    std::cout << "   Appuyez sur H ou ESC pour revenir au menu  " << std::endl;
-    std::cout << "===============================================" << std::endl;
-}
-
-std::string ForceEffectSimulator::FormatForce(LONG force)
-{
-    double percentage = (force * 100.0) / MAX_FORCE;
-    char buffer[64];
-    sprintf_s(buffer, sizeof(buffer), "%d (%.1f%%)", (int)force, percentage);
-    return std::string(buffer);
+    HelpScreen help;
+    help.platform = "Windows";
+    help.intensityStep = 500;
+    help.bArrowKeys = true;
+    help.devicePath = nullptr;
+    RenderHelpScreen(std::cout, help);
 }
 
-std::string ForceEffectSimulator::FormatDirection(LONG direction)
-{
-    if (direction == 0) return "Centre";
-    else if (direction > 0) return "Droite (" + std::to_string(direction) + ")";
-    else return "Gauche (" + std::to_string(direction) + ")";
-}
-
-std::string ForceEffectSimulator::FormatDuration(DWORD duration)
+/**
+ * Axe DirectInput (plage ±MAX_FORCE pour les axes à retour de force, 0..65535
+ * par défaut pour les autres) ramené dans l'int16 de InputSnapshot.
+ */
+int16_t ForceEffectSimulator::ClampAxis(LONG value)
 {
-    if (duration == INFINITE_DURATION) return "Infinie";
-    else return std::to_string(duration) + "ms";
+    return static_cast<int16_t>(std::max(-32768L, std::min(32767L, value)));
 }
 
 void ForceEffectSimulator::CleanupEffects()
@@ -1379,6 +992,14 @@ int main()
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
     
+    // Séquences ANSI des écrans du cœur (effacement, curseur)
+    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD consoleMode = 0;
+    if (hOut != INVALID_HANDLE_VALUE && GetConsoleMode(hOut, &consoleMode))
+    {
+        SetConsoleMode(hOut, consoleMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+    
     // Génération du nom de fichier log avec timestamp
     auto now = std::chrono::system_clock::now();
     auto time_t_now = std::chrono::system_clock::to_time_t(now);
@@ -1433,10 +1054,10 @@ int main()
 Pour compiler avec Visual Studio ou MinGW:
 
 # Visual Studio
-cl /EHsc FFB_Simulator.cpp dinput8.lib dxguid.lib
+cl /EHsc /std:c++17 /I ..\..\core\src FFB_Simulator.cpp dinput8.lib dxguid.lib
 
 # MinGW
-g++ -std=c++11 FFB_Simulator.cpp -ldinput8 -ldxguid -o FFB_Simulator.exe
+g++ -std=c++17 -I ../../core/src FFB_Simulator.cpp -ldinput8 -ldxguid -o FFB_Simulator.exe
 
 Dépendances requises:
 - DirectX SDK ou Windows SDK